@@ -22,6 +22,8 @@
 #include <absl/flags/flag.h>
 #include <absl/flags/parse.h>
 #include <absl/status/status.h>
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
 
 #include "GEDS.h"
 #include "Logging.h"
@@ -38,6 +40,12 @@ ABSL_FLAG(size_t, maxFactor, 18, "Maximum factor.");
 ABSL_FLAG(std::string, outputFile, "output.csv", "Filename of the output.");
 ABSL_FLAG(bool, doCachedReads, false, "Cached reads");
 ABSL_FLAG(bool, sameFile, false, "Access the same file from all threads.");
+ABSL_FLAG(std::string, transport, "asio",
+          "Preferred data transport engine (asio|epoll). The serving node needs to offer it.");
+ABSL_FLAG(bool, stripeScaling, false,
+          "Read each payload with a single thread for each of the stripe sizes in --stripeSizes.");
+ABSL_FLAG(std::string, stripeSizes, "0,32,8,2",
+          "Comma separated read stripe sizes in MiB used by --stripeScaling. 0 disables striping.");
 
 struct BenchmarkResult {
   size_t payloadSize;
@@ -163,6 +171,71 @@ BenchmarkResult benchmark(std::shared_ptr<GEDS> geds, size_t factor, size_t numT
       /* timeLastByteP75 */ timeLastByte[std::max(0.75 * numThreads - 1.0, 0.0)]}; // NOLINT
 }
 
+GEDSConfig benchmarkConfig() {
+  auto config = GEDSConfig(FLAGS_address.CurrentValue());
+  config.port = absl::GetFlag(FLAGS_port);
+  config.localStoragePath = FLAGS_gedsRoot.CurrentValue();
+  auto transportStatus = config.set("transport", FLAGS_transport.CurrentValue());
+  if (!transportStatus.ok()) {
+    std::cout << "Invalid transport: " << transportStatus.message() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  return config;
+}
+
+std::shared_ptr<GEDS> startGEDS(GEDSConfig config) {
+  auto geds = GEDS::factory(std::move(config));
+  auto status = geds->start();
+  if (!status.ok()) {
+    std::cout << "Unable to start GEDS:" << status.message() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  return geds;
+}
+
+/**
+ * @brief Single reader throughput for each stripe size. Each stripe size requires a new GEDS
+ * instance, since the stripe configuration is fixed at startup.
+ */
+int runStripeScaling(std::ofstream &f) {
+  std::vector<size_t> stripeSizes;
+  for (auto value : absl::StrSplit(FLAGS_stripeSizes.CurrentValue(), ',', absl::SkipEmpty())) {
+    size_t stripeSize;
+    if (!absl::SimpleAtoi(value, &stripeSize)) {
+      std::cerr << "Invalid stripe size: " << value << std::endl;
+      return EXIT_FAILURE;
+    }
+    stripeSizes.push_back(stripeSize * MEGABYTE);
+  }
+
+  f << "Stripe Size,Payload Size,Throughput,Time Open,Time Last Byte" << std::endl;
+  auto factorCount = absl::GetFlag(FLAGS_maxFactor);
+  buffers.resize(1);
+  buffers[0].resize(getPayloadSize(factorCount));
+  for (auto stripeSize : stripeSizes) {
+    auto config = benchmarkConfig();
+    if (stripeSize == 0) {
+      config.readStripeThreshold = SIZE_MAX;
+    } else {
+      config.readStripeSize = stripeSize;
+      config.readStripeThreshold = stripeSize;
+    }
+    auto geds = startGEDS(config);
+    for (size_t i = 0; i <= factorCount; i++) {
+      if (absl::GetFlag(FLAGS_doCachedReads)) {
+        benchmark(geds, i, 1);
+      }
+      auto result = benchmark(geds, i, 1);
+      std::cout << "Stripe " << stripeSize / MEGABYTE << " MiB: " << result.payloadSize << ": "
+                << result.rate << " MB/s" << std::endl;
+      f << stripeSize << "," << result.payloadSize << "," << result.rate << ","
+        << result.timeOpenAvg << "," << result.timeLastByteAvg << std::endl;
+    }
+    (void)geds->stop();
+  }
+  return EXIT_SUCCESS;
+}
+
 int main(int argc, char **argv) {
   absl::ParseCommandLine(argc, argv);
 
@@ -172,21 +245,19 @@ int main(int argc, char **argv) {
               << std::endl;
     exit(EXIT_FAILURE);
   }
+  if (absl::GetFlag(FLAGS_stripeScaling)) {
+    auto result = runStripeScaling(f);
+    f.close();
+    return result;
+  }
+
   f << "Payload Size,Thread Count,Throughput,"
     << "Time Open [avg],Time Open [min],Time Open [p25],Time Open [p50], Time Open [p75],"
     << "Time Open [max],"
     << "Time Last Byte [avg],Time Last Byte [min],Time Last Byte [p25],Time Last Byte [p50],"
     << "Time Last Byte [p75],Time Last Byte [max]" << std::endl;
 
-  auto config = GEDSConfig(FLAGS_address.CurrentValue());
-  config.port = absl::GetFlag(FLAGS_port);
-  config.localStoragePath = FLAGS_gedsRoot.CurrentValue();
-  auto geds = GEDS::factory(config);
-  auto status = geds->start();
-  if (!status.ok()) {
-    std::cout << "Unable to start GEDS:" << status.message() << std::endl;
-    exit(EXIT_FAILURE);
-  }
+  auto geds = startGEDS(benchmarkConfig());
 
   auto threadCount = absl::GetFlag(FLAGS_maxThreads);
   buffers.resize(threadCount);
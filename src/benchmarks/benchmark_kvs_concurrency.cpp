@@ -0,0 +1,78 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <absl/status/status.h>
+
+#include "MDSKVS.h"
+#include "Object.h"
+
+ABSL_FLAG(size_t, keys, 1000000, "Number of keys created in each run.");
+ABSL_FLAG(size_t, maxThreads, 16, "Maximum number of concurrent writers.");
+
+static const std::string bucket = "shuffle";
+
+/**
+ * @brief Run `action(thread, i)` for all `numKeys` keys split over `threads` threads. Returns the
+ * throughput in operations per second.
+ */
+template <typename F> double run(size_t threads, size_t numKeys, F &&action) {
+  std::vector<std::thread> workers;
+  auto startTime = std::chrono::steady_clock::now();
+  for (size_t t = 0; t < threads; t++) {
+    workers.emplace_back([&, t]() {
+      for (size_t i = t; i < numKeys; i += threads) {
+        if (!action(i)) {
+          std::cerr << "Operation " << i << " failed." << std::endl;
+          exit(EXIT_FAILURE);
+        }
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  auto endTime = std::chrono::steady_clock::now();
+  auto seconds = std::chrono::duration<double>(endTime - startTime).count();
+  return numKeys / seconds;
+}
+
+int main(int argc, char **argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  auto numKeys = absl::GetFlag(FLAGS_keys);
+  auto maxThreads = absl::GetFlag(FLAGS_maxThreads);
+
+  std::vector<std::string> keys;
+  keys.reserve(numKeys);
+  for (size_t i = 0; i < numKeys; i++) {
+    keys.push_back("shuffle_0/map_" + std::to_string(i / 1000) + "/reduce_" +
+                   std::to_string(i % 1000));
+  }
+
+  std::cout << "Threads,Create [ops/s],Lookup [ops/s]" << std::endl;
+  for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+    MDSKVS kvs;
+    (void)kvs.createBucket(bucket);
+    auto create = run(threads, numKeys, [&](size_t i) {
+      return kvs
+          .createObject(geds::Object{geds::ObjectID{bucket, keys[i]},
+                                     geds::ObjectInfo{"geds://", i, i, std::nullopt}})
+          .ok();
+    });
+    auto lookup = run(threads, numKeys, [&](size_t i) { return kvs.lookup(bucket, keys[i]).ok(); });
+    std::cout << threads << "," << create << "," << lookup << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,115 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <absl/status/status.h>
+
+#include "MDSKVS.h"
+#include "Object.h"
+#include "Path.h"
+
+ABSL_FLAG(size_t, keys, 10000000, "Number of synthetic keys.");
+ABSL_FLAG(size_t, folders, 100, "Number of top-level folders.");
+ABSL_FLAG(size_t, subfolders, 100, "Number of subfolders per top-level folder.");
+ABSL_FLAG(size_t, repetitions, 10, "Number of repetitions of each listing.");
+ABSL_FLAG(bool, compareLinearScan, true,
+          "Also list with a linear scan over an ordered set of all keys.");
+
+static const std::string bucket = "benchmark";
+
+static std::string syntheticKey(size_t i, size_t folders, size_t subfolders) {
+  return "folder" + std::to_string(i % folders) + "/sub" +
+         std::to_string((i / folders) % subfolders) + "/object" + std::to_string(i);
+}
+
+template <typename F> double measure(size_t repetitions, F &&f) {
+  auto startTime = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < repetitions; i++) {
+    f();
+  }
+  auto endTime = std::chrono::steady_clock::now();
+  return (double)std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+             .count() /
+         repetitions;
+}
+
+/**
+ * @brief Delimited listing which visits every key below the prefix.
+ */
+static size_t linearScan(const std::set<utility::Path, std::less<>> &keys,
+                         const std::string &prefix, char delimiter) {
+  std::set<std::string> commonPrefixes;
+  size_t objects = 0;
+  auto [prefixStart, prefixEnd] = utility::prefixSearch(keys, prefix);
+  for (auto it = prefixStart; it != prefixEnd; it++) {
+    auto loc = it->name.find(delimiter, prefix.size());
+    if (loc != std::string::npos) {
+      commonPrefixes.insert(it->name.substr(0, loc + 1));
+    } else {
+      objects++;
+    }
+  }
+  return objects + commonPrefixes.size();
+}
+
+int main(int argc, char **argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  auto numKeys = absl::GetFlag(FLAGS_keys);
+  auto folders = absl::GetFlag(FLAGS_folders);
+  auto subfolders = absl::GetFlag(FLAGS_subfolders);
+  auto repetitions = absl::GetFlag(FLAGS_repetitions);
+  auto compare = absl::GetFlag(FLAGS_compareLinearScan);
+
+  MDSKVS kvs;
+  (void)kvs.createBucket(bucket);
+  std::set<utility::Path, std::less<>> keys;
+  auto insert = measure(1, [&]() {
+    for (size_t i = 0; i < numKeys; i++) {
+      auto key = syntheticKey(i, folders, subfolders);
+      auto status = kvs.createObject(
+          geds::Object{geds::ObjectID{bucket, key}, geds::ObjectInfo{"geds://", i, i, {}}});
+      if (!status.ok()) {
+        std::cerr << "Unable to create " << key << ": " << status.message() << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+  });
+  if (compare) {
+    for (size_t i = 0; i < numKeys; i++) {
+      keys.emplace(utility::Path{syntheticKey(i, folders, subfolders)});
+    }
+  }
+  std::cout << "Inserted " << numKeys << " keys in " << insert / 1000 << " ms" << std::endl;
+
+  std::cout << "Prefix,Entries,Radix tree [us/op],Linear scan [us/op]" << std::endl;
+  for (const std::string prefix : {"", "folder0/", "folder0/sub0/"}) {
+    size_t entries = 0;
+    auto radix = measure(repetitions, [&]() {
+      auto list = kvs.listObjects(bucket, prefix, '/');
+      if (!list.ok()) {
+        std::cerr << "Unable to list " << prefix << ": " << list.status().message() << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      entries = list->first.size() + list->second.size();
+    });
+    std::cout << "\"" << prefix << "\"," << entries << "," << radix << ",";
+    if (compare) {
+      std::cout << measure(repetitions, [&]() { entries = linearScan(keys, prefix, '/'); });
+    }
+    std::cout << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
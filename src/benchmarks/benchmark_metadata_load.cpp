@@ -0,0 +1,144 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <grpcpp/grpcpp.h>
+
+#include "Ports.h"
+
+#include "geds.grpc.pb.h"
+#include "geds.pb.h"
+
+ABSL_FLAG(std::string, address, "localhost:" + std::to_string(defaultMetdataServerPort),
+          "Address of the metadata server.");
+ABSL_FLAG(size_t, requests, 20000, "Number of requests of each kind sent in each run.");
+ABSL_FLAG(size_t, maxThreads, 64, "Maximum number of concurrent clients.");
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+  double qps;
+  double p50;
+  double p99;
+};
+
+/**
+ * @brief Send `numRequests` requests `action(stub, i)` from `threads` clients with a connection
+ * each. Returns the throughput and the latency percentiles in microseconds.
+ */
+template <typename F>
+Result run(const std::vector<std::unique_ptr<geds::rpc::MetadataService::Stub>> &stubs,
+           size_t threads, size_t numRequests, F &&action) {
+  std::vector<std::vector<double>> latencies(threads);
+  std::vector<std::thread> workers;
+  auto startTime = Clock::now();
+  for (size_t t = 0; t < threads; t++) {
+    workers.emplace_back([&, t]() {
+      latencies[t].reserve(numRequests / threads + 1);
+      for (size_t i = t; i < numRequests; i += threads) {
+        auto requestStart = Clock::now();
+        if (!action(*stubs[t], i)) {
+          std::cerr << "Request " << i << " failed." << std::endl;
+          exit(EXIT_FAILURE);
+        }
+        latencies[t].push_back(
+            std::chrono::duration<double, std::micro>(Clock::now() - requestStart).count());
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  auto seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+  std::vector<double> all;
+  all.reserve(numRequests);
+  for (const auto &l : latencies) {
+    all.insert(all.end(), l.begin(), l.end());
+  }
+  std::sort(all.begin(), all.end());
+  auto percentile = [&](double p) { return all[std::min(all.size() - 1, size_t(p * all.size()))]; };
+  return Result{numRequests / seconds, percentile(0.5), percentile(0.99)};
+}
+
+int main(int argc, char **argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  auto address = absl::GetFlag(FLAGS_address);
+  auto numRequests = absl::GetFlag(FLAGS_requests);
+  auto maxThreads = absl::GetFlag(FLAGS_maxThreads);
+
+  // Separate subchannels give every client its own connection, like separate GEDS instances.
+  std::vector<std::unique_ptr<geds::rpc::MetadataService::Stub>> stubs;
+  for (size_t t = 0; t < maxThreads; t++) {
+    grpc::ChannelArguments arguments;
+    arguments.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+    auto channel =
+        grpc::CreateCustomChannel(address, grpc::InsecureChannelCredentials(), arguments);
+    if (!channel->WaitForConnected(std::chrono::system_clock::now() + std::chrono::seconds(10))) {
+      std::cerr << "Unable to connect to " << address << std::endl;
+      return EXIT_FAILURE;
+    }
+    stubs.push_back(geds::rpc::MetadataService::NewStub(channel));
+  }
+
+  // A fresh bucket per invocation keeps the creates of repeated runs from colliding.
+  auto bucket = "benchmark-" + std::to_string(::getpid());
+  {
+    grpc::ClientContext context;
+    geds::rpc::Bucket request;
+    geds::rpc::StatusResponse response;
+    request.set_bucket(bucket);
+    auto status = stubs[0]->CreateBucket(&context, request, &response);
+    if (!status.ok() || response.code() != geds::rpc::StatusCode::OK) {
+      std::cerr << "Unable to create bucket " << bucket << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "Threads,Create [ops/s],Create p50 [us],Create p99 [us],"
+            << "Lookup [ops/s],Lookup p50 [us],Lookup p99 [us]" << std::endl;
+  for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+    auto prefix = "run_" + std::to_string(threads) + "/key_";
+    auto create = run(stubs, threads, numRequests,
+                      [&](geds::rpc::MetadataService::Stub &stub, size_t i) {
+                        grpc::ClientContext context;
+                        geds::rpc::Object request;
+                        geds::rpc::StatusResponse response;
+                        request.mutable_id()->set_bucket(bucket);
+                        request.mutable_id()->set_key(prefix + std::to_string(i));
+                        request.mutable_info()->set_location("geds://benchmark");
+                        request.mutable_info()->set_size(i);
+                        request.mutable_info()->set_sealedoffset(i);
+                        auto status = stub.Create(&context, request, &response);
+                        return status.ok() && response.code() == geds::rpc::StatusCode::OK;
+                      });
+    auto lookup = run(stubs, threads, numRequests,
+                      [&](geds::rpc::MetadataService::Stub &stub, size_t i) {
+                        grpc::ClientContext context;
+                        geds::rpc::ObjectID request;
+                        geds::rpc::ObjectResponse response;
+                        request.set_bucket(bucket);
+                        request.set_key(prefix + std::to_string(i));
+                        auto status = stub.Lookup(&context, request, &response);
+                        return status.ok() && !response.has_error();
+                      });
+    std::cout << threads << "," << create.qps << "," << create.p50 << "," << create.p99 << ","
+              << lookup.qps << "," << lookup.p50 << "," << lookup.p99 << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,76 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <absl/status/status.h>
+
+#include "TcpDataTransport.h"
+
+ABSL_FLAG(size_t, iterations, 1000000, "Number of requests to encode and decode.");
+ABSL_FLAG(size_t, keyLength, 32, "Length of the object key.");
+ABSL_FLAG(std::string, bucket, "benchmark", "Bucket name used in the requests.");
+
+using namespace geds::tcp_transport;
+
+template <typename F> double measure(size_t iterations, F &&f) {
+  auto startTime = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; i++) {
+    if (!f(i)) {
+      std::cerr << "Request " << i << " failed." << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+  auto endTime = std::chrono::steady_clock::now();
+  return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime)
+             .count() /
+         iterations;
+}
+
+int main(int argc, char **argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  auto iterations = absl::GetFlag(FLAGS_iterations);
+  auto bucket = absl::GetFlag(FLAGS_bucket);
+  auto key = std::string(absl::GetFlag(FLAGS_keyLength), 'k');
+
+  std::string parsedBucket;
+  std::string parsedKey;
+  size_t offset = 0;
+  size_t length = 0;
+  uint64_t requestId = 0;
+
+  auto text = measure(iterations, [&](size_t i) {
+    auto request = createGetRequest(bucket, key, i, 4096);
+    request.push_back('\0');
+    return parseGetRequest(request, parsedBucket, parsedKey, offset, length).ok() && offset == i;
+  });
+
+  auto binary = measure(iterations, [&](size_t i) {
+    auto request = createBinaryGetRequest(i, bucket, key, i, 4096);
+    if (!request.ok()) {
+      return false;
+    }
+    return parseBinaryGetRequest(*request, requestId, parsedBucket, parsedKey, offset, length)
+               .ok() &&
+           offset == i;
+  });
+
+  std::cout << "Protocol,Request Size,Encode+Decode [ns/op]" << std::endl;
+  std::cout << "text," << createGetRequest(bucket, key, 0, 4096).size() + 1 << "," << text
+            << std::endl;
+  std::cout << "binary," << sizeof(RequestHeader) + bucket.size() + key.size() << "," << binary
+            << std::endl;
+  std::cout << "Speedup: " << text / binary << "x" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -13,11 +13,19 @@ static_assert(static_cast<int>(geds::rpc::FileTransferProtocol::Socket) ==
 static_assert(static_cast<int>(geds::rpc::FileTransferProtocol::RDMA) ==
               static_cast<int>(geds::FileTransferProtocol::RDMA));
 
+static_assert(static_cast<int>(geds::rpc::FileTransferProtocol::SocketEpoll) ==
+              static_cast<int>(geds::FileTransferProtocol::SocketEpoll));
+
+static_assert(static_cast<int>(geds::rpc::FileTransferProtocol::UnixDomain) ==
+              static_cast<int>(geds::FileTransferProtocol::UnixDomain));
+
 namespace geds {
 
 const std::vector<geds::rpc::FileTransferProtocol> &supportedProtocols() {
   static const auto result = std::vector<geds::rpc::FileTransferProtocol> {
     geds::rpc::FileTransferProtocol::Socket,
+    geds::rpc::FileTransferProtocol::SocketEpoll,
+    geds::rpc::FileTransferProtocol::UnixDomain,
 #if HAVE_RDMA
         FileTransferProtocol::RDMA,
 #endif
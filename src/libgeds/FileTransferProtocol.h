@@ -24,7 +24,7 @@ namespace geds {
  *
  * The types of this file need to match the types in geds.proto.
  */
-enum class FileTransferProtocol : uint8_t { Socket = 0, RDMA = 1 };
+enum class FileTransferProtocol : uint8_t { Socket = 0, RDMA = 1, SocketEpoll = 2, UnixDomain = 3 };
 
 struct ObjTransferEndpoint {
   std::string hostname;
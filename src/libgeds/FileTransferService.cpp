@@ -5,18 +5,26 @@
 
 #include "FileTransferService.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <tuple>
 
 #include <absl/status/status.h>
 
 #include "FileTransferProtocol.h"
+#include "GEDS.h"
 #include "GEDSInternal.h"
 #include "Logging.h"
 #include "TcpClient.h"
 #include "TcpDataTransport.h"
+#include "UnixDomainTransport.h"
 #include "geds.pb.h"
 
 namespace geds {
@@ -65,7 +73,52 @@ absl::Status FileTransferService::connect() {
     return endpoints.status();
   }
 
-  for (size_t i = 0; i < geds::MAXIMUM_TCP_THREADS(); i++) {
+  // Peers on the same host hand out file descriptors through a Unix domain socket. The TCP
+  // connections are set up as well: Reads fall back to them if the local data path fails.
+  if (_geds->config().localTransport) {
+    for (auto &ep : *endpoints) {
+      if (std::get<2>(ep) != FileTransferProtocol::UnixDomain) {
+        continue;
+      }
+      auto client = std::make_shared<UnixDomainClient>(std::get<0>(ep));
+      auto status = client->connect();
+      if (status.ok()) {
+        LOG_DEBUG("Using the local data path @", std::get<0>(ep), " for ", nodeAddress);
+        _localClient = std::move(client);
+        break;
+      }
+      LOG_DEBUG("Unable to use the local data path: ", status.message());
+    }
+  }
+
+  // Prefer the engine this instance is configured with if the peer offers several.
+  auto hasEndpoint = [&](FileTransferProtocol protocol) {
+    return std::any_of(endpoints->begin(), endpoints->end(), [&](const auto &ep) {
+      return std::get<2>(ep) == protocol && std::get<0>(ep) == nodeLoc;
+    });
+  };
+  bool useEpoll = hasEndpoint(FileTransferProtocol::SocketEpoll) &&
+                  (_geds->config().transport == "epoll" ||
+                   !hasEndpoint(FileTransferProtocol::Socket));
+  if (useEpoll) {
+    for (auto &ep : *endpoints) {
+      if (std::get<2>(ep) != FileTransferProtocol::SocketEpoll || std::get<0>(ep) != nodeLoc) {
+        continue;
+      }
+      auto transport = _geds->tcpTransport();
+      if (!transport.ok()) {
+        return transport.status();
+      }
+      LOG_DEBUG("Connecting the TcpTransport to ", std::get<0>(ep), ":", std::get<1>(ep));
+      auto peer = (*transport)->connect(std::get<0>(ep), std::get<1>(ep));
+      if (peer.ok()) {
+        _tcpPeer = *peer;
+        break;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < geds::MAXIMUM_TCP_THREADS() && _tcpPeer == nullptr; i++) {
     for (auto &ep : *endpoints) {
       if (std::get<2>(ep) == FileTransferProtocol::Socket) {
         const auto &ep_ip = std::get<0>(ep);
@@ -73,24 +126,35 @@ absl::Status FileTransferService::connect() {
           continue;
         }
         auto ep_port = std::get<1>(ep);
-        LOG_DEBUG("Creating a new TcpClient for ", ep_ip, ":", ep_port);
-        auto connection = std::make_shared<TcpClient>(ep_ip, ep_port);
+        // Fall back to the text protocol if the peer does not support the binary protocol.
+        auto ep_version = std::min(std::get<3>(ep), tcp_transport::BinaryProtocolVersion);
+        LOG_DEBUG("Creating a new TcpClient for ", ep_ip, ":", ep_port, " (protocol version ",
+                  (int)ep_version, ")");
+        auto connection = std::make_shared<TcpClient>(ep_ip, ep_port, ep_version);
         auto status = connection->connect();
         if (!status.ok()) {
           connection = nullptr;
           continue;
         }
-        _connections.push(connection);
+        _connections.emplace_back(std::move(connection));
         break;
       }
     }
   }
 
+  if (_connections.empty() && _tcpPeer == nullptr) {
+    if (_localClient == nullptr) {
+      return absl::UnavailableError("Unable to establish a data connection to " + nodeAddress +
+                                    ".");
+    }
+    LOG_WARNING("Unable to establish a TCP connection to ", nodeAddress,
+                ": Only the local data path is available.");
+  }
   _connectionState = ConnectionState::Connected;
   return absl::OkStatus();
 }
 
-absl::StatusOr<std::vector<std::tuple<std::string, uint16_t, FileTransferProtocol>>>
+absl::StatusOr<std::vector<std::tuple<std::string, uint16_t, FileTransferProtocol, uint8_t>>>
 FileTransferService::availTransportEndpoints() {
   // Function is called during connect, so no check.
   geds::rpc::EmptyParams request;
@@ -105,11 +169,17 @@ FileTransferService::availTransportEndpoints() {
   }
 
   const auto rpc_results = response.endpoint();
-  auto results = std::vector<std::tuple<std::string, uint16_t, FileTransferProtocol>>{};
+  auto results =
+      std::vector<std::tuple<std::string, uint16_t, FileTransferProtocol, uint8_t>>{};
   for (const auto &i : rpc_results) {
+    if (i.type() == rpc::UnixDomain && i.hostid() != unix_transport::hostId()) {
+      // The peer runs on a different host.
+      continue;
+    }
+    auto version = static_cast<uint8_t>(
+        std::min<uint32_t>(i.protocolversion(), std::numeric_limits<uint8_t>::max()));
     results.emplace_back(std::make_tuple(i.address(), i.port(),
-                                         i.type() == rpc::RDMA ? FileTransferProtocol::RDMA
-                                                               : FileTransferProtocol::Socket));
+                                         static_cast<FileTransferProtocol>(i.type()), version));
   }
   return results;
 }
@@ -120,10 +190,9 @@ absl::Status FileTransferService::disconnect() {
     return absl::UnknownError("The service is in the wrong state!");
   }
   _connectionState = ConnectionState::Unknown;
-  for (size_t i = 0; i < MAXIMUM_TCP_THREADS(); i++) {
-    auto tcp = _connections.pop_wait_until_available();
-    tcp = nullptr;
-  }
+  _connections.clear();
+  _tcpPeer = nullptr;
+  _localClient = nullptr;
   _channel = nullptr;
   _connectionState = ConnectionState::Disconnected;
   return absl::OkStatus();
@@ -132,11 +201,226 @@ absl::Status FileTransferService::disconnect() {
 absl::StatusOr<size_t> FileTransferService::readBytes(const std::string &bucket,
                                                       const std::string &key, uint8_t *buffer,
                                                       size_t position, size_t length) {
+  auto local = localClient();
+  if (!local.ok()) {
+    return local.status();
+  }
+  if (*local != nullptr) {
+    auto count = (*local)->readBytes(bucket, key, buffer, position, length);
+    if (count.ok() || !hasTcpConnection()) {
+      return count;
+    }
+    LOG_DEBUG("Reading ", bucket, "/", key, " through the local data path failed: ",
+              count.status().message(), ". Falling back to TCP.");
+  }
+  return readBytesTcp(bucket, key, buffer, position, length);
+}
+
+absl::StatusOr<size_t> FileTransferService::readBytesTcp(const std::string &bucket,
+                                                         const std::string &key, uint8_t *buffer,
+                                                         size_t position, size_t length) {
+  auto peer = epollPeer();
+  if (!peer.ok()) {
+    return peer.status();
+  }
+  if (*peer != nullptr) {
+    return (*peer)->readBytes(bucket, key, buffer, position, length);
+  }
+  const auto &config = _geds->config();
+  if (config.readStripeSize > 0 && length >= config.readStripeThreshold &&
+      length > config.readStripeSize) {
+    auto connections = healthyConnections();
+    if (connections.size() > 1) {
+      return readStriped(connections, bucket, key, buffer, position, length);
+    }
+  }
+  auto tcp = selectConnection();
+  if (!tcp.ok()) {
+    return tcp.status();
+  }
+  return (*tcp)->readBytes(bucket, key, buffer, position, length);
+}
+
+absl::StatusOr<size_t>
+FileTransferService::readStriped(const std::vector<std::shared_ptr<TcpClient>> &connections,
+                                 const std::string &bucket, const std::string &key,
+                                 uint8_t *buffer, size_t position, size_t length) {
+  const auto stripeSize = _geds->config().readStripeSize;
+  const auto numStripes = (length + stripeSize - 1) / stripeSize;
+  const auto numWorkers = std::min(connections.size(), numStripes);
+  LOG_DEBUG("Reading ", length, " bytes of ", bucket, "/", key, " as ", numStripes,
+            " stripes over ", numWorkers, " connections");
+
+  struct StripeHelper {
+    std::vector<size_t> counts;
+    std::atomic<size_t> next = 0;
+    std::atomic<bool> failed = false;
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t done = 0;
+    absl::Status status;
+  };
+  auto h = std::make_shared<StripeHelper>();
+  h->counts.resize(numStripes, 0);
+  // Workers which start after all stripes are claimed return without touching `buffer`.
+  auto readStripes = [h, bucket, key, buffer, position, length, stripeSize,
+                      numStripes](std::shared_ptr<TcpClient> connection) {
+    for (auto stripe = h->next++; stripe < numStripes; stripe = h->next++) {
+      auto status = absl::OkStatus();
+      if (!h->failed) {
+        auto offset = stripe * stripeSize;
+        auto count = connection->readBytes(bucket, key, buffer + offset, position + offset,
+                                           std::min(stripeSize, length - offset));
+        if (count.ok()) {
+          h->counts[stripe] = *count;
+        } else {
+          status = count.status();
+        }
+      }
+      std::lock_guard lock(h->mutex);
+      if (!status.ok() && h->status.ok()) {
+        h->status = status;
+        h->failed = true;
+      }
+      h->done += 1;
+      h->cv.notify_all();
+    }
+  };
+  // The caller reads stripes as well, so the read completes even if all I/O threads are busy.
+  for (size_t i = 1; i < numWorkers; i++) {
+    _geds->postIO([readStripes, connection = connections[i]]() { readStripes(connection); });
+  }
+  readStripes(connections[0]);
+  {
+    std::unique_lock lock(h->mutex);
+    h->cv.wait(lock, [h, numStripes]() { return h->done == numStripes; });
+  }
+  if (!h->status.ok()) {
+    return h->status;
+  }
+  const auto &counts = h->counts;
+
+  // A short stripe marks the end of the object: Subsequent stripes are empty.
+  size_t total = 0;
+  for (size_t stripe = 0; stripe < numStripes; stripe++) {
+    total += counts[stripe];
+    if (counts[stripe] < std::min(stripeSize, length - stripe * stripeSize)) {
+      break;
+    }
+  }
+  return total;
+}
+
+absl::StatusOr<std::vector<size_t>>
+FileTransferService::readv(const std::string &bucket, const std::string &key,
+                           const std::vector<geds::ReadRange> &ranges) {
+  auto local = localClient();
+  if (!local.ok()) {
+    return local.status();
+  }
+  if (*local != nullptr) {
+    auto counts = (*local)->readv(bucket, key, ranges);
+    if (counts.ok() || !hasTcpConnection()) {
+      return counts;
+    }
+    LOG_DEBUG("Reading ", bucket, "/", key, " through the local data path failed: ",
+              counts.status().message(), ". Falling back to TCP.");
+  }
+  return readvTcp(bucket, key, ranges);
+}
+
+absl::StatusOr<std::vector<size_t>>
+FileTransferService::readvTcp(const std::string &bucket, const std::string &key,
+                              const std::vector<geds::ReadRange> &ranges) {
+  auto peer = epollPeer();
+  if (!peer.ok()) {
+    return peer.status();
+  }
+  if (*peer != nullptr) {
+    // The epoll engine does not support vectored requests.
+    std::vector<size_t> result;
+    result.reserve(ranges.size());
+    for (const auto &range : ranges) {
+      auto count = (*peer)->readBytes(bucket, key, range.buffer, range.position, range.length);
+      if (!count.ok()) {
+        return count.status();
+      }
+      result.push_back(*count);
+    }
+    return result;
+  }
+  auto tcp = selectConnection();
+  if (!tcp.ok()) {
+    return tcp.status();
+  }
+  return (*tcp)->readv(bucket, key, ranges);
+}
+
+absl::StatusOr<std::shared_ptr<TcpPeer>> FileTransferService::epollPeer() {
+  auto lock = getReadLock();
   CHECK_CONNECTED
-  auto tcp = _connections.pop_wait_until_available();
-  auto status = tcp->readBytes(bucket, key, buffer, position, length);
-  _connections.push(tcp);
-  return status;
+  return _tcpPeer;
+}
+
+absl::StatusOr<std::shared_ptr<UnixDomainClient>> FileTransferService::localClient() {
+  auto lock = getReadLock();
+  CHECK_CONNECTED
+  return _localClient;
+}
+
+bool FileTransferService::hasTcpConnection() {
+  auto lock = getReadLock();
+  return _tcpPeer != nullptr || !_connections.empty();
+}
+
+void FileTransferService::invalidate(const std::string &bucket, const std::string &key) {
+  std::shared_ptr<UnixDomainClient> local;
+  {
+    auto lock = getReadLock();
+    local = _localClient;
+  }
+  if (local != nullptr) {
+    local->invalidate(bucket, key);
+  }
+}
+
+std::vector<std::shared_ptr<TcpClient>> FileTransferService::healthyConnections() {
+  auto lock = getReadLock();
+  std::vector<std::shared_ptr<TcpClient>> result;
+  if (_connectionState != ConnectionState::Connected) {
+    return result;
+  }
+  result.reserve(_connections.size());
+  for (const auto &connection : _connections) {
+    if (!connection->failed()) {
+      result.push_back(connection);
+    }
+  }
+  return result;
+}
+
+absl::StatusOr<std::shared_ptr<TcpClient>> FileTransferService::selectConnection() {
+  auto lock = getReadLock();
+  CHECK_CONNECTED
+  std::shared_ptr<TcpClient> result;
+  size_t minInFlight = SIZE_MAX;
+  for (const auto &connection : _connections) {
+    if (connection->failed()) {
+      continue;
+    }
+    auto inFlight = connection->inFlight();
+    if (inFlight < minInFlight) {
+      result = connection;
+      minInFlight = inFlight;
+    }
+    if (inFlight == 0) {
+      break;
+    }
+  }
+  if (result == nullptr) {
+    return absl::UnavailableError("All data connections to " + nodeAddress + " failed.");
+  }
+  return result;
 }
 
 } // namespace geds
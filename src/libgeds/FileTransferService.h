@@ -9,12 +9,14 @@
 #include <absl/status/statusor.h>
 #include <grpcpp/grpcpp.h>
 #include <memory>
+#include <vector>
 
-#include "ConcurrentQueue.h"
 #include "FileTransferProtocol.h"
 #include "GEDSInternal.h"
 #include "RWConcurrentObjectAdaptor.h"
 #include "TcpClient.h"
+#include "TcpTransport.h"
+#include "UnixDomainClient.h"
 #include "geds.grpc.pb.h"
 
 class GEDS;
@@ -27,9 +29,58 @@ class FileTransferService: public utility::RWConcurrentObjectAdaptor {
   std::unique_ptr<geds::rpc::GEDSService::Stub> _stub;
 
   std::shared_ptr<GEDS> _geds;
-  utility::ConcurrentQueue<std::shared_ptr<TcpClient>> _connections;
-
-  absl::StatusOr<std::vector<std::tuple<std::string, uint16_t, FileTransferProtocol>>>
+  std::vector<std::shared_ptr<TcpClient>> _connections;
+  // Set if the peer is served by the epoll TcpTransport engine.
+  std::shared_ptr<TcpPeer> _tcpPeer;
+  // Set if the peer runs on the same host and serves the Unix domain data path.
+  std::shared_ptr<UnixDomainClient> _localClient;
+
+  /**
+   * @brief Select the connection with the fewest outstanding requests.
+   */
+  absl::StatusOr<std::shared_ptr<TcpClient>> selectConnection();
+
+  /**
+   * @brief Returns the connections which have not failed.
+   */
+  std::vector<std::shared_ptr<TcpClient>> healthyConnections();
+
+  /**
+   * @brief Read a large range as stripes of `readStripeSize` bytes. The connections read stripes
+   * directly into `buffer` on the I/O thread pool and the calling thread until all are issued.
+   */
+  absl::StatusOr<size_t> readStriped(const std::vector<std::shared_ptr<TcpClient>> &connections,
+                                     const std::string &bucket, const std::string &key,
+                                     uint8_t *buffer, size_t position, size_t length);
+
+  /**
+   * @brief Returns true if the peer is reachable through the epoll peer or asio connections.
+   */
+  bool hasTcpConnection();
+
+  /**
+   * @brief Read through the epoll peer or the asio connections.
+   */
+  absl::StatusOr<size_t> readBytesTcp(const std::string &bucket, const std::string &key,
+                                      uint8_t *buffer, size_t position, size_t length);
+
+  absl::StatusOr<std::vector<size_t>> readvTcp(const std::string &bucket, const std::string &key,
+                                               const std::vector<geds::ReadRange> &ranges);
+
+  /**
+   * @brief Returns the epoll peer or nullptr if the asio connections are used.
+   */
+  absl::StatusOr<std::shared_ptr<TcpPeer>> epollPeer();
+
+  /**
+   * @brief Returns the Unix domain client or nullptr if the peer is not local.
+   */
+  absl::StatusOr<std::shared_ptr<UnixDomainClient>> localClient();
+
+  /**
+   * @brief Returns the endpoints of the peer as (address, port, protocol, wire protocol version).
+   */
+  absl::StatusOr<std::vector<std::tuple<std::string, uint16_t, FileTransferProtocol, uint8_t>>>
   availTransportEndpoints();
 
 public:
@@ -44,6 +95,14 @@ public:
   absl::StatusOr<size_t> readBytes(const std::string &bucket, const std::string &key,
                                    uint8_t *buffer, size_t position, size_t length);
 
+  absl::StatusOr<std::vector<size_t>> readv(const std::string &bucket, const std::string &key,
+                                            const std::vector<geds::ReadRange> &ranges);
+
+  /**
+   * @brief Drop state cached for the object, e.g. the descriptor of the local data path.
+   */
+  void invalidate(const std::string &bucket, const std::string &key);
+
   template <typename T, typename = std::enable_if_t<std::is_trivially_copyable<T>::value>>
   absl::StatusOr<size_t> read(const std::string &bucket, const std::string &key, T *buffer,
                               size_t position, size_t length) {
@@ -12,8 +12,10 @@
 #include <cstring>
 #include <fcntl.h>
 #include <filesystem>
+#include <linux/fs.h>
 #include <stdexcept>
 #include <string>
+#include <sys/ioctl.h>
 #include <unistd.h>
 
 #include "Logging.h"
@@ -52,6 +54,51 @@ absl::Status removeFile(const std::string &path) {
   return absl::OkStatus();
 }
 
+absl::Status renameFile(const std::string &from, const std::string &to) {
+  if (std::rename(from.c_str(), to.c_str()) != 0) {
+    int error = errno;
+    auto message = "Unable to rename " + from + " to " + to + ": " + std::strerror(error);
+    LOG_ERROR(message);
+    return absl::UnknownError(message);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status cloneFile(int srcFd, int destFd) {
+  if (ioctl(destFd, FICLONE, srcFd) != 0) {
+    int error = errno;
+    return absl::UnimplementedError(std::string{"Unable to clone file: "} + std::strerror(error));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<size_t> copyFileRange(int srcFd, size_t srcPosition, int destFd,
+                                     size_t destPosition, size_t length) {
+  auto srcOffset = static_cast<loff_t>(srcPosition);
+  auto destOffset = static_cast<loff_t>(destPosition);
+  size_t count = 0;
+  while (count < length) {
+    auto n = copy_file_range(srcFd, &srcOffset, destFd, &destOffset, length - count, 0);
+    if (n < 0) {
+      int error = errno;
+      if (error == EINTR) {
+        continue;
+      }
+      auto message = std::string{"Unable to copy file range: "} + std::strerror(error);
+      // The kernel cannot copy between these files: Callers fall back to a buffered copy.
+      if (error == EXDEV || error == ENOSYS || error == EOPNOTSUPP || error == EINVAL) {
+        return absl::UnimplementedError(message);
+      }
+      return absl::UnknownError(message);
+    }
+    if (n == 0) {
+      break;
+    }
+    count += static_cast<size_t>(n);
+  }
+  return count;
+}
+
 absl::Status mkdir(const std::string &path) {
   std::error_code errorCode;
   auto fsPath = std::filesystem::path(path);
@@ -8,6 +8,7 @@
 
 #include <absl/status/status.h>
 #include <absl/status/statusor.h>
+#include <cstddef>
 #include <string>
 
 namespace geds::filesystem {
@@ -15,6 +16,20 @@ namespace geds::filesystem {
 absl::StatusOr<int> createFile(const std::string &path);
 absl::Status touchFile(const std::string &path);
 absl::Status removeFile(const std::string &path);
+absl::Status renameFile(const std::string &from, const std::string &to);
+
+/**
+ * @brief Make `destFd` share the blocks of `srcFd` (reflink). Fails on file systems without
+ * reflinks, e.g. ext4.
+ */
+absl::Status cloneFile(int srcFd, int destFd);
+
+/**
+ * @brief Copy up to `length` bytes in the kernel with `copy_file_range`. Returns the number of
+ * bytes copied, which is less than `length` at the end of the source.
+ */
+absl::StatusOr<size_t> copyFileRange(int srcFd, size_t srcPosition, int destFd,
+                                     size_t destPosition, size_t length);
 absl::Status mkdir(const std::string &path);
 std::string mktempdir(const std::string &name);
 std::string tempFile(const std::string &folder, const std::string &prefix);
@@ -6,10 +6,13 @@
 #include "GEDS.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
+#include <future>
 #include <iostream>
 #include <iterator>
 #include <memory>
@@ -27,6 +30,7 @@
 #include <typeinfo>
 #include <unistd.h>
 #include <utility>
+#include <vector>
 
 #include <absl/status/status.h>
 #include <absl/status/statusor.h>
@@ -76,9 +80,22 @@ GEDS::GEDS(GEDSConfig &&argConfig)
     : std::enable_shared_from_this<GEDS>(), _config(argConfig),
       _server(_config.listenAddress, _config.port),
       _metadataService(_config.metadataServiceAddress), _pathPrefix(_config.localStoragePath),
-      _hostname(_config.hostname.value_or("")), _httpServer(_config.portHttpServer),
-      _ioThreadPool(_config.io_thread_pool_size), _storageCounters(_config.available_local_storage),
-      _memoryCounters(_config.available_local_memory), uuid(createUUID()) {
+      _hostname(_config.hostname.value_or("")), _openFileCache(_config.openFileCacheSize),
+      _httpServer(_config.portHttpServer),
+      _ioThreadPool(_config.io_thread_pool_size),
+      _readAheadPool(geds::ReadAheadBufferPool::factory(_config.readAheadMemory)),
+      _copyBufferPool(geds::ReadAheadBufferPool::factory(_config.copyBufferMemory)),
+      _storageCounters(_config.available_local_storage),
+      _memoryCounters(_config.available_local_memory),
+      _gedsObjectCacheCounters(
+          std::make_shared<geds::StorageCounter>(_config.geds_object_cache_size)),
+      uuid(createUUID()) {
+  if (_config.lookupCache) {
+    auto ttl = std::chrono::milliseconds(_config.lookupCacheTtl);
+    auto negativeTtl = std::chrono::milliseconds(_config.lookupCacheNegativeTtl);
+    _metadataService.configureLookupCache(_config.lookupCacheSize, ttl, negativeTtl);
+    _statusCache.configure(_config.lookupCacheSize, ttl, negativeTtl);
+  }
   std::error_code ec;
   auto success = std::filesystem::create_directories(_pathPrefix, ec);
   if (!success && ec.value() != 0) {
@@ -153,6 +170,18 @@ absl::Status GEDS::start() {
     LOG_ERROR("Unable to start webserver.");
   }
 
+  if (_config.asyncSeal) {
+    _sealQueue = std::make_unique<geds::SealQueue>(
+        [this](const std::vector<geds::Object> &objects) {
+          auto result = _metadataService.createBatch(objects);
+          for (const auto &object : objects) {
+            invalidateStatus(object.id.bucket, object.id.key);
+          }
+          return result;
+        },
+        geds::MetadataService::MaxBatchSize);
+  }
+
   // Update state.
   _state = ServiceState::Running;
 
@@ -177,6 +206,12 @@ absl::Status GEDS::stop() {
   if (_config.force_relocation_when_stopping) {
     relocate(true);
   }
+  if (_sealQueue != nullptr) {
+    auto status = _sealQueue->stop();
+    if (!status.ok()) {
+      LOG_ERROR("Unable to register sealed objects: ", status.message());
+    }
+  }
 
   auto result = _metadataService.disconnect();
   if (!result.ok()) {
@@ -190,6 +225,7 @@ absl::Status GEDS::stop() {
   _httpServer.stop();
 
   // XXX TODO: Properly cleanup files
+  _openFileCache.clear();
   _fileHandles.clear();
   _fileTransfers.clear();
 
@@ -302,13 +338,17 @@ GEDS::createAsFileHandle(const std::string &bucket, const std::string &key, bool
   }
 
   if (overwrite) {
+    _openFileCache.erase(path.name);
     _fileHandles.insertOrReplace(path, *handle);
+    invalidateStatus(bucket, key);
     return handle;
   }
   auto newHandle = _fileHandles.insertOrExists(path, *handle);
   if (newHandle.get() != handle->get()) {
     return absl::AlreadyExistsError("The file " + path.name + "already exists!");
   }
+  // A cached miss would hide the new object until it is sealed.
+  invalidateStatus(bucket, key);
   return newHandle;
 }
 
@@ -397,6 +437,7 @@ absl::StatusOr<GEDSFile> GEDS::open(const std::string &bucket, const std::string
   }
   // Remove invalid filehandle.
   const auto path = getPath(bucket, key);
+  _openFileCache.erase(path.name);
   _fileHandles.removeIf(path, [&](const std::shared_ptr<GEDSFileHandle> &check) {
     return (*fh).get() == check.get();
   });
@@ -406,6 +447,34 @@ absl::StatusOr<GEDSFile> GEDS::open(const std::string &bucket, const std::string
   return absl::UnavailableError("The file " + path.name + " is invalid.");
 }
 
+absl::StatusOr<std::vector<absl::StatusOr<GEDSFile>>>
+GEDS::openMany(const std::string &bucket, const std::vector<std::string> &keys) {
+  GEDS_CHECK_SERVICE_RUNNING
+  LOG_DEBUG("openMany ", bucket, ": ", keys.size(), " objects");
+
+  // Populate the metadata cache for files which are not open yet.
+  std::vector<geds::ObjectID> missing;
+  for (const auto &key : keys) {
+    if (isValid(bucket, key).ok() && !_fileHandles.get(getPath(bucket, key)).has_value()) {
+      missing.emplace_back(bucket, key);
+    }
+  }
+  if (!missing.empty()) {
+    auto lookup = _metadataService.lookupBatch(missing);
+    if (!lookup.ok()) {
+      // The individual opens report the error.
+      LOG_DEBUG("Unable to lookup batch: ", lookup.status().message());
+    }
+  }
+
+  std::vector<absl::StatusOr<GEDSFile>> results;
+  results.reserve(keys.size());
+  for (const auto &key : keys) {
+    results.push_back(open(bucket, key));
+  }
+  return results;
+}
+
 absl::StatusOr<GEDSFile> GEDS::localOpen(const std::string &objectName) {
   auto s = parseObjectName(objectName);
   if (!s.ok()) {
@@ -430,6 +499,23 @@ absl::StatusOr<GEDSFile> GEDS::localOpen(const std::string &bucket, const std::s
   return absl::NotFoundError(path.name + " is not available on this machine");
 }
 
+absl::StatusOr<std::shared_ptr<GEDSFile>> GEDS::cachedOpen(const std::string &bucket,
+                                                           const std::string &key) {
+  const auto path = getPath(bucket, key);
+  auto cached = _openFileCache.get(path.name);
+  if (cached != nullptr) {
+    return cached;
+  }
+  auto generation = _openFileCache.generation();
+  auto file = open(bucket, key);
+  if (!file.ok()) {
+    return file.status();
+  }
+  auto result = std::make_shared<GEDSFile>(std::move(*file));
+  _openFileCache.insert(path.name, result, generation);
+  return result;
+}
+
 absl::StatusOr<std::shared_ptr<GEDSFileHandle>>
 GEDS::reopen(std::shared_ptr<GEDSFileHandle> existing) {
   GEDS_CHECK_SERVICE_RUNNING;
@@ -440,6 +526,7 @@ GEDS::reopen(std::shared_ptr<GEDSFileHandle> existing) {
   auto lock = existing->lockFile();
 
   auto path = getPath(existing->bucket, existing->key);
+  _openFileCache.erase(path.name);
   _fileHandles.removeIf(path, [&existing](const std::shared_ptr<GEDSFileHandle> check) {
     return existing.get() == check.get();
   });
@@ -462,7 +549,16 @@ absl::StatusOr<std::shared_ptr<GEDSFileHandle>> GEDS::openAsFileHandle(const std
   {
     auto fileHandle = _fileHandles.get(path);
     if (fileHandle.has_value()) {
-      return (*fileHandle);
+      auto version = (*fileHandle)->version();
+      if (_config.pubSubEnabled || !version.has_value()) {
+        return (*fileHandle);
+      }
+      // Without publications cached contents are revalidated by version.
+      auto current = _metadataService.isCurrent(bucket, key, *version);
+      if (current.ok() ? *current : current.status().code() != absl::StatusCode::kNotFound) {
+        return (*fileHandle);
+      }
+      invalidateRemoteObject(bucket, key);
     }
   }
 
@@ -491,7 +587,21 @@ GEDS::reopenFileHandle(const std::string &bucket, const std::string &key, bool i
 
   absl::StatusOr<std::shared_ptr<GEDSFileHandle>> fileHandle;
   if (location.compare(0, gedsPrefix.size(), gedsPrefix) == 0) {
-    fileHandle = GEDSRemoteFileHandle::factory(shared_from_this(), object);
+    // Blocks cached by other instances are not cached again.
+    if (_config.cache_objects_from_geds &&
+        !key.starts_with(GEDSCachedFileHandle::CacheBlockMarker)) {
+      fileHandle = GEDSCachedFileHandle::factory<GEDSRemoteFileHandle>(shared_from_this(), object,
+                                                                       _gedsObjectCacheCounters);
+      if (fileHandle.ok() && _config.pubSubEnabled) {
+        // Updates and deletes of the object invalidate the cached blocks.
+        auto status = std::static_pointer_cast<GEDSCachedFileHandle>(*fileHandle)->subscribe();
+        if (!status.ok()) {
+          LOG_ERROR("Unable to subscribe to ", bucket, "/", key, ": ", status.message());
+        }
+      }
+    } else {
+      fileHandle = GEDSRemoteFileHandle::factory(shared_from_this(), object);
+    }
   } else if (location.compare(0, s3Prefix.size(), s3Prefix) == 0) {
     if (_config.cache_objects_from_s3) {
       fileHandle = GEDSCachedFileHandle::factory<GEDSS3FileHandle>(shared_from_this(), object);
@@ -537,20 +647,126 @@ GEDS::getFileTransferService(const std::string &hostname) {
   return _fileTransfers.insertOrExists(hostname, fileTransferService);
 }
 
-absl::Status GEDS::seal(GEDSFileHandle &fileHandle, bool update, size_t size,
-                        std::optional<std::string> uri) {
-  GEDS_CHECK_SERVICE_RUNNING
+absl::StatusOr<std::shared_ptr<geds::TcpTransport>> GEDS::tcpTransport() {
+  return _server.tcpTransport();
+}
+
+void GEDS::postIO(std::function<void()> task) { boost::asio::post(_ioThreadPool, std::move(task)); }
+
+static std::shared_future<absl::Status> readyFuture(absl::Status status) {
+  std::promise<absl::Status> promise;
+  promise.set_value(std::move(status));
+  return promise.get_future().share();
+}
+
+absl::Status GEDS::seal(GEDSFileHandle &fileHandle) {
+  auto registered = sealAsync(fileHandle);
+  // Errors of queued registrations are reported by `flush`.
+  if (registered.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+    return registered.get();
+  }
+  return absl::OkStatus();
+}
+
+std::shared_future<absl::Status> GEDS::sealAsync(GEDSFileHandle &fileHandle) {
+  if (_state != ServiceState::Running) {
+    return readyFuture(absl::FailedPreconditionError("The service is " + to_string(_state) + "."));
+  }
 
   LOG_DEBUG(fileHandle.identifier);
 
-  auto obj =
-      geds::Object{geds::ObjectID{fileHandle.bucket, fileHandle.key},
-                   geds::ObjectInfo{uri.value_or(_hostURI), size, size, fileHandle.metadata()}};
+  auto pending = fileHandle.prepareSeal();
+  if (!pending.ok()) {
+    return readyFuture(pending.status());
+  }
+  auto &obj = pending->object;
+  if (obj.info.location.empty()) {
+    obj.info.location = _hostURI;
+  }
+  if (_sealQueue != nullptr) {
+    return _sealQueue->enqueue(std::move(obj), std::move(pending->markSealed));
+  }
+  auto status =
+      pending->update ? _metadataService.updateObject(obj) : _metadataService.createObject(obj);
+  invalidateStatus(fileHandle.bucket, fileHandle.key);
+  if (status.ok()) {
+    pending->markSealed();
+  }
+  return readyFuture(std::move(status));
+}
+
+absl::StatusOr<std::vector<absl::Status>> GEDS::sealMany(std::vector<GEDSFile> &files) {
+  GEDS_CHECK_SERVICE_RUNNING
+  LOG_DEBUG("sealMany: ", files.size(), " files");
+
+  // Lock the handles in a consistent order to avoid deadlocks with concurrent batches. A handle
+  // which is passed multiple times is sealed once.
+  std::vector<GEDSFileHandle *> handles;
+  handles.reserve(files.size());
+  for (auto &file : files) {
+    handles.push_back(file.fileHandle().get());
+  }
+  std::sort(handles.begin(), handles.end());
+  handles.erase(std::unique(handles.begin(), handles.end()), handles.end());
+
+  std::vector<absl::Status> handleResults(handles.size());
+  std::vector<GEDSPendingSeal> pendingSeals;
+  std::vector<geds::Object> objects;
+  // Index of the object registered for each handle or SIZE_MAX.
+  std::vector<size_t> objectIndex(handles.size(), SIZE_MAX);
+  for (size_t i = 0; i < handles.size(); i++) {
+    auto pending = handles[i]->prepareSeal();
+    if (!pending.ok()) {
+      handleResults[i] = pending.status();
+      continue;
+    }
+    if (pending->object.info.location.empty()) {
+      pending->object.info.location = _hostURI;
+    }
+    objectIndex[i] = objects.size();
+    objects.push_back(pending->object);
+    pendingSeals.push_back(std::move(*pending));
+  }
 
-  if (update) {
-    return _metadataService.updateObject(obj);
+  if (!objects.empty()) {
+    // Creating an object overwrites existing entries: Updates are registered the same way.
+    auto statuses = _metadataService.createBatch(objects);
+    for (const auto &object : objects) {
+      invalidateStatus(object.id.bucket, object.id.key);
+    }
+    if (!statuses.ok()) {
+      return statuses.status();
+    }
+    for (size_t i = 0; i < handles.size(); i++) {
+      if (objectIndex[i] == SIZE_MAX) {
+        continue;
+      }
+      handleResults[i] = (*statuses)[objectIndex[i]];
+      if (handleResults[i].ok()) {
+        pendingSeals[objectIndex[i]].markSealed();
+      }
+    }
   }
-  return _metadataService.createObject(obj);
+
+  std::vector<absl::Status> results;
+  results.reserve(files.size());
+  for (auto &file : files) {
+    auto it = std::lower_bound(handles.begin(), handles.end(), file.fileHandle().get());
+    results.push_back(handleResults[it - handles.begin()]);
+  }
+  return results;
+}
+
+std::shared_future<absl::Status> GEDS::sealAsync(GEDSFile &file) {
+  return sealAsync(*file.fileHandle());
+}
+
+absl::Status GEDS::flush() {
+  GEDS_CHECK_SERVICE_RUNNING
+  if (_sealQueue == nullptr) {
+    return absl::OkStatus();
+  }
+  return _sealQueue->flush();
 }
 
 std::string GEDS::getLocalPath(const std::string &bucket, const std::string &key) const {
@@ -578,31 +794,42 @@ absl::StatusOr<std::vector<GEDSFileStatus>> GEDS::list(const std::string &bucket
   LOG_DEBUG(bucket, "/", prefix);
 
   bool prefixExists = false;
-  absl::StatusOr<std::pair<std::vector<geds::Object>, std::vector<std::string>>> list;
-  if (_config.pubSubEnabled) {
-    list = _metadataService.listPrefixFromCache(bucket, prefix, delimiter);
-  } else {
-    list = _metadataService.listPrefix(bucket, prefix, delimiter);
-  }
-  if (!list.ok()) {
-    return list.status();
-  }
-  _knownBuckets.insert(bucket);
   const std::string folderString = delimiter + Default_DirectoryMarker;
   std::set<GEDSFileStatus> result;
-  for (const auto &value : list->first) {
-    prefixExists = true;
-    const auto &key = value.id.key;
-    if (delimiter != 0 && key.ends_with(folderString)) {
-      // Don't list current directory.
-      continue;
-    } else {
-      result.emplace(GEDSFileStatus{.key = key, .size = value.info.size, .isDirectory = false});
+  auto addPage = [&](const std::vector<geds::Object> &objects,
+                     const std::vector<std::string> &commonPrefixes) {
+    for (const auto &value : objects) {
+      prefixExists = true;
+      const auto &key = value.id.key;
+      if (delimiter != 0 && key.ends_with(folderString)) {
+        // Don't list current directory.
+        continue;
+      } else {
+        result.emplace(GEDSFileStatus{.key = key, .size = value.info.size, .isDirectory = false});
+      }
+    }
+    for (const auto &prefix : commonPrefixes) {
+      result.emplace(GEDSFileStatus{.key = prefix, .size = 0, .isDirectory = true});
+    }
+  };
+  if (_config.pubSubEnabled) {
+    auto list = _metadataService.listPrefixFromCache(bucket, prefix, delimiter);
+    if (!list.ok()) {
+      return list.status();
+    }
+    addPage(list->first, list->second);
+  } else {
+    // Consume the listing page by page instead of materializing it.
+    auto status = _metadataService.listPrefixPaged(
+        bucket, prefix, delimiter,
+        [&](std::vector<geds::Object> &&objects, std::vector<std::string> &&commonPrefixes) {
+          addPage(objects, commonPrefixes);
+        });
+    if (!status.ok()) {
+      return status;
     }
   }
-  for (const auto &prefix : list->second) {
-    result.emplace(GEDSFileStatus{.key = prefix, .size = 0, .isDirectory = true});
-  }
+  _knownBuckets.insert(bucket);
   if (result.empty() && delimiter && !prefixExists) {
     return absl::NotFoundError("Prefix not found: " + prefix);
   }
@@ -631,6 +858,28 @@ absl::StatusOr<GEDSFileStatus> GEDS::status(const std::string &bucket, const std
     return absl::NotFoundError("Bucket not found!");
   }
 
+  // Only results for the default delimiter are cached.
+  auto cacheable = delimiter == Default_GEDSFolderDelimiter;
+  const auto cacheKey = bucket + "/" + key;
+  if (cacheable) {
+    auto cached = _statusCache.get(cacheKey);
+    if (cached.has_value()) {
+      return *cached;
+    }
+  }
+  auto result = uncachedStatus(bucket, key, delimiter);
+  if (cacheable) {
+    if (result.ok()) {
+      _statusCache.put(cacheKey, *result);
+    } else if (result.status().code() == absl::StatusCode::kNotFound) {
+      _statusCache.putMissing(cacheKey);
+    }
+  }
+  return result;
+}
+
+absl::StatusOr<GEDSFileStatus> GEDS::uncachedStatus(const std::string &bucket,
+                                                    const std::string &key, char delimiter) {
   auto listDir = [&](const std::string &k) -> absl::StatusOr<GEDSFileStatus> {
     auto list = _metadataService.listPrefix(bucket, k, delimiter);
     if (list.ok() && list->second.size() > 0) {
@@ -674,6 +923,16 @@ absl::StatusOr<GEDSFileStatus> GEDS::status(const std::string &bucket, const std
   return absl::NotFoundError("Key " + key + " not found!");
 }
 
+void GEDS::invalidateStatus(const std::string &bucket, const std::string &key) {
+  const auto prefix = bucket + "/";
+  _statusCache.erase(prefix + key);
+  for (size_t pos = key.find(Default_GEDSFolderDelimiter); pos != std::string::npos;
+       pos = key.find(Default_GEDSFolderDelimiter, pos + 1)) {
+    _statusCache.erase(prefix + key.substr(0, pos));
+    _statusCache.erase(prefix + key.substr(0, pos + 1));
+  }
+}
+
 absl::Status GEDS::renamePrefix(const std::string &bucket, const std::string &srcKey,
                                 const std::string &destKey) {
   return renamePrefix(bucket, srcKey, bucket, destKey);
@@ -686,6 +945,28 @@ absl::Status GEDS::renamePrefix(const std::string &srcBucket, const std::string
   if (!prefixList.ok()) {
     return prefixList.status();
   }
+  std::vector<std::string> srcKeys;
+  std::vector<std::string> destKeys;
+  for (const auto &element : *prefixList) {
+    if (!element.isDirectory) {
+      srcKeys.push_back(element.key);
+      destKeys.push_back(destKey + element.key.substr(srcKey.size()));
+    }
+  }
+  if (srcKeys.empty()) {
+    return absl::OkStatus();
+  }
+  // Objects created by other instances after the listing are stored under their old keys: The
+  // metadata server only renames the prefix if it holds exactly the listed objects.
+  auto moved = moveObjects(srcBucket, srcKeys, destBucket, destKeys, [&] {
+    return _metadataService.renameObjectPrefix(geds::ObjectID{srcBucket, srcKey},
+                                               geds::ObjectID{destBucket, destKey}, srcKeys);
+  });
+  if (moved.code() != absl::StatusCode::kUnimplemented &&
+      moved.code() != absl::StatusCode::kFailedPrecondition) {
+    return moved;
+  }
+  LOG_DEBUG("Renaming ", srcBucket, "/", srcKey, " by object: ", moved.message());
   for (const auto &element : *prefixList) {
     if (element.isDirectory) {
       continue;
@@ -706,7 +987,16 @@ absl::Status GEDS::rename(const std::string &bucket, const std::string &srcKey,
 }
 absl::Status GEDS::rename(const std::string &srcBucket, const std::string &srcKey,
                           const std::string &destBucket, const std::string &destKey) {
-  // ToDo: Actually move the files.
+  auto moved = moveObjects(srcBucket, {srcKey}, destBucket, {destKey}, [&] {
+    return _metadataService.renameObject(geds::ObjectID{srcBucket, srcKey},
+                                         geds::ObjectID{destBucket, destKey});
+  });
+  if (moved.code() != absl::StatusCode::kUnimplemented &&
+      moved.code() != absl::StatusCode::kFailedPrecondition) {
+    return moved;
+  }
+  LOG_DEBUG("Copying ", srcBucket, "/", srcKey, " to ", destBucket, "/", destKey, ": ",
+            moved.message());
   auto status = copy(srcBucket, srcKey, destBucket, destKey);
   if (!status.ok()) {
     return status;
@@ -714,6 +1004,80 @@ absl::Status GEDS::rename(const std::string &srcBucket, const std::string &srcKe
   return deleteObject(srcBucket, srcKey);
 }
 
+absl::Status GEDS::moveObjects(const std::string &srcBucket,
+                               const std::vector<std::string> &srcKeys,
+                               const std::string &destBucket,
+                               const std::vector<std::string> &destKeys,
+                               const std::function<absl::Status()> &renameMetadata) {
+  GEDS_CHECK_SERVICE_RUNNING
+  if (_objectStores.get(srcBucket).ok() || _objectStores.get(destBucket).ok()) {
+    // The data on the object store needs to be moved as well.
+    return absl::UnimplementedError("Objects of buckets backed by an object store are copied.");
+  }
+  std::vector<std::shared_ptr<GEDSFileHandle>> handles;
+  handles.reserve(srcKeys.size());
+  for (size_t i = 0; i < srcKeys.size(); i++) {
+    auto check = isValid(destBucket, destKeys[i]);
+    if (!check.ok()) {
+      return check;
+    }
+    auto handle = _fileHandles.get(getPath(srcBucket, srcKeys[i]));
+    if (!handle.has_value() || !(*handle)->isWriteable()) {
+      return absl::UnimplementedError("The object " + srcBucket + "/" + srcKeys[i] +
+                                      " is not stored by this instance.");
+    }
+    handles.push_back(std::move(*handle));
+  }
+  auto bucketStatus = createBucket(destBucket);
+  if (!bucketStatus.ok()) {
+    return bucketStatus;
+  }
+  if (_sealQueue != nullptr) {
+    // The objects need to be registered before they are renamed.
+    _sealQueue->wait();
+  }
+
+  std::vector<std::shared_ptr<GEDSFileHandle>> moved;
+  moved.reserve(handles.size());
+  auto moveBack = [&] {
+    for (size_t i = 0; i < moved.size(); i++) {
+      auto restored = moved[i]->move(srcBucket, srcKeys[i]);
+      if (restored.ok()) {
+        _fileHandles.insertOrReplace(getPath(srcBucket, srcKeys[i]), *restored);
+      } else {
+        LOG_ERROR("Unable to move ", moved[i]->identifier, " back: ", restored.status().message());
+      }
+    }
+  };
+  for (size_t i = 0; i < handles.size(); i++) {
+    // Cached files count as open.
+    _openFileCache.erase(getPath(srcBucket, srcKeys[i]).name);
+    auto handle = handles[i]->move(destBucket, destKeys[i]);
+    if (!handle.ok()) {
+      moveBack();
+      return handle.status();
+    }
+    moved.push_back(std::move(*handle));
+  }
+  auto status = renameMetadata();
+  if (!status.ok()) {
+    moveBack();
+    return status;
+  }
+  for (size_t i = 0; i < moved.size(); i++) {
+    const auto srcPath = getPath(srcBucket, srcKeys[i]);
+    const auto destPath = getPath(destBucket, destKeys[i]);
+    _openFileCache.erase(destPath.name);
+    _fileHandles.insertOrReplace(destPath, moved[i]);
+    _fileHandles.removeIf(srcPath, [&](const std::shared_ptr<GEDSFileHandle> &check) {
+      return check.get() == handles[i].get();
+    });
+    invalidateStatus(srcBucket, srcKeys[i]);
+    invalidateStatus(destBucket, destKeys[i]);
+  }
+  return absl::OkStatus();
+}
+
 absl::Status GEDS::copyPrefix(const std::string &bucket, const std::string &srcKey,
                               const std::string &destKey) {
   return copyPrefix(bucket, srcKey, bucket, destKey);
@@ -725,18 +1089,52 @@ absl::Status GEDS::copyPrefix(const std::string &srcBucket, const std::string &s
   if (!prefixList.ok()) {
     return prefixList.status();
   }
+  struct CopyHelper {
+    std::vector<std::pair<std::string, std::string>> keys;
+    std::atomic<size_t> next = 0;
+    std::atomic<bool> failed = false;
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t done = 0;
+    absl::Status status;
+  };
+  auto h = std::make_shared<CopyHelper>();
   for (const auto &element : *prefixList) {
     if (element.isDirectory) {
       continue;
     }
     const auto &key = element.key;
-    auto newKey = destKey + key.substr(srcKey.size());
-    auto status = copy(srcBucket, element.key, destBucket, newKey);
-    if (!status.ok()) {
-      return status;
+    h->keys.emplace_back(key, destKey + key.substr(srcKey.size()));
+  }
+  if (h->keys.empty()) {
+    return absl::OkStatus();
+  }
+
+  auto copyKeys = [self = shared_from_this(), h, srcBucket, destBucket]() {
+    for (auto i = h->next++; i < h->keys.size(); i = h->next++) {
+      auto status = absl::OkStatus();
+      if (!h->failed) {
+        const auto &[src, dest] = h->keys[i];
+        status = self->copy(srcBucket, src, destBucket, dest);
+      }
+      std::lock_guard lock(h->mutex);
+      if (!status.ok() && h->status.ok()) {
+        h->status = status;
+        h->failed = true;
+      }
+      h->done += 1;
+      h->cv.notify_all();
     }
+  };
+  // The caller copies as well, so the copy completes even if all I/O threads are busy.
+  auto nWorkers = std::min(_config.io_thread_pool_size, h->keys.size() - 1);
+  for (size_t i = 0; i < nWorkers; i++) {
+    postIO(copyKeys);
   }
-  return absl::OkStatus();
+  copyKeys();
+  std::unique_lock lock(h->mutex);
+  h->cv.wait(lock, [h]() { return h->done == h->keys.size(); });
+  return h->status;
 }
 
 absl::Status GEDS::copy(const std::string &bucket, const std::string &srcKey,
@@ -763,6 +1161,10 @@ absl::Status GEDS::copy(const std::string &srcBucket, const std::string &srcKey,
 
 absl::Status GEDS::deleteObject(const std::string &bucket, const std::string &key) {
   LOG_DEBUG("DeleteObject ", bucket, "/", key);
+  if (_sealQueue != nullptr) {
+    // Pending registrations would recreate the object.
+    _sealQueue->wait();
+  }
   // Delete on metadata service.
   {
     auto status = _metadataService.deleteObject(bucket, key);
@@ -771,6 +1173,13 @@ absl::Status GEDS::deleteObject(const std::string &bucket, const std::string &ke
       return status;
     }
   }
+  deleteObjectData(bucket, key);
+  return absl::OkStatus();
+}
+
+void GEDS::deleteObjectData(const std::string &bucket, const std::string &key) {
+  invalidateStatus(bucket, key);
+
   // Delete on s3.
   {
     auto storeStatus = _objectStores.get(bucket);
@@ -784,15 +1193,50 @@ absl::Status GEDS::deleteObject(const std::string &bucket, const std::string &ke
 
   // Delete the file locally.
   auto path = getPath(bucket, key);
+  _openFileCache.erase(path.name);
   auto removed = _fileHandles.remove(path);
   if (!removed) {
     LOG_ERROR("The file ", path.name, " did not exist locally!");
   }
-  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<absl::Status>>
+GEDS::deleteMany(const std::string &bucket, const std::vector<std::string> &keys) {
+  GEDS_CHECK_SERVICE_RUNNING
+  LOG_DEBUG("deleteMany ", bucket, ": ", keys.size(), " objects");
+  if (_sealQueue != nullptr) {
+    // Pending registrations would recreate the objects.
+    _sealQueue->wait();
+  }
+
+  std::vector<geds::ObjectID> ids;
+  ids.reserve(keys.size());
+  for (const auto &key : keys) {
+    ids.emplace_back(bucket, key);
+  }
+  auto statuses = _metadataService.deleteBatch(ids);
+  if (!statuses.ok()) {
+    // Omit local deletion if we cannot communicate with Metadata service.
+    return statuses.status();
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    auto &status = (*statuses)[i];
+    if (status.code() == absl::StatusCode::kNotFound) {
+      status = absl::OkStatus();
+    }
+    if (status.ok()) {
+      deleteObjectData(bucket, keys[i]);
+    }
+  }
+  return statuses;
 }
 
 absl::Status GEDS::deleteObjectPrefix(const std::string &bucket, const std::string &prefix) {
   LOG_DEBUG("deleteObjectPrefix ", bucket, "/", prefix);
+  if (_sealQueue != nullptr) {
+    // Pending registrations would recreate the objects.
+    _sealQueue->wait();
+  }
 
   // Delete on GEDS.
   {
@@ -813,7 +1257,11 @@ absl::Status GEDS::deleteObjectPrefix(const std::string &bucket, const std::stri
       }
     }
   }
+  _statusCache.erasePrefix(bucket + "/" + prefix);
+  invalidateStatus(bucket, prefix);
+
   // Mark the file as deleted and remove it.
+  _openFileCache.erasePrefix(getPath(bucket, prefix).name);
   _fileHandles.removeRange(utility::PathPrefixProbe{prefix});
   return absl::OkStatus();
 }
@@ -915,6 +1363,8 @@ void GEDS::relocate(std::shared_ptr<GEDSFileHandle> handle, bool force) {
   LOG_DEBUG(handle->identifier);
 
   const auto path = getPath(handle->bucket, handle->key);
+  // Cached files count as open.
+  _openFileCache.erase(path.name);
   auto lock = handle->lockFile();
   if ((handle->openCount() > 0 && !force) || !_fileHandles.exists(path)) {
     // File is open: Unable to relocate.
@@ -1028,6 +1478,11 @@ void GEDS::startPubSubStreamThread() {
     LOG_DEBUG("PubSub streaming thread not enabled.");
     return;
   }
+  _metadataService.setObjectChangedCallback(
+      [this](const geds::ObjectID &id) {
+        invalidateStatus(id.bucket, id.key);
+        invalidateRemoteObject(id.bucket, id.key);
+      });
   if (_state == ServiceState::Running) {
     _pubSubStreamThread = std::thread([&]() { auto status = _metadataService.subscribeStream(); });
   } else {
@@ -1036,6 +1491,24 @@ void GEDS::startPubSubStreamThread() {
   LOG_DEBUG("PubSub streaming thread enabled.");
 }
 
+void GEDS::invalidateRemoteObject(const std::string &bucket, const std::string &key) {
+  if (key.starts_with(GEDSCachedFileHandle::CacheBlockMarker)) {
+    return;
+  }
+  const auto path = getPath(bucket, key);
+  auto fileHandle = _fileHandles.get(path);
+  if (!fileHandle.has_value() || (*fileHandle)->isWriteable()) {
+    // Files written by this instance are up to date.
+    return;
+  }
+  LOG_DEBUG("Invalidating ", path.name);
+  _openFileCache.erase(path.name);
+  _fileHandles.removeIf(path, [&](const std::shared_ptr<GEDSFileHandle> &check) {
+    return fileHandle->get() == check.get();
+  });
+  (*fileHandle)->invalidate();
+}
+
 absl::Status GEDS::subscribe(const geds::SubscriptionEvent &event) {
   GEDS_CHECK_SERVICE_RUNNING
   if (!_config.pubSubEnabled) {
@@ -1051,3 +1524,32 @@ absl::Status GEDS::unsubscribe(const geds::SubscriptionEvent &event) {
   }
   return _metadataService.unsubscribe(event);
 }
+
+absl::Status GEDS::retainObjectSubscription(const std::string &bucket, const std::string &key) {
+  auto lock = std::lock_guard(_objectSubscriptionsMutex);
+  auto &count = _objectSubscriptions[getPath(bucket, key).name];
+  if (count == 0) {
+    auto status =
+        subscribe(geds::SubscriptionEvent(bucket, key, geds::rpc::SubscriptionType::OBJECT));
+    if (!status.ok()) {
+      _objectSubscriptions.erase(getPath(bucket, key).name);
+      return status;
+    }
+  }
+  count++;
+  return absl::OkStatus();
+}
+
+void GEDS::releaseObjectSubscription(const std::string &bucket, const std::string &key) {
+  auto lock = std::lock_guard(_objectSubscriptionsMutex);
+  auto it = _objectSubscriptions.find(getPath(bucket, key).name);
+  if (it == _objectSubscriptions.end() || --it->second > 0) {
+    return;
+  }
+  _objectSubscriptions.erase(it);
+  auto status =
+      unsubscribe(geds::SubscriptionEvent(bucket, key, geds::rpc::SubscriptionType::OBJECT));
+  if (!status.ok()) {
+    LOG_DEBUG("Unable to unsubscribe from ", bucket, "/", key, ": ", status.message());
+  }
+}
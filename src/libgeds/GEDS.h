@@ -10,6 +10,8 @@
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <future>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -32,13 +34,17 @@
 #include "GEDSInternal.h"
 #include "GEDSLocalFileHandle.h"
 #include "HttpServer.h"
+#include "LookupCache.h"
 #include "MetadataService.h"
 #include "Object.h"
 #include "ObjectStoreConfig.h"
+#include "OpenFileCache.h"
 #include "Path.h"
 #include "RWConcurrentObjectAdaptor.h"
+#include "ReadAhead.h"
 #include "S3Endpoint.h"
 #include "S3ObjectStores.h"
+#include "SealQueue.h"
 #include "Server.h"
 #include "Statistics.h"
 #include "StorageCounter.h"
@@ -93,6 +99,11 @@ protected:
   }
   utility::ConcurrentMap<std::string, std::shared_ptr<geds::FileTransferService>> _fileTransfers;
 
+  /**
+   * @brief Files opened to serve remote reads.
+   */
+  geds::OpenFileCache _openFileCache;
+
   utility::ConcurrentSet<std::string> _knownBuckets;
 
   geds::s3::ObjectStores _objectStores;
@@ -105,15 +116,60 @@ protected:
   geds::HttpServer _httpServer;
 
   boost::asio::thread_pool _ioThreadPool;
+  std::shared_ptr<geds::ReadAheadBufferPool> _readAheadPool;
+  std::shared_ptr<geds::ReadAheadBufferPool> _copyBufferPool;
+  std::unique_ptr<geds::SealQueue> _sealQueue;
   std::thread _storageMonitoringThread;
   void startStorageMonitoringThread();
 
   geds::StorageCounter _storageCounters;
   geds::StorageCounter _memoryCounters;
+  // Local storage used by cached blocks of objects located on other GEDS instances.
+  std::shared_ptr<geds::StorageCounter> _gedsObjectCacheCounters;
 
   std::thread _pubSubStreamThread;
   void startPubSubStreamThread();
 
+  // Number of cached file handles subscribed to each object. Held while subscribing, so the
+  // subscription RPCs of an object reach the metadata server in order.
+  std::mutex _objectSubscriptionsMutex;
+  std::map<std::string, size_t> _objectSubscriptions;
+
+  /**
+   * @brief Drop the file handle of an object which has been changed by another instance.
+   */
+  void invalidateRemoteObject(const std::string &bucket, const std::string &key);
+
+  /**
+   * @brief Results of `status` for the default delimiter, including misses and S3 fallbacks.
+   */
+  geds::LookupCache<GEDSFileStatus> _statusCache{"GEDS: status cache"};
+
+  /**
+   * @brief Drop the cached status of `key` and of its parent directories.
+   */
+  void invalidateStatus(const std::string &bucket, const std::string &key);
+
+  absl::StatusOr<GEDSFileStatus> uncachedStatus(const std::string &bucket, const std::string &key,
+                                                char delimiter);
+
+  /**
+   * @brief Delete the object from S3 and drop the local file after it has been removed from the
+   * metadata service.
+   */
+  void deleteObjectData(const std::string &bucket, const std::string &key);
+
+  /**
+   * @brief Move the local files of `srcKeys` to `destKeys` and rename the objects on the metadata
+   * service with `renameMetadata`, without copying data. The files are moved back if renaming
+   * fails. Returns UNIMPLEMENTED or FAILED_PRECONDITION if the objects need to be copied instead:
+   * Objects of buckets backed by an object store, objects stored by other instances and open
+   * files are not moved.
+   */
+  absl::Status moveObjects(const std::string &srcBucket, const std::vector<std::string> &srcKeys,
+                           const std::string &destBucket, const std::vector<std::string> &destKeys,
+                           const std::function<absl::Status()> &renameMetadata);
+
 public:
   const std::string uuid;
 
@@ -199,6 +255,13 @@ public:
                                 bool retry = true);
   absl::StatusOr<std::shared_ptr<GEDSFileHandle>> openAsFileHandle(const std::string &bucket,
                                                                    const std::string &key);
+
+  /**
+   * @brief Open multiple objects in `bucket`. The metadata of objects which are not open yet is
+   * fetched with batched lookups. Returns one result per key.
+   */
+  absl::StatusOr<std::vector<absl::StatusOr<GEDSFile>>>
+  openMany(const std::string &bucket, const std::vector<std::string> &keys);
   absl::StatusOr<std::shared_ptr<GEDSFileHandle>>
   reopenFileHandle(const std::string &bucket, const std::string &key, bool invalidate);
 
@@ -214,10 +277,40 @@ public:
   absl::StatusOr<GEDSFile> localOpen(const std::string &bucket, const std::string &key);
 
   /**
-   * @brief Mark the file associated with fileHandle as sealed.
+   * @brief Open object located at bucket/key to serve a remote read. The file is kept open for
+   * subsequent requests until it is deleted or relocated.
+   */
+  absl::StatusOr<std::shared_ptr<GEDSFile>> cachedOpen(const std::string &bucket,
+                                                       const std::string &key);
+
+  /**
+   * @brief Register the file associated with fileHandle and mark it as sealed.
+   */
+  absl::Status seal(GEDSFileHandle &fileHandle);
+
+  /**
+   * @brief Like `seal`, but the future completes once the object is registered with the metadata
+   * service. Without `GEDSConfig::asyncSeal` it is ready on return.
    */
-  absl::Status seal(GEDSFileHandle &fileHandle, bool update, size_t size,
-                    std::optional<std::string> uri = std::nullopt);
+  std::shared_future<absl::Status> sealAsync(GEDSFileHandle &fileHandle);
+
+  /**
+   * @brief Seal multiple files and register them with a batched request. Returns one status per
+   * file. Files which fail to register are not marked as sealed and can be sealed again.
+   */
+  absl::StatusOr<std::vector<absl::Status>> sealMany(std::vector<GEDSFile> &files);
+
+  /**
+   * @brief Seal `file`. With `GEDSConfig::asyncSeal` the future completes once the object is
+   * registered with the metadata service, otherwise it is ready on return.
+   */
+  std::shared_future<absl::Status> sealAsync(GEDSFile &file);
+
+  /**
+   * @brief Wait until all objects sealed before the call are registered with the metadata
+   * service. Returns the first registration error since the previous flush.
+   */
+  absl::Status flush();
 
   /**
    * @brief List objects in bucket where the key starts with `prefix`.
@@ -250,7 +343,9 @@ public:
                                         char delimiter);
 
   /**
-   * @brief Rename a prefix recursively.
+   * @brief Rename a prefix recursively. If this instance stores all objects of the prefix, the
+   * files are moved and the prefix is renamed atomically on the metadata service; otherwise the
+   * objects are renamed one by one.
    */
   absl::Status renamePrefix(const std::string &bucket, const std::string &srcPrefix,
                             const std::string &destPrefix);
@@ -258,7 +353,8 @@ public:
                             const std::string &destPrefix, const std::string &destKey);
 
   /**
-   * @brief Rename an object.
+   * @brief Rename an object. Objects stored by this instance are moved without copying their data,
+   * other objects are copied and deleted.
    */
   absl::Status rename(const std::string &bucket, const std::string &srcKey,
                       const std::string &destKey);
@@ -287,6 +383,12 @@ public:
    */
   absl::Status deleteObject(const std::string &bucket, const std::string &key);
 
+  /**
+   * @brief Delete multiple objects in `bucket` with a batched request. Returns one status per key.
+   */
+  absl::StatusOr<std::vector<absl::Status>> deleteMany(const std::string &bucket,
+                                                       const std::vector<std::string> &keys);
+
   /**
    * @brief Delete objects in `bucket` with keys starting with `prefix`.
    * @returns absl::OkStatus if the operation has been successful or not objects have been deleted.
@@ -315,12 +417,41 @@ public:
   absl::StatusOr<std::shared_ptr<geds::FileTransferService>>
   getFileTransferService(const std::string &hostname);
 
+  /**
+   * @brief The epoll TcpTransport engine used for `SocketEpoll` endpoints.
+   */
+  absl::StatusOr<std::shared_ptr<geds::TcpTransport>> tcpTransport();
+
+  /**
+   * @brief Buffers shared by the read-ahead of all remote files.
+   */
+  const std::shared_ptr<geds::ReadAheadBufferPool> &readAheadPool() const { return _readAheadPool; }
+
+  /**
+   * @brief Buffers of copies which cannot be done by the kernel.
+   */
+  const std::shared_ptr<geds::ReadAheadBufferPool> &copyBufferPool() const {
+    return _copyBufferPool;
+  }
+
+  /**
+   * @brief Run `task` on the I/O thread pool.
+   */
+  void postIO(std::function<void()> task);
+
   void relocate(bool force = false);
   void relocate(std::vector<std::shared_ptr<GEDSFileHandle>> &relocatable, bool force = false);
   void relocate(std::shared_ptr<GEDSFileHandle> handle, bool force = false);
 
   absl::Status subscribe(const geds::SubscriptionEvent &event);
   absl::Status unsubscribe(const geds::SubscriptionEvent &event);
+
+  /**
+   * @brief Subscribe to `bucket/key` on behalf of a cached file handle. The object is unsubscribed
+   * once every handle has called `releaseObjectSubscription`.
+   */
+  absl::Status retainObjectSubscription(const std::string &bucket, const std::string &key);
+  void releaseObjectSubscription(const std::string &bucket, const std::string &key);
 };
 
 #endif // GEDS_GEDS_H
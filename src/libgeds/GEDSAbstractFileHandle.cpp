@@ -13,11 +13,6 @@ std::string getLocalPath(std::shared_ptr<GEDS> geds, const std::string &bucket,
   return geds->getLocalPath(bucket, key);
 }
 
-absl::Status seal(std::shared_ptr<GEDS> geds, GEDSFileHandle &fileHandle, bool update,
-                  size_t size) {
-  return geds->seal(fileHandle, update, size);
-}
-
 absl::StatusOr<std::shared_ptr<geds::s3::Endpoint>> getS3Endpoint(std::shared_ptr<GEDS> geds,
                                                                   const std::string &bucket) {
   return geds->getS3Endpoint(bucket);
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
@@ -27,14 +28,13 @@
 namespace geds::service {
 std::string getLocalPath(std::shared_ptr<GEDS> geds, const std::string &bucket,
                          const std::string &key);
-absl::Status seal(std::shared_ptr<GEDS> geds, GEDSFileHandle &fileHandle, bool update, size_t size);
 absl::StatusOr<std::shared_ptr<geds::s3::Endpoint>> getS3Endpoint(std::shared_ptr<GEDS> geds,
                                                                   const std::string &bucket);
 
 } // namespace geds::service
 
 template <class T> class GEDSAbstractFileHandle : public GEDSFileHandle {
-  bool _isSealed{false};
+  std::atomic<bool> _isSealed{false};
 
   T _file;
 
@@ -45,10 +45,10 @@ private:
   // Constructors are private to enable `shared_from_this`.
   GEDSAbstractFileHandle(std::shared_ptr<GEDS> gedsService, std::string bucketArg,
                          std::string keyArg, std::optional<std::string> metadataArg,
-                         std::string pathArg)
+                         std::string pathArg, bool overwrite = true)
       : GEDSFileHandle(gedsService, std::move(bucketArg), std::move(keyArg),
                        std::move(metadataArg)),
-        _file(T(std::move(pathArg))), _readStatistics(geds::Statistics::createCounter(
+        _file(T(std::move(pathArg), overwrite)), _readStatistics(geds::Statistics::createCounter(
                                           "GEDS" + _file.statisticsLabel() + "Handle: bytes read")),
         _writeStatistics(geds::Statistics::createCounter("GEDS" + _file.statisticsLabel() +
                                                          "Handle: bytes written")) {
@@ -110,6 +110,18 @@ public:
     return result;
   }
 
+  absl::StatusOr<std::vector<size_t>>
+  readv(const std::vector<geds::ReadRange> &ranges) override {
+    auto lock = lockShared();
+    auto result = _file.readv(ranges);
+    if (result.ok()) {
+      for (auto count : *result) {
+        *_readStatistics += count;
+      }
+    }
+    return result;
+  }
+
   absl::Status writeBytes(const uint8_t *bytes, size_t position, size_t length) override {
     auto lock = lockShared();
     auto result = _file.writeBytes(bytes, position, length);
@@ -134,19 +146,22 @@ public:
     return _file.truncate(targetSize);
   }
 
-  absl::Status seal() override {
-    auto lock = lockFile();
+  absl::StatusOr<GEDSPendingSeal> prepareSeal() override {
+    auto fileLock = std::unique_lock(_fileMutex);
     auto ioLock = lockExclusive();
     size_t currentSize = _file.size();
-    absl::Status status = absl::OkStatus();
-    // FIXME: Create a GEDS Service mock to skip this abonimation below here.
-    if (_gedsService != nullptr) { // Allow faking the GEDS Service for unittests.
-      status = geds::service::seal(_gedsService, *this, _isSealed, currentSize);
-    }
-    if (status.ok()) {
-      _isSealed = true;
-    }
-    return status;
+    auto markSealed = [weakSelf = weak_from_this(), this]() {
+      if (auto self = weakSelf.lock()) {
+        _isSealed = true;
+      }
+    };
+    GEDSPendingSeal pending{
+        geds::Object{geds::ObjectID{bucket, key},
+                     geds::ObjectInfo{"", currentSize, currentSize, _metadata}},
+        _isSealed, std::move(markSealed), {}, {}};
+    pending.fileLocks.push_back(std::move(fileLock));
+    pending.ioLocks.push_back(std::move(ioLock));
+    return pending;
   }
 
   void notifyUnused() override {
@@ -160,18 +175,23 @@ public:
 
   absl::StatusOr<int> rawFd() const override {
     auto lock = lockShared();
-    auto s = _file.fsync();
-    if (!s.ok()) {
-      return s;
+    // Sealed files are not modified anymore: Skip the sync on the serving path.
+    if (!_isSealed) {
+      auto s = _file.fsync();
+      if (!s.ok()) {
+        return s;
+      }
     }
     return _file.rawFd();
   }
 
   absl::StatusOr<uint8_t *> rawPtr() override {
     auto lock = lockShared();
-    auto s = _file.fsync();
-    if (!s.ok()) {
-      return s;
+    if (!_isSealed) {
+      auto s = _file.fsync();
+      if (!s.ok()) {
+        return s;
+      }
     }
     return _file.rawPtr();
   }
@@ -233,4 +253,35 @@ public:
     _isValid = false;
     return fh;
   }
+
+  absl::StatusOr<std::shared_ptr<GEDSFileHandle>> move(const std::string &bucketArg,
+                                                       const std::string &keyArg) override {
+    auto lock = lockFile();
+    auto iolock = lockExclusive();
+    if (!isValid()) {
+      return absl::UnavailableError("The file " + identifier + " is no longer valid!");
+    }
+    if (_openCount > 0) {
+      return absl::FailedPreconditionError("Unable to move " + identifier +
+                                           " reason: The file is still in use.");
+    }
+    try {
+      auto path = geds::service::getLocalPath(_gedsService, bucketArg, keyArg);
+      auto dirStatus = geds::filesystem::mkdir(std::filesystem::path(path).remove_filename());
+      if (!dirStatus.ok()) {
+        return dirStatus;
+      }
+      auto status = _file.moveTo(path);
+      if (!status.ok()) {
+        return status;
+      }
+      _isValid = false;
+      auto moved = std::shared_ptr<GEDSAbstractFileHandle<T>>(new GEDSAbstractFileHandle<T>(
+          _gedsService, bucketArg, keyArg, _metadata, std::move(path), false));
+      moved->_isSealed = _isSealed.load();
+      return std::shared_ptr<GEDSFileHandle>(std::move(moved));
+    } catch (const std::runtime_error &e) {
+      return absl::UnknownError(e.what());
+    }
+  }
 };
@@ -22,9 +22,11 @@ const std::string GEDSCachedFileHandle::CacheBlockMarker = {"_$cachedblock$/"};
 GEDSCachedFileHandle::GEDSCachedFileHandle(std::shared_ptr<GEDS> gedsService, std::string bucketArg,
                                            std::string keyArg,
                                            std::optional<std::string> metadataArg,
-                                           std::shared_ptr<GEDSFileHandle> remoteFileHandle)
+                                           std::shared_ptr<GEDSFileHandle> remoteFileHandle,
+                                           std::shared_ptr<geds::StorageCounter> budget)
     : GEDSFileHandle(gedsService, std::move(bucketArg), std::move(keyArg), std::move(metadataArg)),
-      _remoteFileHandle(remoteFileHandle), _blockSize(gedsService->config().cacheBlockSize) {
+      _remoteFileHandle(remoteFileHandle), _blockSize(gedsService->config().cacheBlockSize),
+      _budget(std::move(budget)) {
   static auto counter = geds::Statistics::createCounter("GEDSCachedFileHandle: count");
   *counter += 1;
 
@@ -40,6 +42,37 @@ GEDSCachedFileHandle::GEDSCachedFileHandle(std::shared_ptr<GEDS> gedsService, st
   _remoteSize = _remoteFile->size();
   _blocks = std::vector<std::shared_ptr<GEDSFile>>(_remoteSize / _blockSize + 1, nullptr);
   _blockMutex = std::vector<std::mutex>(_remoteSize / _blockSize + 1);
+  _blockReserved = std::vector<uint8_t>(_remoteSize / _blockSize + 1, 0);
+}
+
+GEDSCachedFileHandle::~GEDSCachedFileHandle() {
+  if (_subscribed) {
+    _gedsService->releaseObjectSubscription(bucket, key);
+  }
+}
+
+absl::Status GEDSCachedFileHandle::subscribe() {
+  auto lock = lockFile();
+  if (_subscribed) {
+    return absl::OkStatus();
+  }
+  auto status = _gedsService->retainObjectSubscription(bucket, key);
+  _subscribed = status.ok();
+  return status;
+}
+
+size_t GEDSCachedFileHandle::blockLength(size_t idx) const {
+  auto offset = idx * _blockSize;
+  return offset >= _remoteSize ? 0 : std::min(_blockSize, _remoteSize - offset);
+}
+
+void GEDSCachedFileHandle::deleteBlock(size_t idx) {
+  auto file = std::move(_blocks[idx]);
+  (void)_gedsService->deleteObject(file->bucket(), file->key());
+  if (_blockReserved[idx]) {
+    _budget->release(blockLength(idx));
+    _blockReserved[idx] = false;
+  }
 }
 
 absl::StatusOr<size_t> GEDSCachedFileHandle::size() const { return _remoteSize; }
@@ -91,18 +124,34 @@ absl::StatusOr<size_t> GEDSCachedFileHandle::readBytes(uint8_t *bytes, size_t po
       return *_blocks[idx];
     }
 
+    if (_budget != nullptr) {
+      if (!_budget->reserve(blockLength(idx))) {
+        return absl::ResourceExhaustedError("The cache budget is exhausted.");
+      }
+      _blockReserved[idx] = true;
+    }
+    auto releaseReservation = [&]() {
+      if (_blockReserved[idx]) {
+        _budget->release(blockLength(idx));
+        _blockReserved[idx] = false;
+      }
+    };
+
     auto newFile = _gedsService->createAsFileHandle(bucket, cacheKey);
     if (!newFile.ok()) {
+      releaseReservation();
       return newFile.status();
     }
     auto copyStatus = _remoteFileHandle->downloadRange(*newFile, _blockSize * idx, _blockSize, 0);
     if (!copyStatus.ok()) {
+      releaseReservation();
       return copyStatus.status();
     }
     *_cacheSize += *copyStatus;
 
     auto f = (*newFile)->open();
     if (!f.ok()) {
+      releaseReservation();
       return f.status();
     }
     *_numCachedBlocks += 1;
@@ -124,9 +173,8 @@ absl::StatusOr<size_t> GEDSCachedFileHandle::readBytes(uint8_t *bytes, size_t po
     const GEDSFileHandle *t = file.fileHandle().get();
     if (e == t) {
       *_numPurgedBlocks += 1;
-      _blocks[idx] = nullptr;
       LOG_INFO("About to purge block", file.identifier());
-      (void)_gedsService->deleteObject(file.bucket(), file.key());
+      deleteBlock(idx);
       LOG_INFO("Purged block ", file.identifier());
     }
   };
@@ -136,10 +184,24 @@ absl::StatusOr<size_t> GEDSCachedFileHandle::readBytes(uint8_t *bytes, size_t po
 
   const size_t MAX_RETRIES = 1;
   size_t count = 0;
-  for (size_t idx = startBlock; idx <= endBlock; idx++) {
+  for (size_t idx = startBlock; idx <= endBlock && count < length; idx++) {
     size_t retryCount = 0;
     while (true) {
       auto fileBlock = openBlock(idx);
+      if (fileBlock.status().code() == absl::StatusCode::kResourceExhausted) {
+        // Read the block range from the remote file without caching it.
+        auto offset = (position + count) % _blockSize;
+        auto uncachedCount =
+            _remoteFile->read(bytes + count, position + count,
+                              std::min(length - count, _blockSize - offset));
+        if (!uncachedCount.ok()) {
+          return uncachedCount.status();
+        }
+        *_numUncachedReads += 1;
+        *_readStatistics += *uncachedCount;
+        count += *uncachedCount;
+        break;
+      }
       if (!fileBlock.ok()) {
         return fileBlock.status();
       }
@@ -167,10 +229,10 @@ absl::StatusOr<size_t> GEDSCachedFileHandle::readBytes(uint8_t *bytes, size_t po
   return count;
 }
 
-absl::Status GEDSCachedFileHandle::seal() {
+absl::StatusOr<GEDSPendingSeal> GEDSCachedFileHandle::prepareSeal() {
   auto lock = lockFile();
   auto iolock = lockExclusive();
-  return _remoteFileHandle->seal();
+  return _remoteFileHandle->prepareSeal();
 }
 
 absl::StatusOr<std::shared_ptr<GEDSFileHandle>> GEDSCachedFileHandle::relocate() {
@@ -182,14 +244,22 @@ absl::StatusOr<std::shared_ptr<GEDSFileHandle>> GEDSCachedFileHandle::relocate()
     if (_blocks[idx].get() == nullptr) {
       continue;
     }
-    auto file = _blocks[idx];
-    auto bucket = file->bucket();
-    auto key = file->key();
-    auto fh = file->fileHandle();
+    auto fh = _blocks[idx]->fileHandle();
     if (fh->localStorageSize()) {
-      (void)_gedsService->deleteObject(bucket, key);
-      _blocks[idx] = nullptr;
+      deleteBlock(idx);
     }
   }
   return shared_from_this();
 }
+
+void GEDSCachedFileHandle::invalidate() {
+  GEDSFileHandle::invalidate();
+  auto ioLock = lockExclusive();
+  for (size_t idx = 0; idx < _blocks.size(); idx++) {
+    auto lock = std::lock_guard(_blockMutex[idx]);
+    if (_blocks[idx].get() != nullptr) {
+      deleteBlock(idx);
+    }
+  }
+  _remoteFileHandle->invalidate();
+}
@@ -6,6 +6,7 @@
 #ifndef GEDS_CACHED_FILE_HANDLE_H
 #define GEDS_CACHED_FILE_HANDLE_H
 
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -14,6 +15,7 @@
 #include "GEDSFile.h"
 #include "MMAPFile.h"
 #include "Object.h"
+#include "StorageCounter.h"
 
 #include "GEDS.h"
 
@@ -23,10 +25,18 @@ class GEDSCachedFileHandle : public GEDSFileHandle {
 
   size_t _remoteSize;
   size_t _blockSize;
+  std::optional<uint64_t> _version;
+  bool _subscribed = false;
 
   std::vector<std::shared_ptr<GEDSFile>> _blocks;
   mutable std::vector<std::mutex> _blockMutex;
 
+  // Optional bound of the local storage used by blocks of this handle. Blocks which were
+  // accounted for are marked in `_blockReserved`. One byte per block: Blocks are guarded by
+  // separate mutexes, so their flags must not share a word as in `std::vector<bool>`.
+  std::shared_ptr<geds::StorageCounter> _budget;
+  std::vector<uint8_t> _blockReserved;
+
   std::shared_ptr<geds::StatisticsCounter> _readStatistics =
       geds::Statistics::createCounter("GEDSCachedFileHandle: bytes read");
   std::shared_ptr<geds::StatisticsCounter> _cacheSize =
@@ -35,11 +45,20 @@ class GEDSCachedFileHandle : public GEDSFileHandle {
       geds::Statistics::createCounter("GEDSCachedFileHandle: number of locally cached blocks");
   std::shared_ptr<geds::StatisticsCounter> _numPurgedBlocks =
       geds::Statistics::createCounter("GEDSCachedFileHandle: number of purged blocks");
+  std::shared_ptr<geds::StatisticsCounter> _numUncachedReads =
+      geds::Statistics::createCounter("GEDSCachedFileHandle: reads bypassing the exhausted cache");
+
+  size_t blockLength(size_t idx) const;
+  /**
+   * @brief Delete the block `idx`. Requires the lock of the block.
+   */
+  void deleteBlock(size_t idx);
   // private:
 public:
   GEDSCachedFileHandle(std::shared_ptr<GEDS> gedsService, std::string bucketArg, std::string keyArg,
                        std::optional<std::string> metadataArg,
-                       std::shared_ptr<GEDSFileHandle> remoteFile);
+                       std::shared_ptr<GEDSFileHandle> remoteFile,
+                       std::shared_ptr<geds::StorageCounter> budget = nullptr);
 
 public:
   static const std::string CacheBlockMarker;
@@ -58,19 +77,25 @@ public:
 
   template <class TRemote>
   [[nodiscard]] static absl::StatusOr<std::shared_ptr<GEDSFileHandle>>
-  factory(std::shared_ptr<GEDS> gedsService, const geds::Object &object) {
+  factory(std::shared_ptr<GEDS> gedsService, const geds::Object &object,
+          std::shared_ptr<geds::StorageCounter> budget = nullptr) {
     auto remoteFH = TRemote::factory(gedsService, object);
     if (!remoteFH.ok()) {
       return remoteFH.status();
     }
-    return std::shared_ptr<GEDSFileHandle>(new GEDSCachedFileHandle(
-        gedsService, object.id.bucket, object.id.key, object.info.metadata, *remoteFH));
+    auto handle = std::shared_ptr<GEDSCachedFileHandle>(
+        new GEDSCachedFileHandle(gedsService, object.id.bucket, object.id.key,
+                                 object.info.metadata, *remoteFH, std::move(budget)));
+    if (object.info.version != 0) {
+      handle->_version = object.info.version;
+    }
+    return std::shared_ptr<GEDSFileHandle>(std::move(handle));
   }
 
   GEDSCachedFileHandle() = delete;
   GEDSCachedFileHandle(const GEDSCachedFileHandle &) = delete;
   GEDSCachedFileHandle(GEDSCachedFileHandle &&) = delete;
-  ~GEDSCachedFileHandle() override = default;
+  ~GEDSCachedFileHandle() override;
   GEDSCachedFileHandle &operator=(const GEDSCachedFileHandle &) = delete;
   GEDSCachedFileHandle &operator=(GEDSCachedFileHandle &&) = delete;
 
@@ -79,11 +104,23 @@ public:
   size_t localStorageSize() const override;
   size_t localMemorySize() const override;
 
+  std::optional<uint64_t> version() const override { return _version; }
+
+  /**
+   * @brief Subscribe to updates of the object until the handle is destroyed.
+   */
+  absl::Status subscribe();
+
   absl::StatusOr<size_t> readBytes(uint8_t *bytes, size_t position, size_t length) override;
 
-  absl::Status seal() override;
+  absl::StatusOr<GEDSPendingSeal> prepareSeal() override;
 
   absl::StatusOr<std::shared_ptr<GEDSFileHandle>> relocate() override;
+
+  /**
+   * @brief Invalidate the handle and delete all cached blocks.
+   */
+  void invalidate() override;
 };
 
 #endif
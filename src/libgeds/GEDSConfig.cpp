@@ -17,6 +17,31 @@ absl::Status GEDSConfig::set(const std::string &key, const std::string &value) {
     localStoragePath = value;
   } else if (key == "pub_sub_enabled" && value == "true") {
     pubSubEnabled = true;
+  } else if (key == "transport") {
+    if (value != "asio" && value != "epoll") {
+      return absl::InvalidArgumentError("Value " + value + " is out of range for " + key);
+    }
+    transport = value;
+  } else if (key == "local_transport") {
+    if (value != "true" && value != "false") {
+      return absl::InvalidArgumentError("Value " + value + " is out of range for " + key);
+    }
+    localTransport = value == "true";
+  } else if (key == "read_ahead") {
+    if (value != "true" && value != "false") {
+      return absl::InvalidArgumentError("Value " + value + " is out of range for " + key);
+    }
+    readAhead = value == "true";
+  } else if (key == "async_seal") {
+    if (value != "true" && value != "false") {
+      return absl::InvalidArgumentError("Value " + value + " is out of range for " + key);
+    }
+    asyncSeal = value == "true";
+  } else if (key == "lookup_cache") {
+    if (value != "true" && value != "false") {
+      return absl::InvalidArgumentError("Value " + value + " is out of range for " + key);
+    }
+    lookupCache = value == "true";
   } else {
     LOG_ERROR("Configuration " + key + " not supported (type: string).");
     return absl::NotFoundError("Key " + key + " not found.");
@@ -45,6 +70,26 @@ absl::Status GEDSConfig::set(const std::string &key, size_t value) {
     portHttpServer = value;
   } else if (key == "cache_block_size") {
     cacheBlockSize = value;
+  } else if (key == "copy_buffer_memory") {
+    copyBufferMemory = value;
+  } else if (key == "open_file_cache_size") {
+    openFileCacheSize = value;
+  } else if (key == "read_stripe_size") {
+    readStripeSize = value;
+  } else if (key == "read_stripe_threshold") {
+    readStripeThreshold = value;
+  } else if (key == "read_ahead_min_window") {
+    readAheadMinWindow = value;
+  } else if (key == "read_ahead_max_window") {
+    readAheadMaxWindow = value;
+  } else if (key == "read_ahead_memory") {
+    readAheadMemory = value;
+  } else if (key == "lookup_cache_size") {
+    lookupCacheSize = value;
+  } else if (key == "lookup_cache_ttl") {
+    lookupCacheTtl = value;
+  } else if (key == "lookup_cache_negative_ttl") {
+    lookupCacheNegativeTtl = value;
   } else if (key == "io_thread_pool_size") {
     io_thread_pool_size = value;
   } else if (key == "available_local_storage") {
@@ -55,6 +100,10 @@ absl::Status GEDSConfig::set(const std::string &key, size_t value) {
     pubSubEnabled = value != 0;
   } else if (key == "cache_objects_from_s3") {
     cache_objects_from_s3 = value != 0;
+  } else if (key == "cache_objects_from_geds") {
+    cache_objects_from_geds = value != 0;
+  } else if (key == "geds_object_cache_size") {
+    geds_object_cache_size = value;
   } else if (key == "force_relocation_when_stopping") {
     force_relocation_when_stopping = value != 0;
   } else {
@@ -93,6 +142,21 @@ absl::StatusOr<std::string> GEDSConfig::getString(const std::string &key) const
   if (key == "local_storage_path") {
     return localStoragePath;
   }
+  if (key == "transport") {
+    return transport;
+  }
+  if (key == "local_transport") {
+    return std::string{localTransport ? "true" : "false"};
+  }
+  if (key == "read_ahead") {
+    return std::string{readAhead ? "true" : "false"};
+  }
+  if (key == "async_seal") {
+    return std::string{asyncSeal ? "true" : "false"};
+  }
+  if (key == "lookup_cache") {
+    return std::string{lookupCache ? "true" : "false"};
+  }
   LOG_ERROR("Configuration " + key + " not supported (type: string).");
   return absl::NotFoundError("Key " + key + " not found.");
 }
@@ -108,6 +172,36 @@ absl::StatusOr<size_t> GEDSConfig::getUnsignedInt(const std::string &key) const
   if (key == "cache_block_size") {
     return cacheBlockSize;
   }
+  if (key == "copy_buffer_memory") {
+    return copyBufferMemory;
+  }
+  if (key == "open_file_cache_size") {
+    return openFileCacheSize;
+  }
+  if (key == "read_stripe_size") {
+    return readStripeSize;
+  }
+  if (key == "read_stripe_threshold") {
+    return readStripeThreshold;
+  }
+  if (key == "read_ahead_min_window") {
+    return readAheadMinWindow;
+  }
+  if (key == "read_ahead_max_window") {
+    return readAheadMaxWindow;
+  }
+  if (key == "read_ahead_memory") {
+    return readAheadMemory;
+  }
+  if (key == "lookup_cache_size") {
+    return lookupCacheSize;
+  }
+  if (key == "lookup_cache_ttl") {
+    return lookupCacheTtl;
+  }
+  if (key == "lookup_cache_negative_ttl") {
+    return lookupCacheNegativeTtl;
+  }
   if (key == "io_thread_pool_size") {
     return io_thread_pool_size;
   }
@@ -117,6 +211,9 @@ absl::StatusOr<size_t> GEDSConfig::getUnsignedInt(const std::string &key) const
   if (key == "available_local_memory") {
     return available_local_memory;
   }
+  if (key == "geds_object_cache_size") {
+    return geds_object_cache_size;
+  }
   LOG_ERROR("Configuration " + key + " not supported (type: signed/unsigned integer).");
   return absl::NotFoundError("Key " + key + " not found.");
 }
@@ -48,6 +48,19 @@ struct GEDSConfig {
    */
   uint16_t portHttpServer = defaultPrometheusPort;
 
+  /**
+   * @brief Engine serving the TCP data path: `asio` or `epoll`.
+   *
+   * Remote reads prefer endpoints of the same engine if the peer advertises several.
+   */
+  std::string transport = "asio";
+
+  /**
+   * @brief Serve objects to processes on the same host through a Unix domain socket and read
+   * from peers on the same host through their Unix domain socket.
+   */
+  bool localTransport = true;
+
   /**
    * @brief Storage path for files create by GEDS.
    *
@@ -62,6 +75,53 @@ struct GEDSConfig {
    */
   size_t cacheBlockSize = 32 * 1024 * 1024;
 
+  /**
+   * @brief Bytes kept for the buffers of copies which cannot be done by the kernel.
+   */
+  size_t copyBufferMemory = 128 * 1024 * 1024;
+
+  /**
+   * @brief Number of files kept open to serve remote reads.
+   */
+  size_t openFileCacheSize = 4096;
+
+  /**
+   * @brief Remote reads of at least `readStripeThreshold` bytes are split into stripes of
+   * `readStripeSize` bytes which are read concurrently over the pooled data connections.
+   */
+  size_t readStripeSize = 8 * 1024 * 1024;
+  size_t readStripeThreshold = 32 * 1024 * 1024;
+
+  /**
+   * @brief Prefetch ahead of sequential reads of remote GEDS objects.
+   *
+   * The read-ahead window grows from `readAheadMinWindow` to `readAheadMaxWindow` bytes. The
+   * prefetched data of all files is bounded by `readAheadMemory` bytes.
+   */
+  bool readAhead = true;
+  size_t readAheadMinWindow = 256 * 1024;
+  size_t readAheadMaxWindow = 16 * 1024 * 1024;
+  size_t readAheadMemory = 512 * 1024 * 1024;
+
+  /**
+   * @brief Register sealed objects asynchronously in batches. Other instances see the objects
+   * after `GEDS::flush`.
+   */
+  bool asyncSeal = false;
+
+  /**
+   * @brief Cache metadata lookups and `GEDS::status` results, including misses.
+   *
+   * At most `lookupCacheSize` entries are cached per cache. Found objects expire after
+   * `lookupCacheTtl` milliseconds, misses after `lookupCacheNegativeTtl` milliseconds. Without
+   * `pubSubEnabled`, changes by other instances are only seen once the entries expire, so the
+   * cache is opt-in.
+   */
+  bool lookupCache = false;
+  size_t lookupCacheSize = 100000;
+  size_t lookupCacheTtl = 5000;
+  size_t lookupCacheNegativeTtl = 1000;
+
   /**
    * @brief Size of I/O thread pool.
    */
@@ -84,6 +144,15 @@ struct GEDSConfig {
    */
   bool cache_objects_from_s3 = false;
 
+  /**
+   * @brief Cache blocks of objects located on other GEDS instances.
+   *
+   * Cached blocks use at most `geds_object_cache_size` bytes of local storage. Reads beyond the
+   * budget are served by the remote instance.
+   */
+  bool cache_objects_from_geds = false;
+  size_t geds_object_cache_size = 10 * 1024 * 1024 * (size_t)1024;
+
   /**
    * @brief Force relocation when stopping.
    */
@@ -68,6 +68,10 @@ absl::StatusOr<size_t> GEDSFile::readBytes(uint8_t *bytes, size_t position, size
   return _fileHandle->readBytes(bytes, position, length);
 }
 
+absl::StatusOr<std::vector<size_t>> GEDSFile::readv(const std::vector<geds::ReadRange> &ranges) {
+  return _fileHandle->readv(ranges);
+}
+
 absl::Status GEDSFile::writeBytes(const uint8_t *bytes, size_t position, size_t length) {
   return _fileHandle->writeBytes(bytes, position, length);
 }
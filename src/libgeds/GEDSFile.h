@@ -128,6 +128,12 @@ public:
     return write(buffer, 0, position, length);
   }
 
+  /**
+   * @brief Read multiple ranges with a single request. Returns the number of bytes read for
+   * each range.
+   */
+  absl::StatusOr<std::vector<size_t>> readv(const std::vector<geds::ReadRange> &ranges);
+
   absl::Status truncate(size_t size);
 
   absl::StatusOr<int> rawFd() const;
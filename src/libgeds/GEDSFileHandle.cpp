@@ -7,10 +7,12 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "Filesystem.h"
 #include "GEDS.h"
 #include "GEDSFile.h"
 #include "GEDSInternal.h"
@@ -55,10 +57,21 @@ bool GEDSFileHandle::isValid() const {
   return _isValid;
 }
 
+void GEDSFileHandle::invalidate() {
+  auto lock = lockFile();
+  _isValid = false;
+}
+
 absl::StatusOr<std::shared_ptr<GEDSFileHandle>> GEDSFileHandle::relocate() {
   return absl::UnavailableError("Relocating is not supported for this file handle type!");
 }
 
+absl::StatusOr<std::shared_ptr<GEDSFileHandle>>
+GEDSFileHandle::move(const std::string & /* unused bucket */,
+                     const std::string & /* unused key */) {
+  return absl::UnimplementedError("Moving is not supported for this file handle type!");
+}
+
 void GEDSFileHandle::notifyUnused() { LOG_DEBUG("The file ", identifier, " is unused."); }
 
 std::chrono::system_clock::time_point GEDSFileHandle::lastOpened() const { return _lastOpened; }
@@ -84,6 +97,20 @@ absl::StatusOr<size_t> GEDSFileHandle::readBytes(uint8_t * /* unused bytes */,
   return absl::UnavailableError("Read operation is not available.");
 }
 
+absl::StatusOr<std::vector<size_t>>
+GEDSFileHandle::readv(const std::vector<geds::ReadRange> &ranges) {
+  std::vector<size_t> result;
+  result.reserve(ranges.size());
+  for (const auto &range : ranges) {
+    auto count = readBytes(range.buffer, range.position, range.length);
+    if (!count.ok()) {
+      return count.status();
+    }
+    result.push_back(*count);
+  }
+  return result;
+}
+
 absl::StatusOr<int> GEDSFileHandle::rawFd() const {
   return absl::UnavailableError("rawFDs are not supported for this FileHandle type!");
 }
@@ -107,14 +134,24 @@ absl::Status GEDSFileHandle::truncate(size_t /*targetSize*/) {
 }
 
 absl::Status GEDSFileHandle::download(std::shared_ptr<GEDSFileHandle> destination) {
+  if (this == destination.get()) {
+    return absl::InvalidArgumentError("Source and target are the same!");
+  }
   size_t pos = 0;
   const auto totalSize = size();
   if (!totalSize.ok()) {
     return totalSize.status();
   }
+  auto copied = copyLocal(*destination, 0, *totalSize, 0);
+  if (copied.ok()) {
+    return absl::OkStatus();
+  }
+  // Both files are local, but the kernel cannot copy: Avoid retrying for every block.
+  bool local = copied.status().code() != absl::StatusCode::kUnavailable;
   do {
     auto length = std::min(_gedsService->config().cacheBlockSize, *totalSize - pos);
-    auto count = downloadRange(destination, pos, length, pos);
+    auto count = local ? copyBuffered(*destination, pos, length, pos)
+                       : downloadRange(destination, pos, length, pos);
     if (!count.ok()) {
       return count.status();
     }
@@ -129,19 +166,78 @@ absl::StatusOr<size_t> GEDSFileHandle::downloadRange(std::shared_ptr<GEDSFileHan
   if (this == destination.get()) {
     return absl::InvalidArgumentError("Source and target are the same!");
   }
+  auto copied = copyLocal(*destination, srcPosition, length, destPosition);
+  if (copied.ok()) {
+    return copied;
+  }
+  return copyBuffered(*destination, srcPosition, length, destPosition);
+}
+
+absl::StatusOr<size_t> GEDSFileHandle::copyLocal(GEDSFileHandle &destination, size_t srcPosition,
+                                                 size_t length, size_t destPosition) {
+  auto srcFd = rawFd();
+  if (!srcFd.ok()) {
+    return absl::UnavailableError(srcFd.status().message());
+  }
+  auto destFd = destination.rawFd();
+  if (!destFd.ok()) {
+    return absl::UnavailableError(destFd.status().message());
+  }
+  auto srcSize = size();
+  if (!srcSize.ok()) {
+    return srcSize.status();
+  }
+  auto destSize = destination.size();
+  if (!destSize.ok()) {
+    return destSize.status();
+  }
+  length = std::min(length, *srcSize - std::min(srcPosition, *srcSize));
+
+  size_t count = 0;
+  bool whole = srcPosition == 0 && destPosition == 0 && length == *srcSize && *destSize == 0;
+  if (whole && geds::filesystem::cloneFile(*srcFd, *destFd).ok()) {
+    count = length;
+  } else {
+    auto copied =
+        geds::filesystem::copyFileRange(*srcFd, srcPosition, *destFd, destPosition, length);
+    if (!copied.ok()) {
+      return copied.status();
+    }
+    count = *copied;
+  }
+  // The data bypassed the destination handle: Set the size it tracks. Truncating a clone also drops
+  // the blocks a memory-mapped source allocates beyond its size.
+  if (whole || destPosition + count > *destSize) {
+    auto status = destination.truncate(std::max(*destSize, destPosition + count));
+    if (!status.ok()) {
+      return status;
+    }
+  }
+  return count;
+}
+
+absl::StatusOr<size_t> GEDSFileHandle::copyBuffered(GEDSFileHandle &destination,
+                                                    size_t srcPosition, size_t length,
+                                                    size_t destPosition) {
   size_t count = 0;
   try {
-    std::vector<uint8_t> buffer(_gedsService->config().cacheBlockSize, 0);
+    auto bufferSize = std::max<size_t>(std::min(_gedsService->config().cacheBlockSize, length), 1);
+    // Allocate a temporary buffer if the pooled buffers are in use.
+    auto buffer = _gedsService->copyBufferPool()->acquire(bufferSize);
+    if (buffer == nullptr) {
+      buffer = std::make_shared<std::vector<uint8_t>>(bufferSize);
+    }
+    auto &bytes = *buffer;
     do {
       auto rcount =
-          readBytes(&buffer[0], srcPosition + count, std::min(length - count, buffer.size()));
+          readBytes(&bytes[0], srcPosition + count, std::min(length - count, bufferSize));
       if (!rcount.ok()) {
         return rcount.status();
       }
       if (*rcount == 0) {
         break;
       }
-      auto writeStatus = destination->writeBytes(&buffer[0], destPosition + count, *rcount);
+      auto writeStatus = destination.writeBytes(&bytes[0], destPosition + count, *rcount);
       if (!writeStatus.ok()) {
         return writeStatus;
       }
@@ -154,6 +250,19 @@ absl::StatusOr<size_t> GEDSFileHandle::downloadRange(std::shared_ptr<GEDSFileHan
 }
 
 absl::Status GEDSFileHandle::seal() {
+  // FIXME: Create a GEDS Service mock to skip this abonimation below here.
+  if (_gedsService != nullptr) { // Allow faking the GEDS Service for unittests.
+    return _gedsService->seal(*this);
+  }
+  auto pending = prepareSeal();
+  if (!pending.ok()) {
+    return pending.status();
+  }
+  pending->markSealed();
+  return absl::OkStatus();
+}
+
+absl::StatusOr<GEDSPendingSeal> GEDSFileHandle::prepareSeal() {
   return absl::UnavailableError("Seal operation is not available.");
 }
 
@@ -9,21 +9,49 @@
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <istream>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <shared_mutex>
 #include <string>
+#include <vector>
 
 #include <absl/status/status.h>
 #include <absl/status/statusor.h>
 
 #include "GEDSFile.h"
 #include "GEDSInternal.h"
+#include "Object.h"
 
 class GEDS;
 
+/**
+ * @brief Registration of a file handle which is about to be sealed, see
+ * `GEDSFileHandle::prepareSeal`.
+ */
+struct GEDSPendingSeal {
+  /**
+   * @brief The object to register. An empty location refers to the local GEDS instance.
+   */
+  geds::Object object;
+  /**
+   * @brief The object has been registered before.
+   */
+  bool update;
+  /**
+   * @brief Marks the handle as sealed. Invoked once the object is registered.
+   */
+  std::function<void()> markSealed;
+
+  /**
+   * @brief Keep the handle from being modified until the registration is done.
+   */
+  std::vector<std::unique_lock<std::recursive_mutex>> fileLocks;
+  std::vector<std::unique_lock<std::shared_mutex>> ioLocks;
+};
+
 class GEDSFileHandle : public std::enable_shared_from_this<GEDSFileHandle> {
 public:
   const std::string bucket;
@@ -52,6 +80,22 @@ protected:
   GEDSFileHandle(std::shared_ptr<GEDS> gedsService, std::string bucketArg, std::string keyArg,
                  std::optional<std::string> metadataArg);
 
+  /**
+   * @brief Copy in the kernel if both handles expose a file descriptor. Whole files are cloned on
+   * file systems with reflinks, other ranges are copied with `copy_file_range`.
+   *
+   * Returns UNAVAILABLE if a handle has no file descriptor and UNIMPLEMENTED if the kernel cannot
+   * copy between the files.
+   */
+  absl::StatusOr<size_t> copyLocal(GEDSFileHandle &destination, size_t srcPosition, size_t length,
+                                   size_t destPosition);
+
+  /**
+   * @brief Copy through a buffer of the copy buffer pool.
+   */
+  absl::StatusOr<size_t> copyBuffered(GEDSFileHandle &destination, size_t srcPosition,
+                                      size_t length, size_t destPosition);
+
 public:
   auto lockFile() const { return std::lock_guard(_fileMutex); }
 
@@ -71,17 +115,40 @@ public:
   std::chrono::system_clock::time_point lastReleased() const;
 
   virtual bool isValid() const;
+  /**
+   * @brief Mark the file as outdated. Subsequent opens reopen the object.
+   */
+  virtual void invalidate();
   virtual bool isRelocatable() const { return false; }
   virtual bool isWriteable() const { return false; }
 
   virtual absl::StatusOr<std::shared_ptr<GEDSFileHandle>> relocate();
 
+  /**
+   * @brief Move the local data to a new handle of `bucket`/`key` without copying it. This handle
+   * becomes invalid. Fails with FAILED_PRECONDITION if the file is open.
+   */
+  virtual absl::StatusOr<std::shared_ptr<GEDSFileHandle>> move(const std::string &bucket,
+                                                               const std::string &key);
+
   virtual std::optional<std::string> metadata() const;
 
+  /**
+   * @brief Version of the object whose contents are cached by this handle, if any.
+   */
+  virtual std::optional<uint64_t> version() const { return std::nullopt; }
+
   virtual absl::Status setMetadata(std::optional<std::string> metadata, bool seal = true);
 
   virtual absl::StatusOr<size_t> readBytes(uint8_t *bytes, size_t position, size_t length);
 
+  /**
+   * @brief Vectored read. Returns the number of bytes read for each range.
+   *
+   * The default implementation issues one `readBytes` per range.
+   */
+  virtual absl::StatusOr<std::vector<size_t>> readv(const std::vector<geds::ReadRange> &ranges);
+
   virtual absl::Status writeBytes(const uint8_t *bytes, size_t position, size_t length);
 
   virtual absl::Status write(std::istream &stream, size_t position = 0,
@@ -89,7 +156,16 @@ public:
 
   virtual absl::Status truncate(size_t targetSize);
 
-  virtual absl::Status seal();
+  /**
+   * @brief Seal the file and register it with the metadata service.
+   */
+  absl::Status seal();
+
+  /**
+   * @brief Lock the handle and return the object to register for a seal. The handle is not marked
+   * as sealed until `GEDSPendingSeal::markSealed` is invoked.
+   */
+  virtual absl::StatusOr<GEDSPendingSeal> prepareSeal();
 
   virtual absl::StatusOr<GEDSFile> open();
 
@@ -7,6 +7,8 @@
 #define GEDS_GEDSINTERNAL_H
 
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace geds {
@@ -14,6 +16,15 @@ enum class ConnectionState : int { Disconnected = 0, Connected, Unknown };
 enum class ServiceState : int { Stopped = 0, Running, Unknown };
 enum class FileMode : int { ReadWrite = 0, ReadOnly = 1 };
 
+/**
+ * @brief A single range of a vectored read: Read `length` bytes at `position` into `buffer`.
+ */
+struct ReadRange {
+  uint8_t *buffer;
+  size_t position;
+  size_t length;
+};
+
 std::string to_string(geds::ConnectionState state);
 
 std::string to_string(geds::ServiceState state);
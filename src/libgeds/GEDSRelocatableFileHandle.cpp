@@ -38,11 +38,22 @@ bool GEDSRelocatableFileHandle::isWriteable() const {
   return _fileHandle->isWriteable();
 }
 
+void GEDSRelocatableFileHandle::invalidate() {
+  GEDSFileHandle::invalidate();
+  auto lock = lockShared();
+  _fileHandle->invalidate();
+}
+
 std::optional<std::string> GEDSRelocatableFileHandle::metadata() const {
   auto lock = lockFile();
   return _fileHandle->metadata();
 };
 
+std::optional<uint64_t> GEDSRelocatableFileHandle::version() const {
+  auto lock = lockFile();
+  return _fileHandle->version();
+}
+
 absl::Status GEDSRelocatableFileHandle::setMetadata(std::optional<std::string> metadata,
                                                     bool seal) {
   auto lock = lockFile();
@@ -81,6 +92,37 @@ absl::StatusOr<size_t> GEDSRelocatableFileHandle::readBytes(uint8_t *bytes, size
   }
 }
 
+absl::StatusOr<std::vector<size_t>>
+GEDSRelocatableFileHandle::readv(const std::vector<geds::ReadRange> &ranges) {
+  GEDSFileHandle *oldFh;
+  {
+    auto lock = lockShared();
+    oldFh = _fileHandle.get();
+    auto success = _fileHandle->readv(ranges);
+    if (success.ok()) {
+      return success;
+    }
+  }
+  // Reopen in case of read failures.
+  {
+    auto lock = lockFile();
+    auto ioLock = lockExclusive();
+    if (_fileHandle.get() != oldFh) {
+      // The file has already been reopened.
+      return _fileHandle->readv(ranges);
+    }
+    LOG_INFO("Reopening file ", identifier);
+    // Force lookup in MDS.
+    auto newFh = _gedsService->reopenFileHandle(bucket, key, true);
+    if (!newFh.ok()) {
+      LOG_INFO("Unable to reopen file: ", identifier, " reason: ", newFh.status().message());
+      return newFh.status();
+    }
+    _fileHandle = *newFh;
+    return _fileHandle->readv(ranges);
+  }
+}
+
 absl::Status GEDSRelocatableFileHandle::writeBytes(const uint8_t *bytes, size_t position,
                                                    size_t length) {
   auto lock = lockShared();
@@ -98,9 +140,14 @@ absl::Status GEDSRelocatableFileHandle::truncate(size_t targetSize) {
   return _fileHandle->truncate(targetSize);
 }
 
-absl::Status GEDSRelocatableFileHandle::seal() {
+absl::StatusOr<GEDSPendingSeal> GEDSRelocatableFileHandle::prepareSeal() {
+  // Hold the lock until the object is registered: The file must not be relocated meanwhile.
   auto lock = lockExclusive();
-  return _fileHandle->seal();
+  auto pending = _fileHandle->prepareSeal();
+  if (pending.ok()) {
+    pending->ioLocks.push_back(std::move(lock));
+  }
+  return pending;
 }
 
 void GEDSRelocatableFileHandle::notifyUnused() {
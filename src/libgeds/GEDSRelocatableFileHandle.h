@@ -50,12 +50,19 @@ public:
 
   bool isWriteable() const override;
 
+  void invalidate() override;
+
   std::optional<std::string> metadata() const override;
 
+  std::optional<uint64_t> version() const override;
+
   absl::Status setMetadata(std::optional<std::string> metadata, bool seal) override;
 
   absl::StatusOr<size_t> readBytes(uint8_t *bytes, size_t position, size_t length) override;
 
+  absl::StatusOr<std::vector<size_t>>
+  readv(const std::vector<geds::ReadRange> &ranges) override;
+
   absl::Status writeBytes(const uint8_t *bytes, size_t position, size_t length) override;
 
   absl::Status write(std::istream &stream, size_t position,
@@ -63,7 +70,7 @@ public:
 
   absl::Status truncate(size_t targetSize) override;
 
-  absl::Status seal() override;
+  absl::StatusOr<GEDSPendingSeal> prepareSeal() override;
 
   void notifyUnused() override;
 
@@ -18,10 +18,29 @@ GEDSRemoteFileHandle::GEDSRemoteFileHandle(
     std::shared_ptr<geds::FileTransferService> fileTransferService)
     : GEDSFileHandle(gedsService, object.id.bucket, object.id.key, object.info.metadata),
       _fileTransferService(fileTransferService), _info(object.info) {
+  const auto &config = gedsService->config();
+  if (config.readAhead) {
+    // Prefetches may outlive the file handle: Do not capture `this`.
+    auto fetch = [service = _fileTransferService, bucket = object.id.bucket,
+                  key = object.id.key](uint8_t *buffer, size_t position, size_t length) {
+      return service->readBytes(bucket, key, buffer, position, length);
+    };
+    std::weak_ptr<GEDS> weakGeds = gedsService;
+    auto executor = [weakGeds](std::function<void()> task) {
+      if (auto geds = weakGeds.lock()) {
+        geds->postIO(std::move(task));
+      }
+    };
+    _readAhead = std::make_unique<geds::ReadAhead>(fetch, executor, gedsService->readAheadPool(),
+                                                   _info.size, config.readAheadMinWindow,
+                                                   config.readAheadMaxWindow);
+  }
   static auto counter = geds::Statistics::createCounter("GEDSRemoteFileHandle: count");
   *counter += 1;
 }
 
+GEDSRemoteFileHandle::~GEDSRemoteFileHandle() { _fileTransferService->invalidate(bucket, key); }
+
 absl::StatusOr<std::shared_ptr<GEDSFileHandle>>
 GEDSRemoteFileHandle::factory(std::shared_ptr<GEDS> gedsService, const geds::Object &object) {
   const std::string_view prefix{"geds://"};
@@ -47,7 +66,8 @@ absl::StatusOr<size_t> GEDSRemoteFileHandle::readBytes(uint8_t *bytes, size_t po
     return 0;
   }
   auto lock = lockShared();
-  auto read = _fileTransferService->read(bucket, key, bytes, position, length);
+  auto read = _readAhead ? _readAhead->read(bytes, position, length)
+                         : _fileTransferService->read(bucket, key, bytes, position, length);
   if (!read.ok()) {
     return read;
   }
@@ -59,12 +79,33 @@ absl::StatusOr<size_t> GEDSRemoteFileHandle::readBytes(uint8_t *bytes, size_t po
   return *read;
 }
 
+absl::StatusOr<std::vector<size_t>>
+GEDSRemoteFileHandle::readv(const std::vector<geds::ReadRange> &ranges) {
+  if (ranges.empty()) {
+    return std::vector<size_t>{};
+  }
+  auto lock = lockShared();
+  auto read = _fileTransferService->readv(bucket, key, ranges);
+  if (!read.ok()) {
+    return read;
+  }
+  for (auto count : *read) {
+    *_statistics += count;
+  }
+  return read;
+}
+
 absl::StatusOr<size_t> GEDSRemoteFileHandle::size() const {
   auto lock = lockShared();
   // TODO: Update size with remote request.
   return _info.size;
 }
 
-absl::Status GEDSRemoteFileHandle::seal() {
+absl::StatusOr<GEDSPendingSeal> GEDSRemoteFileHandle::prepareSeal() {
   return absl::FailedPreconditionError("Remote files cannot be sealed!");
 }
+
+void GEDSRemoteFileHandle::invalidate() {
+  GEDSFileHandle::invalidate();
+  _fileTransferService->invalidate(bucket, key);
+}
@@ -9,11 +9,14 @@
 #include "FileTransferService.h"
 #include "GEDSFileHandle.h"
 #include "Object.h"
+#include "ReadAhead.h"
 #include "Statistics.h"
 
 class GEDSRemoteFileHandle : public GEDSFileHandle {
   std::shared_ptr<geds::FileTransferService> _fileTransferService;
   geds::ObjectInfo _info;
+  // Set if read-ahead is enabled.
+  std::unique_ptr<geds::ReadAhead> _readAhead;
 
   std::shared_ptr<geds::StatisticsCounter> _statistics =
       geds::Statistics::createCounter("GEDSRemoteFileHandle: bytes read");
@@ -25,7 +28,7 @@ private:
 
 public:
   GEDSRemoteFileHandle() = delete;
-  ~GEDSRemoteFileHandle() override = default;
+  ~GEDSRemoteFileHandle() override;
 
   [[nodiscard]] static absl::StatusOr<std::shared_ptr<GEDSFileHandle>>
   factory(std::shared_ptr<GEDS> gedsService, const geds::Object &object);
@@ -34,9 +37,13 @@ public:
 
   absl::StatusOr<size_t> size() const override;
 
-  absl::Status seal() override;
+  absl::StatusOr<GEDSPendingSeal> prepareSeal() override;
+
+  void invalidate() override;
 
   absl::StatusOr<size_t> readBytes(uint8_t *bytes, size_t position, size_t length) override;
+
+  absl::StatusOr<std::vector<size_t>> readv(const std::vector<geds::ReadRange> &ranges) override;
 };
 
 #endif
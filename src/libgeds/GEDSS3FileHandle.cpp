@@ -124,8 +124,13 @@ absl::StatusOr<size_t> GEDSS3FileHandle::downloadRange(std::shared_ptr<GEDSFileH
   return *count;
 }
 
-absl::Status GEDSS3FileHandle::seal() {
-  auto lock = lockFile();
+absl::StatusOr<GEDSPendingSeal> GEDSS3FileHandle::prepareSeal() {
+  auto fileLock = std::unique_lock(_fileMutex);
   auto ioLock = lockExclusive();
-  return _gedsService->seal(*this, false, _size, location);
+  GEDSPendingSeal pending{geds::Object{geds::ObjectID{bucket, key},
+                                       geds::ObjectInfo{location, _size, _size, _metadata}},
+                          false, []() {}, {}, {}};
+  pending.fileLocks.push_back(std::move(fileLock));
+  pending.ioLocks.push_back(std::move(ioLock));
+  return pending;
 }
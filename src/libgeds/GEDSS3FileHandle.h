@@ -49,7 +49,7 @@ public:
                                        size_t srcPosition, size_t length,
                                        size_t destPosition) override;
 
-  absl::Status seal() override;
+  absl::StatusOr<GEDSPendingSeal> prepareSeal() override;
 };
 
 #endif
@@ -0,0 +1,380 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "IoUringSender.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#if HAVE_IO_URING
+#include <liburing.h>
+#else
+struct io_uring {};
+struct io_uring_sqe {};
+#endif
+
+#include "Logging.h"
+
+namespace geds {
+
+static constexpr size_t IO_URING_PIPE_SIZE = 1024 * 1024;
+static constexpr size_t IO_URING_MAX_PIPES = 64;
+
+struct IoUringSender::Transfer {
+  enum class State { FileToPipe, PipeToSocket, PollSocket };
+
+  int socketFd;
+  int fileFd;
+  uint64_t offset;
+  size_t remaining;
+  Callback callback;
+
+  State state = State::FileToPipe;
+  Pipe pipe;
+  size_t inPipe = 0;
+  size_t sent = 0;
+};
+
+IoUringSender::IoUringSender(std::unique_ptr<io_uring> ring, unsigned int queueDepth, int eventFd)
+    : _ring(std::move(ring)), _queueDepth(queueDepth), _eventFd(eventFd) {
+  _thread = std::thread([this] { run(); });
+}
+
+IoUringSender::~IoUringSender() { stop(); }
+
+#if HAVE_IO_URING
+
+absl::StatusOr<std::shared_ptr<IoUringSender>> IoUringSender::factory(unsigned int queueDepth) {
+  if (queueDepth < 2) {
+    return absl::InvalidArgumentError("The io_uring queue depth needs to be at least 2.");
+  }
+  auto ring = std::make_unique<io_uring>();
+  auto e = io_uring_queue_init(queueDepth, ring.get(), 0);
+  if (e < 0) {
+    return absl::UnavailableError("Unable to initialize io_uring: " + std::string{strerror(-e)});
+  }
+
+  auto probe = io_uring_get_probe_ring(ring.get());
+  bool hasSplice = probe != nullptr && io_uring_opcode_supported(probe, IORING_OP_SPLICE) &&
+                   io_uring_opcode_supported(probe, IORING_OP_POLL_ADD) &&
+                   io_uring_opcode_supported(probe, IORING_OP_ASYNC_CANCEL);
+  if (probe != nullptr) {
+    io_uring_free_probe(probe);
+  }
+  if (!hasSplice) {
+    io_uring_queue_exit(ring.get());
+    return absl::UnavailableError("The kernel does not support splice on io_uring.");
+  }
+
+  int eventFd = ::eventfd(0, EFD_CLOEXEC);
+  if (eventFd < 0) {
+    int err = errno;
+    io_uring_queue_exit(ring.get());
+    return absl::UnavailableError("Unable to create eventfd: " + std::string{strerror(err)});
+  }
+  return std::shared_ptr<IoUringSender>(new IoUringSender(std::move(ring), queueDepth, eventFd));
+}
+
+void IoUringSender::sendfile(int socketFd, int fileFd, uint64_t offset, size_t length,
+                             Callback &&callback) {
+  auto transfer = std::make_unique<Transfer>();
+  transfer->socketFd = socketFd;
+  transfer->fileFd = fileFd;
+  transfer->offset = offset;
+  transfer->remaining = length;
+  transfer->callback = std::move(callback);
+  {
+    auto lock = std::lock_guard(_mutex);
+    if (_running) {
+      _pending.emplace_back(std::move(transfer));
+    }
+  }
+  if (transfer) {
+    transfer->callback(absl::CancelledError("The io_uring sender has been stopped."));
+    return;
+  }
+  uint64_t one = 1;
+  [[maybe_unused]] auto e = ::write(_eventFd, &one, sizeof(one));
+}
+
+void IoUringSender::stop() {
+  {
+    auto lock = std::lock_guard(_mutex);
+    if (!_running) {
+      return;
+    }
+    _running = false;
+  }
+  uint64_t one = 1;
+  [[maybe_unused]] auto e = ::write(_eventFd, &one, sizeof(one));
+  _thread.join();
+
+  for (auto &pipe : _pipes) {
+    releasePipe(pipe, false);
+  }
+  _pipes.clear();
+  io_uring_queue_exit(_ring.get());
+  ::close(_eventFd);
+}
+
+io_uring_sqe *IoUringSender::nextSqe() {
+  auto sqe = io_uring_get_sqe(_ring.get());
+  while (sqe == nullptr) {
+    // The submission queue is full: Flush it to the kernel.
+    io_uring_submit(_ring.get());
+    sqe = io_uring_get_sqe(_ring.get());
+  }
+  return sqe;
+}
+
+void IoUringSender::armEventFd() {
+  auto sqe = nextSqe();
+  io_uring_prep_read(sqe, _eventFd, &_eventBuffer, sizeof(_eventBuffer), 0);
+  io_uring_sqe_set_data(sqe, nullptr);
+}
+
+void IoUringSender::submitFileToPipe(Transfer &transfer) {
+  transfer.state = Transfer::State::FileToPipe;
+  auto length = std::min(transfer.remaining, transfer.pipe.capacity);
+  auto sqe = nextSqe();
+  io_uring_prep_splice(sqe, transfer.fileFd, static_cast<int64_t>(transfer.offset),
+                       transfer.pipe.writeFd, -1, length, SPLICE_F_MOVE);
+  io_uring_sqe_set_data(sqe, &transfer);
+}
+
+void IoUringSender::submitPipeToSocket(Transfer &transfer) {
+  transfer.state = Transfer::State::PipeToSocket;
+  auto sqe = nextSqe();
+  io_uring_prep_splice(sqe, transfer.pipe.readFd, -1, transfer.socketFd, -1, transfer.inPipe,
+                       SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  io_uring_sqe_set_data(sqe, &transfer);
+}
+
+void IoUringSender::submitPollSocket(Transfer &transfer) {
+  transfer.state = Transfer::State::PollSocket;
+  auto sqe = nextSqe();
+  io_uring_prep_poll_add(sqe, transfer.socketFd, POLLOUT);
+  io_uring_sqe_set_data(sqe, &transfer);
+}
+
+void IoUringSender::handleCompletion(Transfer &transfer, int result) {
+  if (result == -EINTR) {
+    // Retry the interrupted operation.
+    switch (transfer.state) {
+    case Transfer::State::FileToPipe:
+      return submitFileToPipe(transfer);
+    case Transfer::State::PipeToSocket:
+      return submitPipeToSocket(transfer);
+    case Transfer::State::PollSocket:
+      return submitPollSocket(transfer);
+    }
+  }
+  switch (transfer.state) {
+  case Transfer::State::FileToPipe:
+    if (result == -EAGAIN) {
+      submitFileToPipe(transfer);
+    } else if (result < 0) {
+      finish(transfer,
+             absl::UnknownError("Unable to splice file: " + std::string{strerror(-result)}));
+    } else if (result == 0) {
+      // The file is shorter than expected.
+      finish(transfer, transfer.sent);
+    } else {
+      transfer.offset += result;
+      transfer.inPipe = result;
+      submitPipeToSocket(transfer);
+    }
+    return;
+  case Transfer::State::PipeToSocket:
+    if (result == -EAGAIN) {
+      submitPollSocket(transfer);
+    } else if (result <= 0) {
+      auto message = result == 0 ? std::string{"Connection closed"} : strerror(-result);
+      finish(transfer, absl::UnavailableError("Unable to splice to socket: " + message));
+    } else {
+      transfer.inPipe -= result;
+      transfer.sent += result;
+      transfer.remaining -= result;
+      if (transfer.inPipe > 0) {
+        submitPipeToSocket(transfer);
+      } else if (transfer.remaining > 0) {
+        submitFileToPipe(transfer);
+      } else {
+        finish(transfer, transfer.sent);
+      }
+    }
+    return;
+  case Transfer::State::PollSocket:
+    if (result < 0 && result != -EAGAIN) {
+      finish(transfer, absl::UnavailableError("Unable to poll socket: " +
+                                              std::string{strerror(-result)}));
+    } else {
+      // Errors on the socket are reported by the next splice.
+      submitPipeToSocket(transfer);
+    }
+    return;
+  }
+}
+
+void IoUringSender::finish(Transfer &transfer, absl::StatusOr<size_t> result) {
+  auto it = _active.find(&transfer);
+  auto owned = std::move(it->second);
+  _active.erase(it);
+  releasePipe(owned->pipe, owned->inPipe == 0);
+  *_statisticsActiveTransfers = _active.size();
+  owned->callback(std::move(result));
+}
+
+absl::StatusOr<IoUringSender::Pipe> IoUringSender::acquirePipe() {
+  if (!_pipes.empty()) {
+    auto pipe = _pipes.back();
+    _pipes.pop_back();
+    return pipe;
+  }
+  int fds[2];
+  if (::pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+    int err = errno;
+    return absl::UnavailableError("Unable to create pipe: " + std::string{strerror(err)});
+  }
+  Pipe pipe{fds[0], fds[1], 0};
+  // Larger pipes reduce the number of round trips per transfer. Keep the default size if the
+  // limit in /proc/sys/fs/pipe-max-size is lower.
+  auto capacity = ::fcntl(pipe.writeFd, F_SETPIPE_SZ, IO_URING_PIPE_SIZE);
+  if (capacity < 0) {
+    capacity = ::fcntl(pipe.writeFd, F_GETPIPE_SZ);
+  }
+  pipe.capacity = capacity > 0 ? capacity : 4096;
+  return pipe;
+}
+
+void IoUringSender::releasePipe(Pipe pipe, bool reusable) {
+  if (pipe.readFd < 0) {
+    return;
+  }
+  if (reusable && _pipes.size() < IO_URING_MAX_PIPES) {
+    _pipes.push_back(pipe);
+    return;
+  }
+  ::close(pipe.readFd);
+  ::close(pipe.writeFd);
+}
+
+void IoUringSender::run() {
+  armEventFd();
+  bool eventFdArmed = true;
+  while (_running) {
+    {
+      // Start pending transfers. Each transfer has at most one operation in flight, and one slot
+      // is reserved for the eventfd.
+      auto lock = std::lock_guard(_mutex);
+      while (!_pending.empty() && _active.size() + 1 < _queueDepth) {
+        auto transfer = std::move(_pending.front());
+        _pending.pop_front();
+        auto pipe = acquirePipe();
+        if (!pipe.ok()) {
+          LOG_ERROR(pipe.status().message());
+          transfer->callback(pipe.status());
+          continue;
+        }
+        transfer->pipe = *pipe;
+        auto ptr = transfer.get();
+        _active.emplace(ptr, std::move(transfer));
+        submitFileToPipe(*ptr);
+      }
+    }
+    *_statisticsActiveTransfers = _active.size();
+    if (!eventFdArmed) {
+      armEventFd();
+      eventFdArmed = true;
+    }
+
+    // Entries prepared since the last submission.
+    *_statisticsSubmissionQueueDepth = io_uring_sq_ready(_ring.get());
+    auto e = io_uring_submit_and_wait(_ring.get(), 1);
+    if (e < 0 && e != -EINTR) {
+      LOG_ERROR("Unable to submit to io_uring: ", strerror(-e));
+    }
+
+    *_statisticsCompletionQueueDepth = io_uring_cq_ready(_ring.get());
+    io_uring_cqe *cqe;
+    unsigned int head;
+    unsigned int count = 0;
+    io_uring_for_each_cqe(_ring.get(), head, cqe) {
+      count++;
+      auto transfer = static_cast<Transfer *>(io_uring_cqe_get_data(cqe));
+      if (transfer == nullptr) {
+        eventFdArmed = false;
+        continue;
+      }
+      handleCompletion(*transfer, cqe->res);
+    }
+    io_uring_cq_advance(_ring.get(), count);
+  }
+  cancelAll();
+}
+
+void IoUringSender::cancelAll() {
+  std::deque<std::unique_ptr<Transfer>> pending;
+  {
+    auto lock = std::lock_guard(_mutex);
+    pending.swap(_pending);
+  }
+  for (auto &transfer : pending) {
+    transfer->callback(absl::CancelledError("The io_uring sender has been stopped."));
+  }
+
+  // Cancel all outstanding operations and wait until the kernel released the file descriptors.
+  for (auto &[ptr, _] : _active) {
+    auto sqe = nextSqe();
+    io_uring_prep_cancel(sqe, ptr, 0);
+    io_uring_sqe_set_data(sqe, this);
+  }
+  io_uring_submit(_ring.get());
+  while (!_active.empty()) {
+    io_uring_cqe *cqe;
+    auto e = io_uring_wait_cqe(_ring.get(), &cqe);
+    if (e < 0) {
+      if (e == -EINTR) {
+        continue;
+      }
+      LOG_ERROR("Unable to wait for io_uring: ", strerror(-e));
+      break;
+    }
+    auto data = io_uring_cqe_get_data(cqe);
+    io_uring_cqe_seen(_ring.get(), cqe);
+    if (data == nullptr || data == this) {
+      continue;
+    }
+    auto transfer = static_cast<Transfer *>(data);
+    finish(*transfer, absl::CancelledError("The io_uring sender has been stopped."));
+  }
+  // Transfers which could not be reaped.
+  while (!_active.empty()) {
+    finish(*_active.begin()->first, absl::CancelledError("The io_uring sender has been stopped."));
+  }
+}
+
+#else
+
+absl::StatusOr<std::shared_ptr<IoUringSender>> IoUringSender::factory(unsigned int) {
+  return absl::UnimplementedError("GEDS has been built without io_uring support.");
+}
+
+void IoUringSender::sendfile(int, int, uint64_t, size_t, Callback &&callback) {
+  callback(absl::UnimplementedError("GEDS has been built without io_uring support."));
+}
+
+void IoUringSender::stop() {}
+
+void IoUringSender::run() {}
+
+#endif
+
+} // namespace geds
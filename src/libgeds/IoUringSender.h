@@ -0,0 +1,119 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <absl/status/status.h>
+#include <absl/status/statusor.h>
+
+#include "Statistics.h"
+#include "StatisticsGauge.h"
+
+struct io_uring;
+struct io_uring_sqe;
+
+namespace geds {
+
+constexpr unsigned int IO_URING_QUEUE_DEPTH = 256;
+
+/**
+ * @brief Sends file ranges to sockets using io_uring.
+ *
+ * Transfers of all connections share a single ring. A dedicated thread collects new transfers
+ * and submits them in one batch together with the follow-up operations of running transfers.
+ * Each transfer splices the file into a pipe and the pipe into the socket. If the socket is
+ * not writable the transfer polls the socket on the ring before continuing.
+ *
+ * Only available if GEDS is built with liburing and the kernel supports `IORING_OP_SPLICE`.
+ */
+class IoUringSender {
+public:
+  /**
+   * @brief Invoked on the ring thread with the number of bytes sent. Fewer bytes than requested
+   * indicate that the file ended early.
+   */
+  using Callback = std::function<void(absl::StatusOr<size_t>)>;
+
+private:
+  struct Pipe {
+    int readFd = -1;
+    int writeFd = -1;
+    size_t capacity = 0;
+  };
+
+  struct Transfer;
+
+  std::unique_ptr<io_uring> _ring;
+  const unsigned int _queueDepth;
+  int _eventFd = -1;
+  uint64_t _eventBuffer = 0;
+
+  std::thread _thread;
+  std::atomic<bool> _running = true;
+
+  std::mutex _mutex;
+  std::deque<std::unique_ptr<Transfer>> _pending;
+
+  // Only accessed from the ring thread.
+  std::vector<Pipe> _pipes;
+  std::unordered_map<Transfer *, std::unique_ptr<Transfer>> _active;
+
+  std::shared_ptr<StatisticsGauge> _statisticsActiveTransfers =
+      Statistics::createGauge("GEDS: io_uring active transfers");
+  std::shared_ptr<StatisticsGauge> _statisticsSubmissionQueueDepth =
+      Statistics::createGauge("GEDS: io_uring submission queue depth");
+  std::shared_ptr<StatisticsGauge> _statisticsCompletionQueueDepth =
+      Statistics::createGauge("GEDS: io_uring completion queue depth");
+
+  IoUringSender(std::unique_ptr<io_uring> ring, unsigned int queueDepth, int eventFd);
+
+  void run();
+  void armEventFd();
+  void submitFileToPipe(Transfer &transfer);
+  void submitPipeToSocket(Transfer &transfer);
+  void submitPollSocket(Transfer &transfer);
+  void handleCompletion(Transfer &transfer, int result);
+  void finish(Transfer &transfer, absl::StatusOr<size_t> result);
+  void cancelAll();
+  io_uring_sqe *nextSqe();
+
+  absl::StatusOr<Pipe> acquirePipe();
+  void releasePipe(Pipe pipe, bool reusable);
+
+public:
+  /**
+   * @brief Creates the sender. Fails if io_uring is not available on this system.
+   */
+  [[nodiscard]] static absl::StatusOr<std::shared_ptr<IoUringSender>>
+  factory(unsigned int queueDepth = IO_URING_QUEUE_DEPTH);
+
+  IoUringSender(const IoUringSender &) = delete;
+  IoUringSender &operator=(const IoUringSender &) = delete;
+  ~IoUringSender();
+
+  /**
+   * @brief Send `length` bytes at `offset` of `fileFd` to `socketFd`. Both descriptors need to
+   * remain valid until `callback` has been invoked.
+   */
+  void sendfile(int socketFd, int fileFd, uint64_t offset, size_t length, Callback &&callback);
+
+  /**
+   * @brief Cancel all outstanding transfers and stop the ring thread.
+   */
+  void stop();
+};
+
+} // namespace geds
@@ -15,6 +15,7 @@
 #include <ios>
 #include <stdexcept>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <vector>
 
@@ -147,6 +148,81 @@ absl::StatusOr<size_t> LocalFile::readBytes(uint8_t *bytes, size_t position, siz
   return offset;
 }
 
+absl::StatusOr<std::vector<size_t>> LocalFile::readv(const std::vector<geds::ReadRange> &ranges) {
+  CHECK_FILE_OPEN
+
+  size_t fileSize = _size;
+  std::vector<size_t> result(ranges.size(), 0);
+  std::vector<struct iovec> iov;
+  iov.reserve(std::min<size_t>(ranges.size(), IOV_MAX));
+
+  // Ranges which are adjacent in the file are read with a single preadv.
+  size_t i = 0;
+  while (i < ranges.size()) {
+    const auto &first = ranges[i];
+    if (first.position >= INT64_MAX) {
+      return absl::FailedPreconditionError("Stream positions > " + std::to_string(INT64_MAX) +
+                                           " are not supported!");
+    }
+    size_t start = first.position;
+    size_t end = start;
+    size_t j = i;
+    iov.clear();
+    while (j < ranges.size() && ranges[j].position == end && iov.size() < IOV_MAX) {
+      size_t length = ranges[j].position >= fileSize
+                          ? 0
+                          : std::min(ranges[j].length, fileSize - ranges[j].position);
+      result[j] = length;
+      if (length > 0) {
+        iov.push_back({ranges[j].buffer, length});
+      }
+      end += ranges[j].length;
+      j++;
+      if (length < ranges[j - 1].length) {
+        // Reached EOF.
+        break;
+      }
+    }
+
+    size_t index = 0;
+    int64_t position = start;
+    while (index < iov.size()) {
+      ssize_t numBytes = 0;
+      do {
+        numBytes = ::preadv64(_fd, &iov[index], std::min<size_t>(iov.size() - index, IOV_MAX),
+                              position);
+      } while (numBytes == -1 && errno == EINTR);
+      if (numBytes < 0) {
+        int err = errno;
+        auto errorMessage = "Error reading " + _path + ": " + strerror(err);
+        LOG_ERROR(errorMessage);
+        return absl::UnknownError(errorMessage);
+      }
+      if (numBytes == 0) {
+        // Unexpected EOF: Truncate the remaining ranges.
+        for (size_t k = i; k < j; k++) {
+          auto begin = ranges[k].position;
+          result[k] = begin >= (size_t)position ? 0 : std::min(result[k], position - begin);
+        }
+        break;
+      }
+      position += numBytes;
+      // Advance the iovec array for partial reads.
+      auto remaining = static_cast<size_t>(numBytes);
+      while (index < iov.size() && remaining >= iov[index].iov_len) {
+        remaining -= iov[index].iov_len;
+        index++;
+      }
+      if (remaining > 0) {
+        iov[index].iov_base = static_cast<uint8_t *>(iov[index].iov_base) + remaining;
+        iov[index].iov_len -= remaining;
+      }
+    }
+    i = j;
+  }
+  return result;
+}
+
 absl::Status LocalFile::truncate(size_t targetSize) {
   CHECK_FILE_OPEN
 
@@ -161,6 +237,18 @@ absl::Status LocalFile::truncate(size_t targetSize) {
   return absl::OkStatus();
 }
 
+absl::Status LocalFile::moveTo(const std::string &path) {
+  CHECK_FILE_OPEN
+
+  auto status = renameFile(_path, path);
+  if (!status.ok()) {
+    return status;
+  }
+  (void)::close(_fd);
+  _fd = -1;
+  return absl::OkStatus();
+}
+
 absl::Status LocalFile::writeBytes(const uint8_t *bytes, size_t position, size_t length) {
   if (position > INT64_MAX) {
     return absl::FailedPreconditionError("Stream positions > " + std::to_string(position) +
@@ -0,0 +1,178 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <absl/status/status.h>
+#include <absl/status/statusor.h>
+
+#include "Statistics.h"
+#include "StatisticsCounter.h"
+
+namespace geds {
+
+/**
+ * @brief Bounded cache of lookup results with expiry.
+ *
+ * Found values expire after `ttl`, cached misses after `negativeTtl`. A zero TTL disables caching
+ * of the respective results. Expired values stay cached until they are evicted, so that they can
+ * be revalidated with `getStale`. The least recently used entry is evicted once `capacity`
+ * entries are cached.
+ */
+template <typename T> class LookupCache {
+public:
+  using Clock = std::chrono::steady_clock;
+
+private:
+  struct Entry {
+    std::string key;
+    std::optional<T> value;
+    Clock::time_point expiry;
+  };
+
+  mutable std::mutex _mutex;
+  // Most recently used entries first.
+  std::list<Entry> _entries;
+  using Index = std::map<std::string, typename std::list<Entry>::iterator>;
+  Index _index;
+
+  size_t _capacity = 0;
+  Clock::duration _ttl = Clock::duration::zero();
+  Clock::duration _negativeTtl = Clock::duration::zero();
+
+  std::shared_ptr<StatisticsCounter> _statisticsHits;
+  std::shared_ptr<StatisticsCounter> _statisticsNegativeHits;
+  std::shared_ptr<StatisticsCounter> _statisticsMisses;
+
+  void eraseLocked(typename Index::iterator it) {
+    _entries.erase(it->second);
+    _index.erase(it);
+  }
+
+  void insert(const std::string &key, std::optional<T> value, Clock::duration ttl) {
+    auto lock = std::lock_guard(_mutex);
+    if (_capacity == 0 || ttl == Clock::duration::zero()) {
+      return;
+    }
+    auto it = _index.find(key);
+    if (it != _index.end()) {
+      eraseLocked(it);
+    }
+    while (_entries.size() >= _capacity) {
+      _index.erase(_entries.back().key);
+      _entries.pop_back();
+    }
+    _entries.push_front(Entry{key, std::move(value), Clock::now() + ttl});
+    _index.emplace(key, _entries.begin());
+  }
+
+public:
+  /**
+   * @brief The counters are labelled `<name> hits`, `<name> negative hits` and `<name> misses`.
+   */
+  explicit LookupCache(const std::string &name)
+      : _statisticsHits(geds::Statistics::createCounter(name + " hits")),
+        _statisticsNegativeHits(geds::Statistics::createCounter(name + " negative hits")),
+        _statisticsMisses(geds::Statistics::createCounter(name + " misses")) {}
+
+  /**
+   * @brief Set the bounds of the cache. Drops all entries.
+   */
+  void configure(size_t capacity, std::chrono::milliseconds ttl,
+                 std::chrono::milliseconds negativeTtl) {
+    auto lock = std::lock_guard(_mutex);
+    _entries.clear();
+    _index.clear();
+    _capacity = capacity;
+    _ttl = ttl;
+    _negativeTtl = negativeTtl;
+  }
+
+  /**
+   * @brief Returns the cached value, a NotFound status for a cached miss or std::nullopt if
+   * nothing valid is cached.
+   */
+  std::optional<absl::StatusOr<T>> get(const std::string &key) {
+    auto lock = std::lock_guard(_mutex);
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+      *_statisticsMisses += 1;
+      return std::nullopt;
+    }
+    if (it->second->expiry <= Clock::now()) {
+      if (!it->second->value.has_value()) {
+        eraseLocked(it);
+      }
+      *_statisticsMisses += 1;
+      return std::nullopt;
+    }
+    _entries.splice(_entries.begin(), _entries, it->second);
+    if (!it->second->value.has_value()) {
+      *_statisticsNegativeHits += 1;
+      return absl::NotFoundError("Key " + key + " not found (cached).");
+    }
+    *_statisticsHits += 1;
+    return *it->second->value;
+  }
+
+  /**
+   * @brief Returns the cached value even if it expired. Does not count as a hit or miss.
+   */
+  std::optional<T> getStale(const std::string &key) const {
+    auto lock = std::lock_guard(_mutex);
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+      return std::nullopt;
+    }
+    return it->second->value;
+  }
+
+  void put(const std::string &key, T value) { insert(key, std::move(value), _ttl); }
+
+  /**
+   * @brief Remember that `key` does not exist.
+   */
+  void putMissing(const std::string &key) { insert(key, std::nullopt, _negativeTtl); }
+
+  void erase(const std::string &key) {
+    auto lock = std::lock_guard(_mutex);
+    auto it = _index.find(key);
+    if (it != _index.end()) {
+      eraseLocked(it);
+    }
+  }
+
+  void erasePrefix(const std::string &prefix) {
+    auto lock = std::lock_guard(_mutex);
+    auto it = _index.lower_bound(prefix);
+    while (it != _index.end() && it->first.starts_with(prefix)) {
+      _entries.erase(it->second);
+      it = _index.erase(it);
+    }
+  }
+
+  void clear() {
+    auto lock = std::lock_guard(_mutex);
+    _entries.clear();
+    _index.clear();
+  }
+
+  size_t size() const {
+    auto lock = std::lock_guard(_mutex);
+    return _entries.size();
+  }
+};
+
+} // namespace geds
@@ -13,6 +13,7 @@
 #include <optional>
 #include <string>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include "Filesystem.h"
@@ -41,6 +42,16 @@ MMAPFile::MMAPFile(std::string pathArg, bool overwrite) : _path(std::move(pathAr
     LOG_ERROR(message);
     throw std::runtime_error{message};
   }
+  if (!overwrite) {
+    struct stat statBuf {};
+    if (fstat(_fd, &statBuf) != 0) {
+      int error = errno;
+      auto message = "Fstat on " + _path + " reported: " + strerror(error);
+      LOG_ERROR(message);
+      throw std::runtime_error{message};
+    }
+    _size = statBuf.st_size;
+  }
 }
 
 MMAPFile::~MMAPFile() {
@@ -140,6 +151,27 @@ absl::StatusOr<int> MMAPFile::rawFd() const {
   return _fd;
 }
 
+absl::StatusOr<std::vector<size_t>> MMAPFile::readv(const std::vector<geds::ReadRange> &ranges) {
+  // Reopen the file if it has been unmapped.
+  auto status = reopen();
+  if (!status.ok()) {
+    return status;
+  }
+
+  std::vector<size_t> result(ranges.size(), 0);
+  auto lock = getReadLock();
+  for (size_t i = 0; i < ranges.size(); i++) {
+    const auto &range = ranges[i];
+    if (range.position >= _size || range.length == 0) {
+      continue;
+    }
+    auto n = std::min(range.length, _size - range.position);
+    (void)std::memcpy(range.buffer, _mmapPtr + range.position, n);
+    result[i] = n;
+  }
+  return result;
+}
+
 absl::Status MMAPFile::truncate(size_t targetSize) {
   auto lock = getWriteLock();
   if (targetSize > _size) {
@@ -152,6 +184,25 @@ absl::Status MMAPFile::truncate(size_t targetSize) {
   return absl::OkStatus();
 }
 
+absl::Status MMAPFile::moveTo(const std::string &path) {
+  auto lock = getWriteLock();
+  CHECK_FILE_OPEN
+
+  release();
+  // The mapping extends the file to whole pages: Reopening determines the size from the file.
+  if (ftruncate64(_fd, _size) != 0) {
+    int err = errno;
+    return absl::UnknownError("Unable to ftruncate file " + _path + ": " + strerror(err));
+  }
+  auto status = renameFile(_path, path);
+  if (!status.ok()) {
+    return status;
+  }
+  (void)::close(_fd);
+  _fd = -1;
+  return absl::OkStatus();
+}
+
 absl::Status MMAPFile::writeBytes(const uint8_t *bytes, size_t position, size_t length) {
   if (length == 0) {
     // Length is 0, return.
@@ -18,6 +18,7 @@
 #include <absl/status/status.h>
 #include <absl/status/statusor.h>
 
+#include "GEDSInternal.h"
 #include "RWConcurrentObjectAdaptor.h"
 
 namespace geds::filesystem {
@@ -62,8 +63,16 @@ public:
 
   absl::StatusOr<size_t> readBytes(uint8_t *bytes, size_t position, size_t length);
 
+  absl::StatusOr<std::vector<size_t>> readv(const std::vector<geds::ReadRange> &ranges);
+
   absl::Status truncate(size_t targetSize);
 
+  /**
+   * @brief Rename the file to `path` and close it without deleting it. The file is reopened at
+   * `path` with `overwrite = false`.
+   */
+  absl::Status moveTo(const std::string &path);
+
   absl::Status writeBytes(const uint8_t *bytes, size_t position, size_t length);
   absl::StatusOr<size_t> write(std::istream &stream, size_t position,
                                std::optional<size_t> length = std::nullopt);
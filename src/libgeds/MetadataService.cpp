@@ -12,7 +12,9 @@
 #include <grpcpp/client_context.h>
 #include <grpcpp/support/status.h>
 #include <grpcpp/support/status_code_enum.h>
+#include <algorithm>
 #include <optional>
+#include <thread>
 
 #include "GEDS.h"
 #include "Logging.h"
@@ -31,14 +33,65 @@ static std::string printGRPCError(const grpc::Status &status) {
   return {"Code: " + std::to_string(status.error_code())};
 }
 
+static std::string cacheKey(const std::string &bucket, const std::string &key) {
+  return bucket + "/" + key;
+}
+
+static void convert(const geds::Object &obj, geds::rpc::Object *r) {
+  auto id = r->mutable_id();
+  id->set_bucket(obj.id.bucket);
+  id->set_key(obj.id.key);
+  auto info = r->mutable_info();
+  info->set_location(obj.info.location);
+  info->set_size(obj.info.size);
+  info->set_sealedoffset(obj.info.sealedOffset);
+  if (obj.info.metadata.has_value()) {
+    info->set_metadata(obj.info.metadata.value());
+  }
+}
+
+static geds::Object convert(const geds::rpc::Object &r) {
+  return geds::Object{
+      geds::ObjectID{r.id().bucket(), r.id().key()},
+      geds::ObjectInfo{
+          r.info().location(), r.info().size(), r.info().sealedoffset(),
+          (r.info().has_metadata() ? std::make_optional(r.info().metadata()) : std::nullopt),
+          r.info().version()}};
+}
+
+namespace {
+/**
+ * @brief Indices of the items of a batch that belong to one shard.
+ */
+struct ShardGroup {
+  size_t shard;
+  std::vector<size_t> indices;
+};
+
+template <typename F>
+std::vector<ShardGroup> groupByShard(const utility::ShardRing &ring, size_t count, F &&bucketOf) {
+  std::vector<ShardGroup> groups;
+  std::vector<size_t> groupOfShard(ring.size(), SIZE_MAX);
+  for (size_t i = 0; i < count; i++) {
+    auto shard = ring.shardOf(bucketOf(i));
+    if (groupOfShard[shard] == SIZE_MAX) {
+      groupOfShard[shard] = groups.size();
+      groups.push_back(ShardGroup{shard, {}});
+    }
+    groups[groupOfShard[shard]].indices.push_back(i);
+  }
+  return groups;
+}
+} // namespace
+
 #define METADATASERVICE_CHECK_CONNECTED                                                            \
   if (_connectionState != ConnectionState::Connected) {                                            \
     return absl::FailedPreconditionError("Not connected.");                                        \
   }
 
 MetadataService::MetadataService(std::string serverAddress)
-    : _connectionState(ConnectionState::Disconnected), _channel(nullptr),
-      serverAddress(std::move(serverAddress)) {
+    : _connectionState(ConnectionState::Disconnected),
+      _ring(utility::ShardRing::parse(serverAddress)), serverAddress(std::move(serverAddress)) {
   boost::uuids::uuid uuid_generated = boost::uuids::random_generator()();
   uuid = boost::lexical_cast<std::string>(uuid_generated);
 }
@@ -53,24 +106,31 @@ absl::Status MetadataService::connect() {
   if (_connectionState != ConnectionState::Disconnected) {
     return absl::UnknownError("Cannot reinitialize service.");
   }
-  try {
-    assert(_channel.get() == nullptr);
-
-    auto arguments = grpc::ChannelArguments();
-    arguments.SetMaxReceiveMessageSize(64 * 1024 * 1024);
-
-    _channel =
-        grpc::CreateCustomChannel(serverAddress, grpc::InsecureChannelCredentials(), arguments);
-    auto success = _channel->WaitForConnected(grpcDefaultDeadline());
-    if (!success) {
-      LOG_ERROR("Unable to connect to ", serverAddress);
-      return absl::UnavailableError("Could not connect to " + serverAddress + ".");
+  if (_ring.size() == 0) {
+    return absl::InvalidArgumentError("No metadata server address.");
+  }
+  _shards.clear();
+  for (const auto &address : _ring.shards()) {
+    try {
+      auto arguments = grpc::ChannelArguments();
+      arguments.SetMaxReceiveMessageSize(64 * 1024 * 1024);
+
+      auto channel =
+          grpc::CreateCustomChannel(address, grpc::InsecureChannelCredentials(), arguments);
+      auto success = channel->WaitForConnected(grpcDefaultDeadline());
+      if (!success) {
+        LOG_ERROR("Unable to connect to ", address);
+        _shards.clear();
+        return absl::UnavailableError("Could not connect to " + address + ".");
+      }
+      auto stub = geds::rpc::MetadataService::NewStub(channel);
+      _shards.push_back(Shard{std::move(channel), std::move(stub)});
+    } catch (std::exception &e) {
+      auto msg = "Could not open channel with " + address + ". Reason" + std::string(e.what());
+      LOG_ERROR(msg);
+      _shards.clear();
+      return absl::UnavailableError(msg);
     }
-    _stub = geds::rpc::MetadataService::NewStub(_channel);
-  } catch (std::exception &e) {
-    auto msg = "Could not open channel with " + serverAddress + ". Reason" + std::string(e.what());
-    LOG_ERROR(msg);
-    return absl::UnavailableError(msg);
   }
   _connectionState = ConnectionState::Connected;
   // ToDO: Register client and implement stop().
@@ -82,7 +142,9 @@ absl::Status MetadataService::disconnect() {
   if (_connectionState != ConnectionState::Connected) {
     return absl::UnknownError("The service is in the wrong state.");
   }
-  _channel = nullptr;
+  for (auto &shard : _shards) {
+    shard.channel = nullptr;
+  }
   _connectionState = ConnectionState::Disconnected;
   return absl::OkStatus();
 }
@@ -99,7 +161,7 @@ absl::Status MetadataService::registerObjectStoreConfig(const ObjectStoreConfig
   request.set_accesskey(mapping.accessKey);
   request.set_secretkey(mapping.secretKey);
 
-  auto status = _stub->RegisterObjectStore(&context, request, &response);
+  auto status = stub(mapping.bucket).RegisterObjectStore(&context, request, &response);
   if (!status.ok()) {
     return absl::UnavailableError("Unable to execute RegisterObjectStore: " +
                                   status.error_message());
@@ -111,18 +173,20 @@ absl::StatusOr<std::vector<std::shared_ptr<ObjectStoreConfig>>>
 MetadataService::listObjectStoreConfigs() {
   METADATASERVICE_CHECK_CONNECTED;
 
-  geds::rpc::EmptyParams request;
-  geds::rpc::AvailableObjectStoreConfigs response;
-  grpc::ClientContext context;
-  auto status = _stub->ListObjectStores(&context, request, &response);
-  if (!status.ok()) {
-    return absl::UnavailableError("Unable to execute ListObjectStores: " + status.error_message());
-  }
-  auto mappings = response.mappings();
   std::vector<std::shared_ptr<ObjectStoreConfig>> result;
-  for (auto &m : mappings) {
-    result.emplace_back(std::make_shared<ObjectStoreConfig>(m.bucket(), m.endpointurl(),
-                                                            m.accesskey(), m.secretkey()));
+  for (auto &shard : _shards) {
+    geds::rpc::EmptyParams request;
+    geds::rpc::AvailableObjectStoreConfigs response;
+    grpc::ClientContext context;
+    auto status = shard.stub->ListObjectStores(&context, request, &response);
+    if (!status.ok()) {
+      return absl::UnavailableError("Unable to execute ListObjectStores: " +
+                                    status.error_message());
+    }
+    for (auto &m : response.mappings()) {
+      result.emplace_back(std::make_shared<ObjectStoreConfig>(m.bucket(), m.endpointurl(),
+                                                              m.accesskey(), m.secretkey()));
+    }
   }
   return result;
 }
@@ -132,7 +196,7 @@ absl::StatusOr<std::string> MetadataService::getConnectionInformation() {
   geds::rpc::EmptyParams request;
   geds::rpc::ConnectionInformation response;
   grpc::ClientContext context;
-  auto status = _stub->GetConnectionInformation(&context, request, &response);
+  auto status = _shards.front().stub->GetConnectionInformation(&context, request, &response);
   if (!status.ok()) {
     return absl::UnavailableError("Unable to execute GetConnectionInformation: " +
                                   status.error_message());
@@ -151,7 +215,7 @@ absl::Status MetadataService::createBucket(const std::string_view &bucket) {
   geds::rpc::StatusResponse response;
   grpc::ClientContext context;
 
-  auto status = _stub->CreateBucket(&context, request, &response);
+  auto status = stub(request.bucket()).CreateBucket(&context, request, &response);
   if (!status.ok()) {
     return absl::UnavailableError("Unable to execute CreateBucket command: " +
                                   status.error_message());
@@ -167,7 +231,8 @@ absl::Status MetadataService::deleteBucket(const std::string_view &bucket) {
   geds::rpc::StatusResponse response;
   grpc::ClientContext context;
 
-  auto status = _stub->DeleteBucket(&context, request, &response);
+  auto status = stub(request.bucket()).DeleteBucket(&context, request, &response);
+  _lookupCache.erasePrefix(std::string{bucket} + "/");
   if (!status.ok()) {
     return absl::UnavailableError("Unable to execute DeleteBucket command: " +
                                   status.error_message());
@@ -177,25 +242,29 @@ absl::Status MetadataService::deleteBucket(const std::string_view &bucket) {
 
 absl::StatusOr<std::vector<std::string>> MetadataService::listBuckets() {
   METADATASERVICE_CHECK_CONNECTED;
-  geds::rpc::EmptyParams request;
+  std::vector<std::string> result;
+  for (auto &shard : _shards) {
+    geds::rpc::EmptyParams request;
 
-  geds::rpc::BucketListResponse response;
-  grpc::ClientContext context;
+    geds::rpc::BucketListResponse response;
+    grpc::ClientContext context;
 
-  auto status = _stub->ListBuckets(&context, request, &response);
-  if (!status.ok()) {
-    return absl::UnavailableError("Unable to execute ListBuckets command: " +
-                                  status.error_message());
-  }
-  if (response.has_error()) {
-    return convertStatus(response.error());
+    auto status = shard.stub->ListBuckets(&context, request, &response);
+    if (!status.ok()) {
+      return absl::UnavailableError("Unable to execute ListBuckets command: " +
+                                    status.error_message());
+    }
+    if (response.has_error()) {
+      return convertStatus(response.error());
+    }
+    for (const auto &r : response.results()) {
+      result.emplace_back(r);
+    }
   }
-  const auto &bucketList = response.results();
-
-  std::vector<std::string> result;
-  result.reserve(bucketList.size());
-  for (const auto &r : bucketList) {
-    result.emplace_back(r);
+  if (_shards.size() > 1) {
+    // Every shard creates the default bucket.
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
   }
   return result;
 }
@@ -209,7 +278,7 @@ absl::Status MetadataService::lookupBucket(const std::string_view &bucket) {
   geds::rpc::StatusResponse response;
   grpc::ClientContext context;
 
-  auto status = _stub->LookupBucket(&context, request, &response);
+  auto status = stub(request.bucket()).LookupBucket(&context, request, &response);
   if (!status.ok()) {
     return absl::UnavailableError("Unable to execute LookupBucket command: " +
                                   status.error_message());
@@ -217,6 +286,7 @@ absl::Status MetadataService::lookupBucket(const std::string_view &bucket) {
   auto s = convertStatus(response);
   if (!s.ok()) {
     (void)_mdsCache.deleteBucket(std::string{bucket});
+    _lookupCache.erasePrefix(std::string{bucket} + "/");
   }
   return s;
 }
@@ -239,7 +309,9 @@ absl::Status MetadataService::createObject(const geds::Object &obj) {
   geds::rpc::StatusResponse response;
   grpc::ClientContext context;
 
-  auto status = _stub->Create(&context, request, &response);
+  auto status = stub(obj.id.bucket).Create(&context, request, &response);
+  // Drop cached misses of the object.
+  _lookupCache.erase(cacheKey(obj.id.bucket, obj.id.key));
   if (!status.ok()) {
     return absl::UnavailableError("Unable to execute Create command: " + status.error_message());
   }
@@ -265,7 +337,8 @@ absl::Status MetadataService::updateObject(const geds::Object &obj) {
   geds::rpc::StatusResponse response;
   grpc::ClientContext context;
 
-  auto status = _stub->Update(&context, request, &response);
+  auto status = stub(obj.id.bucket).Update(&context, request, &response);
+  _lookupCache.erase(cacheKey(obj.id.bucket, obj.id.key));
   if (!status.ok()) {
     return absl::UnavailableError("Unable to execute Update command: " + printGRPCError(status));
   }
@@ -289,7 +362,8 @@ absl::Status MetadataService::deleteObject(const std::string &bucket, const std:
   geds::rpc::StatusResponse response;
   grpc::ClientContext context;
 
-  auto status = _stub->Delete(&context, request, &response);
+  auto status = stub(bucket).Delete(&context, request, &response);
+  _lookupCache.erase(cacheKey(bucket, key));
   if (!status.ok()) {
     return absl::UnavailableError("Unable to execute Delete command: " + printGRPCError(status));
   }
@@ -312,13 +386,70 @@ absl::Status MetadataService::deleteObjectPrefix(const std::string &bucket,
   geds::rpc::StatusResponse response;
   grpc::ClientContext context;
 
-  auto status = _stub->DeletePrefix(&context, request, &response);
+  auto status = stub(bucket).DeletePrefix(&context, request, &response);
+  _lookupCache.erasePrefix(cacheKey(bucket, key));
   if (!status.ok()) {
     return absl::UnavailableError("Unable to execute Delete command: " + printGRPCError(status));
   }
   return convertStatus(response);
 }
 
+absl::Status MetadataService::renameObject(const geds::ObjectID &src, const geds::ObjectID &dest) {
+  return rename(src, dest, false);
+}
+
+absl::Status MetadataService::renameObjectPrefix(const geds::ObjectID &src,
+                                                 const geds::ObjectID &dest,
+                                                 const std::vector<std::string> &keys) {
+  return rename(src, dest, true, keys);
+}
+
+absl::Status MetadataService::rename(const geds::ObjectID &src, const geds::ObjectID &dest,
+                                     bool prefix, const std::vector<std::string> &keys) {
+  METADATASERVICE_CHECK_CONNECTED;
+  if (_ring.shardOf(src.bucket) != _ring.shardOf(dest.bucket)) {
+    return absl::UnimplementedError("The buckets " + src.bucket + " and " + dest.bucket +
+                                    " belong to different metadata shards.");
+  }
+
+  for (const auto *id : {&src, &dest}) {
+    if (prefix) {
+      (void)_mdsCache.deleteObjectPrefix(*id);
+    } else {
+      (void)_mdsCache.deleteObject(*id);
+    }
+  }
+
+  geds::rpc::RenameRequest request;
+  request.mutable_source()->set_bucket(src.bucket);
+  request.mutable_source()->set_key(src.key);
+  request.mutable_destination()->set_bucket(dest.bucket);
+  request.mutable_destination()->set_key(dest.key);
+  for (const auto &key : keys) {
+    request.add_keys(key);
+  }
+
+  geds::rpc::StatusResponse response;
+  grpc::ClientContext context;
+
+  auto status = prefix ? stub(src.bucket).RenamePrefix(&context, request, &response)
+                       : stub(src.bucket).Rename(&context, request, &response);
+  for (const auto *id : {&src, &dest}) {
+    if (prefix) {
+      _lookupCache.erasePrefix(cacheKey(id->bucket, id->key));
+    } else {
+      _lookupCache.erase(cacheKey(id->bucket, id->key));
+    }
+  }
+  if (status.error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+    return absl::UnimplementedError("Rename is not supported by the metadata server.");
+  }
+  if (!status.ok()) {
+    return absl::UnavailableError("Unable to execute Rename command: " + printGRPCError(status));
+  }
+  return convertStatus(response);
+}
+
 absl::StatusOr<geds::Object> MetadataService::lookup(const geds::ObjectID &id, bool force) {
   return lookup(id.bucket, id.key, force);
 }
@@ -328,12 +459,34 @@ absl::StatusOr<geds::Object> MetadataService::lookup(const std::string &bucket,
 
   if (!invalidate) {
     LOG_DEBUG("Lookup cache", bucket, "/", key);
+    auto cached = _lookupCache.get(cacheKey(bucket, key));
+    if (cached.has_value()) {
+      return *cached;
+    }
     auto c = _mdsCache.lookup(bucket, key);
     if (c.ok()) {
       return c;
     }
   }
 
+  // Entries which are no longer trusted are revalidated by version instead of being transferred
+  // again.
+  if (_conditionalLookups) {
+    auto cached = _lookupCache.getStale(cacheKey(bucket, key));
+    if (!cached.has_value()) {
+      auto c = _mdsCache.lookup(bucket, key);
+      if (c.ok()) {
+        cached = std::move(*c);
+      }
+    }
+    if (cached.has_value() && cached->info.version != 0) {
+      auto result = lookupIfChanged(*cached);
+      if (result.status().code() != absl::StatusCode::kUnimplemented) {
+        return result;
+      }
+    }
+  }
+
   geds::rpc::ObjectID request;
   request.set_bucket(bucket);
   request.set_key(key);
@@ -343,24 +496,255 @@ absl::StatusOr<geds::Object> MetadataService::lookup(const std::string &bucket,
 
   LOG_DEBUG("Lookup remote", bucket, "/", key);
 
-  auto status = _stub->Lookup(&context, request, &response);
+  auto status = stub(bucket).Lookup(&context, request, &response);
   if (!status.ok()) {
     return absl::UnavailableError("Unable to execute Lookup command: " + printGRPCError(status));
   }
   if (response.has_error()) {
-    return convertStatus(response.error());
+    auto error = convertStatus(response.error());
+    if (error.code() == absl::StatusCode::kNotFound) {
+      _lookupCache.putMissing(cacheKey(bucket, key));
+    }
+    return error;
   }
   const auto &r = response.result();
   auto obj_id = geds::ObjectID{r.id().bucket(), r.id().key()};
   auto obj_info = geds::ObjectInfo{
       r.info().location(), r.info().size(), r.info().sealedoffset(),
-      (r.info().has_metadata() ? std::make_optional(r.info().metadata()) : std::nullopt)};
+      (r.info().has_metadata() ? std::make_optional(r.info().metadata()) : std::nullopt),
+      r.info().version()};
 
   auto result = geds::Object{obj_id, obj_info};
   (void)_mdsCache.createObject(result, true);
+  _lookupCache.put(cacheKey(bucket, key), result);
+  return result;
+}
+
+absl::StatusOr<geds::Object> MetadataService::lookupIfChanged(const geds::Object &cached) {
+  const auto &bucket = cached.id.bucket;
+  const auto &key = cached.id.key;
+
+  geds::rpc::ObjectIDVersion request;
+  request.mutable_id()->set_bucket(bucket);
+  request.mutable_id()->set_key(key);
+  request.set_version(cached.info.version);
+
+  geds::rpc::ObjectResponse response;
+  grpc::ClientContext context;
+
+  LOG_DEBUG("Revalidate ", bucket, "/", key, " (", cached.info.version, ")");
+  auto status = stub(bucket).LookupIfChanged(&context, request, &response);
+  if (status.error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+    _conditionalLookups = false;
+    return absl::UnimplementedError("LookupIfChanged is not supported by the metadata server.");
+  }
+  if (!status.ok()) {
+    return absl::UnavailableError("Unable to execute LookupIfChanged command: " +
+                                  printGRPCError(status));
+  }
+  if (response.has_error()) {
+    auto error = convertStatus(response.error());
+    if (error.code() == absl::StatusCode::kNotFound) {
+      (void)_mdsCache.deleteObject(bucket, key);
+      _lookupCache.putMissing(cacheKey(bucket, key));
+    }
+    return error;
+  }
+  auto result = response.notmodified() ? cached : convert(response.result());
+  if (!response.notmodified()) {
+    (void)_mdsCache.createObject(result, true);
+  }
+  _lookupCache.put(cacheKey(bucket, key), result);
   return result;
 }
 
+absl::StatusOr<bool> MetadataService::isCurrent(const std::string &bucket, const std::string &key,
+                                                uint64_t version) {
+  auto cached = _lookupCache.get(cacheKey(bucket, key));
+  if (cached.has_value()) {
+    if (!cached->ok()) {
+      return cached->status();
+    }
+    return (*cached)->info.version == version;
+  }
+  auto object = lookup(bucket, key, true);
+  if (!object.ok()) {
+    return object.status();
+  }
+  return object->info.version == version;
+}
+
+absl::StatusOr<std::vector<absl::StatusOr<geds::Object>>>
+MetadataService::lookupBatch(const std::vector<geds::ObjectID> &ids, bool invalidate) {
+  METADATASERVICE_CHECK_CONNECTED;
+
+  std::vector<absl::StatusOr<geds::Object>> results(ids.size(),
+                                                    absl::UnknownError("Not looked up."));
+  // Indices of the objects which are not cached.
+  std::vector<size_t> remote;
+  remote.reserve(ids.size());
+  for (size_t i = 0; i < ids.size(); i++) {
+    if (!invalidate) {
+      auto cached = _lookupCache.get(cacheKey(ids[i].bucket, ids[i].key));
+      if (cached.has_value()) {
+        results[i] = std::move(*cached);
+        continue;
+      }
+      auto c = _mdsCache.lookup(ids[i].bucket, ids[i].key);
+      if (c.ok()) {
+        results[i] = std::move(c);
+        continue;
+      }
+    }
+    remote.push_back(i);
+  }
+
+  auto groups = groupByShard(_ring, remote.size(), [&](size_t j) -> const std::string & {
+    return ids[remote[j]].bucket;
+  });
+  for (const auto &group : groups) {
+    const auto &indices = group.indices;
+    for (size_t begin = 0; begin < indices.size(); begin += MaxBatchSize) {
+      auto end = std::min(begin + MaxBatchSize, indices.size());
+      geds::rpc::ObjectIDBatch request;
+      for (size_t j = begin; j < end; j++) {
+        auto id = request.add_ids();
+        id->set_bucket(ids[remote[indices[j]]].bucket);
+        id->set_key(ids[remote[indices[j]]].key);
+      }
+      geds::rpc::ObjectResponseBatch response;
+      grpc::ClientContext context;
+
+      LOG_DEBUG("Lookup remote batch of ", end - begin, " objects");
+      auto status = _shards[group.shard].stub->LookupBatch(&context, request, &response);
+      if (status.error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+        for (size_t j = begin; j < indices.size(); j++) {
+          results[remote[indices[j]]] = lookup(ids[remote[indices[j]]], true);
+        }
+        break;
+      }
+      if (!status.ok()) {
+        return absl::UnavailableError("Unable to execute LookupBatch command: " +
+                                      printGRPCError(status));
+      }
+      if (response.results_size() != static_cast<int>(end - begin)) {
+        return absl::InternalError("LookupBatch returned an unexpected number of results.");
+      }
+      for (size_t j = begin; j < end; j++) {
+        const auto &r = response.results(static_cast<int>(j - begin));
+        auto i = remote[indices[j]];
+        const auto &id = ids[i];
+        if (r.has_error()) {
+          results[i] = convertStatus(r.error());
+          if (results[i].status().code() == absl::StatusCode::kNotFound) {
+            _lookupCache.putMissing(cacheKey(id.bucket, id.key));
+          }
+          continue;
+        }
+        auto object = convert(r.result());
+        (void)_mdsCache.createObject(object, true);
+        _lookupCache.put(cacheKey(id.bucket, id.key), object);
+        results[i] = std::move(object);
+      }
+    }
+  }
+  return results;
+}
+
+absl::StatusOr<std::vector<absl::Status>>
+MetadataService::createBatch(const std::vector<geds::Object> &objects) {
+  METADATASERVICE_CHECK_CONNECTED;
+
+  std::vector<absl::Status> results(objects.size());
+  auto groups = groupByShard(_ring, objects.size(), [&](size_t i) -> const std::string & {
+    return objects[i].id.bucket;
+  });
+  for (const auto &group : groups) {
+    const auto &indices = group.indices;
+    for (size_t begin = 0; begin < indices.size(); begin += MaxBatchSize) {
+      auto end = std::min(begin + MaxBatchSize, indices.size());
+      geds::rpc::ObjectBatch request;
+      for (size_t j = begin; j < end; j++) {
+        convert(objects[indices[j]], request.add_objects());
+      }
+      geds::rpc::StatusResponseBatch response;
+      grpc::ClientContext context;
+
+      auto status = _shards[group.shard].stub->CreateBatch(&context, request, &response);
+      for (size_t j = begin; j < end; j++) {
+        const auto &id = objects[indices[j]].id;
+        _lookupCache.erase(cacheKey(id.bucket, id.key));
+      }
+      if (status.error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+        for (size_t j = begin; j < indices.size(); j++) {
+          results[indices[j]] = createObject(objects[indices[j]]);
+        }
+        break;
+      }
+      if (!status.ok()) {
+        return absl::UnavailableError("Unable to execute CreateBatch command: " +
+                                      printGRPCError(status));
+      }
+      if (response.results_size() != static_cast<int>(end - begin)) {
+        return absl::InternalError("CreateBatch returned an unexpected number of results.");
+      }
+      for (size_t j = begin; j < end; j++) {
+        results[indices[j]] = convertStatus(response.results(static_cast<int>(j - begin)));
+      }
+    }
+  }
+  return results;
+}
+
+absl::StatusOr<std::vector<absl::Status>>
+MetadataService::deleteBatch(const std::vector<geds::ObjectID> &ids) {
+  METADATASERVICE_CHECK_CONNECTED;
+
+  for (const auto &id : ids) {
+    (void)_mdsCache.deleteObject(id.bucket, id.key);
+  }
+
+  std::vector<absl::Status> results(ids.size());
+  auto groups = groupByShard(_ring, ids.size(),
+                             [&](size_t i) -> const std::string & { return ids[i].bucket; });
+  for (const auto &group : groups) {
+    const auto &indices = group.indices;
+    for (size_t begin = 0; begin < indices.size(); begin += MaxBatchSize) {
+      auto end = std::min(begin + MaxBatchSize, indices.size());
+      geds::rpc::ObjectIDBatch request;
+      for (size_t j = begin; j < end; j++) {
+        auto id = request.add_ids();
+        id->set_bucket(ids[indices[j]].bucket);
+        id->set_key(ids[indices[j]].key);
+      }
+      geds::rpc::StatusResponseBatch response;
+      grpc::ClientContext context;
+
+      auto status = _shards[group.shard].stub->DeleteBatch(&context, request, &response);
+      for (size_t j = begin; j < end; j++) {
+        _lookupCache.erase(cacheKey(ids[indices[j]].bucket, ids[indices[j]].key));
+      }
+      if (status.error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+        for (size_t j = begin; j < indices.size(); j++) {
+          results[indices[j]] = deleteObject(ids[indices[j]]);
+        }
+        break;
+      }
+      if (!status.ok()) {
+        return absl::UnavailableError("Unable to execute DeleteBatch command: " +
+                                      printGRPCError(status));
+      }
+      if (response.results_size() != static_cast<int>(end - begin)) {
+        return absl::InternalError("DeleteBatch returned an unexpected number of results.");
+      }
+      for (size_t j = begin; j < end; j++) {
+        results[indices[j]] = convertStatus(response.results(static_cast<int>(j - begin)));
+      }
+    }
+  }
+  return results;
+}
+
 absl::StatusOr<std::vector<geds::Object>> MetadataService::listPrefix(const geds::ObjectID &id) {
   return listPrefix(id.bucket, id.key);
 }
@@ -390,7 +774,7 @@ MetadataService::listPrefix(const std::string &bucket, const std::string &keyPre
   geds::rpc::ObjectListResponse response;
   grpc::ClientContext context;
 
-  auto status = _stub->List(&context, request, &response);
+  auto status = stub(bucket).List(&context, request, &response);
   if (!status.ok()) {
     return absl::UnavailableError("Unable to execute List command: " + printGRPCError(status));
   }
@@ -405,7 +789,8 @@ MetadataService::listPrefix(const std::string &bucket, const std::string &keyPre
     auto obj_id = geds::ObjectID{i.id().bucket(), i.id().key()};
     auto obj_info = geds::ObjectInfo{
         i.info().location(), i.info().size(), i.info().sealedoffset(),
-        i.info().has_metadata() ? std::make_optional(i.info().metadata()) : std::nullopt};
+        i.info().has_metadata() ? std::make_optional(i.info().metadata()) : std::nullopt,
+        i.info().version()};
     auto obj = geds::Object{obj_id, obj_info};
     (void)_mdsCache.createObject(obj, true);
     objects.emplace_back(std::move(obj));
@@ -414,6 +799,64 @@ MetadataService::listPrefix(const std::string &bucket, const std::string &keyPre
                                                           response.commonprefixes().end()});
 }
 
+absl::Status MetadataService::listPrefixPaged(
+    const std::string &bucket, const std::string &keyPrefix, char delimiter,
+    const std::function<void(std::vector<geds::Object> &&, std::vector<std::string> &&)>
+        &onPage) {
+  METADATASERVICE_CHECK_CONNECTED;
+
+  geds::rpc::ObjectListRequest request;
+  auto prefix = request.mutable_prefix();
+  prefix->set_bucket(bucket);
+  prefix->set_key(keyPrefix);
+  if (delimiter > 0) {
+    request.set_delimiter(delimiter);
+  }
+  request.set_omitmetadata(true);
+
+  geds::rpc::ObjectListResponse response;
+  grpc::ClientContext context;
+  std::unique_ptr<grpc::ClientReader<geds::rpc::ObjectListResponse>> reader(
+      stub(bucket).ListStream(&context, request));
+
+  bool received = false;
+  absl::Status error;
+  while (reader->Read(&response)) {
+    received = true;
+    if (response.has_error()) {
+      error = convertStatus(response.error());
+      continue;
+    }
+    std::vector<geds::Object> objects;
+    objects.reserve(response.results_size());
+    for (auto &i : *response.mutable_results()) {
+      auto *id = i.mutable_id();
+      objects.emplace_back(geds::Object{
+          geds::ObjectID{std::move(*id->mutable_bucket()), std::move(*id->mutable_key())},
+          geds::ObjectInfo{std::move(*i.mutable_info()->mutable_location()), i.info().size(),
+                           i.info().sealedoffset(), std::nullopt, i.info().version()}});
+    }
+    std::vector<std::string> commonPrefixes{
+        std::make_move_iterator(response.mutable_commonprefixes()->begin()),
+        std::make_move_iterator(response.mutable_commonprefixes()->end())};
+    onPage(std::move(objects), std::move(commonPrefixes));
+  }
+  auto status = reader->Finish();
+  if (status.error_code() == grpc::StatusCode::UNIMPLEMENTED && !received) {
+    auto list = listPrefix(bucket, keyPrefix, delimiter);
+    if (!list.ok()) {
+      return list.status();
+    }
+    onPage(std::move(list->first), std::move(list->second));
+    return absl::OkStatus();
+  }
+  if (!status.ok()) {
+    return absl::UnavailableError("Unable to execute ListStream command: " +
+                                  printGRPCError(status));
+  }
+  return error;
+}
+
 absl::StatusOr<std::pair<std::vector<geds::Object>, std::vector<std::string>>>
 MetadataService::listPrefixFromCache(const std::string &bucket, const std::string &keyPrefix,
                                      char delimiter) {
@@ -430,16 +873,45 @@ MetadataService::listFolder(const std::string &bucket, const std::string &keyPre
   return listPrefix(bucket, keyPrefix, Default_GEDSFolderDelimiter);
 }
 
+void MetadataService::configureLookupCache(size_t capacity, std::chrono::milliseconds ttl,
+                                           std::chrono::milliseconds negativeTtl) {
+  _lookupCache.configure(capacity, ttl, negativeTtl);
+}
+
+void MetadataService::setObjectChangedCallback(std::function<void(const ObjectID &)> callback) {
+  _objectChangedCallback = std::move(callback);
+}
+
 absl::Status MetadataService::subscribeStream() {
   METADATASERVICE_CHECK_CONNECTED;
 
+  // One stream per shard: Publications are sent by the shard that owns the bucket.
+  std::vector<std::thread> streams;
+  for (size_t shard = 1; shard < _shards.size(); shard++) {
+    streams.emplace_back([this, shard] {
+      auto status = subscribeStream(shard);
+      if (!status.ok()) {
+        LOG_ERROR("Subscription stream to ", _ring.shard(shard), " failed: ", status.message());
+      }
+    });
+  }
+  auto status = subscribeStream(0);
+  for (auto &stream : streams) {
+    stream.join();
+  }
+  return status;
+}
+
+absl::Status MetadataService::subscribeStream(size_t shard) {
+  METADATASERVICE_CHECK_CONNECTED;
+
   geds::rpc::SubscriptionStreamEvent subscription_stream_event;
   geds::rpc::SubscriptionStreamResponse subscription_response;
   grpc::ClientContext context;
   subscription_stream_event.set_subscriberid(uuid);
 
   std::unique_ptr<grpc::ClientReader<geds::rpc::SubscriptionStreamResponse>> reader(
-      _stub->SubscribeStream(&context, subscription_stream_event));
+      _shards[shard].stub->SubscribeStream(&context, subscription_stream_event));
 
   while (reader->Read(&subscription_response)) {
     const auto &objectPublication = subscription_response.object();
@@ -449,7 +921,8 @@ absl::Status MetadataService::subscribeStream() {
                          objectPublication.info().sealedoffset(),
                          objectPublication.info().has_metadata()
                              ? std::make_optional(objectPublication.info().metadata())
-                             : std::nullopt};
+                             : std::nullopt,
+                         objectPublication.info().version()};
     auto obj = geds::Object{obj_id, obj_info};
 
     if (subscription_response.publicationtype() == geds::rpc::CREATE_OBJECT) {
@@ -460,15 +933,29 @@ absl::Status MetadataService::subscribeStream() {
       (void)_mdsCache.deleteObject(obj.id.bucket, obj.id.key);
     }
 
+    _lookupCache.erase(cacheKey(obj.id.bucket, obj.id.key));
+
     LOG_DEBUG("Received subscription and added to cache (bucket, key): ", obj.id.bucket, " , ",
               obj.id.key);
+    if (_objectChangedCallback) {
+      _objectChangedCallback(obj.id);
+    }
   }
   auto status = reader->Finish();
-  if (!status.ok()) {
+  // Publications may have been missed until the stream is reestablished.
+  _lookupCache.clear();
+  auto buckets = _mdsCache.listBuckets();
+  if (buckets.ok()) {
+    for (const auto &bucket : *buckets) {
+      (void)_mdsCache.deleteBucket(bucket);
+    }
+  }
+  // The server closes the streams of subscribers which do not keep up.
+  if (!status.ok() && status.error_code() != grpc::StatusCode::RESOURCE_EXHAUSTED) {
     return absl::InternalError(status.error_message());
   }
   std::this_thread::sleep_for(std::chrono::seconds(1));
-  return subscribeStream();
+  return subscribeStream(shard);
 }
 
 absl::Status MetadataService::subscribe(const geds::SubscriptionEvent &event) {
@@ -483,7 +970,8 @@ absl::Status MetadataService::subscribe(const geds::SubscriptionEvent &event) {
   subscription_event.set_key(std::string{event.key});
   subscription_event.set_subscriptiontype(event.subscriptionType);
 
-  auto status = _stub->Subscribe(&context, subscription_event, &response);
+  auto status =
+      stub(subscription_event.bucketid()).Subscribe(&context, subscription_event, &response);
   if (!status.ok()) {
     return absl::UnavailableError("Unable to execute CreateBucket command: " +
                                   status.error_message());
@@ -503,7 +991,8 @@ absl::Status MetadataService::unsubscribe(const geds::SubscriptionEvent &event)
   subscription_event.set_key(std::string{event.key});
   subscription_event.set_subscriptiontype(event.subscriptionType);
 
-  auto status = _stub->Unsubscribe(&context, subscription_event, &response);
+  auto status =
+      stub(subscription_event.bucketid()).Unsubscribe(&context, subscription_event, &response);
   if (!status.ok()) {
     return absl::UnavailableError("Unable to unsubscribe: " + status.error_message());
   }
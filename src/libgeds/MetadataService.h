@@ -6,6 +6,10 @@
 #ifndef GEDS_METADATASERVICE_H
 #define GEDS_METADATASERVICE_H
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -17,23 +21,62 @@
 #include <grpcpp/grpcpp.h>
 
 #include "GEDSInternal.h"
+#include "LookupCache.h"
 #include "MDSKVS.h"
 #include "Object.h"
 #include "ObjectStoreConfig.h"
 #include "PubSub.h"
+#include "ShardRing.h"
 
 #include "geds.grpc.pb.h"
 
 namespace geds {
 
+/**
+ * @brief Client of the metadata service.
+ *
+ * The metadata can be sharded over several metadata servers: Buckets are assigned to the servers
+ * in `serverAddress` by consistent hashing, and requests spanning buckets are split per server.
+ */
 class MetadataService {
+  struct Shard {
+    std::shared_ptr<grpc::Channel> channel;
+    std::unique_ptr<geds::rpc::MetadataService::Stub> stub;
+  };
+
   ConnectionState _connectionState;
   MDSKVS _mdsCache;
-  std::shared_ptr<grpc::Channel> _channel;
-  std::unique_ptr<geds::rpc::MetadataService::Stub> _stub;
+  LookupCache<geds::Object> _lookupCache{"GEDS: metadata lookup cache"};
+  utility::ShardRing _ring;
+  std::vector<Shard> _shards;
   std::string uuid;
+  std::function<void(const ObjectID &)> _objectChangedCallback;
+  std::atomic<bool> _conditionalLookups{true};
+
+  geds::rpc::MetadataService::Stub &stub(const std::string &bucket) {
+    return *_shards[_ring.shardOf(bucket)].stub;
+  }
+
+  absl::Status subscribeStream(size_t shard);
+
+  /**
+   * @brief Look up `cached.id` and return `cached` if its version is still current. Returns
+   * UNIMPLEMENTED if the metadata server does not support conditional lookups.
+   */
+  absl::StatusOr<geds::Object> lookupIfChanged(const geds::Object &cached);
+
+  absl::Status rename(const geds::ObjectID &src, const geds::ObjectID &dest, bool prefix,
+                      const std::vector<std::string> &keys = {});
 
 public:
+  /**
+   * @brief Maximum number of items per batch request. Larger batches are split.
+   */
+  static constexpr size_t MaxBatchSize = geds::MaxMetadataBatchSize;
+
+  /**
+   * @brief Address of the metadata server, or comma-separated addresses of the metadata shards.
+   */
   const std::string serverAddress;
 
   MetadataService() = delete;
@@ -43,8 +86,21 @@ public:
 
   absl::Status connect();
 
+  /**
+   * @brief Called for each object publication received by `subscribeStream`. Needs to be set
+   * before the stream is started.
+   */
+  void setObjectChangedCallback(std::function<void(const ObjectID &)> callback);
+
   absl::Status disconnect();
 
+  /**
+   * @brief Cache up to `capacity` lookup results. Found objects are cached for `ttl`, missing
+   * objects for `negativeTtl`.
+   */
+  void configureLookupCache(size_t capacity, std::chrono::milliseconds ttl,
+                            std::chrono::milliseconds negativeTtl);
+
   absl::StatusOr<std::string> getConnectionInformation();
 
   absl::Status registerObjectStoreConfig(const ObjectStoreConfig &mapping);
@@ -69,10 +125,41 @@ public:
   absl::Status deleteObjectPrefix(const geds::ObjectID &id);
   absl::Status deleteObjectPrefix(const std::string &bucket, const std::string &key);
 
+  /**
+   * @brief Rename object `src` to `dest` on the metadata server. Returns UNIMPLEMENTED if the
+   * metadata server does not support renames or the buckets belong to different metadata shards.
+   */
+  absl::Status renameObject(const geds::ObjectID &src, const geds::ObjectID &dest);
+
+  /**
+   * @brief Rename all objects starting with `src.key` by replacing the prefix with `dest.key`, see
+   * `renameObject`. Returns FAILED_PRECONDITION without renaming if the objects starting with
+   * `src.key` are not exactly `keys`.
+   */
+  absl::Status renameObjectPrefix(const geds::ObjectID &src, const geds::ObjectID &dest,
+                                  const std::vector<std::string> &keys);
+
   absl::StatusOr<geds::Object> lookup(const geds::ObjectID &id, bool invalidate = false);
   absl::StatusOr<geds::Object> lookup(const std::string &bucket, const std::string &key,
                                       bool invalidate = false);
 
+  /**
+   * @brief Check whether `version` is the current version of the object. A valid entry of the
+   * lookup cache answers without a request; otherwise a cached entry is revalidated.
+   */
+  absl::StatusOr<bool> isCurrent(const std::string &bucket, const std::string &key,
+                                 uint64_t version);
+
+  /**
+   * @brief Batched variants of `lookup`, `createObject` and `deleteObject`. The result holds one
+   * status per item in request order. Falls back to single requests if the metadata server does
+   * not implement the batch RPCs.
+   */
+  absl::StatusOr<std::vector<absl::StatusOr<geds::Object>>>
+  lookupBatch(const std::vector<geds::ObjectID> &ids, bool invalidate = false);
+  absl::StatusOr<std::vector<absl::Status>> createBatch(const std::vector<geds::Object> &objects);
+  absl::StatusOr<std::vector<absl::Status>> deleteBatch(const std::vector<geds::ObjectID> &ids);
+
   /**
    * @brief List objects in `bucket` starting with `key` as prefix.
    */
@@ -87,6 +174,16 @@ public:
   absl::StatusOr<std::pair<std::vector<geds::Object>, std::vector<std::string>>>
   listPrefix(const std::string &bucket, const std::string &keyPrefix, char delimiter);
 
+  /**
+   * @brief Stream the listing of `listPrefix` page by page without object metadata. `onPage` is
+   * called with the objects and common prefixes of each page. Falls back to a single `List` if
+   * the metadata server does not implement `ListStream`.
+   */
+  absl::Status listPrefixPaged(
+      const std::string &bucket, const std::string &keyPrefix, char delimiter,
+      const std::function<void(std::vector<geds::Object> &&, std::vector<std::string> &&)>
+          &onPage);
+
   /**
    * @brief List objects from cache in `bucket` starting with `key` as prefix. Objects that contain
    * `delimiter` in the postfix of the key are filtered. Delimiter `\0` is treated as no filter.
@@ -101,7 +198,8 @@ public:
   listFolder(const std::string &bucket, const std::string &keyPrefix);
 
   /**
-   * @brief Create subscription stream for the subscriber.
+   * @brief Create subscription stream for the subscriber. Streams from all shards are served until
+   * they fail.
    */
   absl::Status subscribeStream();
 
@@ -0,0 +1,117 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "OpenFileCache.h"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "GEDSFile.h"
+#include "GEDSFileHandle.h"
+
+namespace geds {
+
+OpenFileCache::OpenFileCache(size_t capacity)
+    : _shardCapacity(std::max<size_t>(1, capacity / NumShards)) {}
+
+OpenFileCache::Shard &OpenFileCache::shard(const std::string &path) {
+  return _shards[std::hash<std::string>{}(path) % NumShards];
+}
+
+std::shared_ptr<GEDSFile> OpenFileCache::get(const std::string &path) {
+  std::shared_ptr<GEDSFile> result;
+  auto &s = shard(path);
+  {
+    auto lock = std::lock_guard(s.mutex);
+    auto it = s.entries.find(path);
+    if (it != s.entries.end()) {
+      s.lru.splice(s.lru.begin(), s.lru, it->second);
+      result = it->second->second;
+    }
+  }
+  if (result == nullptr) {
+    *_statisticsMisses += 1;
+    return nullptr;
+  }
+  if (!result->fileHandle()->isValid()) {
+    erase(path);
+    *_statisticsMisses += 1;
+    return nullptr;
+  }
+  *_statisticsHits += 1;
+  return result;
+}
+
+void OpenFileCache::insert(const std::string &path, std::shared_ptr<GEDSFile> file,
+                           uint64_t generation) {
+  // Evicted files are released outside of the lock.
+  std::shared_ptr<GEDSFile> evicted;
+  auto &s = shard(path);
+  auto lock = std::lock_guard(s.mutex);
+  if (generation != _generation) {
+    return;
+  }
+  auto it = s.entries.find(path);
+  if (it != s.entries.end()) {
+    evicted = std::move(it->second->second);
+    it->second->second = std::move(file);
+    s.lru.splice(s.lru.begin(), s.lru, it->second);
+    return;
+  }
+  s.lru.emplace_front(path, std::move(file));
+  s.entries.emplace(path, s.lru.begin());
+  if (s.lru.size() > _shardCapacity) {
+    evicted = std::move(s.lru.back().second);
+    s.entries.erase(s.lru.back().first);
+    s.lru.pop_back();
+  }
+}
+
+void OpenFileCache::erase(const std::string &path) {
+  std::shared_ptr<GEDSFile> evicted;
+  auto &s = shard(path);
+  auto lock = std::lock_guard(s.mutex);
+  _generation++;
+  auto it = s.entries.find(path);
+  if (it == s.entries.end()) {
+    return;
+  }
+  evicted = std::move(it->second->second);
+  s.lru.erase(it->second);
+  s.entries.erase(it);
+}
+
+void OpenFileCache::erasePrefix(const std::string &prefix) {
+  std::vector<std::shared_ptr<GEDSFile>> evicted;
+  for (auto &s : _shards) {
+    auto lock = std::lock_guard(s.mutex);
+    _generation++;
+    for (auto it = s.lru.begin(); it != s.lru.end();) {
+      if (it->first.starts_with(prefix)) {
+        evicted.emplace_back(std::move(it->second));
+        s.entries.erase(it->first);
+        it = s.lru.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+}
+
+void OpenFileCache::clear() {
+  std::vector<std::shared_ptr<GEDSFile>> evicted;
+  for (auto &s : _shards) {
+    auto lock = std::lock_guard(s.mutex);
+    _generation++;
+    for (auto &entry : s.lru) {
+      evicted.emplace_back(std::move(entry.second));
+    }
+    s.lru.clear();
+    s.entries.clear();
+  }
+}
+
+} // namespace geds
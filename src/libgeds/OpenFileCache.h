@@ -0,0 +1,80 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "Statistics.h"
+#include "StatisticsCounter.h"
+
+class GEDSFile;
+
+namespace geds {
+
+/**
+ * @brief Bounded LRU cache of opened files used to serve remote reads.
+ *
+ * Repeated reads of the same object skip name validation, the file handle lookup and the open
+ * count bookkeeping of `GEDS::open`. Cached files count as open: Entries need to be removed before
+ * a file is deleted or relocated.
+ *
+ * Entries are distributed over independently locked shards by the hash of their path.
+ */
+class OpenFileCache {
+  static constexpr size_t NumShards = 16;
+
+  struct Shard {
+    std::mutex mutex;
+    std::list<std::pair<std::string, std::shared_ptr<GEDSFile>>> lru;
+    std::unordered_map<std::string, decltype(lru)::iterator> entries;
+  };
+
+  const size_t _shardCapacity;
+  std::array<Shard, NumShards> _shards;
+  // Incremented on each invalidation. Prevents inserting files that have been opened before a
+  // concurrent invalidation.
+  std::atomic<uint64_t> _generation = 0;
+
+  std::shared_ptr<StatisticsCounter> _statisticsHits =
+      Statistics::createCounter("GEDS: open file cache hits");
+  std::shared_ptr<StatisticsCounter> _statisticsMisses =
+      Statistics::createCounter("GEDS: open file cache misses");
+
+  Shard &shard(const std::string &path);
+
+public:
+  explicit OpenFileCache(size_t capacity);
+
+  /**
+   * @brief Returns the generation to pass to `insert`.
+   */
+  uint64_t generation() const { return _generation; }
+
+  /**
+   * @brief Returns the cached file or nullptr. Files which are no longer valid are evicted.
+   */
+  std::shared_ptr<GEDSFile> get(const std::string &path);
+
+  /**
+   * @brief Insert the file unless an invalidation happened since `generation` was obtained.
+   */
+  void insert(const std::string &path, std::shared_ptr<GEDSFile> file, uint64_t generation);
+
+  void erase(const std::string &path);
+  void erasePrefix(const std::string &prefix);
+  void clear();
+};
+
+} // namespace geds
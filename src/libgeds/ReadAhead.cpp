@@ -0,0 +1,192 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ReadAhead.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "Logging.h"
+
+namespace geds {
+
+ReadAheadBufferPool::ReadAheadBufferPool(size_t capacity) : _capacity(capacity) {}
+
+std::shared_ptr<ReadAheadBufferPool> ReadAheadBufferPool::factory(size_t capacity) {
+  return std::shared_ptr<ReadAheadBufferPool>(new ReadAheadBufferPool(capacity));
+}
+
+std::shared_ptr<std::vector<uint8_t>> ReadAheadBufferPool::acquire(size_t size) {
+  std::vector<uint8_t> buffer;
+  {
+    auto lock = std::lock_guard(_mutex);
+    auto it = std::find_if(_free.begin(), _free.end(),
+                           [size](const auto &candidate) { return candidate.size() >= size; });
+    if (it != _free.end()) {
+      buffer = std::move(*it);
+      _free.erase(it);
+    } else {
+      // Free unused buffers until the new buffer fits.
+      while (_allocated + size > _capacity && !_free.empty()) {
+        _allocated -= _free.back().size();
+        _free.pop_back();
+      }
+      if (_allocated + size > _capacity) {
+        return nullptr;
+      }
+      _allocated += size;
+    }
+  }
+  if (buffer.empty()) {
+    buffer.resize(size);
+  }
+  std::weak_ptr<ReadAheadBufferPool> pool = shared_from_this();
+  return std::shared_ptr<std::vector<uint8_t>>(new std::vector<uint8_t>(std::move(buffer)),
+                                               [pool](std::vector<uint8_t> *ptr) {
+                                                 if (auto p = pool.lock()) {
+                                                   p->release(ptr);
+                                                 }
+                                                 delete ptr;
+                                               });
+}
+
+void ReadAheadBufferPool::release(std::vector<uint8_t> *buffer) {
+  auto lock = std::lock_guard(_mutex);
+  _free.emplace_back(std::move(*buffer));
+}
+
+size_t ReadAheadBufferPool::allocated() {
+  auto lock = std::lock_guard(_mutex);
+  return _allocated;
+}
+
+void ReadAhead::Segment::run(const Fetch &fetch) {
+  if (started.exchange(true)) {
+    return;
+  }
+  promise.set_value(fetch(buffer->data(), offset, length));
+}
+
+absl::StatusOr<size_t> ReadAhead::Segment::wait(const Fetch &fetch) {
+  run(fetch);
+  return result.get();
+}
+
+ReadAhead::ReadAhead(Fetch fetch, Executor executor, std::shared_ptr<ReadAheadBufferPool> pool,
+                     size_t objectSize, size_t minWindow, size_t maxWindow)
+    : _fetch(std::make_shared<const Fetch>(std::move(fetch))), _executor(std::move(executor)),
+      _pool(std::move(pool)), _objectSize(objectSize), _minWindow(minWindow),
+      _maxWindow(std::max(minWindow, maxWindow)) {}
+
+ReadAhead::~ReadAhead() {
+  auto lock = std::lock_guard(_mutex);
+  dropSegments();
+}
+
+void ReadAhead::dropSegments() {
+  for (const auto &segment : _segments) {
+    *_statisticsWasted += segment->length - segment->consumed;
+  }
+  // In-flight prefetches keep their segment alive until they complete.
+  _segments.clear();
+}
+
+void ReadAhead::prefetch(size_t readLength) {
+  auto grown = _window == 0 ? _minWindow : 2 * _window;
+  _window = std::min(std::max(grown, 2 * readLength), _maxWindow);
+
+  auto next = _segments.empty() ? _expected : _segments.back()->offset + _segments.back()->length;
+  while (next < _objectSize && next - _expected < _window) {
+    auto length = std::min(_window, _objectSize - next);
+    auto buffer = _pool->acquire(length);
+    if (buffer == nullptr) {
+      LOG_DEBUG("Read-ahead buffer pool exhausted");
+      return;
+    }
+    auto segment = std::make_shared<Segment>();
+    segment->offset = next;
+    segment->length = length;
+    segment->buffer = std::move(buffer);
+    segment->result = segment->promise.get_future().share();
+    _segments.push_back(segment);
+    *_statisticsPrefetched += length;
+    _executor([segment, fetch = _fetch]() { segment->run(*fetch); });
+    next += length;
+  }
+}
+
+absl::StatusOr<size_t> ReadAhead::read(uint8_t *buffer, size_t position, size_t length) {
+  auto lock = std::unique_lock(_mutex);
+  if (position != _expected) {
+    // Random access: Forward the read.
+    dropSegments();
+    _window = 0;
+    _expected = position + length;
+    lock.unlock();
+    *_statisticsMisses += 1;
+    return (*_fetch)(buffer, position, length);
+  }
+
+  // `_mutex` is released while waiting for a prefetch or fetching, so other readers may change the
+  // state meanwhile. It is only updated if `_expected` still matches this read.
+  size_t served = 0;
+  while (served < length && !_segments.empty()) {
+    auto segment = _segments.front();
+    auto offset = position + served;
+    if (offset < segment->offset || offset >= segment->offset + segment->length) {
+      dropSegments();
+      break;
+    }
+    lock.unlock();
+    auto count = segment->wait(*_fetch);
+    lock.lock();
+    bool current = _expected == offset && !_segments.empty() && _segments.front() == segment;
+    if (!count.ok() || *count < segment->length) {
+      // Retry the remainder synchronously.
+      if (current) {
+        dropSegments();
+      }
+      break;
+    }
+    // The buffer is not modified once the prefetch completed.
+    auto n = std::min(segment->offset + segment->length - offset, length - served);
+    std::memcpy(buffer + served, segment->buffer->data() + (offset - segment->offset), n);
+    served += n;
+    if (!current) {
+      break;
+    }
+    _expected = offset + n;
+    segment->consumed += n;
+    if (segment->consumed == segment->length) {
+      _segments.pop_front();
+    }
+  }
+
+  auto expected = position + served;
+  if (served == length) {
+    *_statisticsHits += 1;
+  } else {
+    *_statisticsMisses += 1;
+    lock.unlock();
+    auto count = (*_fetch)(buffer + served, position + served, length - served);
+    lock.lock();
+    if (!count.ok()) {
+      if (_expected == expected) {
+        dropSegments();
+        _window = 0;
+      }
+      return count.status();
+    }
+    served += *count;
+  }
+  if (_expected == expected) {
+    _expected = position + served;
+    prefetch(length);
+  }
+  return served;
+}
+
+} // namespace geds
@@ -0,0 +1,117 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <absl/status/statusor.h>
+
+#include "Statistics.h"
+#include "StatisticsCounter.h"
+
+namespace geds {
+
+/**
+ * @brief Buffers for read-ahead and copies, bounded by the number of bytes allocated in total.
+ *
+ * Released buffers are kept for reuse and are freed once an allocation would exceed the capacity.
+ */
+class ReadAheadBufferPool : public std::enable_shared_from_this<ReadAheadBufferPool> {
+  const size_t _capacity;
+
+  std::mutex _mutex;
+  size_t _allocated = 0;
+  std::vector<std::vector<uint8_t>> _free;
+
+  explicit ReadAheadBufferPool(size_t capacity);
+
+  void release(std::vector<uint8_t> *buffer);
+
+public:
+  [[nodiscard]] static std::shared_ptr<ReadAheadBufferPool> factory(size_t capacity);
+
+  /**
+   * @brief Returns a buffer of at least `size` bytes or nullptr if the capacity is exhausted.
+   */
+  std::shared_ptr<std::vector<uint8_t>> acquire(size_t size);
+
+  size_t allocated();
+};
+
+/**
+ * @brief Adaptive read-ahead for sequential reads of a remote object.
+ *
+ * The window starts at `minWindow` on the first sequential read and doubles with every
+ * subsequent one up to `maxWindow`. Prefetches are issued through `executor`. A reader which
+ * needs a prefetch that has not started yet runs it inline, so a saturated executor cannot block
+ * readers. A non-sequential read drops all prefetched data and resets the window. Readers do not
+ * hold the internal lock while waiting for a prefetch or fetching.
+ */
+class ReadAhead {
+public:
+  using Fetch = std::function<absl::StatusOr<size_t>(uint8_t *buffer, size_t position,
+                                                     size_t length)>;
+  using Executor = std::function<void(std::function<void()>)>;
+
+private:
+  struct Segment {
+    size_t offset;
+    size_t length;
+    std::shared_ptr<std::vector<uint8_t>> buffer;
+    std::atomic<bool> started = false;
+    std::promise<absl::StatusOr<size_t>> promise;
+    std::shared_future<absl::StatusOr<size_t>> result;
+    size_t consumed = 0;
+
+    void run(const Fetch &fetch);
+    absl::StatusOr<size_t> wait(const Fetch &fetch);
+  };
+
+  // Shared with in-flight prefetches which may outlive the read-ahead.
+  const std::shared_ptr<const Fetch> _fetch;
+  const Executor _executor;
+  const std::shared_ptr<ReadAheadBufferPool> _pool;
+  const size_t _objectSize;
+  const size_t _minWindow;
+  const size_t _maxWindow;
+
+  std::mutex _mutex;
+  size_t _expected = 0;
+  size_t _window = 0;
+  std::deque<std::shared_ptr<Segment>> _segments;
+
+  std::shared_ptr<StatisticsCounter> _statisticsHits =
+      Statistics::createCounter("GEDS: read-ahead hits");
+  std::shared_ptr<StatisticsCounter> _statisticsMisses =
+      Statistics::createCounter("GEDS: read-ahead misses");
+  std::shared_ptr<StatisticsCounter> _statisticsPrefetched =
+      Statistics::createCounter("GEDS: read-ahead prefetched bytes");
+  std::shared_ptr<StatisticsCounter> _statisticsWasted =
+      Statistics::createCounter("GEDS: read-ahead wasted bytes");
+
+  void dropSegments();
+  void prefetch(size_t readLength);
+
+public:
+  ReadAhead(Fetch fetch, Executor executor, std::shared_ptr<ReadAheadBufferPool> pool,
+            size_t objectSize, size_t minWindow, size_t maxWindow);
+  ~ReadAhead();
+
+  ReadAhead(const ReadAhead &) = delete;
+  ReadAhead &operator=(const ReadAhead &) = delete;
+
+  absl::StatusOr<size_t> read(uint8_t *buffer, size_t position, size_t length);
+};
+
+} // namespace geds
@@ -0,0 +1,141 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "SealQueue.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "Logging.h"
+
+namespace geds {
+
+SealQueue::SealQueue(Commit commit, size_t maxBatchSize)
+    : _commit(std::move(commit)), _maxBatchSize(std::max(maxBatchSize, (size_t)1)),
+      _thread([this] { run(); }) {}
+
+SealQueue::~SealQueue() { (void)stop(); }
+
+std::shared_future<absl::Status> SealQueue::enqueue(geds::Object object,
+                                                    std::function<void()> onRegistered) {
+  std::promise<absl::Status> promise;
+  auto result = promise.get_future().share();
+  {
+    auto lock = std::lock_guard(_mutex);
+    if (_stopped) {
+      promise.set_value(absl::FailedPreconditionError("The seal queue is stopped."));
+      return result;
+    }
+    _entries.emplace_back(Entry{std::move(object), std::move(onRegistered), std::move(promise)});
+    _enqueuedCount++;
+  }
+  *_statisticsQueued += 1;
+  _queued.notify_one();
+  return result;
+}
+
+void SealQueue::run() {
+  while (true) {
+    std::vector<Entry> batch;
+    {
+      auto lock = std::unique_lock(_mutex);
+      _queued.wait(lock, [this] { return !_entries.empty() || _stopped; });
+      if (_entries.empty()) {
+        return;
+      }
+      if (_entries.size() <= _maxBatchSize) {
+        batch.swap(_entries);
+      } else {
+        auto end = _entries.begin() + (ptrdiff_t)_maxBatchSize;
+        batch.assign(std::make_move_iterator(_entries.begin()), std::make_move_iterator(end));
+        _entries.erase(_entries.begin(), end);
+      }
+    }
+    commit(batch);
+    {
+      auto lock = std::lock_guard(_mutex);
+      _committedCount += batch.size();
+    }
+    _committed.notify_all();
+  }
+}
+
+void SealQueue::commit(std::vector<Entry> &entries) {
+  // Coalesce repeated seals of the same object: The latest version wins.
+  std::map<std::pair<std::string, std::string>, size_t> index;
+  std::vector<geds::Object> objects;
+  std::vector<size_t> objectIndex;
+  objectIndex.reserve(entries.size());
+  for (auto &entry : entries) {
+    auto [it, inserted] =
+        index.try_emplace({entry.object.id.bucket, entry.object.id.key}, objects.size());
+    if (inserted) {
+      objects.push_back(entry.object);
+    } else {
+      objects[it->second] = entry.object;
+      *_statisticsCoalesced += 1;
+    }
+    objectIndex.push_back(it->second);
+  }
+  *_statisticsBatches += 1;
+
+  auto result = _commit(objects);
+  if (result.ok() && result->size() != objects.size()) {
+    result = absl::UnknownError("Invalid number of results for a batch of " +
+                                std::to_string(objects.size()) + " objects.");
+  }
+  absl::Status firstError;
+  for (size_t i = 0; i < entries.size(); i++) {
+    auto status = result.ok() ? (*result)[objectIndex[i]] : result.status();
+    if (!status.ok()) {
+      LOG_ERROR("Unable to register ", entries[i].object.id.bucket, "/",
+                entries[i].object.id.key, ": ", status.message());
+      if (firstError.ok()) {
+        firstError = status;
+      }
+    } else if (entries[i].onRegistered) {
+      entries[i].onRegistered();
+    }
+    entries[i].promise.set_value(std::move(status));
+  }
+  if (!firstError.ok()) {
+    auto lock = std::lock_guard(_mutex);
+    if (_firstError.ok()) {
+      _firstError = std::move(firstError);
+    }
+  }
+}
+
+void SealQueue::wait() {
+  auto lock = std::unique_lock(_mutex);
+  auto target = _enqueuedCount;
+  _committed.wait(lock, [&] { return _committedCount >= target; });
+}
+
+absl::Status SealQueue::flush() {
+  auto lock = std::unique_lock(_mutex);
+  auto target = _enqueuedCount;
+  _committed.wait(lock, [&] { return _committedCount >= target; });
+  return std::exchange(_firstError, absl::OkStatus());
+}
+
+absl::Status SealQueue::stop() {
+  {
+    auto lock = std::lock_guard(_mutex);
+    if (_stopped) {
+      return absl::OkStatus();
+    }
+    _stopped = true;
+  }
+  _queued.notify_all();
+  // The background thread drains the queue before it exits.
+  _thread.join();
+  auto lock = std::lock_guard(_mutex);
+  return std::exchange(_firstError, absl::OkStatus());
+}
+
+} // namespace geds
@@ -0,0 +1,102 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <absl/status/status.h>
+#include <absl/status/statusor.h>
+
+#include "Object.h"
+#include "Statistics.h"
+#include "StatisticsCounter.h"
+
+namespace geds {
+
+/**
+ * @brief Write-behind registration of sealed objects.
+ *
+ * Objects are queued and registered in batches on a background thread. All objects queued while
+ * a batch is in flight form the next batch. Multiple seals of the same object within a batch are
+ * coalesced into a single registration of the latest version.
+ */
+class SealQueue {
+public:
+  using Commit = std::function<absl::StatusOr<std::vector<absl::Status>>(
+      const std::vector<geds::Object> &objects)>;
+
+private:
+  struct Entry {
+    geds::Object object;
+    std::function<void()> onRegistered;
+    std::promise<absl::Status> promise;
+  };
+
+  const Commit _commit;
+  const size_t _maxBatchSize;
+
+  std::mutex _mutex;
+  std::condition_variable _queued;
+  std::condition_variable _committed;
+  std::vector<Entry> _entries;
+  uint64_t _enqueuedCount = 0;
+  uint64_t _committedCount = 0;
+  absl::Status _firstError;
+  bool _stopped = false;
+
+  std::shared_ptr<StatisticsCounter> _statisticsQueued =
+      geds::Statistics::createCounter("GEDS: async seals queued");
+  std::shared_ptr<StatisticsCounter> _statisticsCoalesced =
+      geds::Statistics::createCounter("GEDS: async seals coalesced");
+  std::shared_ptr<StatisticsCounter> _statisticsBatches =
+      geds::Statistics::createCounter("GEDS: async seal batches");
+
+  // Declared last: The thread uses all other members as soon as it starts.
+  std::thread _thread;
+
+  void run();
+  void commit(std::vector<Entry> &entries);
+
+public:
+  SealQueue(Commit commit, size_t maxBatchSize);
+  SealQueue(const SealQueue &) = delete;
+  SealQueue &operator=(const SealQueue &) = delete;
+  ~SealQueue();
+
+  /**
+   * @brief Queue `object` for registration. The future completes once the object is registered.
+   *
+   * `onRegistered` runs on the background thread after a successful registration, before the
+   * future completes.
+   */
+  std::shared_future<absl::Status> enqueue(geds::Object object,
+                                           std::function<void()> onRegistered = nullptr);
+
+  /**
+   * @brief Wait until all objects queued before the call are registered.
+   */
+  void wait();
+
+  /**
+   * @brief Like `wait`, but returns the first registration error since the previous flush.
+   */
+  absl::Status flush();
+
+  /**
+   * @brief Flush and stop the background thread. Objects queued afterwards fail.
+   */
+  absl::Status stop();
+};
+
+} // namespace geds
@@ -32,7 +32,9 @@
 #include "Platform.h"
 #include "Ports.h"
 #include "Status.h"
+#include "TcpDataTransport.h"
 #include "TcpServer.h"
+#include "UnixDomainTransport.h"
 #include "geds.grpc.pb.h"
 #include "geds.pb.h"
 
@@ -58,8 +60,14 @@ class ServerImpl final : public geds::rpc::GEDSService::Service {
       auto port = std::get<2>(endpoint);
       if (type == FileTransferProtocol::RDMA) {
         ep->set_type(rpc::RDMA);
+      } else if (type == FileTransferProtocol::SocketEpoll) {
+        ep->set_type(rpc::SocketEpoll);
+      } else if (type == FileTransferProtocol::UnixDomain) {
+        ep->set_type(rpc::UnixDomain);
+        ep->set_hostid(unix_transport::hostId());
       } else {
         ep->set_type(rpc::Socket);
+        ep->set_protocolversion(tcp_transport::BinaryProtocolVersion);
       }
       ep->set_address(addr);
       ep->set_port(port);
@@ -93,6 +101,12 @@ absl::Status Server::start(std::shared_ptr<GEDS> geds) {
     return absl::FailedPreconditionError("The server is already running!");
   }
 
+  const auto &transport = geds->config().transport;
+  if (transport != "asio" && transport != "epoll") {
+    return absl::InvalidArgumentError("Unknown transport " + transport + ".");
+  }
+  bool useEpoll = transport == "epoll";
+
   _geds = geds;
   _grpcService = std::unique_ptr<grpc::Service>(new ServerImpl(geds, *this));
 
@@ -120,20 +134,33 @@ absl::Status Server::start(std::shared_ptr<GEDS> geds) {
   absl::Status status;
   size_t retryCount = 0;
   int socketServerPort = _port;
+  uint16_t dataPort = 0;
   do {
     retryCount++;
     socketServerPort++;
-    try {
-      _TcpServer = std::make_unique<TcpServer>(geds, socketServerPort);
-      status = _TcpServer->start();
-    } catch (std::exception &e) {
-      status = absl::UnknownError("Error starting the socket transport " + std::string{e.what()});
+    if (useEpoll) {
+      auto tcpTransportStatus = tcpTransport();
+      if (!tcpTransportStatus.ok()) {
+        return tcpTransportStatus.status();
+      }
+      status = (*tcpTransportStatus)->listen(socketServerPort);
+      dataPort = (*tcpTransportStatus)->port();
+    } else {
+      try {
+        _TcpServer = std::make_unique<TcpServer>(geds, socketServerPort);
+        status = _TcpServer->start();
+        dataPort = _TcpServer->port;
+      } catch (std::exception &e) {
+        status =
+            absl::UnknownError("Error starting the socket transport " + std::string{e.what()});
+      }
     }
   } while (retryCount < 10 && !status.ok());
 
   if (!status.ok()) {
     return status;
   }
+  auto dataProtocol = useEpoll ? FileTransferProtocol::SocketEpoll : FileTransferProtocol::Socket;
 
   {
     ifaddrs *ifaddr;
@@ -158,14 +185,28 @@ absl::Status Server::start(std::shared_ptr<GEDS> geds) {
         if (str == "127.0.0.1") {
           continue;
         }
-        LOG_DEBUG("Exporting ", str, ":", _TcpServer->port);
-        _endpoints.emplace_back(
-            std::make_tuple(FileTransferProtocol::Socket, str, _TcpServer->port));
+        LOG_DEBUG("Exporting ", str, ":", dataPort);
+        _endpoints.emplace_back(std::make_tuple(dataProtocol, str, dataPort));
       }
     }
     freeifaddrs(ifaddr);
   }
 
+  if (geds->config().localTransport) {
+    // The local data path is optional: Peers also connect to the TCP endpoints and use them if
+    // the local data path is unavailable or a read through it fails.
+    auto server =
+        std::make_unique<UnixDomainServer>(geds, unix_transport::socketName(dataPort));
+    auto unixStatus = server->start();
+    if (unixStatus.ok()) {
+      _endpoints.emplace_back(
+          std::make_tuple(FileTransferProtocol::UnixDomain, server->name, uint16_t{0}));
+      _unixDomainServer = std::move(server);
+    } else {
+      LOG_ERROR("Unable to start the local data path: ", unixStatus.message());
+    }
+  }
+
   // TODO: Check if _grpcServer->Wait() is required.
   _state = ServiceState::Running;
   return absl::OkStatus();
@@ -173,11 +214,38 @@ absl::Status Server::start(std::shared_ptr<GEDS> geds) {
 
 absl::Status Server::stop() {
   CHECK_SERVICE_RUNNING
-  _TcpServer->stop();
-  _TcpServer = nullptr;
+  if (_TcpServer != nullptr) {
+    _TcpServer->stop();
+    _TcpServer = nullptr;
+  }
+  if (_unixDomainServer != nullptr) {
+    _unixDomainServer->stop();
+    _unixDomainServer = nullptr;
+  }
+  {
+    auto lock = std::lock_guard(_tcpTransportMutex);
+    if (_tcpTransport != nullptr) {
+      _tcpTransport->stop();
+      _tcpTransport = nullptr;
+    }
+  }
+  _endpoints.clear();
   _grpcServer->Shutdown();
   _state = ServiceState::Stopped;
   return absl::OkStatus();
 }
 
+absl::StatusOr<std::shared_ptr<TcpTransport>> Server::tcpTransport() {
+  auto lock = std::lock_guard(_tcpTransportMutex);
+  if (_tcpTransport == nullptr) {
+    auto transport = TcpTransport::factory(_geds);
+    auto status = transport->start();
+    if (!status.ok()) {
+      return status;
+    }
+    _tcpTransport = std::move(transport);
+  }
+  return _tcpTransport;
+}
+
 } // namespace geds
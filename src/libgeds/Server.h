@@ -10,6 +10,7 @@
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <sys/socket.h>
@@ -23,6 +24,8 @@
 #include "FileTransferProtocol.h"
 #include "GEDSInternal.h"
 #include "TcpServer.h"
+#include "TcpTransport.h"
+#include "UnixDomainServer.h"
 
 class GEDS;
 
@@ -42,6 +45,11 @@ class Server {
   std::unique_ptr<grpc::Service> _grpcService;
   std::unique_ptr<grpc::Server> _grpcServer;
   std::unique_ptr<TcpServer> _TcpServer;
+  std::unique_ptr<UnixDomainServer> _unixDomainServer;
+
+  // Epoll engine. Serves the data path if configured and carries outgoing epoll connections.
+  std::mutex _tcpTransportMutex;
+  std::shared_ptr<TcpTransport> _tcpTransport;
 
   std::vector<std::tuple<FileTransferProtocol, std::string, uint16_t>> _endpoints;
 
@@ -60,6 +68,11 @@ public:
 
   absl::Status start(std::shared_ptr<GEDS> geds);
   absl::Status stop();
+
+  /**
+   * @brief Returns the epoll TcpTransport engine. The engine is started on first use.
+   */
+  absl::StatusOr<std::shared_ptr<TcpTransport>> tcpTransport();
 };
 
 } // namespace geds
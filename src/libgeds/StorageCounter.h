@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 
 #include "RWConcurrentObjectAdaptor.h"
@@ -23,6 +24,25 @@ struct StorageCounter : public utility::RWConcurrentObjectAdaptor {
     this->free = (used > allocated) ? 0 : allocated - used;
   }
 
+  /**
+   * @brief Account for `size` additional bytes. Fails if they do not fit into the allocation.
+   */
+  bool reserve(size_t size) {
+    auto lock = getWriteLock();
+    if (used + size > allocated) {
+      return false;
+    }
+    used += size;
+    free = allocated - used;
+    return true;
+  }
+
+  void release(size_t size) {
+    auto lock = getWriteLock();
+    used -= std::min(size, used);
+    free = (used > allocated) ? 0 : allocated - used;
+  }
+
   void updateAllocated(size_t allocated) {
     auto lock = getWriteLock();
     this->allocated = allocated;
@@ -5,6 +5,8 @@
 
 #include "TcpClient.h"
 
+#include <algorithm>
+#include <array>
 #include <cstring>
 #include <exception>
 #include <memory>
@@ -17,6 +19,7 @@
 #include <absl/status/status.h>
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/connect.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/read.hpp>
 #include <boost/asio/write.hpp>
 
@@ -28,58 +31,374 @@ using boost::asio::ip::tcp;
 
 namespace geds {
 
-TcpClient::TcpClient(std::string ip, uint16_t port) : _ip(std::move(ip)), _port(port) {}
+TcpClient::TcpClient(std::string ip, uint16_t port, uint8_t protocolVersion,
+                     size_t maxInFlight)
+    : _ip(std::move(ip)), _port(port), _protocolVersion(protocolVersion),
+      _maxInFlight(std::max<size_t>(1, maxInFlight)) {}
 
 TcpClient::~TcpClient() {
+  if (_dispatcher.joinable()) {
+    boost::asio::post(_ioContext, [this] {
+      _closing = true;
+      fail(absl::UnavailableError("Connection closed."));
+    });
+    _work.reset();
+    _dispatcher.join();
+  }
   if (!_ioContext.stopped()) {
     _ioContext.stop();
   }
 }
 
+size_t TcpClient::inFlight() {
+  auto lock = std::lock_guard(_inFlightMutex);
+  return _inFlight;
+}
+
 absl::StatusOr<size_t> TcpClient::readBytes(const std::string &bucket, const std::string &key,
                                             uint8_t *buffer, size_t position, size_t length) {
+  LOG_DEBUG("Requesting ", bucket, "/", key);
+  if (_protocolVersion >= tcp_transport::BinaryProtocolVersion) {
+    return readBytesBinary(bucket, key, buffer, position, length);
+  }
+
+  {
+    auto lock = std::lock_guard(_inFlightMutex);
+    _inFlight++;
+  }
+  auto result = readBytesText(bucket, key, buffer, position, length);
+  {
+    auto lock = std::lock_guard(_inFlightMutex);
+    _inFlight--;
+  }
+  return result;
+}
+
+absl::StatusOr<size_t> TcpClient::readBytesText(const std::string &bucket, const std::string &key,
+                                                uint8_t *buffer, size_t position, size_t length) {
+  auto lock = std::lock_guard(_textMutex);
+  if (_failed) {
+    return absl::UnavailableError("The connection to " + _ip + " failed.");
+  }
   {
-    LOG_DEBUG("Requesting ", bucket, "/", key);
     auto request = tcp_transport::createGetRequest(bucket, key, position, length);
     LOG_DEBUG("Request: ", request);
     auto sendSize = request.size() + 1;
     auto rc = boost::asio::write(*_socket, boost::asio::buffer(request.data(), sendSize));
     if (rc != sendSize) {
+      _failed = true;
       return absl::UnknownError("TcpClient sent an unexpected length!");
     }
   }
 
+  LOG_DEBUG("Waiting for response ");
+  geds::tcp_transport::Response response;
+  auto rc = boost::asio::read(*_socket, boost::asio::buffer(&response, sizeof(response)));
+  if (rc != sizeof(response)) {
+    _failed = true;
+    return absl::UnknownError("TcpClient received an invalid amount of data!");
+  }
+  auto result = readPayload(response.statusCode, response.length, buffer);
+  if (!result.ok() && result.status().code() == absl::StatusCode::kUnknown) {
+    _failed = true;
+  }
+  return result;
+}
+
+absl::StatusOr<size_t> TcpClient::readBytesBinary(const std::string &bucket,
+                                                  const std::string &key, uint8_t *buffer,
+                                                  size_t position, size_t length) {
+  auto header = tcp_transport::createRequestHeader(tcp_transport::Operation::Get, 0, bucket, key,
+                                                   position, length);
+  if (!header.ok()) {
+    return header.status();
+  }
+
+  auto request = std::make_shared<PendingRequest>();
+  request->header = *header;
+  request->bucket = bucket;
+  request->key = key;
+  request->ranges.push_back({buffer, position, length});
+  auto status = submit(request);
+  if (!status.ok()) {
+    return status;
+  }
+  return request->counts.front();
+}
+
+absl::StatusOr<std::vector<size_t>> TcpClient::readv(const std::string &bucket,
+                                                     const std::string &key,
+                                                     const std::vector<geds::ReadRange> &ranges) {
+  LOG_DEBUG("Requesting ", ranges.size(), " ranges of ", bucket, "/", key);
+  std::vector<size_t> result;
+  result.reserve(ranges.size());
+  if (_protocolVersion < tcp_transport::BinaryProtocolVersion) {
+    // The text protocol does not support vectored reads.
+    for (const auto &range : ranges) {
+      auto count = readBytes(bucket, key, range.buffer, range.position, range.length);
+      if (!count.ok()) {
+        return count.status();
+      }
+      result.push_back(*count);
+    }
+    return result;
+  }
+
+  for (size_t i = 0; i < ranges.size(); i += tcp_transport::BinaryProtocolMaxRanges) {
+    auto n = std::min(ranges.size() - i, tcp_transport::BinaryProtocolMaxRanges);
+    auto header = tcp_transport::createRequestHeader(tcp_transport::Operation::GetV, 0, bucket,
+                                                     key, 0, n);
+    if (!header.ok()) {
+      return header.status();
+    }
+    auto request = std::make_shared<PendingRequest>();
+    request->header = *header;
+    request->bucket = bucket;
+    request->key = key;
+    request->ranges.assign(ranges.begin() + i, ranges.begin() + i + n);
+    request->wireRanges.reserve(n);
+    for (const auto &range : request->ranges) {
+      request->wireRanges.push_back({range.position, range.length});
+    }
+    auto status = submit(request);
+    if (!status.ok()) {
+      return status;
+    }
+    result.insert(result.end(), request->counts.begin(), request->counts.end());
+  }
+  return result;
+}
+
+absl::Status TcpClient::submit(std::shared_ptr<PendingRequest> request) {
   {
-    LOG_DEBUG("Waiting for response ");
-    geds::tcp_transport::Response response;
-    auto rc = boost::asio::read(*_socket, boost::asio::buffer(&response, sizeof(response)));
-    if (rc != sizeof(response)) {
-      return absl::UnknownError("TcpClient received an invalid amount of data!");
+    std::unique_lock lock(_inFlightMutex);
+    _inFlightCv.wait(lock, [this] { return _inFlight < _maxInFlight || _failed; });
+    if (_failed) {
+      return absl::UnavailableError("The connection to " + _ip + " failed.");
     }
+    _inFlight++;
+  }
 
-    // Error case.
-    if (response.statusCode != absl::OkStatus().raw_code()) {
-      boost::asio::streambuf buf;
-      rc = boost::asio::read(*_socket, buf.prepare(response.length));
-      if (rc != response.length) {
-        return absl::UnknownError("TcpClient received an unexpected length!");
-      }
-      buf.commit(response.length);
+  auto future = request->promise.get_future();
+  boost::asio::post(_ioContext, [this, request] { sendRequest(request); });
+  auto status = future.get();
 
-      std::string str(boost::asio::buffers_begin(buf.data()),
-                      boost::asio::buffers_begin(buf.data()) + response.length);
-      return absl::Status(static_cast<absl::StatusCode>(response.statusCode), str);
+  {
+    auto lock = std::lock_guard(_inFlightMutex);
+    _inFlight--;
+  }
+  _inFlightCv.notify_one();
+  return status;
+}
+
+absl::StatusOr<size_t> TcpClient::readPayload(int statusCode, size_t length, uint8_t *buffer) {
+  // Error case.
+  if (statusCode != absl::OkStatus().raw_code()) {
+    boost::asio::streambuf buf;
+    auto rc = boost::asio::read(*_socket, buf.prepare(length));
+    if (rc != length) {
+      return absl::UnknownError("TcpClient received an unexpected length!");
     }
+    buf.commit(length);
 
-    if (response.length > 0) {
-      LOG_DEBUG("Reading the response ", response.length);
-      rc = boost::asio::read(*_socket, boost::asio::buffer(buffer, response.length));
-      if (rc != response.length) {
-        return absl::UnknownError("TcpClient received an unexpected length!");
-      }
+    std::string str(boost::asio::buffers_begin(buf.data()),
+                    boost::asio::buffers_begin(buf.data()) + length);
+    return absl::Status(static_cast<absl::StatusCode>(statusCode), str);
+  }
+
+  if (length > 0) {
+    LOG_DEBUG("Reading the response ", length);
+    auto rc = boost::asio::read(*_socket, boost::asio::buffer(buffer, length));
+    if (rc != length) {
+      return absl::UnknownError("TcpClient received an unexpected length!");
     }
-    return response.length;
   }
+  return length;
+}
+
+void TcpClient::sendRequest(std::shared_ptr<PendingRequest> request) {
+  if (!_connectionStatus.ok()) {
+    request->promise.set_value(_connectionStatus);
+    return;
+  }
+  auto requestId = _nextRequestId++;
+  request->header.requestId = requestId;
+  _pending.emplace(requestId, request);
+  _writeQueue.emplace_back(std::move(request));
+  writeNext();
+}
+
+void TcpClient::writeNext() {
+  if (_writing || _writeQueue.empty()) {
+    return;
+  }
+  _writing = true;
+  auto request = _writeQueue.front();
+  _writeQueue.pop_front();
+
+  std::array<boost::asio::const_buffer, 4> buffers{
+      boost::asio::buffer(&request->header, sizeof(tcp_transport::RequestHeader)),
+      boost::asio::buffer(request->bucket), boost::asio::buffer(request->key),
+      boost::asio::buffer(request->wireRanges)};
+  boost::asio::async_write(*_socket, buffers,
+                           [this, request](boost::system::error_code ec, std::size_t) {
+                             _writing = false;
+                             if (ec) {
+                               fail(absl::UnavailableError("Unable to send request: " +
+                                                           ec.message()));
+                               return;
+                             }
+                             writeNext();
+                           });
+}
+
+void TcpClient::readResponseHeader() {
+  boost::asio::async_read(
+      *_socket, boost::asio::buffer(&_responseHeader, sizeof(_responseHeader)),
+      [this](boost::system::error_code ec, std::size_t) {
+        if (ec) {
+          fail(absl::UnavailableError("Unable to read response: " + ec.message()));
+          return;
+        }
+        auto it = _pending.find(_responseHeader.requestId);
+        if (it == _pending.end()) {
+          fail(absl::UnknownError("Received response for unknown request " +
+                                  std::to_string(_responseHeader.requestId) + "."));
+          return;
+        }
+        auto status = tcp_transport::validateResponseHeader(_responseHeader, it->first);
+        if (!status.ok()) {
+          fail(status);
+          return;
+        }
+        auto request = it->second;
+        _pending.erase(it);
+        readResponsePayload(std::move(request));
+      });
+}
+
+void TcpClient::readResponsePayload(std::shared_ptr<PendingRequest> request) {
+  auto statusCode = _responseHeader.statusCode;
+  size_t length = _responseHeader.length;
+
+  // Error case.
+  if (statusCode != absl::OkStatus().raw_code()) {
+    _errorMessage.resize(length);
+    boost::asio::async_read(
+        *_socket, boost::asio::buffer(_errorMessage),
+        [this, request, statusCode](boost::system::error_code ec, std::size_t) {
+          if (ec) {
+            failRequest(request, absl::UnavailableError("Unable to read response: " +
+                                                        ec.message()));
+            return;
+          }
+          request->promise.set_value(
+              absl::Status(static_cast<absl::StatusCode>(statusCode), _errorMessage));
+          readResponseHeader();
+        });
+    return;
+  }
+
+  if (request->header.op == tcp_transport::Operation::GetV) {
+    // Read the byte counts, then scatter the payload into the buffers.
+    auto countsLength = request->ranges.size() * sizeof(uint64_t);
+    if (length < countsLength) {
+      failRequest(request, absl::UnknownError("TcpClient received an unexpected length!"));
+      return;
+    }
+    request->counts.resize(request->ranges.size());
+    boost::asio::async_read(
+        *_socket, boost::asio::buffer(request->counts),
+        [this, request, length, countsLength](boost::system::error_code ec, std::size_t) {
+          if (ec) {
+            failRequest(request, absl::UnavailableError("Unable to read response: " +
+                                                        ec.message()));
+            return;
+          }
+          std::vector<boost::asio::mutable_buffer> buffers;
+          buffers.reserve(request->ranges.size());
+          size_t total = 0;
+          for (size_t i = 0; i < request->ranges.size(); i++) {
+            if (request->counts[i] > request->ranges[i].length) {
+              failRequest(request, absl::UnknownError("TcpClient received an unexpected length!"));
+              return;
+            }
+            total += request->counts[i];
+            if (request->counts[i] > 0) {
+              buffers.emplace_back(
+                  boost::asio::buffer(request->ranges[i].buffer, request->counts[i]));
+            }
+          }
+          if (countsLength + total != length) {
+            failRequest(request, absl::UnknownError("TcpClient received an unexpected length!"));
+            return;
+          }
+          readResponseData(request, std::move(buffers));
+        });
+    return;
+  }
+
+  if (length > request->ranges.front().length) {
+    failRequest(request, absl::UnknownError("TcpClient received an unexpected length!"));
+    return;
+  }
+  request->counts = {length};
+  std::vector<boost::asio::mutable_buffer> buffers;
+  if (length > 0) {
+    buffers.emplace_back(boost::asio::buffer(request->ranges.front().buffer, length));
+  }
+  readResponseData(request, std::move(buffers));
+}
+
+void TcpClient::readResponseData(std::shared_ptr<PendingRequest> request,
+                                 std::vector<boost::asio::mutable_buffer> buffers) {
+  if (buffers.empty()) {
+    request->promise.set_value(absl::OkStatus());
+    readResponseHeader();
+    return;
+  }
+  LOG_DEBUG("Reading the response ", boost::asio::buffer_size(buffers));
+  boost::asio::async_read(*_socket, buffers,
+                          [this, request](boost::system::error_code ec, std::size_t) {
+                            if (ec) {
+                              failRequest(request, absl::UnavailableError(
+                                                       "Unable to read response: " +
+                                                       ec.message()));
+                              return;
+                            }
+                            request->promise.set_value(absl::OkStatus());
+                            readResponseHeader();
+                          });
+}
+
+void TcpClient::failRequest(std::shared_ptr<PendingRequest> request, const absl::Status &status) {
+  // The stream is out of sync: Fail the request together with the connection.
+  _pending.emplace(request->header.requestId, std::move(request));
+  fail(status);
+}
+
+void TcpClient::fail(const absl::Status &status) {
+  if (!_connectionStatus.ok()) {
+    return;
+  }
+  if (!_closing) {
+    LOG_ERROR("Connection to ", _ip, ":", _port, " failed: ", status.message());
+  }
+  _connectionStatus = status;
+  {
+    auto lock = std::lock_guard(_inFlightMutex);
+    _failed = true;
+  }
+  _inFlightCv.notify_all();
+
+  for (auto &[_, request] : _pending) {
+    request->promise.set_value(status);
+  }
+  _pending.clear();
+  _writeQueue.clear();
+
+  boost::system::error_code ec;
+  _socket->close(ec);
 }
 
 absl::Status TcpClient::connect() {
@@ -97,6 +416,13 @@ absl::Status TcpClient::connect() {
   } catch (std::exception &e) {
     return absl::UnknownError(e.what());
   }
+
+  if (_protocolVersion >= tcp_transport::BinaryProtocolVersion) {
+    // Start the completion dispatcher.
+    _work.emplace(boost::asio::make_work_guard(_ioContext));
+    readResponseHeader();
+    _dispatcher = std::thread([this] { _ioContext.run(); });
+  }
   return absl::OkStatus();
 }
 
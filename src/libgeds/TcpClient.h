@@ -5,36 +5,131 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include <absl/status/status.h>
 #include <absl/status/statusor.h>
 #include <boost/asio.hpp>
+#include <boost/asio/executor_work_guard.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
+#include "GEDSInternal.h"
 #include "TcpDataTransport.h"
 
 namespace geds {
 
 class FileTransferService;
+
+/**
+ * @brief Client side of a TCP data connection.
+ *
+ * With the binary protocol, requests are tagged with a request id and pipelined on the socket.
+ * Responses may arrive out of order and are dispatched to the waiting caller by a completion
+ * thread. The number of outstanding requests is bounded by `maxInFlight`.
+ *
+ * With the text protocol, only one request is outstanding at a time.
+ */
 class TcpClient : public std::enable_shared_from_this<TcpClient> {
 
+  struct PendingRequest {
+    tcp_transport::RequestHeader header;
+    std::string bucket;
+    std::string key;
+    // Sent after the key for vectored requests.
+    std::vector<tcp_transport::RangeRequest> wireRanges;
+    std::vector<geds::ReadRange> ranges;
+    // Bytes received per range.
+    std::vector<uint64_t> counts;
+    std::promise<absl::Status> promise;
+  };
+
   std::string _ip;
   uint16_t _port;
+  uint8_t _protocolVersion;
+  const size_t _maxInFlight;
 
   boost::asio::io_context _ioContext;
   std::unique_ptr<boost::asio::ip::tcp::socket> _socket;
+  std::optional<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> _work;
+  std::thread _dispatcher;
+
+  // Text protocol: Serializes requests.
+  std::mutex _textMutex;
+
+  // Binary protocol: Bounds the number of outstanding requests.
+  std::mutex _inFlightMutex;
+  std::condition_variable _inFlightCv;
+  size_t _inFlight = 0;
+  std::atomic<bool> _failed = false;
+
+  // Only accessed from the dispatcher thread.
+  uint64_t _nextRequestId = 0;
+  std::unordered_map<uint64_t, std::shared_ptr<PendingRequest>> _pending;
+  std::deque<std::shared_ptr<PendingRequest>> _writeQueue;
+  bool _writing = false;
+  tcp_transport::ResponseHeader _responseHeader;
+  std::string _errorMessage;
+  absl::Status _connectionStatus;
+  bool _closing = false;
 
 public:
-  TcpClient(std::string ip, uint16_t port);
+  TcpClient(std::string ip, uint16_t port,
+            uint8_t protocolVersion = tcp_transport::TextProtocolVersion,
+            size_t maxInFlight = MAXIMUM_TCP_INFLIGHT_REQUESTS());
   ~TcpClient();
 
   absl::Status connect();
 
+  uint8_t protocolVersion() const { return _protocolVersion; }
+
+  /**
+   * @brief Returns true if the connection failed and cannot be used anymore.
+   */
+  bool failed() const { return _failed; }
+
+  /**
+   * @brief Number of requests currently outstanding on this connection.
+   */
+  size_t inFlight();
+
   absl::StatusOr<size_t> readBytes(const std::string &bucket, const std::string &key,
                                    uint8_t *buffer, size_t position, size_t length);
+
+  /**
+   * @brief Read multiple ranges of an object. Uses a single request per
+   * `BinaryProtocolMaxRanges` ranges with the binary protocol.
+   */
+  absl::StatusOr<std::vector<size_t>> readv(const std::string &bucket, const std::string &key,
+                                            const std::vector<geds::ReadRange> &ranges);
+
+private:
+  absl::StatusOr<size_t> readBytesText(const std::string &bucket, const std::string &key,
+                                       uint8_t *buffer, size_t position, size_t length);
+  absl::StatusOr<size_t> readBytesBinary(const std::string &bucket, const std::string &key,
+                                         uint8_t *buffer, size_t position, size_t length);
+  absl::StatusOr<size_t> readPayload(int statusCode, size_t length, uint8_t *buffer);
+  absl::Status submit(std::shared_ptr<PendingRequest> request);
+
+  // Dispatcher thread.
+  void sendRequest(std::shared_ptr<PendingRequest> request);
+  void writeNext();
+  void readResponseHeader();
+  void readResponsePayload(std::shared_ptr<PendingRequest> request);
+  void readResponseData(std::shared_ptr<PendingRequest> request,
+                        std::vector<boost::asio::mutable_buffer> buffers);
+  void failRequest(std::shared_ptr<PendingRequest> request, const absl::Status &status);
+  void fail(const absl::Status &status);
 };
 } // namespace geds
@@ -14,6 +14,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <deque>
 #include <istream>
 #include <iterator>
 #include <memory>
@@ -26,7 +27,11 @@
 #include <absl/status/status.h>
 #include <boost/archive/binary_iarchive.hpp>
 #include <boost/archive/binary_oarchive.hpp>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/buffers_iterator.hpp>
+#include <boost/asio/completion_condition.hpp>
 #include <boost/asio/placeholders.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/read.hpp>
 #include <boost/asio/read_until.hpp>
 #include <boost/asio/write.hpp>
@@ -39,148 +44,325 @@
 
 namespace geds {
 
-TcpConnection::TcpConnection(boost::asio::ip::tcp::socket &&socket,
-                                         std::shared_ptr<GEDS> geds)
+TcpConnection::TcpConnection(boost::asio::ip::tcp::socket &&socket, std::shared_ptr<GEDS> geds,
+                             boost::asio::any_io_executor workExecutor,
+                             std::shared_ptr<IoUringSender> uring)
     : _socket(std::move(socket)), _geds(geds),
-      _strand(boost::asio::make_strand(socket.get_executor())) {
+      _strand(boost::asio::make_strand(socket.get_executor())),
+      _workExecutor(std::move(workExecutor)), _uring(std::move(uring)) {
   LOG_DEBUG("Creating connection on ", _socket.remote_endpoint().address().to_string(), ":",
             _socket.remote_endpoint().port());
 }
 
-std::shared_ptr<TcpConnection>
-TcpConnection::create(boost::asio::ip::tcp::socket &&socket, std::shared_ptr<GEDS> geds) {
-  return std::shared_ptr<TcpConnection>(new TcpConnection(std::move(socket), geds));
+std::shared_ptr<TcpConnection> TcpConnection::create(boost::asio::ip::tcp::socket &&socket,
+                                                     std::shared_ptr<GEDS> geds,
+                                                     boost::asio::any_io_executor workExecutor,
+                                                     std::shared_ptr<IoUringSender> uring) {
+  return std::shared_ptr<TcpConnection>(
+      new TcpConnection(std::move(socket), geds, std::move(workExecutor), std::move(uring)));
 }
 
 void TcpConnection::start() {
   LOG_DEBUG("Starting connection");
-  awaitRequest();
+  boost::asio::post(_strand, [self = shared_from_this()]() { self->awaitRequest(); });
 }
 
 void TcpConnection::awaitRequest() {
+  switch (_protocol) {
+  case Protocol::Unknown:
+    detectProtocol();
+    return;
+  case Protocol::Text:
+    awaitTextRequest();
+    return;
+  case Protocol::Binary:
+    awaitBinaryRequest();
+    return;
+  }
+}
+
+void TcpConnection::detectProtocol() {
+  readAtLeast(1, [self = shared_from_this()]() {
+    auto first = *static_cast<const uint8_t *>(self->_buffer.data().data());
+    self->_protocol =
+        first == tcp_transport::BinaryProtocolMagic ? Protocol::Binary : Protocol::Text;
+    LOG_DEBUG("Using ", self->_protocol == Protocol::Binary ? "binary" : "text", " protocol");
+    self->awaitRequest();
+  });
+}
+
+void TcpConnection::readAtLeast(size_t count, std::function<void()> &&callback) {
+  if (_buffer.size() >= count) {
+    callback();
+    return;
+  }
+  auto self = shared_from_this();
+  boost::asio::async_read( //
+      _socket, _buffer, boost::asio::transfer_at_least(count - _buffer.size()),
+      boost::asio::bind_executor(_strand, [self, callback = std::move(callback)](
+                                              boost::system::error_code ec,
+                                              std::size_t /* bytes_transferred */) {
+        if (ec) {
+          self->close();
+          return;
+        }
+        callback();
+      }));
+}
+
+void TcpConnection::awaitTextRequest() {
   auto self = shared_from_this();
 
   boost::asio::async_read_until( //
       _socket, _buffer, '\0',
       boost::asio::bind_executor(
-          _strand, [self](boost::system::error_code ec, std::size_t /* bytes_transferred */) {
+          _strand, [self](boost::system::error_code ec, std::size_t bytesTransferred) {
             if (ec) {
+              self->close();
               return;
             }
-            std::string requestStr((std::istreambuf_iterator<char>(&self->_buffer)),
-                                   std::istreambuf_iterator<char>());
-            self->_buffer.consume(self->_buffer.size());
+            auto begin = boost::asio::buffers_begin(self->_buffer.data());
+            std::string requestStr(begin, begin + bytesTransferred);
+            self->_buffer.consume(bytesTransferred);
             LOG_DEBUG("Request: '", requestStr, "'");
 
+            tcp_transport::RequestHeader request{};
+            request.op = tcp_transport::Operation::Get;
             std::string bucket;
             std::string key;
             size_t offset = 0;
             size_t length = 0;
             auto status = tcp_transport::parseGetRequest(requestStr, bucket, key, offset, length);
 
+            // The text protocol does not carry request ids: Requests are served one at a time.
+            self->_inFlight++;
+            self->_readPaused = true;
             if (!status.ok()) {
-              self->handleError(status);
+              self->queueResponse(self->handleError(request, status));
             } else {
-              self->handleWrite(bucket, key, offset, length);
+              request.offset = offset;
+              request.length = length;
+              self->queueResponse(self->handleRequest(request, bucket, key, {{offset, length}}));
             }
           }));
 }
 
-void TcpConnection::handleWrite(const std::string &bucket, const std::string &key,
-                                      size_t offset, size_t length) {
-  geds::tcp_transport::Response response;
-  response.statusCode = absl::OkStatus().raw_code();
-  response.length = 0;
+void TcpConnection::awaitBinaryRequest() {
+  readAtLeast(sizeof(tcp_transport::RequestHeader), [self = shared_from_this()]() {
+    tcp_transport::RequestHeader request;
+    boost::asio::buffer_copy(boost::asio::buffer(&request, sizeof(request)),
+                             self->_buffer.data());
+    auto status = tcp_transport::validateRequestHeader(request);
+    if (!status.ok()) {
+      // The stream cannot be resynchronized: Drop the connection.
+      LOG_ERROR("Received invalid request: ", status.message());
+      self->close();
+      return;
+    }
+    self->_buffer.consume(sizeof(request));
+
+    auto payloadLength = tcp_transport::requestPayloadLength(request);
+    self->readAtLeast(payloadLength, [self, request, payloadLength]() {
+      auto begin = boost::asio::buffers_begin(self->_buffer.data());
+      std::string bucket(begin, begin + request.bucketLength);
+      std::string key(begin + request.bucketLength,
+                      begin + request.bucketLength + request.keyLength);
+      std::vector<tcp_transport::RangeRequest> ranges;
+      if (request.op == tcp_transport::Operation::GetV) {
+        ranges.resize(request.length);
+        boost::asio::buffer_copy(
+            boost::asio::buffer(ranges),
+            self->_buffer.data() + (static_cast<size_t>(request.bucketLength) + request.keyLength));
+      } else {
+        ranges.push_back({request.offset, request.length});
+      }
+      self->_buffer.consume(payloadLength);
+      LOG_DEBUG("Request ", request.requestId, ": ", bucket, "/", key, " (", ranges.size(),
+                " ranges)");
+
+      // Serve the request concurrently and continue reading. Responses are written as soon as
+      // they are ready and matched by request id on the client.
+      boost::asio::post(self->_workExecutor, [self, request, bucket, key, ranges]() {
+        auto response = self->handleRequest(request, bucket, key, ranges);
+        boost::asio::post(self->_strand, [self, response]() { self->queueResponse(response); });
+      });
 
-  uint8_t *byteBuffer = nullptr;
-  auto file = _geds->open(bucket, key);
-  if (!file.ok()) {
-    LOG_DEBUG("Unable to open ", bucket, "/", key, ": ", file.status().message());
-    handleError(file.status());
+      self->_inFlight++;
+      if (self->_inFlight < MAXIMUM_TCP_INFLIGHT_REQUESTS()) {
+        self->awaitRequest();
+      } else {
+        LOG_DEBUG("Reached the maximum number of in-flight requests, pausing reads.");
+        self->_readPaused = true;
+      }
+    });
+  });
+}
+
+void TcpConnection::prepareResponse(PendingResponse &response,
+                                    const tcp_transport::RequestHeader &request, int statusCode,
+                                    size_t length) {
+  if (_protocol == Protocol::Binary) {
+    response.binaryHeader = tcp_transport::createResponseHeader(request, statusCode, length);
+    response.buffers.emplace_back(
+        boost::asio::buffer(&response.binaryHeader, sizeof(response.binaryHeader)));
     return;
   }
+  response.textHeader.statusCode = statusCode;
+  response.textHeader.length = length;
+  response.buffers.emplace_back(
+      boost::asio::buffer(&response.textHeader, sizeof(response.textHeader)));
+}
+
+std::shared_ptr<TcpConnection::PendingResponse>
+TcpConnection::handleRequest(const tcp_transport::RequestHeader &request,
+                             const std::string &bucket, const std::string &key,
+                             const std::vector<tcp_transport::RangeRequest> &ranges) {
+  auto opened = _geds->cachedOpen(bucket, key);
+  if (!opened.ok()) {
+    LOG_DEBUG("Unable to open ", bucket, "/", key, ": ", opened.status().message());
+    return handleError(request, opened.status());
+  }
+  const auto &file = *opened;
 
-  std::vector<boost::asio::const_buffer> writeArray;
-  writeArray.emplace_back(boost::asio::buffer(&response, sizeof(response)));
+  auto response = std::make_shared<PendingResponse>();
+  response->file = file;
 
-  auto self = shared_from_this();
+  // Vectored responses are prefixed with the byte count of each range.
+  bool vectored = request.op == tcp_transport::Operation::GetV;
+  auto addCounts = [&response, vectored]() {
+    if (vectored) {
+      response->buffers.emplace_back(boost::asio::buffer(response->counts));
+    }
+  };
+  auto countsLength = vectored ? ranges.size() * sizeof(uint64_t) : 0;
 
   auto rawFd = file->rawFd();
   auto rawPtr = file->rawPtr();
 
+  auto size = file->size();
+  size_t available = 0;
+  response->counts.reserve(ranges.size());
+  for (const auto &range : ranges) {
+    uint64_t count = range.offset > size ? 0 : std::min(size - range.offset, range.length);
+    response->counts.push_back(count);
+    available += count;
+  }
+
   if (rawPtr.ok()) {
-    auto size = file->size();
-    response.length = offset > size ? 0 : (std::min(size - offset, length));
-    if (offset > size) {
-      response.length = 0;
+    // Scatter-gather write straight from the mapping.
+    prepareResponse(*response, request, absl::OkStatus().raw_code(), countsLength + available);
+    addCounts();
+    for (size_t i = 0; i < ranges.size(); i++) {
+      if (response->counts[i] > 0) {
+        response->buffers.emplace_back(
+            boost::asio::buffer(&(*rawPtr)[ranges[i].offset], response->counts[i]));
+      }
+    }
+  } else if (rawFd.ok() && available > 8192) {
+    // Write header, then proceed to sendfile.
+    prepareResponse(*response, request, absl::OkStatus().raw_code(), countsLength + available);
+    addCounts();
+    response->sendfileFd = *rawFd;
+    for (size_t i = 0; i < ranges.size(); i++) {
+      if (response->counts[i] > 0) {
+        response->sendfileRanges.push_back({ranges[i].offset, response->counts[i]});
+      }
+    }
+  } else {
+    response->byteBuffer = std::unique_ptr<uint8_t[]>(new uint8_t[available]);
+    std::vector<geds::ReadRange> readRanges;
+    readRanges.reserve(ranges.size());
+    size_t offset = 0;
+    for (size_t i = 0; i < ranges.size(); i++) {
+      readRanges.push_back(
+          {response->byteBuffer.get() + offset, ranges[i].offset, response->counts[i]});
+      offset += response->counts[i];
+    }
+    auto counts = file->readv(readRanges);
+    if (!counts.ok()) {
+      return handleError(request, counts.status());
     }
-    if (response.length > 0) {
-      writeArray.emplace_back(boost::asio::buffer(&(*rawPtr)[offset], response.length));
+    available = 0;
+    for (size_t i = 0; i < ranges.size(); i++) {
+      response->counts[i] = (*counts)[i];
+      available += (*counts)[i];
     }
-  } else if (rawFd.ok() && length > 8192) {
-    int fd = *rawFd;
-    auto f = *file;
+    prepareResponse(*response, request, absl::OkStatus().raw_code(), countsLength + available);
+    addCounts();
+    for (size_t i = 0; i < ranges.size(); i++) {
+      if (response->counts[i] > 0) {
+        response->buffers.emplace_back(
+            boost::asio::buffer(readRanges[i].buffer, response->counts[i]));
+      }
+    }
+  }
+  return response;
+}
 
-    auto size = file->size();
-    length = offset > size ? 0 : (std::min(size - offset, length));
-    response.length = length;
-    // Write header, then proceed to sendfile.
-    boost::asio::async_write( //
-        _socket, writeArray,  //
-        [self, &writeArray, &response, f, fd, offset, length](boost::system::error_code ec,
-                                                              std::size_t /* length */) {
-          if (ec) {
-            LOG_ERROR("Error during write of ", f.identifier(), ": ", ec);
-            return;
-          }
+std::shared_ptr<TcpConnection::PendingResponse>
+TcpConnection::handleError(const tcp_transport::RequestHeader &request,
+                           const absl::Status &status) {
+  LOG_DEBUG(status.message());
 
-          (void)writeArray;
-          (void)response;
+  auto response = std::make_shared<PendingResponse>();
+  response->errorMessage = std::string{status.message()};
+  prepareResponse(*response, request, status.raw_code(), response->errorMessage.size());
+  response->buffers.emplace_back(
+      boost::asio::buffer(response->errorMessage.data(), response->errorMessage.size()));
+  return response;
+}
 
-          int64_t off = offset;
-          size_t count = length;
-          self->handleWriteSendfile(f, fd, off, count);
-        });
+void TcpConnection::queueResponse(std::shared_ptr<PendingResponse> response) {
+  if (_closed) {
     return;
-  } else {
-    byteBuffer = new uint8_t[length];
-    auto size = file->read(byteBuffer, offset, length);
-    if (!size.ok()) {
-      handleError(size.status());
-      return;
-    }
-    response.length = *size;
-    if (*size) {
-      writeArray.emplace_back(boost::asio::buffer(byteBuffer, *size));
-    }
   }
+  _writeQueue.emplace_back(std::move(response));
+  writeNext();
+}
 
-  LOG_DEBUG("Sending payload ", response.length);
-  // Note: buffer, file need to be captured by the lambda.
-  boost::asio::async_write( //
-      _socket, writeArray,  //
-      [self, &writeArray, byteBuffer, &response, file](boost::system::error_code ec,
-                                                       std::size_t /* length */) {
-        if (byteBuffer) {
-          delete[] byteBuffer;
-        }
-        if (ec) {
-          LOG_ERROR("Error during write of ", file->identifier(), ": ", ec);
-          return;
-        }
-        (void)response;
-        (void)writeArray;
+void TcpConnection::writeNext() {
+  if (_writing || _closed || _writeQueue.empty()) {
+    return;
+  }
+  _writing = true;
+  auto response = _writeQueue.front();
+  _writeQueue.pop_front();
 
-        LOG_DEBUG("Finished writing");
-        self->awaitRequest();
-      });
+  auto self = shared_from_this();
+  boost::asio::async_write( //
+      _socket, response->buffers,
+      boost::asio::bind_executor(
+          _strand, [self, response](boost::system::error_code ec, std::size_t /* length */) {
+            if (ec) {
+              LOG_ERROR("Error during write",
+                        response->file != nullptr ? " of " + response->file->identifier() : "",
+                        ": ", ec);
+              self->close();
+              return;
+            }
+            if (!response->sendfileRanges.empty()) {
+              self->handleWriteSendfile(response);
+              return;
+            }
+            LOG_DEBUG("Finished writing");
+            self->finishResponse();
+          }));
 }
 
-void TcpConnection::handleWriteSendfile(GEDSFile file, int fd, int64_t offset, size_t count) {
-  LOG_DEBUG("Sending ", file.identifier(), " [", offset, "](", count, ")");
+void TcpConnection::handleWriteSendfile(std::shared_ptr<PendingResponse> response) {
+  while (!response->sendfileRanges.empty() && response->sendfileRanges.front().length == 0) {
+    response->sendfileRanges.pop_front();
+  }
+  if (response->sendfileRanges.empty()) {
+    finishResponse();
+    return;
+  }
+  LOG_DEBUG("Sending ", response->file->identifier(), " [",
+            response->sendfileRanges.front().offset, "](",
+            response->sendfileRanges.front().length, ")");
 
-  if (count == 0) {
-    awaitRequest();
+  if (_uring) {
+    handleWriteUring(std::move(response));
     return;
   }
 
@@ -188,56 +370,100 @@ void TcpConnection::handleWriteSendfile(GEDSFile file, int fd, int64_t offset, s
   // Check if buffer is writable.
   _socket.async_write_some(
       boost::asio::null_buffers(),
-      [self, file, fd, offset, count](boost::system::error_code ec, std::size_t /* length*/) {
-        if (ec) {
-          LOG_ERROR("Error during write of ", file.identifier(), ": sendfile ", ec);
-          return;
-        }
+      boost::asio::bind_executor(
+          _strand, [self, response](boost::system::error_code ec, std::size_t /* length*/) {
+            if (ec) {
+              LOG_ERROR("Error during write of ", response->file->identifier(), ": sendfile ",
+                        ec);
+              self->close();
+              return;
+            }
 
-        int64_t off = offset;
-        ssize_t sent = 0;
-        do {
-          sent = sendfile64(self->_socket.native_handle(), fd, &off, count);
-        } while (sent < 0 && errno == EINTR);
-        if (sent < 0) {
-          int err = errno;
-          if (err != EWOULDBLOCK) {
-            LOG_ERROR("Error during sendfile of ", file.identifier(), ": ", strerror(err));
+            auto &range = response->sendfileRanges.front();
+            int64_t off = range.offset;
+            ssize_t sent = 0;
+            do {
+              sent = sendfile64(self->_socket.native_handle(), response->sendfileFd, &off,
+                                range.length);
+            } while (sent < 0 && errno == EINTR);
+            if (sent < 0) {
+              int err = errno;
+              if (err != EWOULDBLOCK) {
+                LOG_ERROR("Error during sendfile of ", response->file->identifier(), ": ",
+                          strerror(err));
+                self->close();
+                return;
+              }
+              sent = 0;
+            } else if (sent == 0) {
+              // The file has been truncated in the meantime: The stream cannot be completed.
+              LOG_ERROR("Unexpected EOF during sendfile of ", response->file->identifier());
+              self->close();
+              return;
+            }
+            range.offset += sent;
+            range.length -= sent;
+            self->handleWriteSendfile(response);
+          }));
+}
+
+void TcpConnection::handleWriteUring(std::shared_ptr<PendingResponse> response) {
+  auto self = shared_from_this();
+  const auto &range = response->sendfileRanges.front();
+  _uringSending = true;
+  _uring->sendfile(
+      _socket.native_handle(), response->sendfileFd, range.offset, range.length,
+      [self, response](absl::StatusOr<size_t> sent) {
+        // Invoked on the io_uring thread.
+        boost::asio::post(self->_strand, [self, response, sent = std::move(sent)]() {
+          self->_uringSending = false;
+          if (self->_closed) {
+            boost::system::error_code ec;
+            self->_socket.close(ec);
             return;
           }
-          sent = 0;
-        }
-        self->handleWriteSendfile(file, fd, offset + sent, count - sent);
+          if (!sent.ok()) {
+            LOG_ERROR("Error during write of ", response->file->identifier(), ": io_uring ",
+                      sent.status().message());
+            self->close();
+            return;
+          }
+          auto &range = response->sendfileRanges.front();
+          if (*sent < range.length) {
+            // The file has been truncated in the meantime: The stream cannot be completed.
+            LOG_ERROR("Unexpected EOF during io_uring send of ", response->file->identifier());
+            self->close();
+            return;
+          }
+          response->sendfileRanges.pop_front();
+          self->handleWriteSendfile(response);
+        });
       });
 }
 
-void TcpConnection::handleError(const absl::Status &status) {
-  LOG_DEBUG(status.message());
-
-  geds::tcp_transport::Response response;
-  response.statusCode = status.raw_code();
-  response.length = status.message().size();
-  std::string errorMessage = std::string{status.message()};
-
-  auto buffers = std::vector<boost::asio::const_buffer>();
-  buffers.emplace_back(boost::asio::buffer(&response, sizeof(response)));
-  buffers.emplace_back(boost::asio::buffer(errorMessage.data(), errorMessage.size()));
+void TcpConnection::finishResponse() {
+  _writing = false;
+  _inFlight--;
+  if (_readPaused && !_closed) {
+    _readPaused = false;
+    awaitRequest();
+  }
+  writeNext();
+}
 
-  LOG_DEBUG("Sending payload ", response.length);
-  auto self = shared_from_this();
-  boost::asio::async_write( //
-      _socket, buffers,     //
-      [self, &buffers, &errorMessage, &response](boost::system::error_code ec, std::size_t) {
-        if (ec) {
-          LOG_ERROR("Error during write: ", ec);
-          return;
-        }
-        (void)response;
-        (void)buffers;
-        (void)errorMessage;
-        LOG_DEBUG("Finished writing");
-        self->awaitRequest();
-      });
+void TcpConnection::close() {
+  if (_closed) {
+    return;
+  }
+  _closed = true;
+  _writeQueue.clear();
+  boost::system::error_code ec;
+  if (_uringSending) {
+    // Keep the descriptor alive until the io_uring transfer has completed, but make it fail fast.
+    _socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+    return;
+  }
+  _socket.close(ec);
 }
 
 } // namespace geds
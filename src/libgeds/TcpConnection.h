@@ -10,7 +10,11 @@
 #include <boost/asio/any_io_executor.hpp>
 #include <boost/asio/strand.hpp>
 #include <cstddef>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
 #include <absl/status/status.h>
@@ -20,29 +24,86 @@
 #include <boost/bind/bind.hpp>
 
 #include "GEDSFile.h"
+#include "IoUringSender.h"
 
 class GEDS;
 
 namespace geds {
 class TcpConnection : public std::enable_shared_from_this<TcpConnection> {
 
+  /**
+   * @brief A response which is queued for writing. Owns all memory referenced by `buffers`.
+   */
+  struct PendingResponse {
+    tcp_transport::Response textHeader;
+    tcp_transport::ResponseHeader binaryHeader;
+    std::vector<boost::asio::const_buffer> buffers;
+    std::string errorMessage;
+    std::vector<uint64_t> counts;
+    std::unique_ptr<uint8_t[]> byteBuffer;
+    std::shared_ptr<GEDSFile> file;
+
+    // Payload which is sent with sendfile after `buffers` have been written.
+    int sendfileFd = -1;
+    std::deque<tcp_transport::RangeRequest> sendfileRanges;
+  };
+
+  enum class Protocol { Unknown, Text, Binary };
+  Protocol _protocol = Protocol::Unknown;
+
   boost::asio::ip::tcp::socket _socket;
   std::shared_ptr<GEDS> _geds;
 
   boost::asio::strand<boost::asio::any_io_executor> _strand;
+  // Executor used to process binary requests concurrently.
+  boost::asio::any_io_executor _workExecutor;
+  // Sends file payloads if set. Falls back to sendfile otherwise.
+  std::shared_ptr<IoUringSender> _uring;
+
+  // The following members are only accessed from `_strand`.
+  boost::asio::streambuf _buffer;
+  std::deque<std::shared_ptr<PendingResponse>> _writeQueue;
+  bool _writing = false;
+  bool _readPaused = false;
+  bool _closed = false;
+  // The socket is referenced by an io_uring transfer and must not be closed yet.
+  bool _uringSending = false;
+  size_t _inFlight = 0;
 
-  TcpConnection(boost::asio::ip::tcp::socket &&socket, std::shared_ptr<GEDS> geds);
+  TcpConnection(boost::asio::ip::tcp::socket &&socket, std::shared_ptr<GEDS> geds,
+                boost::asio::any_io_executor workExecutor, std::shared_ptr<IoUringSender> uring);
 
   void awaitRequest();
-  void handleWrite(const std::string &bucket, const std::string &key, size_t offset, size_t length);
-  void handleWriteSendfile(GEDSFile file, int fd, int64_t offset, size_t count);
-  void handleError(const absl::Status &status);
+  void detectProtocol();
+  void awaitTextRequest();
+  void awaitBinaryRequest();
+  void readAtLeast(size_t count, std::function<void()> &&callback);
 
-  boost::asio::streambuf _buffer;
+  std::shared_ptr<PendingResponse>
+  handleRequest(const tcp_transport::RequestHeader &request, const std::string &bucket,
+                const std::string &key, const std::vector<tcp_transport::RangeRequest> &ranges);
+  std::shared_ptr<PendingResponse> handleError(const tcp_transport::RequestHeader &request,
+                                               const absl::Status &status);
+
+  /**
+   * @brief Enqueue the response for writing. Responses are written in the order they are
+   * enqueued, which is not necessarily the order of the requests.
+   */
+  void queueResponse(std::shared_ptr<PendingResponse> response);
+  void writeNext();
+  void handleWriteSendfile(std::shared_ptr<PendingResponse> response);
+  void handleWriteUring(std::shared_ptr<PendingResponse> response);
+  void finishResponse();
+  void close();
+
+  void prepareResponse(PendingResponse &response, const tcp_transport::RequestHeader &request,
+                       int statusCode, size_t length);
 
 public:
   static std::shared_ptr<TcpConnection> create(boost::asio::ip::tcp::socket &&socket,
-                                                     std::shared_ptr<GEDS> geds);
+                                               std::shared_ptr<GEDS> geds,
+                                               boost::asio::any_io_executor workExecutor,
+                                               std::shared_ptr<IoUringSender> uring = nullptr);
 
   boost::asio::ip::tcp::socket &socket() { return _socket; }
 
@@ -5,6 +5,7 @@
 
 #include "TcpDataTransport.h"
 
+#include <cstring>
 #include <regex>
 #include <string>
 
@@ -15,6 +16,8 @@ size_t MAXIMUM_TCP_THREADS() {
   return std::min<size_t>(8, std::thread::hardware_concurrency() * 2);
 }
 
+size_t MAXIMUM_TCP_INFLIGHT_REQUESTS() { return 64; }
+
 namespace tcp_transport {
 absl::StatusOr<RequestType> parseRequestType(const std::string &message) {
   if (message.starts_with("GET")) {
@@ -49,5 +52,124 @@ std::string createGetRequest(const std::string &bucket, const std::string &key,
   return ss.str();
 }
 
+absl::StatusOr<RequestHeader> createRequestHeader(Operation op, uint64_t requestId,
+                                                  const std::string &bucket, const std::string &key,
+                                                  size_t offset, size_t length) {
+  if (bucket.size() > UINT16_MAX) {
+    return absl::InvalidArgumentError("Bucket name " + bucket + " is too long.");
+  }
+  if (key.size() > BinaryProtocolMaxKeyLength) {
+    return absl::InvalidArgumentError("Key " + key + " is too long.");
+  }
+  RequestHeader header{};
+  header.magic = BinaryProtocolMagic;
+  header.version = BinaryProtocolVersion;
+  header.op = op;
+  header.keyLength = static_cast<uint32_t>(key.size());
+  header.requestId = requestId;
+  header.offset = offset;
+  header.length = length;
+  header.bucketLength = static_cast<uint16_t>(bucket.size());
+  return header;
+}
+
+absl::Status validateRequestHeader(const RequestHeader &header,
+                                   std::initializer_list<Operation> operations) {
+  if (header.magic != BinaryProtocolMagic) {
+    return absl::InvalidArgumentError("Invalid magic in request header.");
+  }
+  if (header.version != BinaryProtocolVersion) {
+    return absl::InvalidArgumentError("Unsupported protocol version " +
+                                      std::to_string(header.version) + ".");
+  }
+  if (std::find(operations.begin(), operations.end(), header.op) == operations.end()) {
+    return absl::InvalidArgumentError("Invalid operation " +
+                                      std::to_string(static_cast<int>(header.op)) + ".");
+  }
+  if (header.bucketLength == 0 || header.keyLength == 0) {
+    return absl::InvalidArgumentError("Empty bucket or key.");
+  }
+  if (header.keyLength > BinaryProtocolMaxKeyLength) {
+    return absl::InvalidArgumentError("Key length " + std::to_string(header.keyLength) +
+                                      " exceeds the maximum.");
+  }
+  if (header.op == Operation::GetV &&
+      (header.length == 0 || header.length > BinaryProtocolMaxRanges)) {
+    return absl::InvalidArgumentError("Invalid number of ranges " +
+                                      std::to_string(header.length) + ".");
+  }
+  return absl::OkStatus();
+}
+
+size_t requestPayloadLength(const RequestHeader &header) {
+  size_t length = static_cast<size_t>(header.bucketLength) + header.keyLength;
+  if (header.op == Operation::GetV) {
+    length += header.length * sizeof(RangeRequest);
+  }
+  return length;
+}
+
+ResponseHeader createResponseHeader(const RequestHeader &request, int statusCode, size_t length) {
+  ResponseHeader header{};
+  header.magic = BinaryProtocolMagic;
+  header.version = BinaryProtocolVersion;
+  header.op = request.op;
+  header.statusCode = statusCode;
+  header.requestId = request.requestId;
+  header.length = length;
+  return header;
+}
+
+absl::Status validateResponseHeader(const ResponseHeader &header, uint64_t requestId) {
+  if (header.magic != BinaryProtocolMagic || header.version != BinaryProtocolVersion) {
+    return absl::UnknownError("Invalid response header.");
+  }
+  if (header.requestId != requestId) {
+    return absl::UnknownError("Unexpected response for request " +
+                              std::to_string(header.requestId) + " (expected " +
+                              std::to_string(requestId) + ").");
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::string> createBinaryGetRequest(uint64_t requestId, const std::string &bucket,
+                                                   const std::string &key, size_t position,
+                                                   size_t length) {
+  auto header = createRequestHeader(Operation::Get, requestId, bucket, key, position, length);
+  if (!header.ok()) {
+    return header.status();
+  }
+  std::string frame;
+  frame.reserve(sizeof(RequestHeader) + bucket.size() + key.size());
+  frame.append(reinterpret_cast<const char *>(&(*header)), sizeof(RequestHeader));
+  frame.append(bucket);
+  frame.append(key);
+  return frame;
+}
+
+absl::Status parseBinaryGetRequest(std::string_view frame, uint64_t &requestId,
+                                   std::string &bucket, std::string &key, size_t &position,
+                                   size_t &length) {
+  if (frame.size() < sizeof(RequestHeader)) {
+    return absl::InvalidArgumentError("Frame is too short.");
+  }
+  RequestHeader header;
+  std::memcpy(&header, frame.data(), sizeof(RequestHeader));
+  auto status = validateRequestHeader(header, {Operation::Get});
+  if (!status.ok()) {
+    return status;
+  }
+  auto payload = frame.substr(sizeof(RequestHeader));
+  if (payload.size() != static_cast<size_t>(header.bucketLength) + header.keyLength) {
+    return absl::InvalidArgumentError("Frame length does not match the header.");
+  }
+  requestId = header.requestId;
+  bucket = payload.substr(0, header.bucketLength);
+  key = payload.substr(header.bucketLength);
+  position = header.offset;
+  length = header.length;
+  return absl::OkStatus();
+}
+
 } // namespace tcp_transport
 } // namespace geds
@@ -7,6 +7,10 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
@@ -20,6 +24,11 @@ namespace geds {
 
 size_t MAXIMUM_TCP_THREADS();
 
+/**
+ * @brief Maximum number of outstanding requests on a single TCP connection (binary protocol).
+ */
+size_t MAXIMUM_TCP_INFLIGHT_REQUESTS();
+
 namespace tcp_transport {
 
 enum class RequestType { GET };
@@ -36,5 +45,86 @@ struct Response {
   size_t length;
 };
 
+/**
+ * @brief Binary framed protocol.
+ *
+ * A binary request consists of a fixed size `RequestHeader` followed by `bucketLength` bytes of
+ * bucket name and `keyLength` bytes of key. The server replies with a `ResponseHeader` followed by
+ * `length` bytes of payload (or of error message if `statusCode` is not OK). All fields are in host
+ * byte order.
+ *
+ * The first byte of every frame is `BinaryProtocolMagic`, which can never be the first byte of a
+ * text request. This allows the server to detect the protocol of a connection on the first byte.
+ *
+ * `GetV` requests read multiple ranges of the same object: `length` holds the number of ranges
+ * and the key is followed by `length` `RangeRequest` entries. The response payload consists of
+ * one `uint64_t` byte count per range followed by the data of all ranges.
+ *
+ * `Open` is only served on Unix domain sockets (see UnixDomainTransport.h).
+ */
+constexpr uint8_t BinaryProtocolMagic = 0xB1;
+constexpr uint8_t TextProtocolVersion = 0;
+constexpr uint8_t BinaryProtocolVersion = 1;
+constexpr size_t BinaryProtocolMaxKeyLength = 64 * 1024;
+constexpr size_t BinaryProtocolMaxRanges = 1024;
+
+enum class Operation : uint8_t { Get = 1, GetV = 2, Open = 3 };
+
+struct RangeRequest {
+  uint64_t offset;
+  uint64_t length;
+};
+static_assert(sizeof(RangeRequest) == 16);
+
+struct RequestHeader {
+  uint8_t magic;
+  uint8_t version;
+  Operation op;
+  uint8_t reserved;
+  uint32_t keyLength;
+  uint64_t requestId;
+  uint64_t offset;
+  uint64_t length;
+  uint16_t bucketLength;
+  uint16_t reserved2[3];
+};
+static_assert(sizeof(RequestHeader) == 40);
+
+struct ResponseHeader {
+  uint8_t magic;
+  uint8_t version;
+  Operation op;
+  uint8_t reserved;
+  int32_t statusCode;
+  uint64_t requestId;
+  uint64_t length;
+};
+static_assert(sizeof(ResponseHeader) == 24);
+
+absl::StatusOr<RequestHeader> createRequestHeader(Operation op, uint64_t requestId,
+                                                  const std::string &bucket, const std::string &key,
+                                                  size_t offset, size_t length);
+absl::Status validateRequestHeader(const RequestHeader &header,
+                                   std::initializer_list<Operation> operations = {
+                                       Operation::Get, Operation::GetV});
+
+/**
+ * @brief Number of bytes following the request header.
+ */
+size_t requestPayloadLength(const RequestHeader &header);
+
+ResponseHeader createResponseHeader(const RequestHeader &request, int statusCode, size_t length);
+absl::Status validateResponseHeader(const ResponseHeader &header, uint64_t requestId);
+
+/**
+ * @brief Serialize a binary GET frame (header + bucket + key).
+ */
+absl::StatusOr<std::string> createBinaryGetRequest(uint64_t requestId, const std::string &bucket,
+                                                   const std::string &key, size_t position,
+                                                   size_t length);
+absl::Status parseBinaryGetRequest(std::string_view frame, uint64_t &requestId,
+                                   std::string &bucket, std::string &key, size_t &position,
+                                   size_t &length);
+
 } // namespace tcp_transport
 }; // namespace geds
@@ -25,6 +25,14 @@ absl::Status TcpServer::start() {
     return absl::UnknownError("Already started!");
   }
 
+  auto uring = IoUringSender::factory();
+  if (uring.ok()) {
+    _uring = std::move(*uring);
+    LOG_INFO("Sending files with io_uring.");
+  } else {
+    LOG_INFO("Sending files with sendfile: ", uring.status().message());
+  }
+
   accept();
   for (size_t i = 0; i < MAXIMUM_TCP_THREADS(); i++) {
     _threads.emplace_back(std::thread([&] { _ioService.run(); }));
@@ -41,6 +49,9 @@ void TcpServer::stop() {
   for (auto &t : _threads) {
     t.join();
   }
+  if (_uring) {
+    _uring->stop();
+  }
 }
 
 void TcpServer::accept() {
@@ -54,7 +65,8 @@ void TcpServer::accept() {
           return;
         } else {
           LOG_DEBUG("Accepting connection");
-          auto connection = TcpConnection::create(std::move(socket), _geds);
+          auto connection =
+              TcpConnection::create(std::move(socket), _geds, _ioService.get_executor(), _uring);
           connection->start();
         }
         accept();
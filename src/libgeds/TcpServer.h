@@ -18,6 +18,7 @@
 #include <thread>
 #include <vector>
 
+#include "IoUringSender.h"
 #include "RWConcurrentObjectAdaptor.h"
 #include "TcpConnection.h"
 
@@ -30,6 +31,7 @@ class TcpServer : public utility::RWConcurrentObjectAdaptor {
   std::shared_ptr<GEDS> _geds;
 
   std::vector<std::thread> _threads;
+  std::shared_ptr<IoUringSender> _uring;
 
 public:
   const uint16_t port;
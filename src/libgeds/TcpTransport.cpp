@@ -8,15 +8,18 @@
 #include <asm-generic/errno-base.h>
 #include <asm-generic/errno.h>
 #include <asm-generic/socket.h>
-#include <aws/common/thread.h>
+#include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <fcntl.h>
 #include <functional>
 #include <future>
 #include <memory>
 #include <mutex>
+#include <netinet/tcp.h>
 #include <pthread.h>
 #include <shared_mutex>
 #include <string>
@@ -39,54 +42,171 @@
 #include "TcpTransport.h"
 
 constexpr size_t MIN_SENDFILE_SIZE = 4096;
-constexpr size_t BUFFER_ALIGNMENT = 32;
 
 namespace geds {
 
+/**
+ * @brief Receive up to `len` bytes. Returns the number of bytes received, `-EAGAIN` if the
+ * socket is drained, or a negative errno on failure. An orderly shutdown of the peer is
+ * reported as `-ECONNRESET`.
+ */
+static ssize_t recvSome(int sock, void *buffer, size_t len) {
+  auto rv = ::recv(sock, buffer, len, 0);
+  if (rv > 0) {
+    return rv;
+  }
+  if (rv == 0) {
+    return -ECONNRESET;
+  }
+  if (errno == EWOULDBLOCK || errno == EAGAIN) {
+    return -EAGAIN;
+  }
+  return errno ? -errno : -EIO;
+}
+
+static int toErrno(const absl::Status &status) {
+  switch (status.code()) {
+  case absl::StatusCode::kOk:
+    return 0;
+  case absl::StatusCode::kNotFound:
+    return ENOENT;
+  case absl::StatusCode::kInvalidArgument:
+  case absl::StatusCode::kOutOfRange:
+    return EINVAL;
+  default:
+    return EIO;
+  }
+}
+
+static absl::Status fromErrno(int error, const std::string &message) {
+  auto reason = message + ": " + strerror(error);
+  switch (error) {
+  case ENOENT:
+    return absl::NotFoundError(reason);
+  case EINVAL:
+    return absl::InvalidArgumentError(reason);
+  default:
+    return absl::UnknownError(reason);
+  }
+}
+
 TcpTransport::TcpTransport(std::shared_ptr<GEDS> geds) : _geds(geds) {}
 
-TcpTransport::~TcpTransport() { isServing = false; }
+TcpTransport::~TcpTransport() {
+  if (isServing) {
+    stop();
+  }
+}
 
-void TcpTransport::start() {
+absl::Status TcpTransport::start() {
   if (isServing) {
-    LOG_ERROR("TCP service already started");
-    return;
+    return absl::FailedPreconditionError("TCP service already started");
   }
 
-  u_int64_t registers[4]; // NOLINT
-  __asm__ __volatile__("cpuid "
-                       : "=a"(registers[0]), "=b"(registers[1]), "=c"(registers[2]),
-                         "=d"(registers[3])
-                       : "a"(1), "c"(0));
-  bool hyperthreading = registers[3] & (1 << 28); // NOLINT
-  num_proc = std::thread::hardware_concurrency();
-  if (hyperthreading)
-    num_proc /= 2;
-
-  num_proc = std::min(num_proc, MAX_IO_THREADS);
-  isServing = true;
+  num_proc = std::clamp(std::thread::hardware_concurrency(), 1U, MAX_IO_THREADS);
 
   /*
    * Create eventfd to be integrated into epoll interest list for RX and TX
    * threads. Writing to it will wakeup epoll_wait() if no other fd available
    * or active
    */
-  eventFd = eventfd(0, 0);
+  eventFd = eventfd(0, EFD_CLOEXEC);
+  if (eventFd < 0) {
+    return absl::UnknownError("Unable to create eventfd: " + std::string{strerror(errno)});
+  }
+  for (unsigned int id = 0; id < num_proc; id++) {
+    epoll_rfd[id] = ::epoll_create1(EPOLL_CLOEXEC);
+    epoll_wfd[id] = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_rfd[id] < 0 || epoll_wfd[id] < 0) {
+      auto message = "Unable to create epoll instance: " + std::string{strerror(errno)};
+      for (unsigned int i = 0; i <= id; i++) {
+        ::close(epoll_rfd[i]);
+        ::close(epoll_wfd[i]);
+      }
+      ::close(eventFd);
+      eventFd = -1;
+      return absl::UnknownError(message);
+    }
+  }
+  isServing = true;
 
-  for (unsigned int id = 0; id < MAX_IO_THREADS; id++) {
+  for (unsigned int id = 0; id < num_proc; id++) {
     txThreads.push_back(std::make_unique<std::thread>([this, id] { this->tcpTxThread(id); }));
     rxThreads.push_back(std::make_unique<std::thread>([this, id] { this->tcpRxThread(id); }));
-    _buffers.push(new (std::align_val_t(BUFFER_ALIGNMENT)) uint8_t[MIN_SENDFILE_SIZE]);
+    _buffers.push(new uint8_t[MIN_SENDFILE_SIZE]);
   }
   ioStatsThread = std::make_unique<std::thread>([this] { this->updateIoStats(); });
 
-  LOG_DEBUG("TCP service started");
+  LOG_DEBUG("TCP service started with ", num_proc, " I/O threads");
+  return absl::OkStatus();
+}
+
+absl::Status TcpTransport::listen(uint16_t port) {
+  if (!isServing) {
+    return absl::FailedPreconditionError("TCP service not started");
+  }
+  if (listenFd >= 0) {
+    return absl::FailedPreconditionError("TCP service already listening on " +
+                                         std::to_string(listenPort));
+  }
+  int sock = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (sock < 0) {
+    return absl::UnknownError("Cannot create socket: " + std::string{strerror(errno)});
+  }
+  int yes = 1;
+  (void)::setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes);
+
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  socklen_t addrlen = sizeof addr;
+  if (::bind(sock, reinterpret_cast<sockaddr *>(&addr), addrlen) != 0 ||
+      ::listen(sock, SOMAXCONN) != 0 ||
+      ::getsockname(sock, reinterpret_cast<sockaddr *>(&addr), &addrlen) != 0) {
+    auto message = "Cannot listen on port " + std::to_string(port) + ": " + strerror(errno);
+    ::close(sock);
+    return absl::UnavailableError(message);
+  }
+  listenFd = sock;
+  listenPort = ntohs(addr.sin_port);
+  listenThread = std::make_unique<std::thread>([this] { this->acceptThread(); });
+  LOG_INFO("TCP transport listening on port ", listenPort);
+  return absl::OkStatus();
+}
+
+void TcpTransport::acceptThread() {
+  while (isServing) {
+    int sock = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (sock < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      if (isServing) {
+        LOG_ERROR("TCP transport accept failed: ", strerror(errno));
+      }
+      break;
+    }
+    if (!addEndpointPassive(sock)) {
+      ::close(sock);
+    }
+  }
+  LOG_DEBUG("TCP accept thread exiting");
 }
 
 void TcpTransport::stop() {
   LOG_DEBUG("Stopping TCP Service");
   isServing = false;
 
+  if (listenFd >= 0) {
+    // Unblocks accept().
+    ::shutdown(listenFd, SHUT_RDWR);
+    listenThread->join();
+    listenThread = nullptr;
+    ::close(listenFd);
+    listenFd = -1;
+  }
+
   if (eventFd > 0) {
     u_int64_t buf = 1;
     LOG_DEBUG("TCP Transport: write CTL fd");
@@ -94,20 +214,23 @@ void TcpTransport::stop() {
       perror("TCP Transport writing control socket failed: ");
   }
 
-  std::vector<std::shared_ptr<TcpPeer>> tcpPeerV;
-  tcpPeers.forall([&tcpPeerV](std::shared_ptr<TcpPeer> &tp) { tcpPeerV.push_back(tp); });
-  for (auto &ep : tcpPeerV)
-    ep->cleanup();
-
   for (auto &t : txThreads)
     t->join();
 
   for (auto &t : rxThreads)
     t->join();
 
-  // Introduces a performance regression in the I/O Benchmark.
-  // ioStatsThread->join();
-  // ioStatsThread = nullptr;
+  // Close all sockets and fail outstanding requests once the I/O threads are gone.
+  std::vector<std::shared_ptr<TcpPeer>> tcpPeerV;
+  tcpPeers.forall([&tcpPeerV](std::shared_ptr<TcpPeer> &tp) { tcpPeerV.push_back(tp); });
+  for (auto &ep : tcpPeerV)
+    ep->cleanup();
+
+  if (ioStatsThread != nullptr) {
+    ioStatsCv.notify_all();
+    ioStatsThread->join();
+    ioStatsThread = nullptr;
+  }
 
   tcpPeers.clear();
   txThreads.clear();
@@ -119,7 +242,7 @@ void TcpTransport::stop() {
   }
   if (eventFd > 0)
     close(eventFd);
-  
+
   eventFd = -1;
   LOG_DEBUG("TCP Transport stopped");
 }
@@ -134,6 +257,7 @@ void TcpPeer::cleanup() {
   for (auto &endpoint : endpoints) {
     auto tep = endpoint.second;
     shutdown(tep->sock, SHUT_RDWR);
+    close(tep->sock);
     LOG_DEBUG("Endpoint shutdown: socket: ", tep->sock, " sent: ", tep->tx_bytes,
               " received: ", tep->rx_bytes);
   }
@@ -141,7 +265,7 @@ void TcpPeer::cleanup() {
 
   if (recvQueue.size()) {
     LOG_ERROR("Recv Queue not empty for TcpPeer: Removing tasks from recv queue");
-    auto &stats = (*sendQueue_stats);
+    auto &stats = (*recvQueue_stats);
 
     recvQueue.remove([&stats](const uint64_t, std::shared_ptr<SocketRecvWork> &work) {
       work->p->set_value(absl::UnavailableError("TcpPeer closed"));
@@ -225,6 +349,7 @@ bool TcpPeer::processEndpointSend(std::shared_ptr<TcpEndpoint> tep) {
       ctx->hdr.error = work->error;
       ctx->va = work->va;
       ctx->in_fd = work->in_fd;
+      ctx->payload = std::move(work->payload);
       ctx->progress = 0;
     }
     if (ctx->state == PROC_HDR) {
@@ -267,17 +392,19 @@ bool TcpPeer::processEndpointSend(std::shared_ptr<TcpEndpoint> tep) {
      * If error is signalled back, no data are included.
      */
     if (ctx->hdr.type != GET_REPLY || ctx->hdr.error) {
+      ctx->payload = nullptr;
       ctx->state = PROC_IDLE;
       continue;
     }
     data_to_send = ctx->hdr.datalen - ctx->progress;
     if (!data_to_send) {
+      ctx->payload = nullptr;
       ctx->state = PROC_IDLE;
       continue;
     }
     ctx->state = PROC_DATA;
 
-    if (ctx->in_fd > 0) {
+    if (ctx->in_fd >= 0) {
       /*
        * use sendfile() for sending data
        */
@@ -294,15 +421,10 @@ bool TcpPeer::processEndpointSend(std::shared_ptr<TcpEndpoint> tep) {
       iov[0].iov_base = &vap[ctx->progress];           // NOLINT
       iov[0].iov_len = data_to_send;
       sent = ::writev(sock, &iov[0], 1);
-      /*
-       * XXX This is a hack: Free buffer provided for RPC reply.
-       * The caller should take care actually.
-       */
-      if (sent == data_to_send)
-        _tcpTransport.releaseBuffer((uint8_t *)ctx->va);
     }
     if (sent == data_to_send) {
       tep->tx_bytes += ctx->hdr.datalen;
+      ctx->payload = nullptr;
       ctx->state = PROC_IDLE;
       continue;
     } else if (sent < 0)
@@ -319,13 +441,8 @@ bool TcpPeer::processEndpointSend(std::shared_ptr<TcpEndpoint> tep) {
 
 void TcpTransport::tcpTxThread(unsigned int id) {
   struct epoll_event events[EPOLL_MAXEVENTS]; // NOLINT
-  int poll_fd = ::epoll_create1(0);
-  if (poll_fd < 0) {
-    perror("epoll_create: ");
-    return;
-  }
+  int poll_fd = epoll_wfd[id];
   LOG_DEBUG("TCP TX thread ", id, " starting");
-  epoll_wfd[id] = poll_fd;
   if (eventFd > 0) {
     struct epoll_event ev{};
     ev.events = EPOLLIN | EPOLLHUP | EPOLLRDHUP | EPOLLERR;
@@ -352,7 +469,8 @@ void TcpTransport::tcpTxThread(unsigned int id) {
       std::shared_ptr<TcpPeer> tcpPeer = nullptr;
 
       if (sock < 0) {
-        LOG_ERROR("Invalid write socket: ", sock, " PeerId: ", ev->data.u64, ", evcnt: ", cnt);
+        LOG_ERROR("Invalid write socket: ", sock, " PeerId: ", uint64_t{ev->data.u64},
+                  ", evcnt: ", cnt);
         continue;
       }
       auto it = tcpPeers.get(epId);
@@ -387,8 +505,9 @@ void TcpTransport::tcpTxThread(unsigned int id) {
   };
   if (eventFd > 0)
     epoll_ctl(poll_fd, EPOLL_CTL_DEL, eventFd, NULL);
-  
+
   close(poll_fd);
+  epoll_wfd[id] = -1;
   LOG_DEBUG("TCP TX thread ", id, " exiting");
 }
 
@@ -423,7 +542,8 @@ bool TcpPeer::SocketStateChange(int sock, uint32_t change) {
   return dead;
 }
 
-void TcpPeer::TcpProcessRpcGet(uint64_t reqId, const std::string objName, size_t len, size_t off) {
+void TcpPeer::TcpProcessRpcGet(uint64_t reqId, const std::string &objName, size_t len,
+                               size_t off) {
   auto separator = objName.find('/');
   if (separator == std::string::npos) {
     LOG_ERROR("cannot open file: ", objName, " invalid format!");
@@ -433,12 +553,14 @@ void TcpPeer::TcpProcessRpcGet(uint64_t reqId, const std::string objName, size_t
 
   auto bucket = objName.substr(0, separator);
   auto key = objName.substr(separator + 1);
-  auto file = _geds->localOpen(bucket, key);
-  if (!file.ok()) {
-    LOG_DEBUG("cannot open file: ", objName, " reason: ", file.status().message());
-    sendRpcReply(reqId, -1, 0, 0, EINVAL);
+  auto fileStatus = _geds->cachedOpen(bucket, key);
+  if (!fileStatus.ok()) {
+    LOG_DEBUG("cannot open file: ", objName, " reason: ", fileStatus.status().message());
+    sendRpcReply(reqId, -1, 0, 0, toErrno(fileStatus.status()));
     return;
   }
+  // The file is kept open until the reply has been sent.
+  auto file = *fileStatus;
   auto filesize = file->size();
   if (off > filesize) {
     LOG_ERROR("offset > filesize: ", off, " > ", filesize);
@@ -452,26 +574,41 @@ void TcpPeer::TcpProcessRpcGet(uint64_t reqId, const std::string objName, size_t
     return;
   }
   /*
-   * Use sendfile() for large chunks of data
+   * Send directly from memory-mapped files and use sendfile() for large chunks of data
    */
+  auto rawPtr = file->rawPtr();
+  if (rawPtr.ok()) {
+    sendRpcReply(reqId, -1, (uint64_t)(*rawPtr + off), len, 0, file);
+    return;
+  }
   auto rawFd = file->rawFd();
   if (len >= MIN_SENDFILE_SIZE && rawFd.ok()) {
-    int in_fd = *rawFd;
-    sendRpcReply(reqId, in_fd, off, len, 0);
+    sendRpcReply(reqId, *rawFd, off, len, 0, file);
+    return;
+  }
+  std::shared_ptr<uint8_t> buffer;
+  if (len <= MIN_SENDFILE_SIZE) {
+    buffer = std::shared_ptr<uint8_t>(_tcpTransport.getBuffer(),
+                                      [transport = _tcpTransport.weak_from_this()](uint8_t *b) {
+                                        if (auto t = transport.lock()) {
+                                          t->releaseBuffer(b);
+                                        } else {
+                                          delete[] b;
+                                        }
+                                      });
+  } else {
+    buffer = std::shared_ptr<uint8_t>(new uint8_t[len], std::default_delete<uint8_t[]>());
+  }
+  auto status = file->read(buffer.get(), off, len);
+  if (!status.ok()) {
+    LOG_ERROR("cannot read file: ", objName, " reason: ", status.status().message());
+    sendRpcReply(reqId, -1, 0, 0, toErrno(status.status()));
     return;
   }
-  auto buffer = _tcpTransport.getBuffer();
-  auto status = file->read(buffer, off, len);
   if (len != *status) {
     LOG_ERROR("file->read returned with an unexpected length!");
   }
-  if (status.ok()) {
-    sendRpcReply(reqId, -1, (uint64_t)buffer, *status, 0);
-  } else {
-    _tcpTransport.releaseBuffer(buffer);
-    LOG_ERROR("cannot read file: ", objName);
-    sendRpcReply(reqId, -1, 0, 0, EINVAL);
-  }
+  sendRpcReply(reqId, -1, (uint64_t)buffer.get(), *status, 0, buffer);
 }
 
 /**
@@ -510,45 +647,42 @@ bool TcpPeer::processEndpointRecv(int sock) {
       /*
        * Start or resume hdr reception
        */
-      size_t to_recv = sizeof ctx->hdr - ctx->progress;
-
       while (ctx->progress < sizeof ctx->hdr) {
-        auto hdrp = reinterpret_cast<uint8_t *>(&ctx->hdr);  // NOLINT
-        rv = ::recv(sock, &hdrp[ctx->progress], to_recv, 0); // NOLINT
-        if (rv <= 0) {
-          rv = errno == EWOULDBLOCK ? -EAGAIN : (errno ? -errno : -EIO);
+        auto hdrp = reinterpret_cast<uint8_t *>(&ctx->hdr); // NOLINT
+        rv = recvSome(sock, &hdrp[ctx->progress], sizeof ctx->hdr - ctx->progress);
+        if (rv < 0) {
           break;
         }
-        to_recv -= rv;
         ctx->progress += rv;
       }
       if (rv < 0)
         break;
+      if (ctx->hdr.hdrlen < sizeof ctx->hdr) {
+        LOG_ERROR("RPC header size invalid: ", ctx->hdr.hdrlen);
+        rv = -EINVAL;
+        break;
+      }
       /*
        * Get the additional object name, if present
        */
-      to_recv = ctx->hdr.hdrlen - ctx->progress;
+      size_t name_len = ctx->hdr.hdrlen - sizeof ctx->hdr;
 
       if (ctx->hdr.type == GET_REQ) {
-        if (to_recv == 0 || to_recv > (ssize_t)RPC_TCP_MAX_HDR) {
+        if (name_len == 0 || ctx->hdr.hdrlen > RPC_TCP_MAX_HDR) {
           LOG_ERROR("RPC GET_REQ header size invalid: ", ctx->hdr.hdrlen);
           rv = -EINVAL;
           break;
         }
-        char buffer[to_recv];
-
-        while (to_recv) {
-          rv = ::recv(sock, &buffer[0], to_recv, 0);
-          if (rv <= 0) {
-            rv = errno == EWOULDBLOCK ? -EAGAIN : (errno ? -errno : -EIO);
+        ctx->objName.resize(name_len);
+        while (ctx->progress < ctx->hdr.hdrlen) {
+          auto name_off = ctx->progress - sizeof ctx->hdr;
+          rv = recvSome(sock, &ctx->objName[name_off], name_len - name_off);
+          if (rv < 0) {
             break;
           }
           ctx->progress += rv;
-          std::string name(buffer, rv);
-          ctx->objName += name;
-          to_recv -= rv;
         }
-      } else if (to_recv) {
+      } else if (name_len) {
         int type = ctx->hdr.type, error = ctx->hdr.error;
 
         LOG_ERROR("RPC unexpected header content:: ", "reqid: ", ctx->hdr.reqid,
@@ -577,6 +711,8 @@ bool TcpPeer::processEndpointRecv(int sock) {
       TcpProcessRpcGet(ctx->hdr.reqid, ctx->objName, datalen, ctx->hdr.offset);
 
       ctx->state = PROC_IDLE;
+      // Continue with the next request.
+      rv = 1;
       break;
 
     case GET_REPLY:
@@ -604,38 +740,31 @@ bool TcpPeer::processEndpointRecv(int sock) {
           if (datalen) {
             LOG_ERROR("Protocol failure, no data in error reply expected, but indicated: ", datalen,
                       " Ep: ", tep->sock);
-            ctx->hdr.datalen = 0;
+            rv = -EINVAL;
+            break;
           }
-          auto message = "Error from GET_REPLY: " + std::to_string(ctx->hdr.error) +
-                         "length: " + std::to_string(datalen) + " Ep: " + std::to_string(tep->sock);
+          auto message = "Error from GET_REPLY for request " + std::to_string(ctx->hdr.reqid) +
+                         " on Ep " + std::to_string(tep->sock);
           LOG_DEBUG(message);
-          ctx->p->set_value(absl::UnknownError(message));
+          ctx->p->set_value(fromErrno(ctx->hdr.error, message));
           ctx->p = nullptr;
           ctx->state = PROC_IDLE;
           ctx->progress = 0;
+          rv = 1;
+          break;
+        }
+        if (datalen > work->len) {
+          LOG_ERROR("Protocol failure, reply exceeds the requested length: ", datalen, " > ",
+                    work->len);
+          rv = -EINVAL;
           break;
         }
       }
       while (ctx->progress < datalen) {
-        auto to_recv = datalen - ctx->progress;
-        auto vap = reinterpret_cast<uint8_t *>(ctx->va);    // NOLINT
-        rv = ::recv(sock, &vap[ctx->progress], to_recv, 0); // NOLINT
+        auto vap = reinterpret_cast<uint8_t *>(ctx->va); // NOLINT
+        rv = recvSome(sock, &vap[ctx->progress], datalen - ctx->progress);
         if (rv < 0) {
-          if (errno == EWOULDBLOCK) {
-            return true;
-          }
-          int err = errno;
-          int eio = EIO;
-          std::string message = "Error during recv: ";
-          if (err) {
-            message += "got errno " + std::to_string(err) + " " + strerror(err);
-          } else {
-            message += "got EIO " + std::to_string(eio);
-          }
-          ctx->p->set_value(absl::AbortedError(message));
-          ctx->p = nullptr;
-          ctx->state = PROC_FAILED;
-          return false;
+          break;
         }
         ctx->progress += rv;
       }
@@ -647,11 +776,13 @@ bool TcpPeer::processEndpointRecv(int sock) {
         ctx->p->set_value(datalen);
         ctx->p = nullptr;
         ctx->state = PROC_IDLE;
+        rv = 1;
       }
       break;
     default:
       LOG_ERROR("Unsupported RPC operation: ", op);
-      return false;
+      rv = -EINVAL;
+      break;
     }
   } while (rv > 0);
 
@@ -660,38 +791,31 @@ bool TcpPeer::processEndpointRecv(int sock) {
 
   if (ctx->p.get()) {
     auto message =
-        "Protocol error: Aborted with " + std::to_string(rv) + ": " + std::string{strerror(rv)};
+        "Protocol error: Aborted with " + std::to_string(rv) + ": " + std::string{strerror(-rv)};
     LOG_ERROR(message);
     ctx->p->set_value(absl::AbortedError(message));
     ctx->p = nullptr;
-    ctx->state = PROC_FAILED;
-  }
-  if (rv == -ENOENT)
-    LOG_ERROR("Socket close on read");
-  else {
-    int err = errno;
-    LOG_ERROR("unexpected error: ", rv, " errno: ", err);
   }
+  ctx->state = PROC_FAILED;
+  if (rv == -ECONNRESET)
+    LOG_DEBUG("Socket close on read: ", sock);
+  else
+    LOG_ERROR("unexpected error on socket ", sock, ": ", strerror(-rv));
   return false;
 }
 
-// TODO: Make this thread interruptiple by signal to make it killable if Transport goes away.
 void TcpTransport::updateIoStats() {
-  do {
+  std::unique_lock lock(ioStatsMutex);
+  while (isServing) {
     tcpPeers.forall([](std::shared_ptr<TcpPeer> &tp) { tp->updateIoStats(); });
-    sleep(1);
-  } while (isServing);
+    ioStatsCv.wait_for(lock, std::chrono::seconds(1), [this] { return !isServing; });
+  }
 }
 
 void TcpTransport::tcpRxThread(unsigned int id) {
   struct epoll_event events[EPOLL_MAXEVENTS]; // NOLINT
-  int poll_fd = ::epoll_create1(0);
-  if (poll_fd < 0) {
-    perror("epoll_create: ");
-    return;
-  }
+  int poll_fd = epoll_rfd[id];
   LOG_DEBUG("TCP RX thread ", id, " starting");
-  epoll_rfd[id] = poll_fd;
 
   if (eventFd > 0) {
     struct epoll_event ev{};
@@ -708,7 +832,7 @@ void TcpTransport::tcpRxThread(unsigned int id) {
 
     for (int i = 0; i < cnt; i++) {
       struct epoll_event *ev = &events[i];
-      
+
       if (ev->data.fd == eventFd) {
         LOG_DEBUG("TCP RX: epoll CTL");
         continue;
@@ -720,7 +844,7 @@ void TcpTransport::tcpRxThread(unsigned int id) {
       std::shared_ptr<TcpPeer> tcpPeer = nullptr;
 
       if (sock < 0) {
-        LOG_ERROR("Invalid read socket: ", sock, " PeerId: ", ev->data.u64);
+        LOG_ERROR("Invalid read socket: ", sock, " PeerId: ", uint64_t{ev->data.u64});
         continue;
       }
       auto it = tcpPeers.get(epId);
@@ -757,6 +881,7 @@ void TcpTransport::tcpRxThread(unsigned int id) {
     epoll_ctl(poll_fd, EPOLL_CTL_DEL, eventFd, NULL);
 
   close(poll_fd);
+  epoll_rfd[id] = -1;
   LOG_DEBUG("TCP RX thread ", id, " exiting");
 }
 
@@ -827,46 +952,73 @@ bool TcpTransport::addEndpointPassive(int sock) {
     return false;
   }
 
+  /*
+   * Each accepted connection is tracked as a separate peer, keyed by the remote address and
+   * port. Replies are thus always sent on the connection the request arrived on, even if
+   * multiple clients share a host.
+   */
   std::string hostname = inet_ntoa(in_peer->sin_addr);
-  std::shared_ptr<TcpPeer> tcpPeer;
-  unsigned int epId = SStringHash(hostname);
+  uint16_t port = ntohs(in_peer->sin_port);
 
-  getWriteLock();
-  auto it = tcpPeers.get(epId);
-  if (!it.has_value()) {
-    tcpPeer = std::make_shared<TcpPeer>(hostname, _geds, *this);
-    tcpPeers.insertOrReplace(epId, tcpPeer);
-  } else {
-    tcpPeer = *it;
-  }
-  if (tcpPeer->endpoints.size() < num_proc) {
-    std::shared_ptr<TcpEndpoint> tep = std::make_shared<TcpEndpoint>();
-    
-    tep->sock = sock;
+  auto lock = getWriteLock();
+  auto tcpPeer = std::make_shared<TcpPeer>(peerId(hostname, port), hostname, port, _geds, *this);
+  auto tep = std::make_shared<TcpEndpoint>();
+  tep->sock = sock;
+  {
+    auto peerLock = tcpPeer->getWriteLock();
     tcpPeer->addEndpoint(tep);
-    if (activateEndpoint(tep, tcpPeer) == true) {
-      LOG_DEBUG("Server with ", tcpPeer->endpoints.size(),
-              " connections to ", hostname, "::", in_peer->sin_port);
-      return true;
-    }
+  }
+  tcpPeers.insertOrReplace(tcpPeer->getId(), tcpPeer);
+  if (activateEndpoint(tep, tcpPeer)) {
+    LOG_DEBUG("Server accepted connection from ", hostname, ":", port);
+    return true;
+  }
+  tcpPeers.remove(tcpPeer->getId());
+  {
+    auto peerLock = tcpPeer->getWriteLock();
     tcpPeer->delEndpoint(tep);
-    LOG_ERROR("Server failed adding connection to ", hostname, "::", in_peer->sin_port);
   }
-  /*
-   * Drop this extra connection probably created during cross-connect
-   * from both sides
-   */
-  LOG_DEBUG("Server with ", tcpPeer->endpoints.size() + 1,
-            " connections to ", hostname, "::", in_peer->sin_port, ", dropping new");
+  LOG_ERROR("Server failed adding connection to ", hostname, ":", port);
   return false;
 }
 
+absl::StatusOr<std::shared_ptr<TcpPeer>> TcpTransport::connect(const std::string &host,
+                                                              uint16_t port) {
+  if (!isServing) {
+    return absl::FailedPreconditionError("TCP service not started");
+  }
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  if (::inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+    return absl::InvalidArgumentError("Invalid IPv4 address: " + host);
+  }
+  auto peer = getPeer(reinterpret_cast<sockaddr *>(&addr));
+  if (peer == nullptr) {
+    return absl::UnavailableError("Unable to connect to " + host + ":" + std::to_string(port));
+  }
+  return peer;
+}
+
+unsigned int TcpTransport::peerId(const std::string &hostname, uint16_t port) {
+  auto id = SStringHash(hostname + ":" + std::to_string(port));
+  while (true) {
+    auto it = tcpPeers.get(id);
+    if (!it.has_value() || ((*it)->hostname == hostname && (*it)->port == port)) {
+      return id;
+    }
+    LOG_DEBUG("Peer ID ", id, " of ", hostname, ":", port, " is taken by ", (*it)->hostname, ":",
+              (*it)->port);
+    id++;
+  }
+}
+
 std::shared_ptr<TcpPeer> TcpTransport::getPeer(sockaddr *peer) {
   auto inaddr = (sockaddr_in *)peer;
   std::string hostname = inet_ntoa(inaddr->sin_addr);
+  uint16_t port = ntohs(inaddr->sin_port);
   size_t addrlen = sizeof *peer;
   int sock = -1, rv = 0;
-  unsigned int epId = SStringHash(hostname);
 
   if (peer->sa_family != AF_INET) {
     LOG_ERROR("Address family not supported: ", peer->sa_family);
@@ -879,24 +1031,25 @@ std::shared_ptr<TcpPeer> TcpTransport::getPeer(sockaddr *peer) {
    * this case.
    */
   std::shared_ptr<TcpPeer> tcpPeer;
+  auto epId = peerId(hostname, port);
   auto it = tcpPeers.get(epId);
   if (it.has_value()) {
     tcpPeer = *it;
   } else {
-    tcpPeer = std::make_shared<TcpPeer>(hostname, _geds, *this);
+    tcpPeer = std::make_shared<TcpPeer>(epId, hostname, port, _geds, *this);
     tcpPeers.insertOrReplace(epId, tcpPeer);
   }
   unsigned int num_ep = tcpPeer->endpoints.size();
 
   while (num_ep < num_proc) {
-    sock = ::socket(AF_INET, SOCK_STREAM, 0);
+    sock = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
     if (sock < 0) {
-      LOG_ERROR("Cannot create socket: ", hostname, "::", inaddr->sin_port);
+      LOG_ERROR("Cannot create socket: ", hostname, ":", port);
       break;
     }
     rv = ::connect(sock, peer, addrlen);
     if (rv) {
-      LOG_ERROR("Cannot connect: ", hostname, "::", inaddr->sin_port);
+      LOG_ERROR("Cannot connect: ", hostname, ":", port);
       ::close(sock);
       break;
     }
@@ -906,33 +1059,39 @@ std::shared_ptr<TcpPeer> TcpTransport::getPeer(sockaddr *peer) {
      */
     rv = ::fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
     if (rv) {
-      LOG_ERROR("Cannot set socket non-blocking ", hostname, "::", inaddr->sin_port);
+      LOG_ERROR("Cannot set socket non-blocking ", hostname, ":", port);
       close(sock);
       break;
     }
     struct linger lg = {.l_onoff = 0, .l_linger = 0};
     if (::setsockopt(sock, SOL_SOCKET, SO_LINGER, &lg, sizeof lg)) {
-      LOG_ERROR("Cannot set NO_LINGER ", hostname, "::", inaddr->sin_port);
+      LOG_ERROR("Cannot set NO_LINGER ", hostname, ":", port);
       close(sock);
       break;
     }
     std::shared_ptr<TcpEndpoint> tep = std::make_shared<TcpEndpoint>();
     tep->sock = sock;
-    tcpPeer->addEndpoint(tep);
+    {
+      auto peerLock = tcpPeer->getWriteLock();
+      tcpPeer->addEndpoint(tep);
+    }
     if (activateEndpoint(tep, tcpPeer) == false) {
-      tcpPeer->delEndpoint(tep);
+      {
+        auto peerLock = tcpPeer->getWriteLock();
+        tcpPeer->delEndpoint(tep);
+      }
       ::close(sock);
-      LOG_ERROR("Client failed adding connection to ", hostname, "::", inaddr->sin_port);
+      LOG_ERROR("Client failed adding connection to ", hostname, ":", port);
       break;
     }
     num_ep++;
-    LOG_DEBUG("Client with ", num_ep, " connections to ", hostname, "::", inaddr->sin_port);
+    LOG_DEBUG("Client with ", num_ep, " connections to ", hostname, ":", port);
   }
   if (num_ep)
     return tcpPeer;
-  
+
   tcpPeers.remove(tcpPeer->Id);
-  LOG_ERROR("Cannot connect peer: ", hostname, "::", inaddr->sin_port);
+  LOG_ERROR("Cannot connect peer: ", hostname, ":", port);
   return nullptr;
 }
 
@@ -974,7 +1133,8 @@ std::shared_ptr<TcpEndpoint> TcpPeer::getLeastUsedTx(size_t to_send) {
   return tep; // May be nullptr
 }
 
-int TcpPeer::sendRpcReply(uint64_t reqId, int in_fd, uint64_t start, size_t len, int status) {
+int TcpPeer::sendRpcReply(uint64_t reqId, int in_fd, uint64_t start, size_t len, int status,
+                          std::shared_ptr<const void> payload) {
   bool send_ok = false;
 
   auto sendWork = std::make_shared<SocketSendWork>();
@@ -984,7 +1144,8 @@ int TcpPeer::sendRpcReply(uint64_t reqId, int in_fd, uint64_t start, size_t len,
   sendWork->len = len;
   sendWork->type = GET_REPLY;
   sendWork->error = status;
-  sendQueue.emplace(sendWork);
+  sendWork->payload = std::move(payload);
+  sendQueue.push(sendWork);
   (*sendQueue_stats)++;
 
   auto tep = getLeastUsedTx(len);
@@ -1024,7 +1185,7 @@ TcpPeer::sendRpcRequest(uint64_t dest, std::string name, size_t off, size_t len)
   sendWork->off = off;
   sendWork->error = 0;
   sendWork->type = GET_REQ;
-  sendQueue.emplace(sendWork);
+  sendQueue.push(sendWork);
   (*sendQueue_stats)++;
 
   auto tep = getLeastUsedTx(len);
@@ -1045,11 +1206,20 @@ TcpPeer::sendRpcRequest(uint64_t dest, std::string name, size_t off, size_t len)
   return recvWork->p;
 }
 
+absl::StatusOr<size_t> TcpPeer::readBytes(const std::string &bucket, const std::string &key,
+                                          uint8_t *buffer, size_t position, size_t length) {
+  if (length == 0) {
+    return 0;
+  }
+  auto promise = sendRpcRequest((uint64_t)buffer, bucket + "/" + key, position, length);
+  return promise->get_future().get();
+}
+
 uint8_t *TcpTransport::getBuffer() {
   uint8_t *result;
   auto success = _buffers.pop(result);
   if (!success) {
-    return new (std::align_val_t(BUFFER_ALIGNMENT)) uint8_t[MIN_SENDFILE_SIZE];
+    return new uint8_t[MIN_SENDFILE_SIZE];
   }
   return result;
 }
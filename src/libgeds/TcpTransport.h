@@ -7,22 +7,27 @@
 #define _TCP_TRANSPORT_H
 
 #include <atomic>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <future>
 #include <list>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <netinet/in.h>
 #include <queue>
 #include <shared_mutex>
+#include <string>
 #include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <thread>
 #include <utility>
+#include <vector>
 
+#include <absl/status/status.h>
 #include <absl/status/statusor.h>
 #include <boost/lockfree/stack.hpp>
 
@@ -55,6 +60,8 @@ struct SocketSendWork {
   TcpRpcOp type;
   size_t progress;
   int error;
+  // Keeps the memory referenced by `va` or the file referenced by `in_fd` alive until sent.
+  std::shared_ptr<const void> payload;
 };
 
 struct SocketRecvWork {
@@ -90,6 +97,7 @@ struct TcpSendState {
   int in_fd; // If non-negative: fd of requested object, to be used in sendfile()
   std::string objName;
   size_t progress;
+  std::shared_ptr<const void> payload;
 };
 
 struct TcpRcvState {
@@ -153,6 +161,7 @@ private:
   std::shared_ptr<GEDS> _geds;
   TcpTransport &_tcpTransport;
   std::string hostname;
+  uint16_t port;
   std::atomic_uint64_t rpcReqId = 0;
 
   utility::ConcurrentQueue<std::shared_ptr<SocketSendWork>> sendQueue;
@@ -173,14 +182,21 @@ private:
 
   std::shared_ptr<TcpEndpoint> getLeastUsedTx(size_t tu_send);
 
-  int sendRpcReply(uint64_t reqId, uint64_t start, size_t len, int status);
-  void TcpProcessRpcGet(uint64_t ReqId, const std::string ObjName, size_t len, size_t off);
+  void TcpProcessRpcGet(uint64_t ReqId, const std::string &ObjName, size_t len, size_t off);
 
 public:
   unsigned int getId() { return Id; }
   std::shared_ptr<std::promise<absl::StatusOr<size_t>>>
   sendRpcRequest(uint64_t dest, std::string name, size_t src_off, size_t len);
-  int sendRpcReply(uint64_t reqId, int in_fd, uint64_t start, size_t len, int status);
+  int sendRpcReply(uint64_t reqId, int in_fd, uint64_t start, size_t len, int status,
+                   std::shared_ptr<const void> payload = nullptr);
+
+  /**
+   * @brief Read `length` bytes at `position` of `bucket/key` from the peer into `buffer`.
+   */
+  absl::StatusOr<size_t> readBytes(const std::string &bucket, const std::string &key,
+                                   uint8_t *buffer, size_t position, size_t length);
+
   void addEndpoint(std::shared_ptr<TcpEndpoint> tep) {
     // Caller must hold TcpTransports write lock
     endpoints.emplace(tep->sock, tep);
@@ -189,9 +205,10 @@ public:
     // Caller must hold TcpTransport write lock
     endpoints.erase(tep->sock);
   };
-  TcpPeer(std::string name, std::shared_ptr<GEDS> geds, TcpTransport &tcpTransport)
-      : Id(SStringHash(name)), _geds(std::move(geds)), _tcpTransport(tcpTransport),
-        hostname(std::move(name)){};
+  TcpPeer(unsigned int id, std::string name, uint16_t portArg, std::shared_ptr<GEDS> geds,
+          TcpTransport &tcpTransport)
+      : Id(id), _geds(std::move(geds)), _tcpTransport(tcpTransport), hostname(std::move(name)),
+        port(portArg){};
   TcpPeer(const TcpPeer &other) = delete;
   TcpPeer(TcpPeer &&other) = delete;
   TcpPeer &operator=(const TcpPeer &other) = delete;
@@ -215,8 +232,15 @@ private:
 
   void updateIoStats();
   std::unique_ptr<std::thread> ioStatsThread;
+  std::mutex ioStatsMutex;
+  std::condition_variable ioStatsCv;
+
+  void acceptThread();
+  std::unique_ptr<std::thread> listenThread;
+  int listenFd = -1;
+  uint16_t listenPort = 0;
 
-  volatile bool isServing = false;
+  std::atomic<bool> isServing = false;
   unsigned int num_proc = 0;
 
   int epoll_rfd[MAX_IO_THREADS] = {}; // for epoll() receive
@@ -229,6 +253,14 @@ private:
   bool activateEndpoint(std::shared_ptr<TcpEndpoint>, std::shared_ptr<TcpPeer>);
   utility::ConcurrentMap<unsigned int, std::shared_ptr<TcpPeer>> tcpPeers;
 
+  /**
+   * @brief Returns the ID of the peer at `hostname:port`, or a free ID if there is none.
+   *
+   * IDs start at the hash of the endpoint and are probed linearly on collisions, since the ID
+   * identifies the peer in epoll events. Caller must hold the write lock.
+   */
+  unsigned int peerId(const std::string &hostname, uint16_t port);
+
   mutable std::shared_mutex connMutex;
   auto getReadLock() const { return std::shared_lock<std::shared_mutex>(connMutex); }
   auto getWriteLock() const { return std::unique_lock<std::shared_mutex>(connMutex); }
@@ -247,10 +279,21 @@ public:
   TcpTransport &operator=(const TcpTransport &other) = delete;
   TcpTransport &operator=(TcpTransport &&other) = delete;
 
-  void start();
+  absl::Status start();
   void stop();
 
+  /**
+   * @brief Accept connections on `port`. Passing 0 selects an ephemeral port.
+   */
+  absl::Status listen(uint16_t port);
+  uint16_t port() const { return listenPort; }
+
   std::shared_ptr<TcpPeer> getPeer(sockaddr *);
+
+  /**
+   * @brief Connect to the TcpTransport listening on `host:port`.
+   */
+  absl::StatusOr<std::shared_ptr<TcpPeer>> connect(const std::string &host, uint16_t port);
   bool addEndpointPassive(int sock);
 };
 } // namespace geds
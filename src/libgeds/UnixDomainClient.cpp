@@ -0,0 +1,235 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "UnixDomainClient.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Logging.h"
+#include "TcpDataTransport.h"
+
+namespace geds {
+
+UnixDomainClient::OpenObject::~OpenObject() {
+  if (fd >= 0) {
+    ::close(fd);
+  }
+}
+
+UnixDomainClient::UnixDomainClient(std::string nameArg) : name(std::move(nameArg)) {}
+
+UnixDomainClient::~UnixDomainClient() {
+  for (auto fd : _idle) {
+    ::close(fd);
+  }
+}
+
+absl::Status UnixDomainClient::connect() {
+  auto fd = acquire();
+  if (!fd.ok()) {
+    return fd.status();
+  }
+  release(*fd, true);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<int> UnixDomainClient::acquire() {
+  {
+    auto lock = std::lock_guard(_mutex);
+    if (!_idle.empty()) {
+      auto fd = _idle.back();
+      _idle.pop_back();
+      return fd;
+    }
+  }
+  sockaddr_un address;
+  auto length = unix_transport::abstractAddress(name, address);
+  if (!length.ok()) {
+    return length.status();
+  }
+  int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    int err = errno;
+    return absl::UnavailableError("Unable to create Unix domain socket: " +
+                                  std::string{strerror(err)});
+  }
+  if (::connect(fd, reinterpret_cast<sockaddr *>(&address), *length) != 0) {
+    int err = errno;
+    ::close(fd);
+    return absl::UnavailableError("Unable to connect to @" + name + ": " +
+                                  std::string{strerror(err)});
+  }
+  LOG_DEBUG("Connected to @", name);
+  return fd;
+}
+
+void UnixDomainClient::release(int fd, bool reusable) {
+  if (reusable) {
+    auto lock = std::lock_guard(_mutex);
+    _idle.push_back(fd);
+    return;
+  }
+  ::close(fd);
+}
+
+absl::StatusOr<UnixDomainClient::OpenObject>
+UnixDomainClient::open(const std::string &bucket, const std::string &key, size_t offset,
+                       size_t length) {
+  auto requestId = _nextRequestId++;
+  auto header = tcp_transport::createRequestHeader(tcp_transport::Operation::Open, requestId,
+                                                   bucket, key, offset, length);
+  if (!header.ok()) {
+    return header.status();
+  }
+  std::string frame(reinterpret_cast<const char *>(&(*header)), sizeof(*header));
+  frame += bucket;
+  frame += key;
+
+  auto fd = acquire();
+  if (!fd.ok()) {
+    return fd.status();
+  }
+  auto status = unix_transport::sendAll(*fd, frame.data(), frame.size());
+  if (!status.ok()) {
+    release(*fd, false);
+    return status;
+  }
+
+  OpenObject result;
+  tcp_transport::ResponseHeader response;
+  status = unix_transport::receiveAll(*fd, &response, sizeof(response), &result.fd);
+  if (status.ok()) {
+    status = tcp_transport::validateResponseHeader(response, requestId);
+  }
+  if (!status.ok()) {
+    release(*fd, false);
+    return status;
+  }
+  if (response.statusCode != absl::OkStatus().raw_code()) {
+    std::string message(response.length, '\0');
+    status = unix_transport::receiveAll(*fd, message.data(), message.size());
+    release(*fd, status.ok());
+    if (!status.ok()) {
+      return status;
+    }
+    return absl::Status(static_cast<absl::StatusCode>(response.statusCode), message);
+  }
+  if (response.length != sizeof(result.response)) {
+    release(*fd, false);
+    return absl::UnknownError("Invalid open response length.");
+  }
+  status = unix_transport::receiveAll(*fd, &result.response, sizeof(result.response),
+                                      result.fd < 0 ? &result.fd : nullptr);
+  release(*fd, status.ok());
+  if (!status.ok()) {
+    return status;
+  }
+  if (result.fd < 0) {
+    return absl::UnknownError("The server did not pass a file descriptor.");
+  }
+  return result;
+}
+
+absl::StatusOr<std::shared_ptr<const UnixDomainClient::OpenObject>>
+UnixDomainClient::openCached(const std::string &bucket, const std::string &key, size_t begin,
+                             size_t end) {
+  auto path = bucket + "/" + key;
+  {
+    auto lock = std::lock_guard(_objectsMutex);
+    auto it = _objects.find(path);
+    if (it != _objects.end()) {
+      const auto &response = it->second->response;
+      // Ranges past the end of the object are empty, hence the window only needs to reach the end.
+      auto windowEnd = response.fdOffset + response.fdLength;
+      if (begin >= response.fdOffset && std::min<uint64_t>(end, response.size) <= windowEnd) {
+        return it->second;
+      }
+    }
+  }
+  auto opened = open(bucket, key, begin, end - begin);
+  if (!opened.ok()) {
+    return opened.status();
+  }
+  auto object = std::make_shared<const OpenObject>(std::move(*opened));
+  auto lock = std::lock_guard(_objectsMutex);
+  if (_objects.size() >= MaxOpenObjects && !_objects.contains(path)) {
+    _objects.erase(_objects.begin());
+  }
+  _objects.insert_or_assign(path, object);
+  return object;
+}
+
+void UnixDomainClient::invalidate(const std::string &bucket, const std::string &key) {
+  auto lock = std::lock_guard(_objectsMutex);
+  _objects.erase(bucket + "/" + key);
+}
+
+absl::StatusOr<size_t> UnixDomainClient::readBytes(const std::string &bucket,
+                                                   const std::string &key, uint8_t *buffer,
+                                                   size_t position, size_t length) {
+  auto counts = readv(bucket, key, {geds::ReadRange{buffer, position, length}});
+  if (!counts.ok()) {
+    return counts.status();
+  }
+  return counts->front();
+}
+
+absl::StatusOr<std::vector<size_t>>
+UnixDomainClient::readv(const std::string &bucket, const std::string &key,
+                        const std::vector<geds::ReadRange> &ranges) {
+  if (ranges.empty()) {
+    return std::vector<size_t>{};
+  }
+  size_t begin = SIZE_MAX;
+  size_t end = 0;
+  for (const auto &range : ranges) {
+    begin = std::min(begin, range.position);
+    end = std::max(end, range.position + range.length);
+  }
+  auto object = openCached(bucket, key, begin, end);
+  if (!object.ok()) {
+    return object.status();
+  }
+  const auto &response = (*object)->response;
+
+  std::vector<size_t> result;
+  result.reserve(ranges.size());
+  for (const auto &range : ranges) {
+    // Only the part of the range inside the descriptor window is available.
+    auto windowEnd = response.fdOffset + response.fdLength;
+    if (range.position < response.fdOffset || range.position >= windowEnd) {
+      result.push_back(0);
+      continue;
+    }
+    auto length = std::min<uint64_t>(range.length, windowEnd - range.position);
+    size_t count = 0;
+    while (count < length) {
+      auto r = ::pread((*object)->fd, range.buffer + count, length - count,
+                       range.position - response.fdOffset + count);
+      if (r < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        int err = errno;
+        return absl::UnknownError("Unable to read " + bucket + "/" + key + ": " +
+                                  std::string{strerror(err)});
+      }
+      if (r == 0) {
+        break;
+      }
+      count += r;
+    }
+    result.push_back(count);
+  }
+  return result;
+}
+
+} // namespace geds
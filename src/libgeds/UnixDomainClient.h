@@ -0,0 +1,98 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <absl/status/status.h>
+#include <absl/status/statusor.h>
+
+#include "GEDSInternal.h"
+#include "UnixDomainTransport.h"
+
+namespace geds {
+
+/**
+ * @brief Client side of the same-host data path.
+ *
+ * The first read of an object opens it on the server and receives a file descriptor. The descriptor
+ * is cached and subsequent reads use it directly until the object is invalidated. Connections are
+ * pooled, so concurrent readers do not wait for each other.
+ */
+class UnixDomainClient {
+  struct OpenObject {
+    int fd = -1;
+    unix_transport::OpenResponse response{};
+
+    OpenObject() = default;
+    OpenObject(const OpenObject &) = delete;
+    OpenObject &operator=(const OpenObject &) = delete;
+    OpenObject(OpenObject &&other) noexcept : fd(other.fd), response(other.response) {
+      other.fd = -1;
+    }
+    ~OpenObject();
+  };
+
+  std::mutex _mutex;
+  std::vector<int> _idle;
+  std::atomic<uint64_t> _nextRequestId = 0;
+
+  // Open objects by `bucket/key`. Readers hold a reference, so invalidation does not close a
+  // descriptor which is still in use.
+  std::mutex _objectsMutex;
+  std::unordered_map<std::string, std::shared_ptr<const OpenObject>> _objects;
+
+  absl::StatusOr<int> acquire();
+  void release(int fd, bool reusable);
+
+  absl::StatusOr<OpenObject> open(const std::string &bucket, const std::string &key,
+                                  size_t offset, size_t length);
+
+  /**
+   * @brief Returns the cached object if its descriptor covers `[begin, end)`, otherwise opens the
+   * object on the server and caches it.
+   */
+  absl::StatusOr<std::shared_ptr<const OpenObject>>
+  openCached(const std::string &bucket, const std::string &key, size_t begin, size_t end);
+
+public:
+  /**
+   * @brief Maximum number of cached open objects.
+   */
+  static constexpr size_t MaxOpenObjects = 1024;
+
+  /**
+   * @brief Name of the abstract socket of the server.
+   */
+  const std::string name;
+
+  explicit UnixDomainClient(std::string nameArg);
+  UnixDomainClient(const UnixDomainClient &) = delete;
+  UnixDomainClient &operator=(const UnixDomainClient &) = delete;
+  ~UnixDomainClient();
+
+  absl::Status connect();
+
+  absl::StatusOr<size_t> readBytes(const std::string &bucket, const std::string &key,
+                                   uint8_t *buffer, size_t position, size_t length);
+
+  absl::StatusOr<std::vector<size_t>> readv(const std::string &bucket, const std::string &key,
+                                            const std::vector<geds::ReadRange> &ranges);
+
+  /**
+   * @brief Drop the cached descriptor of the object. The next read opens it again.
+   */
+  void invalidate(const std::string &bucket, const std::string &key);
+};
+
+} // namespace geds
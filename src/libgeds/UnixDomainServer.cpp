@@ -0,0 +1,233 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "UnixDomainServer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "GEDS.h"
+#include "GEDSFile.h"
+#include "Logging.h"
+#include "UnixDomainTransport.h"
+
+namespace geds {
+
+UnixDomainServer::UnixDomainServer(std::shared_ptr<GEDS> geds, std::string nameArg)
+    : _geds(std::move(geds)), name(std::move(nameArg)) {}
+
+UnixDomainServer::~UnixDomainServer() { stop(); }
+
+absl::Status UnixDomainServer::start() {
+  if (_started) {
+    return absl::UnknownError("Already started!");
+  }
+  sockaddr_un address;
+  auto length = unix_transport::abstractAddress(name, address);
+  if (!length.ok()) {
+    return length.status();
+  }
+  _listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (_listenFd < 0) {
+    int err = errno;
+    return absl::UnavailableError("Unable to create Unix domain socket: " +
+                                  std::string{strerror(err)});
+  }
+  if (::bind(_listenFd, reinterpret_cast<sockaddr *>(&address), *length) != 0 ||
+      ::listen(_listenFd, SOMAXCONN) != 0) {
+    int err = errno;
+    ::close(_listenFd);
+    _listenFd = -1;
+    return absl::UnavailableError("Unable to listen on " + name + ": " +
+                                  std::string{strerror(err)});
+  }
+  _started = true;
+  _acceptThread = std::thread([this] { accept(); });
+  LOG_INFO("Serving local data path on @", name);
+  return absl::OkStatus();
+}
+
+void UnixDomainServer::stop() {
+  if (!_started.exchange(false)) {
+    return;
+  }
+  LOG_DEBUG("Stopping");
+  // Wakes up the blocking accept.
+  ::shutdown(_listenFd, SHUT_RDWR);
+  _acceptThread.join();
+  ::close(_listenFd);
+  _listenFd = -1;
+
+  auto lock = std::lock_guard(_mutex);
+  for (auto &connection : _connections) {
+    ::shutdown(connection->fd, SHUT_RDWR);
+  }
+  for (auto &connection : _connections) {
+    connection->thread.join();
+    ::close(connection->fd);
+  }
+  _connections.clear();
+}
+
+void UnixDomainServer::accept() {
+  while (_started) {
+    int fd = ::accept4(_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      if (_started) {
+        LOG_ERROR("Unable to accept connection: ", strerror(errno));
+      }
+      return;
+    }
+    // Descriptors grant access to the local storage: Only serve processes of the same user.
+    ucred credentials{};
+    socklen_t credentialsLength = sizeof(credentials);
+    if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &credentialsLength) != 0 ||
+        credentials.uid != ::geteuid()) {
+      LOG_ERROR("Rejecting local connection of uid ", credentials.uid);
+      ::close(fd);
+      continue;
+    }
+    LOG_DEBUG("Accepting local connection from pid ", credentials.pid);
+
+    auto lock = std::lock_guard(_mutex);
+    // Reap connections which have been closed by the peer.
+    _connections.remove_if([](const auto &connection) {
+      if (!connection->done) {
+        return false;
+      }
+      connection->thread.join();
+      ::close(connection->fd);
+      return true;
+    });
+    auto connection = std::make_unique<Connection>();
+    connection->fd = fd;
+    auto ptr = connection.get();
+    connection->thread = std::thread([this, ptr] { serve(*ptr); });
+    _connections.emplace_back(std::move(connection));
+  }
+}
+
+void UnixDomainServer::serve(Connection &connection) {
+  int fd = connection.fd;
+  std::string payload;
+  while (true) {
+    tcp_transport::RequestHeader request;
+    auto status = unix_transport::receiveAll(fd, &request, sizeof(request));
+    if (!status.ok()) {
+      break;
+    }
+    status = tcp_transport::validateRequestHeader(request, {tcp_transport::Operation::Open});
+    if (!status.ok()) {
+      // The stream cannot be resynchronized: Drop the connection.
+      LOG_ERROR("Received invalid request: ", status.message());
+      break;
+    }
+    payload.resize(tcp_transport::requestPayloadLength(request));
+    status = unix_transport::receiveAll(fd, payload.data(), payload.size());
+    if (!status.ok()) {
+      break;
+    }
+    auto bucket = payload.substr(0, request.bucketLength);
+    auto key = payload.substr(request.bucketLength, request.keyLength);
+    status = handleOpen(fd, request, bucket, key);
+    if (!status.ok()) {
+      LOG_DEBUG("Closing local connection: ", status.message());
+      break;
+    }
+  }
+  connection.done = true;
+}
+
+absl::Status UnixDomainServer::sendError(int fd, const tcp_transport::RequestHeader &request,
+                                         const absl::Status &status) {
+  LOG_DEBUG(status.message());
+  auto message = std::string{status.message()};
+  auto header = tcp_transport::createResponseHeader(request, status.raw_code(), message.size());
+  std::string frame(reinterpret_cast<const char *>(&header), sizeof(header));
+  frame += message;
+  return unix_transport::sendAll(fd, frame.data(), frame.size());
+}
+
+absl::Status UnixDomainServer::handleOpen(int fd, const tcp_transport::RequestHeader &request,
+                                          const std::string &bucket, const std::string &key) {
+  auto opened = _geds->cachedOpen(bucket, key);
+  if (!opened.ok()) {
+    return sendError(fd, request, opened.status());
+  }
+  const auto &file = *opened;
+
+  auto size = file->size();
+  unix_transport::OpenResponse response{size, 0, size};
+  int objectFd = -1;
+  auto rawFd = file->rawFd();
+  if (rawFd.ok()) {
+    // Hand out a read-only file description instead of the writable descriptor of the file.
+    auto path = "/proc/self/fd/" + std::to_string(*rawFd);
+    objectFd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  }
+  if (objectFd < 0) {
+    // Copy the requested range into a sealed memfd.
+    auto offset = std::min<uint64_t>(request.offset, size);
+    auto length = std::min<uint64_t>(request.length, size - offset);
+    objectFd = ::memfd_create("geds", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (objectFd < 0) {
+      int err = errno;
+      return sendError(fd, request,
+                       absl::UnavailableError("Unable to create memfd: " +
+                                              std::string{strerror(err)}));
+    }
+    absl::StatusOr<size_t> count = 0;
+    if (length > 0) {
+      if (::ftruncate(objectFd, length) != 0) {
+        int err = errno;
+        ::close(objectFd);
+        return sendError(fd, request,
+                         absl::UnavailableError("Unable to size memfd: " +
+                                                std::string{strerror(err)}));
+      }
+      auto ptr = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, objectFd, 0);
+      if (ptr == MAP_FAILED) {
+        int err = errno;
+        ::close(objectFd);
+        return sendError(fd, request,
+                         absl::UnavailableError("Unable to map memfd: " +
+                                                std::string{strerror(err)}));
+      }
+      count = file->read(static_cast<uint8_t *>(ptr), offset, length);
+      ::munmap(ptr, length);
+    }
+    if (!count.ok()) {
+      ::close(objectFd);
+      return sendError(fd, request, count.status());
+    }
+    if (*count < length) {
+      (void)::ftruncate(objectFd, *count);
+    }
+    ::fcntl(objectFd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+    response = {size, offset, *count};
+  }
+
+  auto header = tcp_transport::createResponseHeader(request, absl::OkStatus().raw_code(),
+                                                    sizeof(response));
+  uint8_t frame[sizeof(header) + sizeof(response)];
+  std::memcpy(frame, &header, sizeof(header));
+  std::memcpy(frame + sizeof(header), &response, sizeof(response));
+  auto status = unix_transport::sendAll(fd, frame, sizeof(frame), objectFd);
+  ::close(objectFd);
+  return status;
+}
+
+} // namespace geds
@@ -0,0 +1,66 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <absl/status/status.h>
+
+#include "TcpDataTransport.h"
+
+class GEDS;
+
+namespace geds {
+
+/**
+ * @brief Serves the same-host data path by handing out file descriptors.
+ *
+ * See UnixDomainTransport.h for the protocol. Each connection is served by its own thread: Requests
+ * only open objects, the data is read by the client.
+ */
+class UnixDomainServer {
+  struct Connection {
+    int fd;
+    std::thread thread;
+    std::atomic<bool> done = false;
+  };
+
+  std::shared_ptr<GEDS> _geds;
+  int _listenFd = -1;
+  std::atomic<bool> _started = false;
+  std::thread _acceptThread;
+
+  std::mutex _mutex;
+  std::list<std::unique_ptr<Connection>> _connections;
+
+  void accept();
+  void serve(Connection &connection);
+  absl::Status handleOpen(int fd, const tcp_transport::RequestHeader &request,
+                          const std::string &bucket, const std::string &key);
+  absl::Status sendError(int fd, const tcp_transport::RequestHeader &request,
+                         const absl::Status &status);
+
+public:
+  /**
+   * @brief Name of the abstract socket.
+   */
+  const std::string name;
+
+  UnixDomainServer(std::shared_ptr<GEDS> geds, std::string nameArg);
+  UnixDomainServer(const UnixDomainServer &) = delete;
+  UnixDomainServer &operator=(const UnixDomainServer &) = delete;
+  ~UnixDomainServer();
+
+  absl::Status start();
+  void stop();
+};
+
+} // namespace geds
@@ -0,0 +1,136 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "UnixDomainTransport.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+
+#include <unistd.h>
+
+namespace geds::unix_transport {
+
+const std::string &hostId() {
+  static const std::string result = [] {
+    std::string id;
+    std::ifstream bootId("/proc/sys/kernel/random/boot_id");
+    if (bootId.good()) {
+      std::getline(bootId, id);
+    }
+    if (id.empty()) {
+      char hostname[256]{};
+      if (::gethostname(hostname, sizeof(hostname) - 1) == 0) {
+        id = hostname;
+      }
+    }
+    return id;
+  }();
+  return result;
+}
+
+std::string socketName(uint16_t port) {
+  return "geds-" + std::to_string(::getpid()) + "-" + std::to_string(port);
+}
+
+absl::StatusOr<socklen_t> abstractAddress(const std::string &name, sockaddr_un &address) {
+  // The leading NUL byte selects the abstract namespace.
+  if (name.empty() || name.size() + 1 > sizeof(address.sun_path)) {
+    return absl::InvalidArgumentError("Invalid socket name " + name + ".");
+  }
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  std::memcpy(&address.sun_path[1], name.data(), name.size());
+  return static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + 1 + name.size());
+}
+
+absl::Status sendAll(int socket, const void *buffer, size_t length, int fd) {
+  const auto *ptr = static_cast<const uint8_t *>(buffer);
+  size_t offset = 0;
+  while (offset < length) {
+    iovec iov{const_cast<uint8_t *>(ptr + offset), length - offset};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    if (fd >= 0) {
+      std::memset(control, 0, sizeof(control));
+      msg.msg_control = control;
+      msg.msg_controllen = sizeof(control);
+      auto cmsg = CMSG_FIRSTHDR(&msg);
+      cmsg->cmsg_level = SOL_SOCKET;
+      cmsg->cmsg_type = SCM_RIGHTS;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+      std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+    auto count = ::sendmsg(socket, &msg, MSG_NOSIGNAL);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      int err = errno;
+      return absl::UnavailableError("Unable to send: " + std::string{strerror(err)});
+    }
+    // The descriptor is transferred with the first byte.
+    fd = -1;
+    offset += count;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status receiveAll(int socket, void *buffer, size_t length, int *fd) {
+  if (fd != nullptr) {
+    *fd = -1;
+  }
+  auto *ptr = static_cast<uint8_t *>(buffer);
+  size_t offset = 0;
+  while (offset < length) {
+    iovec iov{ptr + offset, length - offset};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    auto count = ::recvmsg(socket, &msg, MSG_CMSG_CLOEXEC);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      int err = errno;
+      if (fd != nullptr && *fd >= 0) {
+        ::close(*fd);
+        *fd = -1;
+      }
+      return absl::UnavailableError("Unable to receive: " + std::string{strerror(err)});
+    }
+    for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+        continue;
+      }
+      int received;
+      std::memcpy(&received, CMSG_DATA(cmsg), sizeof(int));
+      if (fd != nullptr && *fd < 0) {
+        *fd = received;
+      } else {
+        ::close(received);
+      }
+    }
+    if (count == 0) {
+      if (fd != nullptr && *fd >= 0) {
+        ::close(*fd);
+        *fd = -1;
+      }
+      return absl::UnavailableError("Connection closed.");
+    }
+    offset += count;
+  }
+  return absl::OkStatus();
+}
+
+} // namespace geds::unix_transport
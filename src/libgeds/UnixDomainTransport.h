@@ -0,0 +1,67 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <absl/status/status.h>
+#include <absl/status/statusor.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace geds::unix_transport {
+
+/**
+ * @brief Same-host data path.
+ *
+ * The client sends a binary `tcp_transport::RequestHeader` with `Operation::Open` followed by the
+ * bucket and key. `offset` and `length` describe the range the client is interested in. The server
+ * replies with a `tcp_transport::ResponseHeader`. On success the payload is an `OpenResponse` and
+ * a read-only file descriptor is attached to the message (SCM_RIGHTS). The client reads the object
+ * from the descriptor without further involvement of the server.
+ *
+ * Objects backed by a local file hand over the file itself. Other objects are copied into a sealed
+ * memfd holding the requested range.
+ *
+ * Servers listen on an abstract socket, hence only processes in the same network namespace can
+ * connect. Connections of other users are rejected.
+ */
+struct OpenResponse {
+  // Size of the object.
+  uint64_t size;
+  // Object offset of the first byte of the descriptor.
+  uint64_t fdOffset;
+  // Number of object bytes available through the descriptor.
+  uint64_t fdLength;
+};
+static_assert(sizeof(OpenResponse) == 24);
+
+/**
+ * @brief Identifies the host. Unix domain endpoints are only used by clients on the same host.
+ */
+const std::string &hostId();
+
+/**
+ * @brief Name of the abstract socket for a GEDS instance.
+ */
+std::string socketName(uint16_t port);
+
+absl::StatusOr<socklen_t> abstractAddress(const std::string &name, sockaddr_un &address);
+
+/**
+ * @brief Write `length` bytes to `socket`. If `fd` is set, the descriptor is passed along.
+ */
+absl::Status sendAll(int socket, const void *buffer, size_t length, int fd = -1);
+
+/**
+ * @brief Read `length` bytes from `socket`. If `fd` is not null, a descriptor passed along is
+ * stored in `fd` (-1 if none was passed).
+ */
+absl::Status receiveAll(int socket, void *buffer, size_t length, int *fd = nullptr);
+
+} // namespace geds::unix_transport
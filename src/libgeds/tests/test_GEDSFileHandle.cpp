@@ -8,10 +8,15 @@
 #include "GEDSInternal.h"
 #include "GEDSLocalFileHandle.h"
 #include "GEDSService.h"
+#include "LocalFile.h"
+#include "MMAPFile.h"
 
 #include <cassert>
+#include <filesystem>
 #include <gtest/gtest.h>
 #include <memory>
+#include <string>
+#include <vector>
 
 TEST(GEDSFileHandle, openCount) {
   auto service_mock = std::shared_ptr<GEDS>(nullptr);
@@ -43,3 +48,127 @@ TEST(GEDSFileHandle, stringstream) {
   ASSERT_TRUE(handleStatus.ok());
   auto handle = handleStatus.value();
 }
+
+TEST(GEDSFileHandle, readv) {
+  auto service_mock = std::shared_ptr<GEDS>(nullptr);
+  auto path = geds::filesystem::tempFile("test_GEDSFileHandle");
+  auto handleStatus =
+      GEDSLocalFileHandle::factory(service_mock, "test", "test", std::nullopt, path);
+  ASSERT_TRUE(handleStatus.ok());
+  auto handle = handleStatus.value();
+
+  std::vector<uint8_t> data(1000);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<uint8_t>(i % 251);
+  }
+  ASSERT_TRUE(handle->writeBytes(data.data(), 0, data.size()).ok());
+
+  // Adjacent, disjoint and out-of-bounds ranges.
+  std::vector<uint8_t> a(100), b(50), c(10), d(40), e(10);
+  std::vector<geds::ReadRange> ranges{{a.data(), 0, a.size()},
+                                      {b.data(), 100, b.size()},
+                                      {c.data(), 500, c.size()},
+                                      {d.data(), 980, d.size()},
+                                      {e.data(), 2000, e.size()}};
+  auto result = handle->readv(ranges);
+  ASSERT_TRUE(result.ok());
+  ASSERT_EQ(*result, (std::vector<size_t>{100, 50, 10, 20, 0}));
+  for (size_t r = 0; r < ranges.size(); r++) {
+    for (size_t i = 0; i < (*result)[r]; i++) {
+      ASSERT_EQ(ranges[r].buffer[i], data[ranges[r].position + i]);
+    }
+  }
+}
+
+TEST(GEDSFileHandle, prepareSeal) {
+  auto service_mock = std::shared_ptr<GEDS>(nullptr);
+  auto path = geds::filesystem::tempFile("test_GEDSFileHandle");
+  auto handleStatus =
+      GEDSLocalFileHandle::factory(service_mock, "test", "test", std::nullopt, path);
+  ASSERT_TRUE(handleStatus.ok());
+  auto handle = handleStatus.value();
+  std::vector<uint8_t> data(10);
+  ASSERT_TRUE(handle->writeBytes(data.data(), 0, data.size()).ok());
+  ASSERT_TRUE(handle->setMetadata("metadata", false).ok());
+  {
+    auto pending = handle->prepareSeal();
+    ASSERT_TRUE(pending.ok());
+    ASSERT_EQ(pending->object.id.key, "test");
+    ASSERT_EQ(pending->object.info.size, data.size());
+    ASSERT_EQ(pending->object.info.metadata, "metadata");
+    ASSERT_FALSE(pending->update);
+  }
+  // The handle is only sealed once the registration succeeded.
+  {
+    auto pending = handle->prepareSeal();
+    ASSERT_TRUE(pending.ok());
+    ASSERT_FALSE(pending->update);
+    pending->markSealed();
+  }
+  auto pending = handle->prepareSeal();
+  ASSERT_TRUE(pending.ok());
+  ASSERT_TRUE(pending->update);
+}
+
+template <typename File> void testMoveTo() {
+  auto src = geds::filesystem::tempFile("test_GEDSFileHandle");
+  auto dest = geds::filesystem::tempFile("test_GEDSFileHandle");
+  const std::string data = "moved without copying";
+  {
+    File file{src};
+    ASSERT_TRUE(file.writeBytes(reinterpret_cast<const uint8_t *>(data.data()), 0, data.size())
+                    .ok());
+    ASSERT_TRUE(file.moveTo(dest).ok());
+    ASSERT_FALSE(file.rawFd().ok());
+  }
+  // The moved file is not deleted with the old file object.
+  ASSERT_FALSE(std::filesystem::exists(src));
+  ASSERT_TRUE(std::filesystem::exists(dest));
+  {
+    File file{dest, false};
+    ASSERT_EQ(file.size(), data.size());
+    std::string read(data.size(), '\0');
+    auto count = file.readBytes(reinterpret_cast<uint8_t *>(read.data()), 0, read.size());
+    ASSERT_TRUE(count.ok());
+    ASSERT_EQ(read, data);
+  }
+  ASSERT_FALSE(std::filesystem::exists(dest));
+}
+
+TEST(GEDSFileHandle, moveTo) {
+  testMoveTo<geds::filesystem::LocalFile>();
+  testMoveTo<geds::filesystem::MMAPFile>();
+}
+
+TEST(GEDSFileHandle, copyLocal) {
+  auto service_mock = std::shared_ptr<GEDS>(nullptr);
+  auto srcHandle = GEDSLocalFileHandle::factory(service_mock, "test", "src", std::nullopt,
+                                                geds::filesystem::tempFile("test_GEDSFileHandle"));
+  ASSERT_TRUE(srcHandle.ok());
+  auto src = *srcHandle;
+  const std::string data = "copied by the kernel";
+  ASSERT_TRUE(src->writeBytes(reinterpret_cast<const uint8_t *>(data.data()), 0, data.size()).ok());
+  ASSERT_TRUE(src->seal().ok());
+
+  // Whole files are cloned or copied with copy_file_range without a GEDS buffer.
+  auto destHandle = GEDSLocalFileHandle::factory(service_mock, "test", "dest", std::nullopt,
+                                                 geds::filesystem::tempFile("test_GEDSFileHandle"));
+  ASSERT_TRUE(destHandle.ok());
+  auto dest = *destHandle;
+  ASSERT_TRUE(src->download(dest).ok());
+  ASSERT_EQ(dest->size().value(), data.size());
+  std::string read(data.size(), '\0');
+  ASSERT_EQ(dest->readBytes(reinterpret_cast<uint8_t *>(read.data()), 0, read.size()).value(),
+            data.size());
+  ASSERT_EQ(read, data);
+
+  // Ranges are copied up to the end of the source.
+  auto count = src->downloadRange(dest, 7, data.size(), data.size());
+  ASSERT_TRUE(count.ok());
+  ASSERT_EQ(*count, data.size() - 7);
+  ASSERT_EQ(dest->size().value(), 2 * data.size() - 7);
+  read.resize(*count);
+  ASSERT_EQ(dest->readBytes(reinterpret_cast<uint8_t *>(read.data()), data.size(), *count).value(),
+            *count);
+  ASSERT_EQ(read, data.substr(7));
+}
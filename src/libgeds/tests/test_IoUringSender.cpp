@@ -0,0 +1,81 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "Filesystem.h"
+#include "IoUringSender.h"
+
+#include <chrono>
+#include <fcntl.h>
+#include <future>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+using namespace geds;
+
+TEST(IoUringSender, Sendfile) {
+  auto sender = IoUringSender::factory(8);
+  if (!sender.ok()) {
+    GTEST_SKIP() << sender.status();
+  }
+
+  constexpr size_t fileSize = 3 * 1024 * 1024 + 17;
+  std::string data(fileSize, '\0');
+  for (size_t i = 0; i < fileSize; i++) {
+    data[i] = static_cast<char>('a' + i % 26);
+  }
+  auto path = geds::filesystem::tempFile("test_IoUringSender");
+  int fileFd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+  ASSERT_GE(fileFd, 0);
+  ASSERT_EQ(::write(fileFd, data.data(), data.size()), static_cast<ssize_t>(data.size()));
+
+  int sockets[2];
+  ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sockets), 0);
+
+  // The reader is slower than the sender, which forces the sender to poll the socket.
+  std::string received;
+  std::thread reader([&] {
+    std::string buffer(64 * 1024, '\0');
+    while (true) {
+      auto count = ::recv(sockets[1], buffer.data(), buffer.size(), 0);
+      if (count == 0) {
+        return;
+      }
+      if (count < 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        continue;
+      }
+      received.append(buffer.data(), count);
+    }
+  });
+
+  std::promise<absl::StatusOr<size_t>> complete;
+  (*sender)->sendfile(sockets[0], fileFd, 10, fileSize - 10,
+                      [&](absl::StatusOr<size_t> sent) { complete.set_value(sent); });
+  auto sent = complete.get_future().get();
+  ASSERT_TRUE(sent.ok()) << sent.status();
+  ASSERT_EQ(*sent, fileSize - 10);
+
+  // Reading beyond the end of the file returns a short count.
+  std::promise<absl::StatusOr<size_t>> truncated;
+  (*sender)->sendfile(sockets[0], fileFd, fileSize - 5, 100,
+                      [&](absl::StatusOr<size_t> sent) { truncated.set_value(sent); });
+  auto shortCount = truncated.get_future().get();
+  ASSERT_TRUE(shortCount.ok()) << shortCount.status();
+  ASSERT_EQ(*shortCount, 5);
+
+  ::shutdown(sockets[0], SHUT_WR);
+  reader.join();
+  ASSERT_EQ(received, data.substr(10) + data.substr(fileSize - 5));
+
+  (*sender)->stop();
+  ::close(sockets[0]);
+  ::close(sockets[1]);
+  ::close(fileFd);
+  ::unlink(path.c_str());
+}
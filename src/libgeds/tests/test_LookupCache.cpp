@@ -0,0 +1,94 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "LookupCache.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace geds;
+using namespace std::chrono_literals;
+
+TEST(LookupCache, HitsAndMisses) {
+  LookupCache<int> cache("test lookup cache");
+  cache.configure(16, 10s, 10s);
+  ASSERT_FALSE(cache.get("bucket/a").has_value());
+
+  cache.put("bucket/a", 1);
+  auto hit = cache.get("bucket/a");
+  ASSERT_TRUE(hit.has_value());
+  ASSERT_TRUE(hit->ok());
+  ASSERT_EQ(**hit, 1);
+
+  cache.putMissing("bucket/b");
+  auto miss = cache.get("bucket/b");
+  ASSERT_TRUE(miss.has_value());
+  ASSERT_EQ(miss->status().code(), absl::StatusCode::kNotFound);
+
+  cache.erase("bucket/b");
+  ASSERT_FALSE(cache.get("bucket/b").has_value());
+}
+
+TEST(LookupCache, Expiry) {
+  LookupCache<int> cache("test lookup cache");
+  cache.configure(16, 1h, 10ms);
+  cache.put("bucket/a", 1);
+  cache.putMissing("bucket/b");
+  std::this_thread::sleep_for(20ms);
+  ASSERT_TRUE(cache.get("bucket/a").has_value());
+  ASSERT_FALSE(cache.get("bucket/b").has_value());
+  ASSERT_EQ(cache.size(), 1);
+
+  // A zero TTL disables caching.
+  cache.configure(16, 0ms, 1h);
+  cache.put("bucket/a", 1);
+  ASSERT_FALSE(cache.get("bucket/a").has_value());
+}
+
+TEST(LookupCache, Stale) {
+  LookupCache<int> cache("test lookup cache");
+  cache.configure(16, 10ms, 1h);
+  cache.put("bucket/a", 1);
+  std::this_thread::sleep_for(20ms);
+  ASSERT_FALSE(cache.get("bucket/a").has_value());
+  // Expired values can still be revalidated.
+  ASSERT_EQ(cache.getStale("bucket/a"), 1);
+  ASSERT_FALSE(cache.getStale("bucket/b").has_value());
+  cache.put("bucket/a", 2);
+  ASSERT_EQ(cache.get("bucket/a")->value(), 2);
+  cache.erase("bucket/a");
+  ASSERT_FALSE(cache.getStale("bucket/a").has_value());
+}
+
+TEST(LookupCache, Eviction) {
+  LookupCache<int> cache("test lookup cache");
+  cache.configure(2, 1h, 1h);
+  cache.put("bucket/a", 1);
+  cache.put("bucket/b", 2);
+  // Touch `a`: `b` is the least recently used entry.
+  ASSERT_TRUE(cache.get("bucket/a").has_value());
+  cache.put("bucket/c", 3);
+  ASSERT_EQ(cache.size(), 2);
+  ASSERT_TRUE(cache.get("bucket/a").has_value());
+  ASSERT_FALSE(cache.get("bucket/b").has_value());
+  ASSERT_TRUE(cache.get("bucket/c").has_value());
+}
+
+TEST(LookupCache, ErasePrefix) {
+  LookupCache<int> cache("test lookup cache");
+  cache.configure(16, 1h, 1h);
+  cache.put("bucket/dir/a", 1);
+  cache.putMissing("bucket/dir/b");
+  cache.put("bucket/dirx", 2);
+  cache.put("other/dir/a", 3);
+  cache.erasePrefix("bucket/dir/");
+  ASSERT_FALSE(cache.get("bucket/dir/a").has_value());
+  ASSERT_FALSE(cache.get("bucket/dir/b").has_value());
+  ASSERT_TRUE(cache.get("bucket/dirx").has_value());
+  ASSERT_TRUE(cache.get("other/dir/a").has_value());
+}
@@ -0,0 +1,328 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "MetadataService.h"
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <grpcpp/grpcpp.h>
+
+#include "GEDS.h"
+#include "GEDSConfig.h"
+#include "Object.h"
+#include "Status.h"
+#include "geds.grpc.pb.h"
+#include "geds.pb.h"
+
+namespace {
+
+/**
+ * @brief In-memory metadata server. Requests for keys in `failing` fail with UNAVAILABLE. Without
+ * `batches` the batch methods are UNIMPLEMENTED like on older servers.
+ */
+class FakeMetadataServer final : public geds::rpc::MetadataService::Service {
+  std::mutex _mutex;
+  std::map<std::string, geds::rpc::Object> _objects;
+  std::unique_ptr<grpc::Server> _server;
+  int _port = 0;
+
+  static std::string name(const geds::rpc::ObjectID &id) { return id.bucket() + "/" + id.key(); }
+
+  absl::Status create(const geds::rpc::Object &object) {
+    if (failing.count(object.id().key())) {
+      return absl::UnavailableError("failing");
+    }
+    _objects[name(object.id())] = object;
+    calls.push_back("create " + object.id().key());
+    return absl::OkStatus();
+  }
+
+  absl::Status update(const geds::rpc::Object &object) {
+    if (failing.count(object.id().key())) {
+      return absl::UnavailableError("failing");
+    }
+    auto it = _objects.find(name(object.id()));
+    if (it == _objects.end()) {
+      return absl::NotFoundError("The object does not exist.");
+    }
+    it->second = object;
+    calls.push_back("update " + object.id().key());
+    return absl::OkStatus();
+  }
+
+  absl::Status remove(const geds::rpc::ObjectID &id) {
+    if (failing.count(id.key())) {
+      return absl::UnavailableError("failing");
+    }
+    if (_objects.erase(name(id)) == 0) {
+      return absl::NotFoundError("The object does not exist.");
+    }
+    return absl::OkStatus();
+  }
+
+  void lookup(const geds::rpc::ObjectID &id, geds::rpc::ObjectResponse *response) {
+    auto it = _objects.find(name(id));
+    if (failing.count(id.key())) {
+      convertStatus(response->mutable_error(), absl::UnavailableError("failing"));
+    } else if (it == _objects.end()) {
+      convertStatus(response->mutable_error(), absl::NotFoundError("The object does not exist."));
+    } else {
+      *response->mutable_result() = it->second;
+    }
+  }
+
+public:
+  bool batches = true;
+  std::set<std::string> failing;
+  std::vector<size_t> batchSizes;
+  std::vector<std::string> calls;
+
+  FakeMetadataServer() {
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &_port);
+    builder.RegisterService(this);
+    _server = builder.BuildAndStart();
+  }
+
+  ~FakeMetadataServer() override { _server->Shutdown(); }
+
+  std::string address() const { return "127.0.0.1:" + std::to_string(_port); }
+
+  bool contains(const std::string &bucket, const std::string &key) {
+    auto lock = std::lock_guard(_mutex);
+    return _objects.count(bucket + "/" + key) != 0;
+  }
+
+  grpc::Status GetConnectionInformation(grpc::ServerContext *, const geds::rpc::EmptyParams *,
+                                        geds::rpc::ConnectionInformation *response) override {
+    response->set_remoteaddress("127.0.0.1");
+    return grpc::Status::OK;
+  }
+
+  grpc::Status CreateBucket(grpc::ServerContext *, const geds::rpc::Bucket *,
+                            geds::rpc::StatusResponse *response) override {
+    convertStatus(response, absl::OkStatus());
+    return grpc::Status::OK;
+  }
+
+  grpc::Status LookupBucket(grpc::ServerContext *, const geds::rpc::Bucket *,
+                            geds::rpc::StatusResponse *response) override {
+    convertStatus(response, absl::OkStatus());
+    return grpc::Status::OK;
+  }
+
+  grpc::Status Create(grpc::ServerContext *, const geds::rpc::Object *request,
+                      geds::rpc::StatusResponse *response) override {
+    auto lock = std::lock_guard(_mutex);
+    convertStatus(response, create(*request));
+    return grpc::Status::OK;
+  }
+
+  grpc::Status Update(grpc::ServerContext *, const geds::rpc::Object *request,
+                      geds::rpc::StatusResponse *response) override {
+    auto lock = std::lock_guard(_mutex);
+    convertStatus(response, update(*request));
+    return grpc::Status::OK;
+  }
+
+  grpc::Status Delete(grpc::ServerContext *, const geds::rpc::ObjectID *request,
+                      geds::rpc::StatusResponse *response) override {
+    auto lock = std::lock_guard(_mutex);
+    convertStatus(response, remove(*request));
+    return grpc::Status::OK;
+  }
+
+  grpc::Status Lookup(grpc::ServerContext *, const geds::rpc::ObjectID *request,
+                      geds::rpc::ObjectResponse *response) override {
+    auto lock = std::lock_guard(_mutex);
+    lookup(*request, response);
+    return grpc::Status::OK;
+  }
+
+  grpc::Status LookupBatch(grpc::ServerContext *context, const geds::rpc::ObjectIDBatch *request,
+                           geds::rpc::ObjectResponseBatch *response) override {
+    if (!batches) {
+      return Service::LookupBatch(context, request, response);
+    }
+    auto lock = std::lock_guard(_mutex);
+    batchSizes.push_back(request->ids_size());
+    for (const auto &id : request->ids()) {
+      lookup(id, response->add_results());
+    }
+    return grpc::Status::OK;
+  }
+
+  grpc::Status CreateBatch(grpc::ServerContext *context, const geds::rpc::ObjectBatch *request,
+                           geds::rpc::StatusResponseBatch *response) override {
+    if (!batches) {
+      return Service::CreateBatch(context, request, response);
+    }
+    auto lock = std::lock_guard(_mutex);
+    batchSizes.push_back(request->objects_size());
+    for (const auto &object : request->objects()) {
+      convertStatus(response->add_results(), create(object));
+    }
+    return grpc::Status::OK;
+  }
+
+  grpc::Status DeleteBatch(grpc::ServerContext *context, const geds::rpc::ObjectIDBatch *request,
+                           geds::rpc::StatusResponseBatch *response) override {
+    if (!batches) {
+      return Service::DeleteBatch(context, request, response);
+    }
+    auto lock = std::lock_guard(_mutex);
+    batchSizes.push_back(request->ids_size());
+    for (const auto &id : request->ids()) {
+      convertStatus(response->add_results(), remove(id));
+    }
+    return grpc::Status::OK;
+  }
+};
+
+std::vector<geds::Object> makeObjects(size_t count) {
+  std::vector<geds::Object> objects;
+  for (size_t i = 0; i < count; i++) {
+    objects.push_back(geds::Object{geds::ObjectID{"bucket", std::to_string(i)},
+                                   geds::ObjectInfo{"geds://node", i, i, std::nullopt}});
+  }
+  return objects;
+}
+
+std::vector<geds::ObjectID> idsOf(const std::vector<geds::Object> &objects) {
+  std::vector<geds::ObjectID> ids;
+  for (const auto &object : objects) {
+    ids.push_back(object.id);
+  }
+  return ids;
+}
+
+} // namespace
+
+TEST(MetadataService, BatchChunking) {
+  FakeMetadataServer server;
+  server.failing.insert("1500");
+  geds::MetadataService client(server.address());
+  ASSERT_TRUE(client.connect().ok());
+
+  auto objects = makeObjects(2 * geds::MetadataService::MaxBatchSize + 452);
+  const std::vector<size_t> chunks{geds::MetadataService::MaxBatchSize,
+                                   geds::MetadataService::MaxBatchSize, 452};
+  auto created = client.createBatch(objects);
+  ASSERT_TRUE(created.ok());
+  ASSERT_EQ(created->size(), objects.size());
+  for (size_t i = 0; i < objects.size(); i++) {
+    ASSERT_EQ((*created)[i].ok(), i != 1500) << i;
+  }
+  ASSERT_EQ(server.batchSizes, chunks);
+
+  server.batchSizes.clear();
+  auto ids = idsOf(objects);
+  ids.emplace_back("bucket", "missing");
+  auto found = client.lookupBatch(ids, true);
+  ASSERT_TRUE(found.ok());
+  ASSERT_EQ(found->size(), ids.size());
+  ASSERT_TRUE((*found)[0].ok());
+  ASSERT_EQ((*found)[7]->info.size, 7);
+  ASSERT_EQ((*found)[1500].status().code(), absl::StatusCode::kUnavailable);
+  ASSERT_EQ(found->back().status().code(), absl::StatusCode::kNotFound);
+  ASSERT_EQ(server.batchSizes, (std::vector<size_t>{geds::MetadataService::MaxBatchSize,
+                                                    geds::MetadataService::MaxBatchSize, 453}));
+
+  server.batchSizes.clear();
+  ids.pop_back();
+  auto deleted = client.deleteBatch(ids);
+  ASSERT_TRUE(deleted.ok());
+  for (size_t i = 0; i < ids.size(); i++) {
+    ASSERT_EQ((*deleted)[i].ok(), i != 1500) << i;
+  }
+  ASSERT_EQ(server.batchSizes, chunks);
+  ASSERT_FALSE(server.contains("bucket", "0"));
+  ASSERT_TRUE(client.disconnect().ok());
+}
+
+TEST(MetadataService, UnimplementedFallback) {
+  FakeMetadataServer server;
+  server.batches = false;
+  server.failing.insert("1");
+  geds::MetadataService client(server.address());
+  ASSERT_TRUE(client.connect().ok());
+
+  auto objects = makeObjects(3);
+  auto created = client.createBatch(objects);
+  ASSERT_TRUE(created.ok());
+  ASSERT_EQ(*created, (std::vector<absl::Status>{
+                          absl::OkStatus(), absl::UnavailableError("failing"), absl::OkStatus()}));
+  ASSERT_TRUE(server.contains("bucket", "2"));
+
+  auto ids = idsOf(objects);
+  auto found = client.lookupBatch(ids, true);
+  ASSERT_TRUE(found.ok());
+  ASSERT_TRUE((*found)[0].ok());
+  ASSERT_EQ((*found)[1].status().code(), absl::StatusCode::kUnavailable);
+  ASSERT_EQ((*found)[2]->info.size, 2);
+
+  auto deleted = client.deleteBatch(ids);
+  ASSERT_TRUE(deleted.ok());
+  ASSERT_TRUE((*deleted)[0].ok());
+  ASSERT_EQ((*deleted)[1].code(), absl::StatusCode::kUnavailable);
+  ASSERT_TRUE((*deleted)[2].ok());
+  ASSERT_TRUE(server.batchSizes.empty());
+  ASSERT_TRUE(client.disconnect().ok());
+}
+
+TEST(MetadataService, SealManyDeleteMany) {
+  FakeMetadataServer server;
+  server.failing.insert("bad");
+
+  GEDSConfig config(server.address());
+  config.hostname = "localhost";
+  config.port = 0;
+  config.portHttpServer = 0;
+  auto geds = GEDS::factory(std::move(config));
+  ASSERT_TRUE(geds->start().ok());
+
+  std::vector<GEDSFile> files;
+  for (const std::string key : {"a", "bad", "c"}) {
+    auto file = geds->create("bucket", key);
+    ASSERT_TRUE(file.ok());
+    files.push_back(*file);
+  }
+  // A file passed twice is registered once.
+  files.push_back(files[0]);
+  auto sealed = geds->sealMany(files);
+  ASSERT_TRUE(sealed.ok());
+  ASSERT_EQ(sealed->size(), files.size());
+  ASSERT_TRUE((*sealed)[0].ok());
+  ASSERT_EQ((*sealed)[1].code(), absl::StatusCode::kUnavailable);
+  ASSERT_TRUE((*sealed)[2].ok());
+  ASSERT_TRUE((*sealed)[3].ok());
+  ASSERT_EQ(server.batchSizes, (std::vector<size_t>{3}));
+
+  // The failed file is not marked as sealed: Sealing it again creates the object.
+  server.failing.clear();
+  ASSERT_TRUE(files[1].seal().ok());
+  ASSERT_EQ(server.calls.back(), "create bad");
+  ASSERT_TRUE(files[0].seal().ok());
+  ASSERT_EQ(server.calls.back(), "update a");
+
+  server.failing.insert("c");
+  auto deleted = geds->deleteMany("bucket", {"a", "missing", "c"});
+  ASSERT_TRUE(deleted.ok());
+  ASSERT_TRUE((*deleted)[0].ok());
+  ASSERT_TRUE((*deleted)[1].ok());
+  ASSERT_EQ((*deleted)[2].code(), absl::StatusCode::kUnavailable);
+  ASSERT_FALSE(server.contains("bucket", "a"));
+  ASSERT_TRUE(server.contains("bucket", "c"));
+
+  files.clear();
+  ASSERT_TRUE(geds->stop().ok());
+}
@@ -0,0 +1,182 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ReadAhead.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace geds;
+
+namespace {
+
+constexpr size_t objectSize = 1024 * 1024;
+constexpr size_t minWindow = 16 * 1024;
+constexpr size_t maxWindow = 128 * 1024;
+
+uint8_t payloadByte(size_t offset) { return static_cast<uint8_t>(offset % 251); }
+
+/**
+ * @brief Remote object which counts the requests it serves. Prefetches run on their own threads.
+ */
+struct FakeRemote {
+  std::atomic<size_t> requests = 0;
+  std::mutex mutex;
+  std::vector<std::thread> threads;
+
+  ReadAhead::Fetch fetch() {
+    return [this](uint8_t *buffer, size_t position, size_t length) -> absl::StatusOr<size_t> {
+      requests++;
+      if (position >= objectSize) {
+        return 0;
+      }
+      auto count = std::min(length, objectSize - position);
+      for (size_t i = 0; i < count; i++) {
+        buffer[i] = payloadByte(position + i);
+      }
+      return count;
+    };
+  }
+
+  ReadAhead::Executor executor() {
+    return [this](std::function<void()> task) {
+      auto lock = std::lock_guard(mutex);
+      threads.emplace_back(std::move(task));
+    };
+  }
+
+  ~FakeRemote() {
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+};
+
+void checkPayload(const std::vector<uint8_t> &buffer, size_t position, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    ASSERT_EQ(buffer[i], payloadByte(position + i)) << "at " << position + i;
+  }
+}
+
+} // namespace
+
+TEST(ReadAhead, Sequential) {
+  FakeRemote remote;
+  auto pool = ReadAheadBufferPool::factory(4 * maxWindow);
+  {
+    ReadAhead readAhead(remote.fetch(), remote.executor(), pool, objectSize, minWindow, maxWindow);
+    std::vector<uint8_t> buffer(10000);
+    size_t position = 0;
+    while (position < objectSize) {
+      auto count = readAhead.read(buffer.data(), position, buffer.size());
+      ASSERT_TRUE(count.ok()) << count.status();
+      ASSERT_EQ(*count, std::min(buffer.size(), objectSize - position));
+      checkPayload(buffer, position, *count);
+      position += *count;
+    }
+    // Reads are served from prefetched windows of up to `maxWindow` bytes.
+    ASSERT_LT(remote.requests, objectSize / buffer.size() / 4);
+  }
+  ASSERT_LE(pool->allocated(), 4 * maxWindow);
+}
+
+TEST(ReadAhead, RandomAccess) {
+  FakeRemote remote;
+  auto pool = ReadAheadBufferPool::factory(4 * maxWindow);
+  ReadAhead readAhead(remote.fetch(), remote.executor(), pool, objectSize, minWindow, maxWindow);
+  std::vector<uint8_t> buffer(1000);
+  for (size_t position : {500000UL, 1000UL, 700000UL, 1048000UL}) {
+    auto count = readAhead.read(buffer.data(), position, buffer.size());
+    ASSERT_TRUE(count.ok()) << count.status();
+    ASSERT_EQ(*count, std::min(buffer.size(), objectSize - position));
+    checkPayload(buffer, position, *count);
+  }
+  auto count = readAhead.read(buffer.data(), objectSize, buffer.size());
+  ASSERT_TRUE(count.ok()) << count.status();
+  ASSERT_EQ(*count, 0);
+}
+
+TEST(ReadAhead, ExhaustedPool) {
+  FakeRemote remote;
+  // The pool cannot hold a single window: All reads are forwarded.
+  auto pool = ReadAheadBufferPool::factory(minWindow / 2);
+  ReadAhead readAhead(remote.fetch(), remote.executor(), pool, objectSize, minWindow, maxWindow);
+  std::vector<uint8_t> buffer(1000);
+  for (size_t position = 0; position < 10 * buffer.size(); position += buffer.size()) {
+    auto count = readAhead.read(buffer.data(), position, buffer.size());
+    ASSERT_TRUE(count.ok()) << count.status();
+    checkPayload(buffer, position, *count);
+  }
+  ASSERT_EQ(remote.requests, 10);
+  ASSERT_EQ(pool->allocated(), 0);
+}
+
+TEST(ReadAhead, InlinePrefetch) {
+  FakeRemote remote;
+  auto pool = ReadAheadBufferPool::factory(4 * maxWindow);
+  // Prefetches are never scheduled: Readers run them inline.
+  ReadAhead readAhead(
+      remote.fetch(), [](std::function<void()>) {}, pool, objectSize, minWindow, maxWindow);
+  std::vector<uint8_t> buffer(4096);
+  for (size_t position = 0; position < 64 * buffer.size(); position += buffer.size()) {
+    auto count = readAhead.read(buffer.data(), position, buffer.size());
+    ASSERT_TRUE(count.ok()) << count.status();
+    ASSERT_EQ(*count, buffer.size());
+    checkPayload(buffer, position, *count);
+  }
+}
+
+TEST(ReadAhead, ConcurrentReaders) {
+  FakeRemote remote;
+  auto pool = ReadAheadBufferPool::factory(4 * maxWindow);
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool blocked = false;
+  bool released = false;
+  // The prefetch following the first read blocks until it is released.
+  auto fetch = [&, remoteFetch = remote.fetch()](uint8_t *buffer, size_t position,
+                                                 size_t length) -> absl::StatusOr<size_t> {
+    if (position == 4096) {
+      auto lock = std::unique_lock(mutex);
+      blocked = true;
+      cv.notify_all();
+      cv.wait(lock, [&]() { return released; });
+    }
+    return remoteFetch(buffer, position, length);
+  };
+  ReadAhead readAhead(
+      fetch, [](std::function<void()>) {}, pool, objectSize, minWindow, maxWindow);
+  std::vector<uint8_t> buffer(4096);
+  ASSERT_TRUE(readAhead.read(buffer.data(), 0, buffer.size()).ok());
+
+  std::vector<uint8_t> sequential(4096);
+  absl::StatusOr<size_t> sequentialCount;
+  std::thread reader(
+      [&]() { sequentialCount = readAhead.read(sequential.data(), 4096, sequential.size()); });
+  {
+    auto lock = std::unique_lock(mutex);
+    cv.wait(lock, [&]() { return blocked; });
+  }
+  // A reader waiting for a prefetch does not block other readers.
+  auto count = readAhead.read(buffer.data(), 500000, buffer.size());
+  ASSERT_TRUE(count.ok()) << count.status();
+  checkPayload(buffer, 500000, *count);
+  {
+    auto lock = std::lock_guard(mutex);
+    released = true;
+    cv.notify_all();
+  }
+  reader.join();
+  ASSERT_TRUE(sequentialCount.ok()) << sequentialCount.status();
+  ASSERT_EQ(*sequentialCount, sequential.size());
+  checkPayload(sequential, 4096, *sequentialCount);
+}
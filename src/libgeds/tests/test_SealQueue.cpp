@@ -0,0 +1,130 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "SealQueue.h"
+
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace geds;
+
+namespace {
+
+geds::Object makeObject(const std::string &key, size_t size) {
+  return geds::Object{geds::ObjectID{"bucket", key}, geds::ObjectInfo{"geds://", size, size, {}}};
+}
+
+/**
+ * @brief Metadata service which records the batches it registers.
+ */
+struct FakeMetadata {
+  std::mutex mutex;
+  std::vector<std::vector<geds::Object>> batches;
+  std::string failingKey;
+
+  SealQueue::Commit commit() {
+    return [this](const std::vector<geds::Object> &objects)
+               -> absl::StatusOr<std::vector<absl::Status>> {
+      auto lock = std::lock_guard(mutex);
+      batches.push_back(objects);
+      std::vector<absl::Status> result;
+      for (const auto &object : objects) {
+        result.push_back(object.id.key == failingKey ? absl::UnavailableError("failed")
+                                                     : absl::OkStatus());
+      }
+      return result;
+    };
+  }
+
+  size_t registered() {
+    auto lock = std::lock_guard(mutex);
+    size_t count = 0;
+    for (const auto &batch : batches) {
+      count += batch.size();
+    }
+    return count;
+  }
+};
+
+} // namespace
+
+TEST(SealQueue, Flush) {
+  FakeMetadata metadata;
+  SealQueue queue(metadata.commit(), 16);
+  std::vector<std::shared_future<absl::Status>> results;
+  for (size_t i = 0; i < 100; i++) {
+    results.push_back(queue.enqueue(makeObject("key" + std::to_string(i), i)));
+  }
+  ASSERT_TRUE(queue.flush().ok());
+  for (auto &result : results) {
+    ASSERT_EQ(result.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    ASSERT_TRUE(result.get().ok());
+  }
+  ASSERT_EQ(metadata.registered(), 100);
+  auto lock = std::lock_guard(metadata.mutex);
+  for (const auto &batch : metadata.batches) {
+    ASSERT_LE(batch.size(), 16);
+  }
+}
+
+TEST(SealQueue, Coalesce) {
+  FakeMetadata metadata;
+  std::promise<void> started;
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  // Block the first batch until all seals are queued.
+  auto blocking = [&, commit = metadata.commit()](const std::vector<geds::Object> &objects) {
+    if (objects.front().id.key == "blocker") {
+      started.set_value();
+      released.wait();
+    }
+    return commit(objects);
+  };
+  SealQueue queue(blocking, 1024);
+  auto first = queue.enqueue(makeObject("blocker", 0));
+  started.get_future().wait();
+  std::vector<std::shared_future<absl::Status>> results;
+  for (size_t i = 1; i <= 10; i++) {
+    results.push_back(queue.enqueue(makeObject("key", i)));
+  }
+  release.set_value();
+  ASSERT_TRUE(queue.flush().ok());
+  ASSERT_TRUE(first.get().ok());
+  for (auto &result : results) {
+    ASSERT_TRUE(result.get().ok());
+  }
+  auto lock = std::lock_guard(metadata.mutex);
+  ASSERT_EQ(metadata.batches.back().size(), 1);
+  ASSERT_EQ(metadata.batches.back().front().info.size, 10);
+}
+
+TEST(SealQueue, Errors) {
+  FakeMetadata metadata;
+  metadata.failingKey = "bad";
+  SealQueue queue(metadata.commit(), 1024);
+  bool goodRegistered = false;
+  bool badRegistered = false;
+  auto good = queue.enqueue(makeObject("good", 1), [&]() { goodRegistered = true; });
+  auto bad = queue.enqueue(makeObject("bad", 1), [&]() { badRegistered = true; });
+  auto status = queue.flush();
+  ASSERT_EQ(status.code(), absl::StatusCode::kUnavailable);
+  ASSERT_TRUE(good.get().ok());
+  ASSERT_EQ(bad.get().code(), absl::StatusCode::kUnavailable);
+  // Only successful registrations are reported.
+  ASSERT_TRUE(goodRegistered);
+  ASSERT_FALSE(badRegistered);
+  // Errors are reported once.
+  ASSERT_TRUE(queue.flush().ok());
+
+  ASSERT_TRUE(queue.stop().ok());
+  auto stopped = queue.enqueue(makeObject("late", 1));
+  ASSERT_EQ(stopped.get().code(), absl::StatusCode::kFailedPrecondition);
+}
@@ -0,0 +1,228 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "TcpClient.h"
+#include "TcpDataTransport.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace geds;
+using namespace geds::tcp_transport;
+
+namespace {
+
+bool readFully(int fd, void *buffer, size_t length) {
+  size_t offset = 0;
+  while (offset < length) {
+    auto count = ::read(fd, static_cast<char *>(buffer) + offset, length - offset);
+    if (count <= 0) {
+      return false;
+    }
+    offset += count;
+  }
+  return true;
+}
+
+bool writeFully(int fd, const void *buffer, size_t length) {
+  size_t offset = 0;
+  while (offset < length) {
+    auto count = ::write(fd, static_cast<const char *>(buffer) + offset, length - offset);
+    if (count <= 0) {
+      return false;
+    }
+    offset += count;
+  }
+  return true;
+}
+
+char payloadByte(size_t offset) { return static_cast<char>('a' + offset % 26); }
+
+constexpr uint64_t objectSize = 1000;
+
+/**
+ * @brief Minimal binary protocol peer which collects up to `batchSize` requests and answers them
+ * in reverse order. Requests for the key `missing` return NOT_FOUND.
+ */
+class ReorderingPeer {
+  int _listenFd = -1;
+  uint16_t _port = 0;
+  std::thread _thread;
+
+  void serve(size_t batchSize) {
+    int fd = ::accept(_listenFd, nullptr, nullptr);
+    if (fd < 0) {
+      return;
+    }
+    while (true) {
+      struct Request {
+        RequestHeader header;
+        std::string key;
+        std::vector<RangeRequest> ranges;
+      };
+      std::vector<Request> batch;
+      for (size_t i = 0; i < batchSize; i++) {
+        if (i > 0) {
+          pollfd p{fd, POLLIN, 0};
+          if (::poll(&p, 1, 20) == 0) {
+            break;
+          }
+        }
+        RequestHeader header;
+        if (!readFully(fd, &header, sizeof(header))) {
+          ::close(fd);
+          return;
+        }
+        std::string payload(header.bucketLength + header.keyLength, '\0');
+        if (!readFully(fd, payload.data(), payload.size())) {
+          ::close(fd);
+          return;
+        }
+        std::vector<RangeRequest> ranges;
+        if (header.op == Operation::GetV) {
+          ranges.resize(header.length);
+          if (!readFully(fd, ranges.data(), ranges.size() * sizeof(RangeRequest))) {
+            ::close(fd);
+            return;
+          }
+        }
+        batch.push_back({header, payload.substr(header.bucketLength), std::move(ranges)});
+      }
+      for (auto it = batch.rbegin(); it != batch.rend(); ++it) {
+        const auto &[header, key, ranges] = *it;
+        std::string payload;
+        int statusCode = absl::OkStatus().raw_code();
+        if (key == "missing") {
+          payload = "not found";
+          statusCode = absl::NotFoundError("").raw_code();
+        } else if (header.op == Operation::GetV) {
+          // Ranges are truncated at `objectSize`.
+          std::vector<uint64_t> counts;
+          std::string data;
+          for (const auto &range : ranges) {
+            auto count = range.offset >= objectSize
+                             ? 0
+                             : std::min<uint64_t>(range.length, objectSize - range.offset);
+            counts.push_back(count);
+            data += std::string(count, payloadByte(range.offset));
+          }
+          payload.assign(reinterpret_cast<const char *>(counts.data()),
+                         counts.size() * sizeof(uint64_t));
+          payload += data;
+        } else {
+          payload = std::string(header.length, payloadByte(header.offset));
+        }
+        auto response = createResponseHeader(header, statusCode, payload.size());
+        writeFully(fd, &response, sizeof(response));
+        writeFully(fd, payload.data(), payload.size());
+      }
+    }
+  }
+
+public:
+  explicit ReorderingPeer(size_t batchSize) {
+    _listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = 0;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    EXPECT_EQ(::bind(_listenFd, reinterpret_cast<sockaddr *>(&addr), len), 0);
+    EXPECT_EQ(::listen(_listenFd, 1), 0);
+    EXPECT_EQ(::getsockname(_listenFd, reinterpret_cast<sockaddr *>(&addr), &len), 0);
+    _port = ntohs(addr.sin_port);
+    _thread = std::thread([this, batchSize] { serve(batchSize); });
+  }
+
+  ~ReorderingPeer() {
+    ::shutdown(_listenFd, SHUT_RDWR);
+    ::close(_listenFd);
+    _thread.join();
+  }
+
+  uint16_t port() const { return _port; }
+};
+
+} // namespace
+
+TEST(TcpClient, PipelinedOutOfOrder) {
+  constexpr size_t numThreads = 16;
+  constexpr size_t numRequests = 25;
+  constexpr size_t length = 100;
+
+  ReorderingPeer peer(4);
+  {
+    auto client = std::make_shared<TcpClient>("127.0.0.1", peer.port(), BinaryProtocolVersion, 8);
+    ASSERT_TRUE(client->connect().ok());
+
+    std::atomic<size_t> success = 0;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++) {
+      threads.emplace_back([&, t] {
+        std::vector<uint8_t> buffer(length);
+        for (size_t i = 0; i < numRequests; i++) {
+          size_t offset = t * numRequests + i;
+          if (offset % 7 == 0) {
+            auto result = client->readBytes("bucket", "missing", buffer.data(), offset, length);
+            if (!result.ok() && result.status().code() == absl::StatusCode::kNotFound) {
+              success++;
+            }
+            continue;
+          }
+          auto result = client->readBytes("bucket", "key", buffer.data(), offset, length);
+          if (result.ok() && *result == length &&
+              buffer.front() == static_cast<uint8_t>(payloadByte(offset)) &&
+              buffer.back() == buffer.front()) {
+            success++;
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    ASSERT_EQ(success, numThreads * numRequests);
+    ASSERT_EQ(client->inFlight(), 0);
+    ASSERT_FALSE(client->failed());
+  }
+}
+
+TEST(TcpClient, Readv) {
+  ReorderingPeer peer(4);
+  {
+    auto client = std::make_shared<TcpClient>("127.0.0.1", peer.port(), BinaryProtocolVersion, 8);
+    ASSERT_TRUE(client->connect().ok());
+
+    std::vector<uint8_t> a(10), b(20), c(50), d(10);
+    std::vector<ReadRange> ranges{{a.data(), 0, a.size()},
+                                  {b.data(), 500, b.size()},
+                                  {c.data(), 980, c.size()},
+                                  {d.data(), 2000, d.size()}};
+    auto result = client->readv("bucket", "key", ranges);
+    ASSERT_TRUE(result.ok()) << result.status();
+    ASSERT_EQ(*result, (std::vector<size_t>{10, 20, 20, 0}));
+    ASSERT_EQ(a.front(), static_cast<uint8_t>(payloadByte(0)));
+    ASSERT_EQ(b.back(), static_cast<uint8_t>(payloadByte(500)));
+    ASSERT_EQ(c[19], static_cast<uint8_t>(payloadByte(980)));
+    ASSERT_EQ(c[20], 0);
+
+    auto missing = client->readv("bucket", "missing", ranges);
+    ASSERT_EQ(missing.status().code(), absl::StatusCode::kNotFound);
+    ASSERT_FALSE(client->failed());
+  }
+}
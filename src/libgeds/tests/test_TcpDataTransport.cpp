@@ -37,3 +37,86 @@ TEST(TcpDataTransport, Parsing) {
   ASSERT_EQ(offset, 0);
   ASSERT_EQ(length, 1073766400);
 }
+
+TEST(TcpDataTransport, BinaryParsing) {
+  auto request = createBinaryGetRequest(42, "bucket", "key ", 0, 1073766400);
+  ASSERT_TRUE(request.ok());
+  ASSERT_EQ(request->size(), sizeof(RequestHeader) + 6 + 4);
+  ASSERT_EQ(static_cast<uint8_t>((*request)[0]), BinaryProtocolMagic);
+
+  uint64_t requestId = 0;
+  std::string bucket;
+  std::string key;
+  size_t offset = SIZE_MAX;
+  size_t length = SIZE_MAX;
+  auto status = parseBinaryGetRequest(*request, requestId, bucket, key, offset, length);
+  if (!status.ok()) {
+    LOG_ERROR(status.message());
+  }
+  ASSERT_TRUE(status.ok());
+
+  ASSERT_EQ(requestId, 42);
+  ASSERT_EQ(bucket, "bucket");
+  ASSERT_EQ(key, "key ");
+  ASSERT_EQ(offset, 0);
+  ASSERT_EQ(length, 1073766400);
+}
+
+TEST(TcpDataTransport, BinaryInvalid) {
+  auto request = createBinaryGetRequest(1, "bucket", "key", 0, 10);
+  ASSERT_TRUE(request.ok());
+
+  uint64_t requestId = 0;
+  std::string bucket;
+  std::string key;
+  size_t offset = 0;
+  size_t length = 0;
+
+  // Truncated frame.
+  auto truncated = request->substr(0, request->size() - 1);
+  ASSERT_FALSE(parseBinaryGetRequest(truncated, requestId, bucket, key, offset, length).ok());
+
+  // Text requests are not valid binary frames.
+  auto text = createGetRequest("bucket", "key", 0, 10);
+  ASSERT_FALSE(parseBinaryGetRequest(text, requestId, bucket, key, offset, length).ok());
+
+  // Unsupported version.
+  auto invalidVersion = *request;
+  invalidVersion[1] = static_cast<char>(BinaryProtocolVersion + 1);
+  ASSERT_FALSE(
+      parseBinaryGetRequest(invalidVersion, requestId, bucket, key, offset, length).ok());
+
+  auto header = createRequestHeader(Operation::Get, 7, "bucket", "key", 0, 10);
+  ASSERT_TRUE(header.ok());
+  auto response = createResponseHeader(*header, 0, 10);
+  ASSERT_TRUE(validateResponseHeader(response, 7).ok());
+  ASSERT_FALSE(validateResponseHeader(response, 8).ok());
+}
+
+TEST(TcpDataTransport, BinaryVectored) {
+  auto header = createRequestHeader(Operation::GetV, 3, "bucket", "key", 0, 4);
+  ASSERT_TRUE(header.ok());
+  ASSERT_TRUE(validateRequestHeader(*header).ok());
+  ASSERT_EQ(requestPayloadLength(*header), 6 + 3 + 4 * sizeof(RangeRequest));
+
+  // Vectored requests need at least one and at most `BinaryProtocolMaxRanges` ranges.
+  auto empty = *header;
+  empty.length = 0;
+  ASSERT_FALSE(validateRequestHeader(empty).ok());
+  auto tooMany = *header;
+  tooMany.length = BinaryProtocolMaxRanges + 1;
+  ASSERT_FALSE(validateRequestHeader(tooMany).ok());
+
+  // Vectored frames are not plain Get requests.
+  std::string frame(reinterpret_cast<const char *>(&(*header)), sizeof(RequestHeader));
+  frame.append("bucketkey");
+  frame.append(4 * sizeof(RangeRequest), '\0');
+  uint64_t requestId = 0;
+  std::string bucket;
+  std::string key;
+  size_t offset = 0;
+  size_t length = 0;
+  auto status = parseBinaryGetRequest(frame, requestId, bucket, key, offset, length);
+  ASSERT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  ASSERT_EQ(status.message().find("Frame length"), std::string::npos) << status;
+}
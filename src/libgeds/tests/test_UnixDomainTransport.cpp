@@ -0,0 +1,203 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "TcpDataTransport.h"
+#include "UnixDomainClient.h"
+#include "UnixDomainTransport.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace geds;
+using namespace geds::tcp_transport;
+
+namespace {
+
+char payloadByte(size_t offset) { return static_cast<char>('a' + offset % 26); }
+
+constexpr uint64_t objectSize = 1000;
+
+/**
+ * @brief Minimal Unix domain peer. Objects are served from a memfd holding the requested range.
+ * Requests for the key `missing` return NOT_FOUND.
+ */
+class LocalPeer {
+  int _listenFd = -1;
+  std::thread _thread;
+
+  void serve() {
+    int fd = ::accept(_listenFd, nullptr, nullptr);
+    if (fd < 0) {
+      return;
+    }
+    while (true) {
+      RequestHeader request;
+      if (!unix_transport::receiveAll(fd, &request, sizeof(request)).ok() ||
+          !validateRequestHeader(request, {Operation::Open}).ok()) {
+        break;
+      }
+      std::string payload(requestPayloadLength(request), '\0');
+      if (!unix_transport::receiveAll(fd, payload.data(), payload.size()).ok()) {
+        break;
+      }
+      auto key = payload.substr(request.bucketLength);
+      opens++;
+      if (key == "missing") {
+        std::string message = "not found";
+        auto header = createResponseHeader(request, absl::NotFoundError("").raw_code(),
+                                           message.size());
+        std::string frame(reinterpret_cast<const char *>(&header), sizeof(header));
+        (void)unix_transport::sendAll(fd, (frame + message).data(), frame.size() + message.size());
+        continue;
+      }
+      auto offset = std::min(request.offset, objectSize);
+      auto length = std::min(request.length, objectSize - offset);
+      std::string data;
+      for (size_t i = 0; i < length; i++) {
+        data.push_back(payloadByte(offset + i));
+      }
+      int objectFd = ::memfd_create("test", MFD_CLOEXEC);
+      EXPECT_EQ(::write(objectFd, data.data(), data.size()), static_cast<ssize_t>(data.size()));
+
+      unix_transport::OpenResponse response{objectSize, offset, length};
+      auto header = createResponseHeader(request, absl::OkStatus().raw_code(), sizeof(response));
+      std::string frame(reinterpret_cast<const char *>(&header), sizeof(header));
+      frame.append(reinterpret_cast<const char *>(&response), sizeof(response));
+      auto status = unix_transport::sendAll(fd, frame.data(), frame.size(), objectFd);
+      ::close(objectFd);
+      if (!status.ok()) {
+        break;
+      }
+    }
+    ::close(fd);
+  }
+
+public:
+  const std::string name = "geds-test-" + std::to_string(::getpid());
+  std::atomic<size_t> opens = 0;
+
+  LocalPeer() {
+    sockaddr_un address;
+    auto length = unix_transport::abstractAddress(name, address);
+    EXPECT_TRUE(length.ok());
+    _listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    EXPECT_EQ(::bind(_listenFd, reinterpret_cast<sockaddr *>(&address), *length), 0);
+    EXPECT_EQ(::listen(_listenFd, 1), 0);
+    _thread = std::thread([this] { serve(); });
+  }
+
+  ~LocalPeer() {
+    ::shutdown(_listenFd, SHUT_RDWR);
+    ::close(_listenFd);
+    _thread.join();
+  }
+};
+
+} // namespace
+
+TEST(UnixDomainTransport, PassDescriptor) {
+  int sockets[2];
+  ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+  int memfd = ::memfd_create("test", MFD_CLOEXEC);
+  ASSERT_EQ(::write(memfd, "hello", 5), 5);
+
+  uint64_t value = 42;
+  ASSERT_TRUE(unix_transport::sendAll(sockets[0], &value, sizeof(value), memfd).ok());
+  ::close(memfd);
+
+  uint64_t received = 0;
+  int fd = -1;
+  ASSERT_TRUE(unix_transport::receiveAll(sockets[1], &received, sizeof(received), &fd).ok());
+  ASSERT_EQ(received, value);
+  ASSERT_GE(fd, 0);
+  char buffer[5];
+  ASSERT_EQ(::pread(fd, buffer, sizeof(buffer), 0), 5);
+  ASSERT_EQ(std::string(buffer, sizeof(buffer)), "hello");
+  ::close(fd);
+
+  ::close(sockets[0]);
+  ASSERT_FALSE(unix_transport::receiveAll(sockets[1], &received, sizeof(received)).ok());
+  ::close(sockets[1]);
+}
+
+TEST(UnixDomainClient, Readv) {
+  LocalPeer peer;
+  UnixDomainClient client(peer.name);
+  ASSERT_TRUE(client.connect().ok());
+
+  std::vector<uint8_t> a(10), b(20), c(50), d(10);
+  std::vector<ReadRange> ranges{{a.data(), 0, a.size()},
+                                {b.data(), 500, b.size()},
+                                {c.data(), 980, c.size()},
+                                {d.data(), 2000, d.size()}};
+  auto result = client.readv("bucket", "key", ranges);
+  ASSERT_TRUE(result.ok()) << result.status();
+  ASSERT_EQ(*result, (std::vector<size_t>{10, 20, 20, 0}));
+  ASSERT_EQ(a.front(), static_cast<uint8_t>(payloadByte(0)));
+  ASSERT_EQ(b.back(), static_cast<uint8_t>(payloadByte(519)));
+  ASSERT_EQ(c[19], static_cast<uint8_t>(payloadByte(999)));
+  ASSERT_EQ(c[20], 0);
+
+  std::vector<uint8_t> buffer(100);
+  auto count = client.readBytes("bucket", "key", buffer.data(), 950, buffer.size());
+  ASSERT_TRUE(count.ok()) << count.status();
+  ASSERT_EQ(*count, 50);
+  ASSERT_EQ(buffer.front(), static_cast<uint8_t>(payloadByte(950)));
+
+  auto missing = client.readv("bucket", "missing", ranges);
+  ASSERT_EQ(missing.status().code(), absl::StatusCode::kNotFound);
+
+  // The connection is reused after an error.
+  count = client.readBytes("bucket", "key", buffer.data(), 0, 10);
+  ASSERT_TRUE(count.ok()) << count.status();
+  ASSERT_EQ(*count, 10);
+}
+
+TEST(UnixDomainClient, CachedDescriptors) {
+  LocalPeer peer;
+  UnixDomainClient client(peer.name);
+  ASSERT_TRUE(client.connect().ok());
+
+  std::vector<uint8_t> buffer(100);
+  auto count = client.readBytes("bucket", "key", buffer.data(), 0, buffer.size());
+  ASSERT_TRUE(count.ok()) << count.status();
+  ASSERT_EQ(peer.opens, 1);
+
+  // Reads inside the descriptor window reuse the descriptor.
+  count = client.readBytes("bucket", "key", buffer.data(), 10, 50);
+  ASSERT_TRUE(count.ok()) << count.status();
+  ASSERT_EQ(*count, 50);
+  ASSERT_EQ(buffer.front(), static_cast<uint8_t>(payloadByte(10)));
+  ASSERT_EQ(peer.opens, 1);
+
+  // Reads outside of the window open the object again.
+  count = client.readBytes("bucket", "key", buffer.data(), 950, buffer.size());
+  ASSERT_TRUE(count.ok()) << count.status();
+  ASSERT_EQ(*count, 50);
+  ASSERT_EQ(peer.opens, 2);
+  count = client.readBytes("bucket", "key", buffer.data(), 990, buffer.size());
+  ASSERT_TRUE(count.ok()) << count.status();
+  ASSERT_EQ(*count, 10);
+  ASSERT_EQ(peer.opens, 2);
+
+  client.invalidate("bucket", "key");
+  count = client.readBytes("bucket", "key", buffer.data(), 990, 10);
+  ASSERT_TRUE(count.ok()) << count.status();
+  ASSERT_EQ(peer.opens, 3);
+
+  // Errors are not cached.
+  ASSERT_FALSE(client.readBytes("bucket", "missing", buffer.data(), 0, 10).ok());
+  ASSERT_FALSE(client.readBytes("bucket", "missing", buffer.data(), 0, 10).ok());
+  ASSERT_EQ(peer.opens, 5);
+}
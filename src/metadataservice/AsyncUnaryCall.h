@@ -0,0 +1,144 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef METADATASERVICE_ASYNC_UNARY_CALL_H
+#define METADATASERVICE_ASYNC_UNARY_CALL_H
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include <google/protobuf/arena.h>
+#include <grpcpp/completion_queue.h>
+#include <grpcpp/server_context.h>
+#include <grpcpp/support/async_unary_call.h>
+
+/**
+ * @brief Completion queue served by one polling thread of the asynchronous metadata server.
+ */
+struct AsyncQueue {
+  std::unique_ptr<grpc::ServerCompletionQueue> cq;
+
+  /**
+   * @brief Guards `shutdown`: Calls must not be requested once the queue is shut down.
+   */
+  std::mutex mutex;
+  bool shutdown = false;
+};
+
+/**
+ * @brief Tag of an operation on a completion queue.
+ */
+class AsyncCall {
+public:
+  virtual ~AsyncCall() = default;
+
+  virtual void proceed(bool ok) = 0;
+};
+
+/**
+ * @brief Serves one unary RPC after the other on the polling thread of its queue.
+ *
+ * Request and response live on an arena that is reset for the next call, so serving a call does
+ * not allocate messages once the initial block of the arena is warm. The handler runs inline on
+ * the polling thread: The metadata handlers only wait for the metadata log. On-demand S3 imports,
+ * which list S3 while serving a call, are therefore not supported with polling threads.
+ */
+template <typename Service, typename Request, typename Response>
+class AsyncUnaryCall final : public AsyncCall {
+public:
+  using RequestMethod = void (Service::*)(grpc::ServerContext *, Request *,
+                                          grpc::ServerAsyncResponseWriter<Response> *,
+                                          grpc::CompletionQueue *, grpc::ServerCompletionQueue *,
+                                          void *);
+  using Handler = grpc::Status (Service::*)(grpc::ServerContext *, const Request *, Response *);
+
+private:
+  static constexpr size_t InitialArenaBlockSize = 4096;
+  using ArenaBlock = std::array<char, InitialArenaBlockSize>;
+
+  Service &_service;
+  AsyncQueue &_queue;
+  const RequestMethod _request;
+  const Handler _handler;
+
+  alignas(std::max_align_t) ArenaBlock _arenaBlock;
+  google::protobuf::Arena _arena;
+  std::optional<grpc::ServerContext> _context;
+  std::optional<grpc::ServerAsyncResponseWriter<Response>> _writer;
+  Request *_requestMessage = nullptr;
+  Response *_responseMessage = nullptr;
+  bool _finishing = false;
+
+  static google::protobuf::ArenaOptions arenaOptions(ArenaBlock &block) {
+    google::protobuf::ArenaOptions options;
+    options.initial_block = block.data();
+    options.initial_block_size = block.size();
+    return options;
+  }
+
+  AsyncUnaryCall(Service &service, AsyncQueue &queue, RequestMethod request, Handler handler)
+      : _service(service), _queue(queue), _request(request), _handler(handler),
+        _arena(arenaOptions(_arenaBlock)) {}
+
+  /**
+   * @brief Request the next call. Returns false if the queue is shut down.
+   */
+  bool request() {
+    auto lock = std::lock_guard(_queue.mutex);
+    if (_queue.shutdown) {
+      return false;
+    }
+    _finishing = false;
+    _context.emplace();
+    _writer.emplace(&*_context);
+    _requestMessage = google::protobuf::Arena::Create<Request>(&_arena);
+    _responseMessage = google::protobuf::Arena::Create<Response>(&_arena);
+    (_service.*_request)(&*_context, _requestMessage, &*_writer, _queue.cq.get(), _queue.cq.get(),
+                         this);
+    return true;
+  }
+
+  void reset() {
+    _writer.reset();
+    _context.reset();
+    _requestMessage = nullptr;
+    _responseMessage = nullptr;
+    _arena.Reset();
+  }
+
+public:
+  /**
+   * @brief Start serving `handler` on `queue`. The call deletes itself once the queue shuts down.
+   */
+  static void start(Service &service, AsyncQueue &queue, RequestMethod request, Handler handler) {
+    auto *call = new AsyncUnaryCall(service, queue, request, handler);
+    if (!call->request()) {
+      delete call;
+    }
+  }
+
+  void proceed(bool ok) override {
+    if (ok && !_finishing) {
+      _finishing = true;
+      auto status = (_service.*_handler)(&*_context, _requestMessage, _responseMessage);
+      _writer->Finish(*_responseMessage, status, this);
+      return;
+    }
+    // The call is finished or the server is shutting down.
+    reset();
+    if (!ok && !_finishing) {
+      delete this;
+      return;
+    }
+    if (!request()) {
+      delete this;
+    }
+  }
+};
+
+#endif // METADATASERVICE_ASYNC_UNARY_CALL_H
@@ -5,11 +5,16 @@
 
 #include "GRPCServer.h"
 
+#include <algorithm>
+#include <chrono>
+#include <functional>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <optional>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 #include <absl/status/status.h>
@@ -18,12 +23,16 @@
 #include <grpcpp/server.h>
 #include <grpcpp/support/status.h>
 
+#include "AsyncUnaryCall.h"
 #include "FormatISO8601.h"
 #include "Logging.h"
 #include "ObjectStoreConfig.h"
 #include "ObjectStoreHandler.h"
 #include "ParseGRPC.h"
+#include "Platform.h"
 #include "S3Helper.h"
+#include "ShardRing.h"
+#include "SubscriptionManager.h"
 #include "Status.h"
 #include "Version.h"
 
@@ -31,14 +40,256 @@
 #include "geds.pb.h"
 
 #define LOG_ACCESS(...)                                                                            \
-  geds::logging::LogTimestamp(std::clog, context->peer(), ": ", __VA_ARGS__) // NOLINT
+  do {                                                                                             \
+    if (geds::logging::Logger::instance().sampleAccess()) {                                        \
+      geds::logging::LogTimestamp(std::clog, context->peer(), ": ", __VA_ARGS__); /* NOLINT */     \
+    }                                                                                              \
+  } while (0)
+
+/**
+ * @brief Setup of the metadata service shared by the synchronous and asynchronous variants.
+ */
+class MetadataServiceControl {
+public:
+  virtual ~MetadataServiceControl() = default;
+
+  virtual void setLog(MetadataLog *log) = 0;
+
+  /**
+   * @brief Only serve the buckets that `ring` assigns to shard `index`.
+   */
+  virtual void setShard(const utility::ShardRing *ring, size_t index) = 0;
+
+  /**
+   * @brief Queue `count` calls of each asynchronous method on `queue`.
+   */
+  virtual void requestCalls(AsyncQueue &queue, size_t count) = 0;
+};
+
+using MetadataRPC = geds::rpc::MetadataService;
+
+using AsyncRenameMethods = MetadataRPC::WithAsyncMethod_Rename<
+    MetadataRPC::WithAsyncMethod_RenamePrefix<MetadataRPC::Service>>;
+
+/**
+ * @brief Base of the asynchronous service: Unary methods are served from completion queues, the
+ * streaming methods `ListStream` and `SubscribeStream` stay synchronous.
+ */
+using AsyncMetadataServiceBase = MetadataRPC::WithAsyncMethod_GetConnectionInformation<
+    MetadataRPC::WithAsyncMethod_RegisterObjectStore<MetadataRPC::WithAsyncMethod_ListObjectStores<
+        MetadataRPC::WithAsyncMethod_CreateBucket<MetadataRPC::WithAsyncMethod_DeleteBucket<
+            MetadataRPC::WithAsyncMethod_ListBuckets<MetadataRPC::WithAsyncMethod_LookupBucket<
+                MetadataRPC::WithAsyncMethod_Create<MetadataRPC::WithAsyncMethod_Update<
+                    MetadataRPC::WithAsyncMethod_Delete<MetadataRPC::WithAsyncMethod_DeletePrefix<
+                        MetadataRPC::WithAsyncMethod_Lookup<
+                            MetadataRPC::WithAsyncMethod_LookupIfChanged<
+                                MetadataRPC::WithAsyncMethod_List<
+                                    MetadataRPC::WithAsyncMethod_LookupBatch<
+                                        MetadataRPC::WithAsyncMethod_CreateBatch<
+                                            MetadataRPC::WithAsyncMethod_DeleteBatch<
+                                                MetadataRPC::WithAsyncMethod_Subscribe<
+                                                    MetadataRPC::WithAsyncMethod_Unsubscribe<
+                                                        AsyncRenameMethods>>>>>>>>>>>>>>>>>>>;
+
+template <typename Base>
+class MetadataServiceImpl final : public Base, public MetadataServiceControl {
+  static constexpr bool IsAsync = std::is_same_v<Base, AsyncMetadataServiceBase>;
 
-class MetadataServiceImpl final : public geds::rpc::MetadataService::Service {
   std::shared_ptr<MDSKVS> _kvs;
+  MetadataLog *_log = nullptr;
+  const utility::ShardRing *_ring = nullptr;
+  size_t _shardIndex = 0;
   ObjectStoreHandler _objectStoreHandler;
+  S3Importer _s3Import;
+  SubscriptionManager _subscriptions;
+
+  // Orders mutations with publications if the metadata log is disabled.
+  std::mutex _publishMutex;
+
+  /**
+   * @brief Apply `mutation` and record it in the metadata log if enabled. `publish` runs after a
+   * successful mutation while the mutations are still locked, so subscribers receive publications
+   * in the order the mutations were applied.
+   */
+  absl::Status mutate(const MetadataLogRecord &record,
+                      const std::function<absl::Status()> &mutation,
+                      const std::function<void()> &publish = nullptr) {
+    auto apply = [&] {
+      auto status = mutation();
+      if (status.ok() && publish) {
+        publish();
+      }
+      return status;
+    };
+    if (_log != nullptr) {
+      return _log->apply(record, apply);
+    }
+    if (!publish || !_subscriptions.hasSubscriptions()) {
+      return apply();
+    }
+    auto lock = std::lock_guard(_publishMutex);
+    return apply();
+  }
+
+  std::vector<absl::Status> mutateBatch(const std::vector<MetadataLogRecord> &records,
+                                        const std::function<absl::Status(size_t)> &mutation,
+                                        const std::function<void(size_t)> &publish = nullptr) {
+    auto apply = [&](size_t i) {
+      auto status = mutation(i);
+      if (status.ok() && publish) {
+        publish(i);
+      }
+      return status;
+    };
+    if (_log != nullptr) {
+      return _log->applyBatch(records, apply);
+    }
+    std::unique_lock<std::mutex> lock;
+    if (publish && _subscriptions.hasSubscriptions()) {
+      lock = std::unique_lock(_publishMutex);
+    }
+    std::vector<absl::Status> result;
+    result.reserve(records.size());
+    for (size_t i = 0; i < records.size(); i++) {
+      result.push_back(apply(i));
+    }
+    return result;
+  }
+
+  /**
+   * @brief Reject requests for buckets of other shards: The client routes with a different ring.
+   */
+  grpc::Status checkShard(const std::string &bucket) {
+    if (_ring == nullptr) {
+      return grpc::Status::OK;
+    }
+    auto owner = _ring->shardOf(bucket);
+    if (owner == _shardIndex) {
+      return grpc::Status::OK;
+    }
+    return grpc::Status(grpc::StatusCode::FAILED_PRECONDITION,
+                        "Bucket " + bucket + " belongs to metadata shard " + _ring->shard(owner) +
+                            ".");
+  }
+
+  /**
+   * @brief Reject batches with more than `geds::MaxMetadataBatchSize` items.
+   */
+  static grpc::Status checkBatchSize(int size) {
+    if (static_cast<size_t>(size) <= geds::MaxMetadataBatchSize) {
+      return grpc::Status::OK;
+    }
+    return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                        "The batch of " + std::to_string(size) + " items exceeds the maximum of " +
+                            std::to_string(geds::MaxMetadataBatchSize) + " items.");
+  }
+
+  /**
+   * @brief Serve `Rename` or `RenamePrefix`. Subscribers see the renamed objects deleted under
+   * their old and created under their new IDs.
+   */
+  grpc::Status rename(MetadataLogRecord::Type type, const ::geds::rpc::RenameRequest *request,
+                      ::geds::rpc::StatusResponse *response) {
+    auto source = convert(&request->source());
+    auto destination = convert(&request->destination());
+    for (const auto *bucket : {&source.bucket, &destination.bucket}) {
+      if (auto shard = checkShard(*bucket); !shard.ok()) {
+        return shard;
+      }
+    }
+    const bool prefix = type == MetadataLogRecord::Type::RenameObjectPrefix;
+    auto imported = prefix ? _s3Import.importPrefix(source.bucket, source.key)
+                           : _s3Import.importKey(source.bucket, source.key);
+    if (!imported.ok()) {
+      convertStatus(response, imported);
+      return grpc::Status::OK;
+    }
+    auto record = MetadataLogRecord::forID(type, source);
+    auto publish = [&] {
+      for (const auto &object : record.objects) {
+        auto key = prefix ? source.key + object.id.key.substr(destination.key.size()) : source.key;
+        _subscriptions.publish(geds::rpc::DELETE_OBJECT,
+                               geds::Object{geds::ObjectID{source.bucket, key}, {}});
+        _subscriptions.publish(geds::rpc::CREATE_OBJECT, object);
+      }
+    };
+    auto mutation = [&]() -> absl::Status {
+      if (prefix) {
+        std::vector<std::string> keys(request->keys().begin(), request->keys().end());
+        auto renamed = _kvs->renameObjectPrefix(source, destination, keys);
+        if (!renamed.ok()) {
+          return renamed.status();
+        }
+        record.objects = std::move(*renamed);
+      } else {
+        auto renamed = _kvs->renameObject(source, destination);
+        if (!renamed.ok()) {
+          return renamed.status();
+        }
+        record.objects = {std::move(*renamed)};
+      }
+      return absl::OkStatus();
+    };
+    auto result = mutate(record, mutation, publish);
+    convertStatus(response, result);
+    return grpc::Status::OK;
+  }
+
+  /**
+   * @brief Serve `handler` from `queue`. The message types are deduced from the handler.
+   */
+  template <typename Request, typename Response>
+  void serve(AsyncQueue &queue,
+             typename AsyncUnaryCall<MetadataServiceImpl, Request, Response>::RequestMethod request,
+             grpc::Status (MetadataServiceImpl::*handler)(grpc::ServerContext *, const Request *,
+                                                          Response *)) {
+    AsyncUnaryCall<MetadataServiceImpl, Request, Response>::start(*this, queue, request, handler);
+  }
 
 public:
-  MetadataServiceImpl(std::shared_ptr<MDSKVS> kvs) : _kvs(kvs) {}
+  static constexpr size_t DefaultListPageSize = 1000;
+
+  MetadataServiceImpl(std::shared_ptr<MDSKVS> kvs, S3Importer::Options s3ImportOptions)
+      : _kvs(kvs), _s3Import(kvs, s3ImportOptions) {}
+
+  void setLog(MetadataLog *log) override { _log = log; }
+
+  void setShard(const utility::ShardRing *ring, size_t index) override {
+    _ring = ring;
+    _shardIndex = index;
+  }
+
+  void requestCalls(AsyncQueue &queue, size_t count) override {
+    if constexpr (IsAsync) {
+      for (size_t i = 0; i < count; i++) {
+        serve(queue, &MetadataServiceImpl::RequestGetConnectionInformation,
+              &MetadataServiceImpl::GetConnectionInformation);
+        serve(queue, &MetadataServiceImpl::RequestRegisterObjectStore,
+              &MetadataServiceImpl::RegisterObjectStore);
+        serve(queue, &MetadataServiceImpl::RequestListObjectStores,
+              &MetadataServiceImpl::ListObjectStores);
+        serve(queue, &MetadataServiceImpl::RequestCreateBucket, &MetadataServiceImpl::CreateBucket);
+        serve(queue, &MetadataServiceImpl::RequestDeleteBucket, &MetadataServiceImpl::DeleteBucket);
+        serve(queue, &MetadataServiceImpl::RequestListBuckets, &MetadataServiceImpl::ListBuckets);
+        serve(queue, &MetadataServiceImpl::RequestLookupBucket, &MetadataServiceImpl::LookupBucket);
+        serve(queue, &MetadataServiceImpl::RequestCreate, &MetadataServiceImpl::Create);
+        serve(queue, &MetadataServiceImpl::RequestUpdate, &MetadataServiceImpl::Update);
+        serve(queue, &MetadataServiceImpl::RequestDelete, &MetadataServiceImpl::Delete);
+        serve(queue, &MetadataServiceImpl::RequestDeletePrefix, &MetadataServiceImpl::DeletePrefix);
+        serve(queue, &MetadataServiceImpl::RequestRename, &MetadataServiceImpl::Rename);
+        serve(queue, &MetadataServiceImpl::RequestRenamePrefix, &MetadataServiceImpl::RenamePrefix);
+        serve(queue, &MetadataServiceImpl::RequestLookup, &MetadataServiceImpl::Lookup);
+        serve(queue, &MetadataServiceImpl::RequestLookupIfChanged,
+              &MetadataServiceImpl::LookupIfChanged);
+        serve(queue, &MetadataServiceImpl::RequestList, &MetadataServiceImpl::List);
+        serve(queue, &MetadataServiceImpl::RequestLookupBatch, &MetadataServiceImpl::LookupBatch);
+        serve(queue, &MetadataServiceImpl::RequestCreateBatch, &MetadataServiceImpl::CreateBatch);
+        serve(queue, &MetadataServiceImpl::RequestDeleteBatch, &MetadataServiceImpl::DeleteBatch);
+        serve(queue, &MetadataServiceImpl::RequestSubscribe, &MetadataServiceImpl::Subscribe);
+        serve(queue, &MetadataServiceImpl::RequestUnsubscribe, &MetadataServiceImpl::Unsubscribe);
+      }
+    }
+  }
 
   geds::ObjectID convert(const ::geds::rpc::ObjectID *r) {
     return geds::ObjectID(r->bucket(), r->key());
@@ -52,6 +303,20 @@ public:
             (r->info().has_metadata() ? std::make_optional(r->info().metadata()) : std::nullopt)}};
   }
 
+  void convert(const geds::Object &object, ::geds::rpc::Object *r) {
+    auto objectId = r->mutable_id();
+    objectId->set_bucket(object.id.bucket);
+    objectId->set_key(object.id.key);
+    auto objectInfo = r->mutable_info();
+    objectInfo->set_location(object.info.location);
+    objectInfo->set_size(object.info.size);
+    objectInfo->set_sealedoffset(object.info.sealedOffset);
+    objectInfo->set_version(object.info.version);
+    if (object.info.metadata.has_value()) {
+      objectInfo->set_metadata(*object.info.metadata);
+    }
+  }
+
 protected:
   grpc::Status GetConnectionInformation(::grpc::ServerContext *context,
                                         const ::geds::rpc::EmptyParams * /* unused request */,
@@ -74,12 +339,15 @@ protected:
                                      ::geds::rpc::StatusResponse *response) override {
     LOG_ACCESS("register object store ", request->endpointurl(), " for bucket ", request->bucket(),
                "'.");
+    if (auto shard = checkShard(request->bucket()); !shard.ok()) {
+      return shard;
+    }
 
     auto config = std::make_shared<geds::ObjectStoreConfig>(
         request->bucket(), request->endpointurl(), request->accesskey(), request->secretkey());
     auto status = _objectStoreHandler.insertConfig(config);
     if (status.ok()) {
-      status = PopulateKVS(config, _kvs);
+      status = _s3Import.registerBucket(config);
     }
     convertStatus(response, status);
 
@@ -104,7 +372,12 @@ protected:
   grpc::Status CreateBucket(::grpc::ServerContext *context, const ::geds::rpc::Bucket *request,
                             ::geds::rpc::StatusResponse *response) override {
     LOG_ACCESS("create bucket: ", request->bucket());
-    auto result = _kvs->createBucket(request->bucket());
+    if (auto shard = checkShard(request->bucket()); !shard.ok()) {
+      return shard;
+    }
+    auto result = mutate(
+        MetadataLogRecord::forBucket(MetadataLogRecord::Type::CreateBucket, request->bucket()),
+        [&] { return _kvs->createBucket(request->bucket()); });
     convertStatus(response, result);
     return grpc::Status::OK;
   }
@@ -112,7 +385,12 @@ protected:
   grpc::Status DeleteBucket(::grpc::ServerContext *context, const ::geds::rpc::Bucket *request,
                             ::geds::rpc::StatusResponse *response) override {
     LOG_ACCESS("delete bucket: ", request->bucket());
-    auto result = _kvs->deleteBucket(request->bucket());
+    if (auto shard = checkShard(request->bucket()); !shard.ok()) {
+      return shard;
+    }
+    auto result = mutate(
+        MetadataLogRecord::forBucket(MetadataLogRecord::Type::DeleteBucket, request->bucket()),
+        [&] { return _kvs->deleteBucket(request->bucket()); });
     convertStatus(response, result);
     return grpc::Status::OK;
   }
@@ -137,6 +415,9 @@ protected:
   grpc::Status LookupBucket(::grpc::ServerContext *context, const ::geds::rpc::Bucket *request,
                             ::geds::rpc::StatusResponse *response) override {
     LOG_ACCESS("Lookup bucket: ", request->bucket());
+    if (auto shard = checkShard(request->bucket()); !shard.ok()) {
+      return shard;
+    }
     auto result = _kvs->bucketStatus(request->bucket());
     convertStatus(response, result);
     return grpc::Status::OK;
@@ -151,7 +432,19 @@ protected:
     LOG_ACCESS("create: ", request->id().bucket(), "/", request->id().key(), ": ",
                request->info().location(), " (", request->info().size(), ", ",
                request->info().sealedoffset(), ", ", msg, ")");
-    auto result = _kvs->createObject(convert(request));
+    if (auto shard = checkShard(request->id().bucket()); !shard.ok()) {
+      return shard;
+    }
+    auto record =
+        MetadataLogRecord::forObject(MetadataLogRecord::Type::CreateObject, convert(request));
+    auto &object = record.object;
+    auto publish = [&] { _subscriptions.publish(geds::rpc::CREATE_OBJECT, object); };
+    auto mutation = [&] {
+      // Assigned while the log is locked: Versions follow the order of the mutations.
+      object.info.version = _kvs->nextVersion();
+      return _kvs->createObject(object);
+    };
+    auto result = mutate(record, mutation, publish);
     convertStatus(response, result);
     return grpc::Status::OK;
   };
@@ -165,7 +458,18 @@ protected:
     LOG_ACCESS("update: ", request->id().bucket(), "/", request->id().key(), ": ",
                request->info().location(), " (", request->info().size(), ", ",
                request->info().sealedoffset(), ", ", msg, ")");
-    auto result = _kvs->updateObject(convert(request));
+    if (auto shard = checkShard(request->id().bucket()); !shard.ok()) {
+      return shard;
+    }
+    auto record =
+        MetadataLogRecord::forObject(MetadataLogRecord::Type::UpdateObject, convert(request));
+    auto &object = record.object;
+    auto publish = [&] { _subscriptions.publish(geds::rpc::UPDATE_OBJECT, object); };
+    auto mutation = [&] {
+      object.info.version = _kvs->nextVersion();
+      return _kvs->updateObject(object);
+    };
+    auto result = mutate(record, mutation, publish);
     convertStatus(response, result);
     return grpc::Status::OK;
   };
@@ -173,7 +477,14 @@ protected:
   grpc::Status Delete(::grpc::ServerContext *context, const ::geds::rpc::ObjectID *request,
                       ::geds::rpc::StatusResponse *response) override {
     LOG_ACCESS("delete: ", request->bucket(), "/", request->key());
-    auto result = _kvs->deleteObject(convert(request));
+    if (auto shard = checkShard(request->bucket()); !shard.ok()) {
+      return shard;
+    }
+    auto id = convert(request);
+    auto result = mutate(
+        MetadataLogRecord::forID(MetadataLogRecord::Type::DeleteObject, id),
+        [&] { return _kvs->deleteObject(id); },
+        [&] { _subscriptions.publish(geds::rpc::DELETE_OBJECT, geds::Object{id, {}}); });
     convertStatus(response, result);
     return grpc::Status::OK;
   };
@@ -181,14 +492,55 @@ protected:
   grpc::Status DeletePrefix(::grpc::ServerContext *context, const ::geds::rpc::ObjectID *request,
                             ::geds::rpc::StatusResponse *response) override {
     LOG_ACCESS("delete prefix: ", request->bucket(), "/", request->key());
-    auto result = _kvs->deleteObjectPrefix(convert(request));
+    if (auto shard = checkShard(request->bucket()); !shard.ok()) {
+      return shard;
+    }
+    auto id = convert(request);
+    // Publications name the deleted objects.
+    std::vector<geds::Object> deleted;
+    if (_subscriptions.hasSubscriptions(id.bucket)) {
+      auto listing = _kvs->listObjects(id);
+      if (listing.ok()) {
+        deleted = std::move(listing->first);
+      }
+    }
+    auto publish = [&] {
+      for (const auto &object : deleted) {
+        _subscriptions.publish(geds::rpc::DELETE_OBJECT, object);
+      }
+    };
+    auto result =
+        mutate(MetadataLogRecord::forID(MetadataLogRecord::Type::DeleteObjectPrefix, id),
+               [&] { return _kvs->deleteObjectPrefix(id); }, publish);
     convertStatus(response, result);
     return grpc::Status::OK;
   }
 
+  grpc::Status Rename(::grpc::ServerContext *context, const ::geds::rpc::RenameRequest *request,
+                      ::geds::rpc::StatusResponse *response) override {
+    LOG_ACCESS("rename: ", request->source().bucket(), "/", request->source().key(), " to ",
+               request->destination().bucket(), "/", request->destination().key());
+    return rename(MetadataLogRecord::Type::RenameObject, request, response);
+  }
+
+  grpc::Status RenamePrefix(::grpc::ServerContext *context,
+                            const ::geds::rpc::RenameRequest *request,
+                            ::geds::rpc::StatusResponse *response) override {
+    LOG_ACCESS("rename prefix: ", request->source().bucket(), "/", request->source().key(), " to ",
+               request->destination().bucket(), "/", request->destination().key());
+    return rename(MetadataLogRecord::Type::RenameObjectPrefix, request, response);
+  }
+
   grpc::Status Lookup(::grpc::ServerContext *context, const ::geds::rpc::ObjectID *request,
                       ::geds::rpc::ObjectResponse *response) override {
     LOG_ACCESS("lookup: ", request->bucket(), "/", request->key());
+    if (auto shard = checkShard(request->bucket()); !shard.ok()) {
+      return shard;
+    }
+    if (auto imported = _s3Import.importKey(request->bucket(), request->key()); !imported.ok()) {
+      convertStatus(response->mutable_error(), imported);
+      return grpc::Status::OK;
+    }
     auto status = _kvs->lookup(convert(request));
     if (status.ok()) {
       const auto &result = status.value();
@@ -203,6 +555,7 @@ protected:
         objectInfo->set_location(result.info.location);
         objectInfo->set_size(result.info.size);
         objectInfo->set_sealedoffset(result.info.sealedOffset);
+        objectInfo->set_version(result.info.version);
         if (result.info.metadata.has_value()) {
           objectInfo->set_metadata(*result.info.metadata);
         }
@@ -214,55 +567,356 @@ protected:
     return grpc::Status::OK;
   }
 
+  grpc::Status LookupIfChanged(::grpc::ServerContext *context,
+                               const ::geds::rpc::ObjectIDVersion *request,
+                               ::geds::rpc::ObjectResponse *response) override {
+    LOG_ACCESS("lookup if changed: ", request->id().bucket(), "/", request->id().key(), " (",
+               request->version(), ")");
+    if (auto shard = checkShard(request->id().bucket()); !shard.ok()) {
+      return shard;
+    }
+    if (auto imported = _s3Import.importKey(request->id().bucket(), request->id().key());
+        !imported.ok()) {
+      convertStatus(response->mutable_error(), imported);
+      return grpc::Status::OK;
+    }
+    auto status = _kvs->lookup(convert(&request->id()));
+    if (!status.ok()) {
+      convertStatus(response->mutable_error(), status.status());
+    } else if (status->info.version == request->version()) {
+      response->set_notmodified(true);
+    } else {
+      convert(*status, response->mutable_result());
+    }
+    return grpc::Status::OK;
+  }
+
+  MDSKVSListOptions listOptions(const ::geds::rpc::ObjectListRequest *request,
+                                size_t defaultMaxResults) {
+    MDSKVSListOptions options;
+    options.startAfter = request->continuationtoken();
+    options.maxResults = request->maxresults() > 0 ? request->maxresults() : defaultMaxResults;
+    options.omitMetadata = request->omitmetadata();
+    return options;
+  }
+
+  void convert(MDSKVSListPage &&page, ::geds::rpc::ObjectListResponse *response) {
+    response->mutable_results()->Reserve(page.objects.size());
+    for (const auto &object : page.objects) {
+      convert(object, response->add_results());
+    }
+    for (auto &prefix : page.commonPrefixes) {
+      response->add_commonprefixes(std::move(prefix));
+    }
+    if (page.continuationToken.has_value()) {
+      response->set_continuationtoken(std::move(*page.continuationToken));
+    }
+  }
+
   grpc::Status List(::grpc::ServerContext *context, const ::geds::rpc::ObjectListRequest *request,
                     ::geds::rpc::ObjectListResponse *response) override {
     LOG_ACCESS("list: ", request->prefix().bucket(), "/", request->prefix().key());
+    if (auto shard = checkShard(request->prefix().bucket()); !shard.ok()) {
+      return shard;
+    }
+    if (auto imported = _s3Import.importPrefix(request->prefix().bucket(), request->prefix().key());
+        !imported.ok()) {
+      convertStatus(response->mutable_error(), imported);
+      return grpc::Status::OK;
+    }
     char delimiter = request->has_delimiter() ? (char)request->delimiter() : 0;
-    auto listing = _kvs->listObjects(convert(&request->prefix()), delimiter);
-    if (listing.ok()) {
-      for (const auto &result : listing->first) {
-        auto object = response->add_results();
-        auto objectId = object->mutable_id();
-        objectId->set_bucket(result.id.bucket);
-        objectId->set_key(result.id.key);
-        auto objectInfo = object->mutable_info();
-        objectInfo->set_location(result.info.location);
-        objectInfo->set_size(result.info.size);
-        objectInfo->set_sealedoffset(result.info.sealedOffset);
-        if (result.info.metadata.has_value()) {
-          objectInfo->set_metadata(result.info.metadata.value());
-        }
-      }
-      for (const auto &prefix : listing->second) {
-        response->add_commonprefixes(prefix);
-      }
+    auto page = _kvs->listObjects(request->prefix().bucket(), request->prefix().key(), delimiter,
+                                  listOptions(request, 0));
+    if (page.ok()) {
+      convert(std::move(*page), response);
     } else {
       auto error = response->mutable_error();
-      convertStatus(error, listing.status());
+      convertStatus(error, page.status());
     }
     return grpc::Status::OK;
   };
+
+  grpc::Status ListStream(::grpc::ServerContext *context,
+                          const ::geds::rpc::ObjectListRequest *request,
+                          ::grpc::ServerWriter<::geds::rpc::ObjectListResponse> *writer) override {
+    LOG_ACCESS("list stream: ", request->prefix().bucket(), "/", request->prefix().key());
+    if (auto shard = checkShard(request->prefix().bucket()); !shard.ok()) {
+      return shard;
+    }
+    if (auto imported = _s3Import.importPrefix(request->prefix().bucket(), request->prefix().key());
+        !imported.ok()) {
+      ::geds::rpc::ObjectListResponse response;
+      convertStatus(response.mutable_error(), imported);
+      writer->Write(response);
+      return grpc::Status::OK;
+    }
+    char delimiter = request->has_delimiter() ? (char)request->delimiter() : 0;
+    auto options = listOptions(request, DefaultListPageSize);
+    while (!context->IsCancelled()) {
+      ::geds::rpc::ObjectListResponse response;
+      auto page = _kvs->listObjects(request->prefix().bucket(), request->prefix().key(),
+                                    delimiter, options);
+      if (!page.ok()) {
+        convertStatus(response.mutable_error(), page.status());
+        writer->Write(response);
+        break;
+      }
+      auto token = page->continuationToken;
+      convert(std::move(*page), &response);
+      if (!writer->Write(response) || !token.has_value()) {
+        break;
+      }
+      options.startAfter = std::move(*token);
+    }
+    return grpc::Status::OK;
+  }
+
+  grpc::Status LookupBatch(::grpc::ServerContext *context,
+                           const ::geds::rpc::ObjectIDBatch *request,
+                           ::geds::rpc::ObjectResponseBatch *response) override {
+    LOG_ACCESS("lookup batch: ", request->ids_size(), " objects");
+    if (auto size = checkBatchSize(request->ids_size()); !size.ok()) {
+      return size;
+    }
+    for (const auto &id : request->ids()) {
+      if (auto shard = checkShard(id.bucket()); !shard.ok()) {
+        return shard;
+      }
+    }
+    for (const auto &id : request->ids()) {
+      auto result = response->add_results();
+      if (auto imported = _s3Import.importKey(id.bucket(), id.key()); !imported.ok()) {
+        convertStatus(result->mutable_error(), imported);
+        continue;
+      }
+      auto status = _kvs->lookup(convert(&id));
+      if (status.ok()) {
+        convert(*status, result->mutable_result());
+      } else {
+        convertStatus(result->mutable_error(), status.status());
+      }
+    }
+    return grpc::Status::OK;
+  }
+
+  grpc::Status CreateBatch(::grpc::ServerContext *context, const ::geds::rpc::ObjectBatch *request,
+                           ::geds::rpc::StatusResponseBatch *response) override {
+    LOG_ACCESS("create batch: ", request->objects_size(), " objects");
+    if (auto size = checkBatchSize(request->objects_size()); !size.ok()) {
+      return size;
+    }
+    for (const auto &object : request->objects()) {
+      if (auto shard = checkShard(object.id().bucket()); !shard.ok()) {
+        return shard;
+      }
+    }
+    std::vector<MetadataLogRecord> records;
+    records.reserve(request->objects_size());
+    for (const auto &object : request->objects()) {
+      records.push_back(
+          MetadataLogRecord::forObject(MetadataLogRecord::Type::CreateObject, convert(&object)));
+    }
+    auto results = mutateBatch(
+        records,
+        [&](size_t i) {
+          records[i].object.info.version = _kvs->nextVersion();
+          return _kvs->createObject(records[i].object);
+        },
+        [&](size_t i) { _subscriptions.publish(geds::rpc::CREATE_OBJECT, records[i].object); });
+    for (const auto &result : results) {
+      convertStatus(response->add_results(), result);
+    }
+    return grpc::Status::OK;
+  }
+
+  grpc::Status DeleteBatch(::grpc::ServerContext *context,
+                           const ::geds::rpc::ObjectIDBatch *request,
+                           ::geds::rpc::StatusResponseBatch *response) override {
+    LOG_ACCESS("delete batch: ", request->ids_size(), " objects");
+    if (auto size = checkBatchSize(request->ids_size()); !size.ok()) {
+      return size;
+    }
+    for (const auto &id : request->ids()) {
+      if (auto shard = checkShard(id.bucket()); !shard.ok()) {
+        return shard;
+      }
+    }
+    std::vector<MetadataLogRecord> records;
+    records.reserve(request->ids_size());
+    for (const auto &id : request->ids()) {
+      records.push_back(
+          MetadataLogRecord::forID(MetadataLogRecord::Type::DeleteObject, convert(&id)));
+    }
+    auto results = mutateBatch(
+        records, [&](size_t i) { return _kvs->deleteObject(records[i].object.id); },
+        [&](size_t i) { _subscriptions.publish(geds::rpc::DELETE_OBJECT, records[i].object); });
+    for (const auto &result : results) {
+      convertStatus(response->add_results(), result);
+    }
+    return grpc::Status::OK;
+  }
+
+  grpc::Status Subscribe(::grpc::ServerContext *context,
+                         const ::geds::rpc::SubscriptionEvent *request,
+                         ::geds::rpc::StatusResponse *response) override {
+    LOG_ACCESS("subscribe: ", request->subscriberid(), " ", request->bucketid(), "/",
+               request->key(), " (", request->subscriptiontype(), ")");
+    if (auto shard = checkShard(request->bucketid()); !shard.ok()) {
+      return shard;
+    }
+    convertStatus(response, _subscriptions.subscribe(*request));
+    return grpc::Status::OK;
+  }
+
+  grpc::Status Unsubscribe(::grpc::ServerContext *context,
+                           const ::geds::rpc::SubscriptionEvent *request,
+                           ::geds::rpc::StatusResponse *response) override {
+    LOG_ACCESS("unsubscribe: ", request->subscriberid(), " ", request->bucketid(), "/",
+               request->key(), " (", request->subscriptiontype(), ")");
+    if (auto shard = checkShard(request->bucketid()); !shard.ok()) {
+      return shard;
+    }
+    convertStatus(response, _subscriptions.unsubscribe(*request));
+    return grpc::Status::OK;
+  }
+
+  grpc::Status
+  SubscribeStream(::grpc::ServerContext *context,
+                  const ::geds::rpc::SubscriptionStreamEvent *request,
+                  ::grpc::ServerWriter<::geds::rpc::SubscriptionStreamResponse> *writer) override {
+    LOG_ACCESS("subscribe stream: ", request->subscriberid());
+    if (request->subscriberid().empty()) {
+      return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Missing subscriber ID.");
+    }
+    auto subscriber = _subscriptions.connect(request->subscriberid());
+    std::vector<Subscriber::Event> events;
+    bool connected = true;
+    while (connected && !context->IsCancelled()) {
+      events.clear();
+      if (!subscriber->pop(events, std::chrono::seconds(1))) {
+        break;
+      }
+      // Publications queued since the last write go out together: Only the last write flushes.
+      for (size_t i = 0; i < events.size() && connected; i++) {
+        auto options = grpc::WriteOptions();
+        if (i + 1 < events.size()) {
+          options.set_buffer_hint();
+        }
+        connected = writer->Write(*events[i], options);
+      }
+    }
+    auto overflowed = subscriber->overflowed();
+    _subscriptions.disconnect(subscriber);
+    LOG_ACCESS("subscribe stream closed: ", request->subscriberid());
+    if (overflowed) {
+      return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                          "Subscriber did not keep up with the publications.");
+    }
+    return grpc::Status::OK;
+  }
 };
 
-GRPCServer::GRPCServer(std::string serverAddress)
-    : _kvs(std::make_shared<MDSKVS>()), _grpcService(new MetadataServiceImpl(_kvs)),
+namespace {
+template <typename Base>
+std::unique_ptr<grpc::Service> makeService(std::shared_ptr<MDSKVS> kvs,
+                                           const GRPCServer::Options &options,
+                                           MetadataServiceControl *&control) {
+  auto service = std::make_unique<MetadataServiceImpl<Base>>(std::move(kvs), options.s3Import);
+  control = service.get();
+  return service;
+}
+} // namespace
+
+GRPCServer::GRPCServer(std::string serverAddress, Options options)
+    : _kvs(std::make_shared<MDSKVS>()), _options(options),
+      _grpcService(options.pollingThreads == 0
+                       ? makeService<MetadataRPC::Service>(_kvs, options, _control)
+                       : makeService<AsyncMetadataServiceBase>(_kvs, options, _control)),
       _serverAddress(std::move(serverAddress)) {}
 
 GRPCServer::~GRPCServer() {}
 
+absl::Status GRPCServer::enableLog(const std::string &directory, MetadataLog::Options options) {
+  auto log = MetadataLog::open(directory, _kvs, options);
+  if (!log.ok()) {
+    return log.status();
+  }
+  _log = std::move(*log);
+  _control->setLog(_log.get());
+  return absl::OkStatus();
+}
+
+absl::Status GRPCServer::setShards(const std::string &shards, const std::string &shard) {
+  auto ring = std::make_unique<utility::ShardRing>(utility::ShardRing::parse(shards));
+  const auto &names = ring->shards();
+  auto it = std::find(names.begin(), names.end(), shard);
+  if (it == names.end()) {
+    return absl::InvalidArgumentError("Shard " + shard + " is not part of " + shards + ".");
+  }
+  _shards = std::move(ring);
+  _control->setShard(_shards.get(), it - names.begin());
+  geds::logging::LogTimestamp(std::clog, "Serving metadata shard ", shard, " of ", names.size());
+  return absl::OkStatus();
+}
+
 absl::Status GRPCServer::startAndWait() {
+  if (_options.s3Import.mode == S3ImportMode::OnDemand && _options.pollingThreads > 0) {
+    // On-demand imports list S3 inline and would stall all calls of a completion queue.
+    return absl::InvalidArgumentError("On-demand S3 imports require synchronous RPCs.");
+  }
   grpc::EnableDefaultHealthCheckService(true);
   grpc::reflection::InitProtoReflectionServerBuilderPlugin();
 
   grpc::ServerBuilder builder;
   builder.AddListeningPort(_serverAddress, grpc::InsecureServerCredentials());
   builder.RegisterService(_grpcService.get());
+  std::vector<std::unique_ptr<AsyncQueue>> queues;
+  for (size_t i = 0; i < _options.pollingThreads; i++) {
+    auto queue = std::make_unique<AsyncQueue>();
+    queue->cq = builder.AddCompletionQueue();
+    queues.push_back(std::move(queue));
+  }
 
   // TODO: FIXME Check if there is already an other service running on the same
   // port.
   std::unique_ptr<grpc::Server> server(builder.BuildAndStart());
+  if (server == nullptr) {
+    return absl::UnavailableError("Unable to start the metadata server on " + _serverAddress);
+  }
   std::clog << "Metadata Server (" << utility::GEDSVersion() << ")" << std::endl;
+
+  std::vector<std::thread> pollers;
+  auto numCores = std::max(std::thread::hardware_concurrency(), 1u);
+  for (size_t i = 0; i < queues.size(); i++) {
+    auto &queue = *queues[i];
+    _control->requestCalls(queue, _options.callsPerThread);
+    pollers.emplace_back([&queue] {
+      void *tag;
+      bool ok;
+      while (queue.cq->Next(&tag, &ok)) {
+        static_cast<AsyncCall *>(tag)->proceed(ok);
+      }
+    });
+    if (_options.pinThreads && !utility::platform::pinThread(pollers.back(), i % numCores)) {
+      LOG_ERROR("Unable to pin polling thread ", i, " to core ", i % numCores);
+    }
+  }
+  if (!pollers.empty()) {
+    geds::logging::LogTimestamp(std::clog, "Serving unary RPCs from ", pollers.size(),
+                                " polling threads");
+  }
   geds::logging::LogTimestamp(std::clog, "Server is listening on ", _serverAddress);
   server->Wait();
+
+  for (auto &queue : queues) {
+    auto lock = std::lock_guard(queue->mutex);
+    queue->shutdown = true;
+  }
+  for (auto &queue : queues) {
+    queue->cq->Shutdown();
+  }
+  for (auto &poller : pollers) {
+    poller.join();
+  }
   return absl::OkStatus();
 }
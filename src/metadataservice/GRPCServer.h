@@ -6,25 +6,83 @@
 #ifndef GEDS_GRPCSERVER_H
 #define GEDS_GRPCSERVER_H
 
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <utility>
 
 #include <absl/status/status.h>
 #include <grpcpp/grpcpp.h>
 
 #include "MDSKVS.h"
+#include "MetadataLog.h"
 #include "Ports.h"
+#include "S3Helper.h"
+#include "ShardRing.h"
+
+class MetadataServiceControl;
 
 class GRPCServer {
+public:
+  struct Options {
+    /**
+     * @brief Number of threads polling the completion queues of the unary RPCs. With 0 threads
+     * all RPCs are served synchronously from the gRPC thread pool.
+     */
+    size_t pollingThreads = 0;
+
+    /**
+     * @brief Pin polling thread `i` to core `i` modulo the number of cores.
+     */
+    bool pinThreads = true;
+
+    /**
+     * @brief Number of calls of each unary method queued per polling thread.
+     */
+    size_t callsPerThread = 4;
+
+    /**
+     * @brief How the objects of registered S3 buckets are imported. On-demand imports require
+     * `pollingThreads == 0`.
+     */
+    S3Importer::Options s3Import;
+  };
+
+private:
   std::shared_ptr<MDSKVS> _kvs;
+  std::unique_ptr<MetadataLog> _log;
+  std::unique_ptr<utility::ShardRing> _shards;
+  const Options _options;
+  MetadataServiceControl *_control = nullptr;
   std::unique_ptr<grpc::Service> _grpcService;
   std::string _serverAddress;
 
 public:
-  GRPCServer(std::string serverAddress);
+  GRPCServer(std::string serverAddress, Options options);
+  GRPCServer(std::string serverAddress) : GRPCServer(std::move(serverAddress), Options{}) {}
   GRPCServer() : GRPCServer("0.0.0.0:" + std::to_string(defaultMetdataServerPort)) {}
   ~GRPCServer();
+
+  /**
+   * @brief Persist the metadata in `directory` and restore it from there. Must be called before
+   * `startAndWait`.
+   */
+  absl::Status enableLog(const std::string &directory, MetadataLog::Options options = {});
+
+  /**
+   * @brief Serve shard `shard` of the comma-separated metadata servers `shards`. The servers and
+   * the clients need to be configured with the same set of shards: Buckets are assigned to shards
+   * by consistent hashing and requests for buckets of other shards are rejected. Must be called
+   * before `startAndWait`.
+   */
+  absl::Status setShards(const std::string &shards, const std::string &shard);
+
   absl::Status startAndWait();
+
+  /**
+   * @brief The synchronous gRPC service, e.g. to serve it in-process. Null with polling threads.
+   */
+  grpc::Service *service() { return _options.pollingThreads == 0 ? _grpcService.get() : nullptr; }
 };
 
 #endif // GEDS_GRPCSERVER_H
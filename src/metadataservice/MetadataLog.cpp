@@ -0,0 +1,780 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "MetadataLog.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string_view>
+
+#include <boost/crc.hpp>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Logging.h"
+
+namespace {
+
+const std::string SnapshotMagic = "GEDSSNAP";
+const std::string SnapshotFile = "snapshot";
+const std::string SnapshotTmpFile = "snapshot.tmp";
+const std::string SegmentPrefix = "wal.";
+constexpr size_t FrameHeaderSize = 2 * sizeof(uint32_t);
+constexpr size_t SnapshotBufferSize = 4 * 1024 * 1024;
+
+uint32_t crc32(std::string_view data) {
+  boost::crc_32_type crc;
+  crc.process_bytes(data.data(), data.size());
+  return crc.checksum();
+}
+
+template <typename T> void put(std::string &out, T value) {
+  out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void putString(std::string &out, const std::string &value) {
+  put<uint32_t>(out, value.size());
+  out.append(value);
+}
+
+bool hasInfo(MetadataLogRecord::Type type) {
+  return type == MetadataLogRecord::Type::CreateObject ||
+         type == MetadataLogRecord::Type::UpdateObject;
+}
+
+bool isRename(MetadataLogRecord::Type type) {
+  return type == MetadataLogRecord::Type::RenameObject ||
+         type == MetadataLogRecord::Type::RenameObjectPrefix;
+}
+
+void putInfo(std::string &out, const geds::ObjectInfo &info) {
+  putString(out, info.location);
+  put<uint64_t>(out, info.size);
+  put<uint64_t>(out, info.sealedOffset);
+  put<uint8_t>(out, info.metadata.has_value());
+  if (info.metadata.has_value()) {
+    putString(out, *info.metadata);
+  }
+  put<uint64_t>(out, info.version);
+}
+
+/**
+ * @brief Append the framed `record` to `out`.
+ */
+void encode(const MetadataLogRecord &record, std::string &out) {
+  auto start = out.size();
+  out.resize(start + FrameHeaderSize);
+  put<uint8_t>(out, static_cast<uint8_t>(record.type));
+  putString(out, record.object.id.bucket);
+  putString(out, record.object.id.key);
+  if (hasInfo(record.type)) {
+    putInfo(out, record.object.info);
+  }
+  if (isRename(record.type)) {
+    put<uint64_t>(out, record.objects.size());
+    for (const auto &object : record.objects) {
+      putString(out, object.id.bucket);
+      putString(out, object.id.key);
+      putInfo(out, object.info);
+    }
+  }
+  uint32_t length = out.size() - start - FrameHeaderSize;
+  uint32_t checksum = crc32(std::string_view{out}.substr(start + FrameHeaderSize));
+  std::memcpy(&out[start], &length, sizeof(length));
+  std::memcpy(&out[start + sizeof(length)], &checksum, sizeof(checksum));
+}
+
+class Reader {
+  std::string_view _data;
+
+public:
+  explicit Reader(std::string_view data) : _data(data) {}
+
+  template <typename T> bool get(T &value) {
+    if (_data.size() < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&value, _data.data(), sizeof(T));
+    _data.remove_prefix(sizeof(T));
+    return true;
+  }
+
+  bool getString(std::string &value) {
+    uint32_t length;
+    if (!get(length) || _data.size() < length) {
+      return false;
+    }
+    value.assign(_data.substr(0, length));
+    _data.remove_prefix(length);
+    return true;
+  }
+
+  bool empty() const { return _data.empty(); }
+};
+
+/**
+ * @brief Read an `ObjectInfo` written by `putInfo`.
+ */
+bool getInfo(Reader &reader, geds::ObjectInfo &info) {
+  uint8_t hasMetadata;
+  if (!reader.getString(info.location) || !reader.get(info.size) ||
+      !reader.get(info.sealedOffset) || !reader.get(hasMetadata)) {
+    return false;
+  }
+  if (hasMetadata) {
+    std::string metadata;
+    if (!reader.getString(metadata)) {
+      return false;
+    }
+    info.metadata = std::move(metadata);
+  }
+  return reader.get(info.version);
+}
+
+absl::StatusOr<MetadataLogRecord> decode(std::string_view payload) {
+  Reader reader{payload};
+  uint8_t type;
+  MetadataLogRecord record{MetadataLogRecord::Type::CreateBucket,
+                           geds::Object{geds::ObjectID{"", ""}, geds::ObjectInfo{"", 0, 0, {}}}};
+  if (!reader.get(type) || type < static_cast<uint8_t>(MetadataLogRecord::Type::CreateBucket) ||
+      type > static_cast<uint8_t>(MetadataLogRecord::Type::RenameObjectPrefix)) {
+    return absl::DataLossError("Invalid record type.");
+  }
+  record.type = static_cast<MetadataLogRecord::Type>(type);
+  auto &object = record.object;
+  if (!reader.getString(object.id.bucket) || !reader.getString(object.id.key)) {
+    return absl::DataLossError("Truncated record.");
+  }
+  if (hasInfo(record.type)) {
+    if (!getInfo(reader, object.info)) {
+      return absl::DataLossError("Truncated record.");
+    }
+  }
+  if (isRename(record.type)) {
+    uint64_t count;
+    if (!reader.get(count)) {
+      return absl::DataLossError("Truncated record.");
+    }
+    for (uint64_t i = 0; i < count; i++) {
+      auto &renamed = record.objects.emplace_back(
+          geds::Object{geds::ObjectID{"", ""}, geds::ObjectInfo{"", 0, 0, {}}});
+      if (!reader.getString(renamed.id.bucket) || !reader.getString(renamed.id.key) ||
+          !getInfo(reader, renamed.info)) {
+        return absl::DataLossError("Truncated record.");
+      }
+    }
+  }
+  if (!reader.empty()) {
+    return absl::DataLossError("Trailing bytes in record.");
+  }
+  return record;
+}
+
+/**
+ * @brief Return the payload of the frame at `offset` and advance `offset` past it.
+ */
+absl::StatusOr<std::string_view> nextFrame(std::string_view data, size_t &offset) {
+  if (data.size() - offset < FrameHeaderSize) {
+    return absl::DataLossError("Truncated frame header.");
+  }
+  uint32_t length;
+  uint32_t checksum;
+  std::memcpy(&length, data.data() + offset, sizeof(length));
+  std::memcpy(&checksum, data.data() + offset + sizeof(length), sizeof(checksum));
+  if (data.size() - offset - FrameHeaderSize < length) {
+    return absl::DataLossError("Truncated frame.");
+  }
+  auto payload = data.substr(offset + FrameHeaderSize, length);
+  if (crc32(payload) != checksum) {
+    return absl::DataLossError("Checksum mismatch.");
+  }
+  offset += FrameHeaderSize + length;
+  return payload;
+}
+
+/**
+ * @brief Apply a replayed record. Records may already be reflected in the store, so missing and
+ * existing entries are not errors.
+ */
+absl::Status replay(MDSKVS &kvs, const MetadataLogRecord &record) {
+  const auto &object = record.object;
+  absl::Status status;
+  switch (record.type) {
+  case MetadataLogRecord::Type::CreateBucket:
+    status = kvs.createBucket(object.id.bucket);
+    break;
+  case MetadataLogRecord::Type::DeleteBucket:
+    status = kvs.deleteBucket(object.id.bucket);
+    break;
+  case MetadataLogRecord::Type::CreateObject:
+  case MetadataLogRecord::Type::UpdateObject:
+    status = kvs.createObject(object, true);
+    break;
+  case MetadataLogRecord::Type::DeleteObject:
+    status = kvs.deleteObject(object.id);
+    break;
+  case MetadataLogRecord::Type::DeleteObjectPrefix:
+    status = kvs.deleteObjectPrefix(object.id);
+    break;
+  case MetadataLogRecord::Type::RenameObject:
+  case MetadataLogRecord::Type::RenameObjectPrefix:
+    status = record.type == MetadataLogRecord::Type::RenameObject
+                 ? kvs.deleteObject(object.id)
+                 : kvs.deleteObjectPrefix(object.id);
+    if (!status.ok() && status.code() != absl::StatusCode::kNotFound) {
+      break;
+    }
+    for (const auto &renamed : record.objects) {
+      status = kvs.createObject(renamed, true);
+      if (!status.ok()) {
+        break;
+      }
+    }
+    break;
+  }
+  if (status.code() == absl::StatusCode::kAlreadyExists ||
+      status.code() == absl::StatusCode::kNotFound) {
+    return absl::OkStatus();
+  }
+  return status;
+}
+
+absl::StatusOr<std::string> readFile(const std::string &path) {
+  std::ifstream stream{path, std::ios::binary};
+  if (!stream) {
+    return absl::UnavailableError("Unable to open " + path + ".");
+  }
+  std::ostringstream data;
+  data << stream.rdbuf();
+  if (stream.bad()) {
+    return absl::UnknownError("Unable to read " + path + ".");
+  }
+  return std::move(data).str();
+}
+
+absl::Status writeAll(int fd, std::string_view data, const std::string &path) {
+  while (!data.empty()) {
+    auto count = ::write(fd, data.data(), data.size());
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      int err = errno;
+      return absl::UnknownError("Unable to write " + path + ": " + strerror(err));
+    }
+    data.remove_prefix(count);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status syncFile(int fd, const std::string &path) {
+  int e = 0;
+  do {
+    e = ::fdatasync(fd);
+  } while (e != 0 && errno == EINTR);
+  if (e != 0) {
+    int err = errno;
+    return absl::UnknownError("Unable to fsync " + path + ": " + strerror(err));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status syncDirectory(const std::string &path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    int err = errno;
+    return absl::UnknownError("Unable to open " + path + ": " + strerror(err));
+  }
+  auto status = syncFile(fd, path);
+  ::close(fd);
+  return status;
+}
+
+std::optional<uint64_t> segmentIndex(const std::filesystem::path &path) {
+  auto name = path.filename().string();
+  if (!name.starts_with(SegmentPrefix) || name.size() == SegmentPrefix.size()) {
+    return std::nullopt;
+  }
+  uint64_t index = 0;
+  for (auto c : std::string_view{name}.substr(SegmentPrefix.size())) {
+    if (c < '0' || c > '9') {
+      return std::nullopt;
+    }
+    index = index * 10 + (c - '0');
+  }
+  return index;
+}
+
+absl::StatusOr<std::vector<uint64_t>> listSegments(const std::string &directory) {
+  std::vector<uint64_t> segments;
+  std::error_code ec;
+  for (const auto &entry : std::filesystem::directory_iterator{directory, ec}) {
+    if (auto index = segmentIndex(entry.path())) {
+      segments.push_back(*index);
+    }
+  }
+  if (ec) {
+    return absl::UnknownError("Unable to list " + directory + ": " + ec.message());
+  }
+  std::sort(segments.begin(), segments.end());
+  return segments;
+}
+
+} // namespace
+
+MetadataLogRecord MetadataLogRecord::forBucket(Type type, const std::string &bucket) {
+  return forID(type, geds::ObjectID{bucket, ""});
+}
+
+MetadataLogRecord MetadataLogRecord::forID(Type type, const geds::ObjectID &id) {
+  return forObject(type, geds::Object{id, geds::ObjectInfo{"", 0, 0, std::nullopt}});
+}
+
+MetadataLogRecord MetadataLogRecord::forObject(Type type, const geds::Object &object) {
+  return MetadataLogRecord{type, object};
+}
+
+MetadataLog::MetadataLog(std::string directory, std::shared_ptr<MDSKVS> kvs, Options options)
+    : _directory(std::move(directory)), _kvs(std::move(kvs)), _options(options) {}
+
+absl::StatusOr<std::unique_ptr<MetadataLog>>
+MetadataLog::open(const std::string &directory, std::shared_ptr<MDSKVS> kvs, Options options) {
+  std::error_code ec;
+  std::filesystem::create_directories(directory, ec);
+  if (ec) {
+    return absl::UnknownError("Unable to create " + directory + ": " + ec.message());
+  }
+  auto log = std::unique_ptr<MetadataLog>(new MetadataLog(directory, std::move(kvs), options));
+  auto status = log->recover();
+  if (!status.ok()) {
+    return status;
+  }
+  log->_snapshotThread = std::thread([log = log.get()] { log->runSnapshots(); });
+  return log;
+}
+
+MetadataLog::~MetadataLog() {
+  {
+    auto lock = std::unique_lock(_snapshotMutex);
+    _stopped = true;
+  }
+  _snapshotWakeup.notify_all();
+  if (_snapshotThread.joinable()) {
+    _snapshotThread.join();
+  }
+  auto lock = std::unique_lock(_mutex);
+  _flushed.wait(lock, [&] { return !_flushing; });
+  if (_error.ok()) {
+    auto status = flushLocked();
+    if (!status.ok()) {
+      LOG_ERROR("Unable to flush the metadata log: ", status.message());
+    }
+  }
+  if (_fd >= 0) {
+    ::close(_fd);
+  }
+}
+
+absl::Status MetadataLog::recover() {
+  uint64_t segment = 0;
+  auto snapshotPath = _directory + "/" + SnapshotFile;
+  auto tmpPath = _directory + "/" + SnapshotTmpFile;
+  std::error_code ec;
+  std::filesystem::remove(tmpPath, ec);
+  if (ec) {
+    return absl::UnknownError("Unable to remove " + tmpPath + ": " + ec.message());
+  }
+  auto hasSnapshot = std::filesystem::exists(snapshotPath, ec);
+  if (ec) {
+    return absl::UnknownError("Unable to access " + snapshotPath + ": " + ec.message());
+  }
+  if (hasSnapshot) {
+    auto status = loadSnapshot(snapshotPath, segment);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+  auto segments = listSegments(_directory);
+  if (!segments.ok()) {
+    return segments.status();
+  }
+  uint64_t next = segment;
+  for (auto index : *segments) {
+    auto path = _directory + "/" + SegmentPrefix + std::to_string(index);
+    if (index < segment) {
+      // Left over from a snapshot that completed before the segments were removed.
+      std::filesystem::remove(path, ec);
+      if (ec) {
+        LOG_WARNING("Unable to remove ", path, ": ", ec.message());
+      }
+      continue;
+    }
+    auto status = replaySegment(path);
+    if (!status.ok()) {
+      return status;
+    }
+    next = index + 1;
+  }
+  return openSegment(next);
+}
+
+absl::Status MetadataLog::loadSnapshot(const std::string &path, uint64_t &segment) {
+  auto data = readFile(path);
+  if (!data.ok()) {
+    return data.status();
+  }
+  std::string_view view{*data};
+  if (!view.starts_with(SnapshotMagic) || view.size() < SnapshotMagic.size() + sizeof(segment)) {
+    return absl::DataLossError("Invalid snapshot header in " + path + ".");
+  }
+  std::memcpy(&segment, view.data() + SnapshotMagic.size(), sizeof(segment));
+
+  std::vector<std::string_view> frames;
+  size_t offset = SnapshotMagic.size() + sizeof(segment);
+  while (offset < view.size()) {
+    auto frame = nextFrame(view, offset);
+    if (!frame.ok()) {
+      return absl::DataLossError("Corrupt snapshot " + path + ": " +
+                                 std::string{frame.status().message()});
+    }
+    frames.push_back(*frame);
+  }
+
+  // The snapshot lists all buckets before their objects. Objects are independent of each other.
+  size_t objectsBegin = 0;
+  for (; objectsBegin < frames.size(); objectsBegin++) {
+    auto record = decode(frames[objectsBegin]);
+    if (!record.ok()) {
+      return record.status();
+    }
+    if (record->type != MetadataLogRecord::Type::CreateBucket) {
+      break;
+    }
+    auto status = replay(*_kvs, *record);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+
+  std::mutex errorMutex;
+  absl::Status error;
+  std::atomic<size_t> nextChunk = objectsBegin;
+  constexpr size_t chunkSize = 1024;
+  auto worker = [&] {
+    while (true) {
+      size_t begin = nextChunk.fetch_add(chunkSize);
+      if (begin >= frames.size()) {
+        return;
+      }
+      auto end = std::min(begin + chunkSize, frames.size());
+      for (auto i = begin; i < end; i++) {
+        auto record = decode(frames[i]);
+        auto status = record.ok() ? replay(*_kvs, *record) : record.status();
+        if (!status.ok()) {
+          auto lock = std::lock_guard(errorMutex);
+          error.Update(status);
+          return;
+        }
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < _options.replayThreads; i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  if (error.ok()) {
+    LOG_INFO("Loaded ", frames.size(), " records from ", path);
+  }
+  return error;
+}
+
+absl::Status MetadataLog::replaySegment(const std::string &path) {
+  auto data = readFile(path);
+  if (!data.ok()) {
+    return data.status();
+  }
+  std::string_view view{*data};
+  size_t offset = 0;
+  size_t records = 0;
+  while (offset < view.size()) {
+    auto start = offset;
+    auto frame = nextFrame(view, offset);
+    if (!frame.ok()) {
+      // A crash while appending leaves a partial record at the end of the segment.
+      LOG_ERROR("Truncating ", path, " at offset ", start, ": ", frame.status().message());
+      std::error_code ec;
+      std::filesystem::resize_file(path, start, ec);
+      if (ec) {
+        return absl::UnknownError("Unable to truncate " + path + ": " + ec.message());
+      }
+      break;
+    }
+    auto record = decode(*frame);
+    if (!record.ok()) {
+      return record.status();
+    }
+    auto status = replay(*_kvs, *record);
+    if (!status.ok()) {
+      return status;
+    }
+    records++;
+  }
+  _recordsSinceSnapshot += records;
+  LOG_INFO("Replayed ", records, " records from ", path);
+  return absl::OkStatus();
+}
+
+absl::Status MetadataLog::openSegment(uint64_t segment) {
+  auto path = _directory + "/" + SegmentPrefix + std::to_string(segment);
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    int err = errno;
+    return absl::UnknownError("Unable to open " + path + ": " + strerror(err));
+  }
+  auto status = syncDirectory(_directory);
+  if (!status.ok()) {
+    ::close(fd);
+    return status;
+  }
+  if (_fd >= 0) {
+    ::close(_fd);
+  }
+  _fd = fd;
+  _segment = segment;
+  return absl::OkStatus();
+}
+
+absl::Status MetadataLog::flushLocked() {
+  if (_pending.empty()) {
+    return absl::OkStatus();
+  }
+  auto path = _directory + "/" + SegmentPrefix + std::to_string(_segment);
+  auto status = writeAll(_fd, _pending, path);
+  if (status.ok()) {
+    status = syncFile(_fd, path);
+  }
+  _pending.clear();
+  _durable = _appended;
+  return status;
+}
+
+absl::Status MetadataLog::waitDurable(std::unique_lock<std::mutex> &lock, uint64_t sequence) {
+  while (_durable < sequence) {
+    if (!_error.ok()) {
+      return _error;
+    }
+    if (_flushing) {
+      _flushed.wait(lock);
+      continue;
+    }
+    // Become the leader and write all records appended so far.
+    _flushing = true;
+    std::string pending;
+    pending.swap(_pending);
+    auto target = _appended;
+    auto path = _directory + "/" + SegmentPrefix + std::to_string(_segment);
+    auto fd = _fd;
+    lock.unlock();
+    auto status = writeAll(fd, pending, path);
+    if (status.ok()) {
+      status = syncFile(fd, path);
+    }
+    lock.lock();
+    _flushing = false;
+    if (status.ok()) {
+      _durable = target;
+    } else {
+      LOG_ERROR("Metadata log failed: ", status.message());
+      _error = status;
+    }
+    _flushed.notify_all();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status MetadataLog::apply(const MetadataLogRecord &record,
+                                const std::function<absl::Status()> &mutate) {
+  auto lock = std::unique_lock(_mutex);
+  if (!_error.ok()) {
+    return _error;
+  }
+  auto status = mutate();
+  if (!status.ok()) {
+    return status;
+  }
+  encode(record, _pending);
+  _recordsSinceSnapshot++;
+  return waitDurable(lock, ++_appended);
+}
+
+std::vector<absl::Status>
+MetadataLog::applyBatch(const std::vector<MetadataLogRecord> &records,
+                        const std::function<absl::Status(size_t)> &mutate) {
+  auto lock = std::unique_lock(_mutex);
+  if (!_error.ok()) {
+    return std::vector<absl::Status>(records.size(), _error);
+  }
+  std::vector<absl::Status> result;
+  result.reserve(records.size());
+  for (size_t i = 0; i < records.size(); i++) {
+    auto status = mutate(i);
+    if (status.ok()) {
+      encode(records[i], _pending);
+      _recordsSinceSnapshot++;
+      _appended++;
+    }
+    result.push_back(status);
+  }
+  auto status = waitDurable(lock, _appended);
+  if (!status.ok()) {
+    for (auto &s : result) {
+      if (s.ok()) {
+        s = status;
+      }
+    }
+  }
+  return result;
+}
+
+absl::Status MetadataLog::snapshot() {
+  auto running = std::lock_guard(_snapshotRunning);
+  uint64_t segment;
+  {
+    auto lock = std::unique_lock(_mutex);
+    _flushed.wait(lock, [&] { return !_flushing; });
+    if (!_error.ok()) {
+      return _error;
+    }
+    auto status = flushLocked();
+    if (!status.ok()) {
+      _error = status;
+      return status;
+    }
+    // Records of mutations that happen while the snapshot is written go to the new segment.
+    status = openSegment(_segment + 1);
+    if (!status.ok()) {
+      return status;
+    }
+    segment = _segment;
+    _recordsSinceSnapshot = 0;
+  }
+  auto status = writeSnapshot(segment);
+  if (!status.ok()) {
+    return status;
+  }
+  auto segments = listSegments(_directory);
+  if (!segments.ok()) {
+    return segments.status();
+  }
+  for (auto index : *segments) {
+    if (index < segment) {
+      // Segments which cannot be removed now are removed during the next recovery.
+      auto path = _directory + "/" + SegmentPrefix + std::to_string(index);
+      std::error_code ec;
+      std::filesystem::remove(path, ec);
+      if (ec) {
+        LOG_WARNING("Unable to remove ", path, ": ", ec.message());
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status MetadataLog::writeSnapshot(uint64_t segment) {
+  auto tmpPath = _directory + "/" + SnapshotTmpFile;
+  int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    int err = errno;
+    return absl::UnknownError("Unable to open " + tmpPath + ": " + strerror(err));
+  }
+  std::string buffer = SnapshotMagic;
+  put<uint64_t>(buffer, segment);
+  absl::Status status;
+  size_t records = 0;
+  auto append = [&](const MetadataLogRecord &record) {
+    if (!status.ok()) {
+      return;
+    }
+    encode(record, buffer);
+    records++;
+    if (buffer.size() >= SnapshotBufferSize) {
+      status = writeAll(fd, buffer, tmpPath);
+      buffer.clear();
+    }
+  };
+
+  auto buckets = _kvs->listBuckets();
+  if (!buckets.ok()) {
+    ::close(fd);
+    return buckets.status();
+  }
+  for (const auto &name : *buckets) {
+    append(MetadataLogRecord::forBucket(MetadataLogRecord::Type::CreateBucket, name));
+  }
+  for (const auto &name : *buckets) {
+    auto bucket = _kvs->getBucket(name);
+    if (!bucket.ok()) {
+      // Deleted concurrently, the new segment records the deletion.
+      continue;
+    }
+    (*bucket)->forall([&](const utility::Path &path, const geds::ObjectInfo &info) {
+      append(MetadataLogRecord::forObject(MetadataLogRecord::Type::CreateObject,
+                                       geds::Object{geds::ObjectID{name, path.name}, info}));
+    });
+  }
+  if (status.ok()) {
+    status = writeAll(fd, buffer, tmpPath);
+  }
+  if (status.ok()) {
+    status = syncFile(fd, tmpPath);
+  }
+  ::close(fd);
+  if (!status.ok()) {
+    return status;
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmpPath, _directory + "/" + SnapshotFile, ec);
+  if (ec) {
+    return absl::UnknownError("Unable to rename " + tmpPath + ": " + ec.message());
+  }
+  status = syncDirectory(_directory);
+  if (status.ok()) {
+    LOG_INFO("Wrote snapshot with ", records, " records at segment ", segment);
+  }
+  return status;
+}
+
+void MetadataLog::runSnapshots() {
+  auto lock = std::unique_lock(_snapshotMutex);
+  while (!_stopped) {
+    _snapshotWakeup.wait_for(lock, _options.snapshotInterval, [&] { return _stopped; });
+    if (_stopped) {
+      break;
+    }
+    size_t records;
+    {
+      auto logLock = std::lock_guard(_mutex);
+      records = _recordsSinceSnapshot;
+    }
+    if (records < _options.snapshotMinRecords) {
+      continue;
+    }
+    lock.unlock();
+    auto status = snapshot();
+    if (!status.ok()) {
+      LOG_ERROR("Unable to write metadata snapshot: ", status.message());
+    }
+    lock.lock();
+  }
+}
@@ -0,0 +1,160 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef METADATASERVICE_METADATA_LOG
+#define METADATASERVICE_METADATA_LOG
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/status/status.h>
+#include <absl/status/statusor.h>
+
+#include "MDSKVS.h"
+#include "Object.h"
+
+/**
+ * @brief A mutation of the metadata store as recorded in the log.
+ *
+ * Buckets use `object.id.bucket`, prefix deletions store the prefix in `object.id.key`. Renames
+ * store the source key or prefix in `object.id` and the renamed objects under their new IDs in
+ * `objects`, so replaying them does not depend on the state of the source.
+ */
+struct MetadataLogRecord {
+  enum class Type : uint8_t {
+    CreateBucket = 1,
+    DeleteBucket = 2,
+    CreateObject = 3,
+    UpdateObject = 4,
+    DeleteObject = 5,
+    DeleteObjectPrefix = 6,
+    RenameObject = 7,
+    RenameObjectPrefix = 8,
+  };
+
+  Type type;
+  geds::Object object;
+  std::vector<geds::Object> objects = {};
+
+  static MetadataLogRecord forBucket(Type type, const std::string &bucket);
+  static MetadataLogRecord forID(Type type, const geds::ObjectID &id);
+  static MetadataLogRecord forObject(Type type, const geds::Object &object);
+};
+
+/**
+ * @brief Write-ahead log of the metadata store with group commit and snapshots.
+ *
+ * The directory holds a snapshot of the store (`snapshot`) and the log segments written after it
+ * (`wal.<index>`). Every mutation is applied to the store and appended to the log while the log
+ * is locked, so the log order matches the order of the mutations. A mutation returns once its
+ * record is on disk. Records of concurrent mutations are written with a single `fdatasync`.
+ *
+ * Snapshots are taken in the background once enough records have been logged: The log switches
+ * to a new segment and the store is written shard by shard while mutations continue. Replaying
+ * the new segment on top of the snapshot yields the current state since all records overwrite
+ * the state of the objects they name.
+ *
+ * Records are framed by their length and a CRC-32 and are stored in host byte order.
+ */
+class MetadataLog {
+public:
+  struct Options {
+    /**
+     * @brief Check every `snapshotInterval` whether to take a snapshot.
+     */
+    std::chrono::seconds snapshotInterval{60};
+    /**
+     * @brief Minimum number of records logged since the previous snapshot.
+     */
+    size_t snapshotMinRecords = 100000;
+    /**
+     * @brief Number of threads loading the snapshot.
+     */
+    size_t replayThreads = std::max(std::thread::hardware_concurrency(), 1U);
+  };
+
+private:
+  const std::string _directory;
+  const std::shared_ptr<MDSKVS> _kvs;
+  const Options _options;
+
+  std::mutex _mutex;
+  std::condition_variable _flushed;
+  int _fd = -1;
+  uint64_t _segment = 0;
+  std::string _pending;
+  uint64_t _appended = 0;
+  uint64_t _durable = 0;
+  bool _flushing = false;
+  absl::Status _error;
+  size_t _recordsSinceSnapshot = 0;
+
+  // Serializes snapshots.
+  std::mutex _snapshotRunning;
+  std::mutex _snapshotMutex;
+  std::condition_variable _snapshotWakeup;
+  bool _stopped = false;
+  std::thread _snapshotThread;
+
+  MetadataLog(std::string directory, std::shared_ptr<MDSKVS> kvs, Options options);
+
+  absl::Status recover();
+  absl::Status loadSnapshot(const std::string &path, uint64_t &segment);
+  absl::Status replaySegment(const std::string &path);
+  absl::Status openSegment(uint64_t segment);
+  absl::Status writeSnapshot(uint64_t segment);
+
+  /**
+   * @brief Write `_pending` to the current segment. Requires the lock and no running flush.
+   */
+  absl::Status flushLocked();
+
+  /**
+   * @brief Wait until record `sequence` is durable. Writes the pending records if no other
+   * thread does.
+   */
+  absl::Status waitDurable(std::unique_lock<std::mutex> &lock, uint64_t sequence);
+
+  void runSnapshots();
+
+public:
+  /**
+   * @brief Open the log in `directory` and restore the state of `kvs` from it.
+   */
+  [[nodiscard]] static absl::StatusOr<std::unique_ptr<MetadataLog>>
+  open(const std::string &directory, std::shared_ptr<MDSKVS> kvs, Options options);
+
+  MetadataLog(const MetadataLog &) = delete;
+  MetadataLog &operator=(const MetadataLog &) = delete;
+  ~MetadataLog();
+
+  /**
+   * @brief Apply `mutate` and log `record` if it succeeds. Returns once the record is durable.
+   */
+  absl::Status apply(const MetadataLogRecord &record, const std::function<absl::Status()> &mutate);
+
+  /**
+   * @brief Apply `mutate(i)` for each record and log the records of the successful mutations.
+   * Returns one status per record once all records are durable.
+   */
+  std::vector<absl::Status> applyBatch(const std::vector<MetadataLogRecord> &records,
+                                       const std::function<absl::Status(size_t)> &mutate);
+
+  /**
+   * @brief Switch to a new segment, write a snapshot and drop the segments it covers.
+   */
+  absl::Status snapshot();
+};
+
+#endif
@@ -5,48 +5,280 @@
 
 #include "S3Helper.h"
 
-#include <map>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include "GEDSFileStatus.h"
 #include "Logging.h"
+#include "MDSKVSBucket.h"
 #include "Object.h"
 #include "S3Endpoint.h"
 
-absl::Status PopulateKVS(std::shared_ptr<geds::ObjectStoreConfig> config,
-                         std::shared_ptr<MDSKVS> kvs) {
+namespace {
+geds::Object toObject(const std::string &bucket, const GEDSFileStatus &file, uint64_t version) {
+  bool slash = file.key.size() > 0 && file.key[0] == '/';
+  return geds::Object{.id = geds::ObjectID{bucket, file.key},
+                      .info = geds::ObjectInfo{.location = "s3://" + bucket + (slash ? "" : "/") +
+                                                           file.key,
+                                               .size = file.size,
+                                               .sealedOffset = file.size,
+                                               .metadata = std::nullopt,
+                                               .version = version}};
+}
+} // namespace
+
+/**
+ * @brief Import state of one S3 bucket.
+ */
+class S3BucketImport {
+  const std::string _bucket;
+  std::shared_ptr<MDSKVS> _kvs;
+  std::shared_ptr<MDSKVSBucket> _kvsBucket;
+  geds::s3::Endpoint _endpoint;
+
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::atomic<bool> _stop{false};
+  std::atomic<size_t> _count{0};
+
+  // Background import: Prefixes waiting to be listed and the folder depth of each.
+  std::deque<std::pair<std::string, size_t>> _tasks;
+  size_t _busy = 0;
+  size_t _failed = 0;
+  size_t _splitDepth = 0;
+  std::chrono::steady_clock::time_point _startTime;
+  std::vector<std::thread> _workers;
+
+  // On-demand import: No imported prefix is a prefix of another.
+  std::set<std::string> _imported;
+  std::set<std::string> _inFlight;
+
+  /**
+   * @brief Insert the objects of `page` and collect its folders in `folders` if not null.
+   */
+  absl::Status insert(std::vector<GEDSFileStatus> &&page, std::vector<std::string> *folders) {
+    if (_stop) {
+      return absl::CancelledError("The import of " + _bucket + " was stopped.");
+    }
+    std::vector<geds::Object> objects;
+    objects.reserve(page.size());
+    for (auto &file : page) {
+      if (file.isDirectory) {
+        if (folders != nullptr) {
+          folders->push_back(std::move(file.key));
+        }
+        continue;
+      }
+      objects.push_back(toObject(_bucket, file, _kvs->nextVersion()));
+    }
+    _count += _kvsBucket->createObjectsIfAbsent(objects);
+    return absl::OkStatus();
+  }
+
+  bool covered(const std::string &prefix) const {
+    auto it = _imported.upper_bound(prefix);
+    if (it == _imported.begin()) {
+      return false;
+    }
+    --it;
+    return prefix.starts_with(*it);
+  }
+
+  void work() {
+    while (true) {
+      std::pair<std::string, size_t> task;
+      {
+        auto lock = std::unique_lock(_mutex);
+        _cv.wait(lock, [&] { return _stop || !_tasks.empty() || _busy == 0; });
+        if (_stop || _tasks.empty()) {
+          return;
+        }
+        task = std::move(_tasks.front());
+        _tasks.pop_front();
+        _busy++;
+      }
+      const auto &[prefix, depth] = task;
+      bool split = depth < _splitDepth;
+      auto status = _endpoint.listPages(
+          _bucket, prefix, split ? '/' : 0, [&](std::vector<GEDSFileStatus> &&page) {
+            std::vector<std::string> folders;
+            auto status = insert(std::move(page), split ? &folders : nullptr);
+            if (!folders.empty()) {
+              {
+                auto lock = std::lock_guard(_mutex);
+                for (auto &folder : folders) {
+                  _tasks.emplace_back(std::move(folder), depth + 1);
+                }
+              }
+              _cv.notify_all();
+            }
+            return status;
+          });
+      {
+        auto lock = std::lock_guard(_mutex);
+        _busy--;
+        if (!status.ok() && !_stop) {
+          _failed++;
+          LOG_ERROR("Unable to import ", _bucket, "/", prefix, ": ", status.message());
+        }
+        if (_tasks.empty() && _busy == 0 && !_stop) {
+          auto seconds =
+              std::chrono::duration<double>(std::chrono::steady_clock::now() - _startTime).count();
+          LOG_INFO("Imported ", _count.load(), " objects of ", _bucket, " in ", seconds, " s (",
+                   _failed, " failed prefixes).");
+        }
+      }
+      _cv.notify_all();
+    }
+  }
+
+public:
+  const S3ImportMode mode;
+
+  S3BucketImport(const geds::ObjectStoreConfig &config, std::shared_ptr<MDSKVS> kvs,
+                 std::shared_ptr<MDSKVSBucket> kvsBucket, S3ImportMode modeArg)
+      : _bucket(config.bucket), _kvs(std::move(kvs)), _kvsBucket(std::move(kvsBucket)),
+        _endpoint(config.endpointURL, config.accessKey, config.secretKey), mode(modeArg) {}
+
+  S3BucketImport(const S3BucketImport &) = delete;
+  S3BucketImport &operator=(const S3BucketImport &) = delete;
+
+  ~S3BucketImport() {
+    {
+      auto lock = std::lock_guard(_mutex);
+      _stop = true;
+    }
+    _cv.notify_all();
+    for (auto &worker : _workers) {
+      worker.join();
+    }
+  }
+
+  void startBackground(size_t threads, size_t splitDepth) {
+    _splitDepth = splitDepth;
+    _startTime = std::chrono::steady_clock::now();
+    _tasks.emplace_back("", 0);
+    for (size_t i = 0; i < std::max<size_t>(threads, 1); i++) {
+      _workers.emplace_back([this] { work(); });
+    }
+  }
+
+  absl::Status importPrefix(const std::string &prefix) {
+    {
+      auto lock = std::unique_lock(_mutex);
+      while (true) {
+        if (covered(prefix)) {
+          return absl::OkStatus();
+        }
+        auto running = std::any_of(_inFlight.begin(), _inFlight.end(),
+                                    [&](const auto &other) { return prefix.starts_with(other); });
+        if (!running) {
+          break;
+        }
+        _cv.wait(lock);
+      }
+      _inFlight.insert(prefix);
+    }
+    auto count = _count.load();
+    auto status = _endpoint.listPages(
+        _bucket, prefix, 0, [&](std::vector<GEDSFileStatus> &&page) {
+          return insert(std::move(page), nullptr);
+        });
+    {
+      auto lock = std::lock_guard(_mutex);
+      _inFlight.erase(prefix);
+      if (status.ok()) {
+        auto it = _imported.lower_bound(prefix);
+        while (it != _imported.end() && it->starts_with(prefix)) {
+          it = _imported.erase(it);
+        }
+        _imported.insert(prefix);
+      }
+    }
+    _cv.notify_all();
+    if (!status.ok()) {
+      LOG_ERROR("Unable to import ", _bucket, "/", prefix, ": ", status.message());
+      return status;
+    }
+    LOG_DEBUG("Imported ", _count.load() - count, " objects of ", _bucket, "/", prefix);
+    return absl::OkStatus();
+  }
+};
+
+S3Importer::S3Importer(std::shared_ptr<MDSKVS> kvs, Options options)
+    : _kvs(std::move(kvs)), _options(options) {}
+
+S3Importer::~S3Importer() {
+  auto lock = std::lock_guard(_mutex);
+  _imports.clear();
+}
+
+absl::Status S3Importer::registerBucket(std::shared_ptr<geds::ObjectStoreConfig> config) {
   // Ensure the bucket already exists
   {
-    auto status = kvs->createBucket(config->bucket);
+    auto status = _kvs->createBucket(config->bucket);
     if (!status.ok() && status.code() != absl::StatusCode::kAlreadyExists) {
       return status;
     }
   }
-  auto bucket = kvs->getBucket(config->bucket);
+  auto bucket = _kvs->getBucket(config->bucket);
   if (!bucket.ok()) {
     return bucket.status();
   }
-  auto s3Endpoint = geds::s3::Endpoint(config->endpointURL, config->accessKey, config->secretKey);
-  auto files = s3Endpoint.list(config->bucket, "");
-  if (!files.ok()) {
-    LOG_ERROR("Unable to list s3 endpoint for ", config->bucket, ": ", files.status().message());
-    return files.status();
-  }
-  for (const auto &f : *files) {
-    if (f.isDirectory) {
-      continue;
-    }
-    LOG_DEBUG("Adding: ", config->bucket, "/", f.key);
-    bool slash = f.key.size() > 0 && f.key[0] == '/';
-    auto objInfo =
-        geds::ObjectInfo{.location = "s3://" + config->bucket + (slash ? "" : "/") + f.key,
-                         .size = f.size,
-                         .sealedOffset = f.size,
-                         .metadata = std::nullopt};
-    auto status = (*bucket)->createObject(
-        geds::Object{.id = geds::ObjectID{config->bucket, f.key}, .info = objInfo});
-    if (!status.ok() && status.code() != absl::StatusCode::kAlreadyExists) {
-      LOG_ERROR("Unable to create entry for ", config->bucket, "/", f.key, ": ", status.message());
-      continue;
+  auto import = std::make_shared<S3BucketImport>(*config, _kvs, *bucket, _options.mode);
+  std::shared_ptr<S3BucketImport> previous;
+  {
+    auto lock = std::lock_guard(_mutex);
+    auto &entry = _imports[config->bucket];
+    previous = std::move(entry);
+    if (previous != nullptr && previous->mode == S3ImportMode::OnDemand) {
+      _numOnDemand--;
     }
+    entry = import;
+    if (import->mode == S3ImportMode::OnDemand) {
+      _numOnDemand++;
+    }
+  }
+  // Stops the previous import outside of the lock.
+  previous.reset();
+  if (import->mode == S3ImportMode::Background) {
+    import->startBackground(_options.threads, _options.splitDepth);
   }
   return absl::OkStatus();
 }
+
+std::shared_ptr<S3BucketImport> S3Importer::onDemandImport(const std::string &bucket) {
+  if (_numOnDemand == 0) {
+    return nullptr;
+  }
+  auto lock = std::lock_guard(_mutex);
+  auto it = _imports.find(bucket);
+  if (it == _imports.end() || it->second->mode != S3ImportMode::OnDemand) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+absl::Status S3Importer::importPrefix(const std::string &bucket, const std::string &prefix) {
+  auto import = onDemandImport(bucket);
+  if (import == nullptr) {
+    return absl::OkStatus();
+  }
+  return import->importPrefix(prefix);
+}
+
+absl::Status S3Importer::importKey(const std::string &bucket, const std::string &key) {
+  auto import = onDemandImport(bucket);
+  if (import == nullptr) {
+    return absl::OkStatus();
+  }
+  // Neighbouring keys are likely looked up next: Import the whole folder.
+  auto folder = key.rfind('/');
+  return import->importPrefix(folder == std::string::npos ? key : key.substr(0, folder + 1));
+}
@@ -5,9 +5,89 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <absl/status/status.h>
+
 #include "MDSKVS.h"
 #include "ObjectStoreConfig.h"
 #include "ObjectStoreHandler.h"
 
-absl::Status PopulateKVS(std::shared_ptr<geds::ObjectStoreConfig> config,
-                         std::shared_ptr<MDSKVS> kvs);
+enum class S3ImportMode {
+  /**
+   * @brief Import the whole bucket in the background when it is registered.
+   */
+  Background,
+  /**
+   * @brief Import a prefix when it is first listed or looked up.
+   */
+  OnDemand,
+};
+
+class S3BucketImport;
+
+/**
+ * @brief Imports the objects of S3 buckets registered as object stores into the key-value store.
+ *
+ * Registering a bucket returns once the bucket exists. Background imports split the bucket into
+ * prefixes at the first `splitDepth` levels of `/` and list the prefixes in parallel; every page is
+ * inserted as it arrives. Imported objects never replace objects that already exist.
+ */
+class S3Importer {
+public:
+  struct Options {
+    S3ImportMode mode = S3ImportMode::Background;
+
+    /**
+     * @brief Number of threads listing the prefixes of a background import.
+     */
+    size_t threads = 8;
+
+    /**
+     * @brief Number of folder levels split into separate listings.
+     */
+    size_t splitDepth = 2;
+  };
+
+private:
+  std::shared_ptr<MDSKVS> _kvs;
+  const Options _options;
+
+  std::mutex _mutex;
+  std::map<std::string, std::shared_ptr<S3BucketImport>> _imports;
+  std::atomic<size_t> _numOnDemand{0};
+
+  std::shared_ptr<S3BucketImport> onDemandImport(const std::string &bucket);
+
+public:
+  S3Importer(std::shared_ptr<MDSKVS> kvs, Options options);
+  S3Importer(const S3Importer &) = delete;
+  S3Importer &operator=(const S3Importer &) = delete;
+
+  /**
+   * @brief Stops the background imports.
+   */
+  ~S3Importer();
+
+  /**
+   * @brief Create the bucket of `config` and start importing it. Replaces a running import of the
+   * same bucket.
+   */
+  absl::Status registerBucket(std::shared_ptr<geds::ObjectStoreConfig> config);
+
+  /**
+   * @brief Make sure all objects starting with `prefix` are imported if the bucket is imported on
+   * demand.
+   */
+  absl::Status importPrefix(const std::string &bucket, const std::string &prefix);
+
+  /**
+   * @brief Make sure the folder of `key` is imported if the bucket is imported on demand.
+   */
+  absl::Status importKey(const std::string &bucket, const std::string &key);
+};
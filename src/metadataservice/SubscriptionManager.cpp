@@ -0,0 +1,306 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "SubscriptionManager.h"
+
+#include <utility>
+#include <vector>
+
+#include "Logging.h"
+
+Subscriber::Subscriber(std::string id, size_t capacity) : _id(std::move(id)), _capacity(capacity) {}
+
+bool Subscriber::push(const Event &event) {
+  {
+    auto lock = std::lock_guard(_mutex);
+    if (_closed) {
+      return !_overflowed;
+    }
+    if (_queue.size() >= _capacity) {
+      _overflowed = true;
+      _closed = true;
+      _queue.clear();
+    } else {
+      _queue.push_back(event);
+    }
+  }
+  _cv.notify_one();
+  return !_overflowed;
+}
+
+bool Subscriber::pop(std::vector<Event> &events, std::chrono::milliseconds timeout) {
+  auto lock = std::unique_lock(_mutex);
+  _cv.wait_for(lock, timeout, [&] { return _closed || !_queue.empty(); });
+  if (_closed) {
+    return false;
+  }
+  events.insert(events.end(), std::make_move_iterator(_queue.begin()),
+                std::make_move_iterator(_queue.end()));
+  _queue.clear();
+  return true;
+}
+
+void Subscriber::close() {
+  {
+    auto lock = std::lock_guard(_mutex);
+    _closed = true;
+  }
+  _cv.notify_all();
+}
+
+bool Subscriber::overflowed() {
+  auto lock = std::lock_guard(_mutex);
+  return _overflowed;
+}
+
+SubscriptionManager::SubscriptionManager(size_t queueCapacity,
+                                         std::chrono::steady_clock::duration expiry)
+    : _queueCapacity(queueCapacity), _expiry(expiry) {}
+
+absl::Status SubscriptionManager::subscribe(const geds::rpc::SubscriptionEvent &event) {
+  if (event.subscriberid().empty()) {
+    return absl::InvalidArgumentError("Missing subscriber ID.");
+  }
+  if (event.bucketid().empty()) {
+    return absl::InvalidArgumentError("Missing bucket.");
+  }
+  expire();
+  {
+    // Subscriptions of subscribers which never open a stream expire as well.
+    auto lock = std::lock_guard(_streamsMutex);
+    if (!_streams.contains(event.subscriberid())) {
+      _disconnected.try_emplace(event.subscriberid(), std::chrono::steady_clock::now());
+    }
+  }
+  auto lock = getWriteLock();
+  auto &bucket = _buckets[event.bucketid()];
+  switch (event.subscriptiontype()) {
+  case geds::rpc::BUCKET:
+    bucket.bucket.insert(event.subscriberid());
+    break;
+  case geds::rpc::OBJECT:
+    bucket.objects[event.key()].insert(event.subscriberid());
+    break;
+  case geds::rpc::PREFIX: {
+    auto subscribers = bucket.prefixes.find(event.key());
+    if (subscribers == nullptr) {
+      bucket.prefixes.insertOrAssign(event.key(), {event.subscriberid()});
+    } else {
+      subscribers->insert(event.subscriberid());
+    }
+    break;
+  }
+  default:
+    if (bucket.empty()) {
+      _buckets.erase(event.bucketid());
+    }
+    return absl::InvalidArgumentError("Invalid subscription type.");
+  }
+  auto key = event.subscriptiontype() == geds::rpc::BUCKET ? std::string{} : event.key();
+  _subscribers[event.subscriberid()].emplace(event.subscriptiontype(), event.bucketid(),
+                                             std::move(key));
+  return absl::OkStatus();
+}
+
+bool SubscriptionManager::remove(const Subscription &subscription,
+                                 const std::string &subscriberID) {
+  const auto &[type, bucketID, key] = subscription;
+  auto it = _buckets.find(bucketID);
+  if (it == _buckets.end()) {
+    return false;
+  }
+  auto &bucket = it->second;
+  bool removed = false;
+  switch (type) {
+  case geds::rpc::BUCKET:
+    removed = bucket.bucket.erase(subscriberID) > 0;
+    break;
+  case geds::rpc::OBJECT: {
+    auto object = bucket.objects.find(key);
+    if (object != bucket.objects.end()) {
+      removed = object->second.erase(subscriberID) > 0;
+      if (object->second.empty()) {
+        bucket.objects.erase(object);
+      }
+    }
+    break;
+  }
+  case geds::rpc::PREFIX: {
+    auto subscribers = bucket.prefixes.find(key);
+    if (subscribers != nullptr) {
+      removed = subscribers->erase(subscriberID) > 0;
+      if (subscribers->empty()) {
+        bucket.prefixes.erase(key);
+      }
+    }
+    break;
+  }
+  default:
+    break;
+  }
+  if (bucket.empty()) {
+    _buckets.erase(it);
+  }
+  if (auto subscriptions = _subscribers.find(subscriberID); subscriptions != _subscribers.end()) {
+    subscriptions->second.erase(subscription);
+    if (subscriptions->second.empty()) {
+      _subscribers.erase(subscriptions);
+    }
+  }
+  return removed;
+}
+
+absl::Status SubscriptionManager::unsubscribe(const geds::rpc::SubscriptionEvent &event) {
+  auto type = event.subscriptiontype();
+  if (type != geds::rpc::BUCKET && type != geds::rpc::OBJECT && type != geds::rpc::PREFIX) {
+    return absl::InvalidArgumentError("Invalid subscription type.");
+  }
+  auto lock = getWriteLock();
+  if (!_buckets.contains(event.bucketid())) {
+    return absl::NotFoundError("No subscriptions for bucket " + event.bucketid() + ".");
+  }
+  auto key = type == geds::rpc::BUCKET ? std::string{} : event.key();
+  if (!remove(Subscription{type, event.bucketid(), std::move(key)}, event.subscriberid())) {
+    return absl::NotFoundError("Subscription of " + event.subscriberid() + " for " +
+                               event.bucketid() + "/" + event.key() + " does not exist.");
+  }
+  return absl::OkStatus();
+}
+
+void SubscriptionManager::expire() {
+  auto now = std::chrono::steady_clock::now();
+  std::vector<std::string> expired;
+  {
+    auto lock = std::lock_guard(_streamsMutex);
+    if (now - _lastExpiry < _expiry) {
+      return;
+    }
+    _lastExpiry = now;
+    for (auto it = _disconnected.begin(); it != _disconnected.end();) {
+      if (now - it->second >= _expiry) {
+        expired.push_back(it->first);
+        it = _disconnected.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  if (expired.empty()) {
+    return;
+  }
+  size_t count = 0;
+  auto lock = getWriteLock();
+  for (const auto &subscriberID : expired) {
+    {
+      // The subscriber reconnected in the meantime.
+      auto streamsLock = std::lock_guard(_streamsMutex);
+      if (_streams.contains(subscriberID)) {
+        continue;
+      }
+    }
+    auto node = _subscribers.extract(subscriberID);
+    if (node.empty()) {
+      continue;
+    }
+    for (const auto &subscription : node.mapped()) {
+      (void)remove(subscription, subscriberID);
+    }
+    count++;
+  }
+  if (count > 0) {
+    LOG_INFO("Dropped the subscriptions of ", count, " disconnected subscribers.");
+  }
+}
+
+bool SubscriptionManager::hasSubscriptions(const std::string &bucket) {
+  auto lock = getReadLock();
+  return _buckets.contains(bucket);
+}
+
+bool SubscriptionManager::hasSubscriptions() {
+  auto lock = getReadLock();
+  return !_buckets.empty();
+}
+
+std::shared_ptr<Subscriber> SubscriptionManager::connect(const std::string &subscriberID) {
+  auto subscriber = std::make_shared<Subscriber>(subscriberID, _queueCapacity);
+  std::shared_ptr<Subscriber> previous;
+  {
+    auto lock = std::lock_guard(_streamsMutex);
+    auto &entry = _streams[subscriberID];
+    previous = std::move(entry);
+    entry = subscriber;
+    _disconnected.erase(subscriberID);
+  }
+  if (previous != nullptr) {
+    LOG_INFO("Replacing stream of subscriber ", subscriberID);
+    previous->close();
+  }
+  return subscriber;
+}
+
+void SubscriptionManager::disconnect(const std::shared_ptr<Subscriber> &subscriber) {
+  subscriber->close();
+  auto lock = std::lock_guard(_streamsMutex);
+  auto it = _streams.find(subscriber->id());
+  if (it != _streams.end() && it->second == subscriber) {
+    _streams.erase(it);
+    _disconnected[subscriber->id()] = std::chrono::steady_clock::now();
+  }
+}
+
+void SubscriptionManager::publish(geds::rpc::PublicationType type, const geds::Object &object) {
+  std::set<std::string> matches;
+  {
+    auto lock = getReadLock();
+    auto it = _buckets.find(object.id.bucket);
+    if (it == _buckets.end()) {
+      return;
+    }
+    const auto &bucket = it->second;
+    matches.insert(bucket.bucket.begin(), bucket.bucket.end());
+    if (auto objects = bucket.objects.find(object.id.key); objects != bucket.objects.end()) {
+      matches.insert(objects->second.begin(), objects->second.end());
+    }
+    bucket.prefixes.forEachPrefixOf(
+        object.id.key, [&](const std::string &, const std::set<std::string> &subscribers) {
+          matches.insert(subscribers.begin(), subscribers.end());
+        });
+  }
+  if (matches.empty()) {
+    return;
+  }
+
+  auto event = std::make_shared<geds::rpc::SubscriptionStreamResponse>();
+  event->set_publicationtype(type);
+  auto *id = event->mutable_object()->mutable_id();
+  id->set_bucket(object.id.bucket);
+  id->set_key(object.id.key);
+  auto *info = event->mutable_object()->mutable_info();
+  info->set_location(object.info.location);
+  info->set_size(object.info.size);
+  info->set_sealedoffset(object.info.sealedOffset);
+  info->set_version(object.info.version);
+  if (object.info.metadata.has_value()) {
+    info->set_metadata(*object.info.metadata);
+  }
+
+  std::vector<std::shared_ptr<Subscriber>> subscribers;
+  subscribers.reserve(matches.size());
+  {
+    auto lock = std::lock_guard(_streamsMutex);
+    for (const auto &subscriberID : matches) {
+      if (auto it = _streams.find(subscriberID); it != _streams.end()) {
+        subscribers.push_back(it->second);
+      }
+    }
+  }
+  for (const auto &subscriber : subscribers) {
+    if (!subscriber->push(event)) {
+      LOG_ERROR("Disconnecting slow subscriber ", subscriber->id());
+      disconnect(subscriber);
+    }
+  }
+}
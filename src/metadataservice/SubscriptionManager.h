@@ -0,0 +1,147 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef METADATASERVICE_SUBSCRIPTION_MANAGER
+#define METADATASERVICE_SUBSCRIPTION_MANAGER
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <absl/status/status.h>
+
+#include "Object.h"
+#include "RWConcurrentObjectAdaptor.h"
+#include "RadixTree.h"
+
+#include "geds.pb.h"
+
+/**
+ * @brief Publications for the stream of one subscriber.
+ *
+ * The queue is bounded: A subscriber that does not keep up is closed and its stream ends, so the
+ * client reconnects and drops its cached state instead of missing publications silently.
+ */
+class Subscriber {
+public:
+  using Event = std::shared_ptr<const geds::rpc::SubscriptionStreamResponse>;
+
+private:
+  const std::string _id;
+  const size_t _capacity;
+
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::deque<Event> _queue;
+  bool _closed = false;
+  bool _overflowed = false;
+
+public:
+  Subscriber(std::string id, size_t capacity);
+
+  const std::string &id() const { return _id; }
+
+  /**
+   * @brief Queue `event`. Closes the subscriber and returns false if the queue is full.
+   */
+  bool push(const Event &event);
+
+  /**
+   * @brief Move all queued events to `events`, waiting up to `timeout` for the first one.
+   * Returns false once the subscriber is closed.
+   */
+  bool pop(std::vector<Event> &events, std::chrono::milliseconds timeout);
+
+  void close();
+
+  bool overflowed();
+};
+
+/**
+ * @brief Subscriptions of the metadata server and the streams of the subscribers.
+ *
+ * Subscriptions are indexed per bucket: Object subscriptions by key and prefix subscriptions in a
+ * radix tree, so matching a publication only walks the path of its key. A publication is
+ * serialized once and shared by the queues of all matching subscribers.
+ *
+ * The subscriptions of a subscriber are dropped once it has had no stream for `expiry`, so clients
+ * which went away do not leave subscriptions behind.
+ */
+class SubscriptionManager : public utility::RWConcurrentObjectAdaptor {
+  struct BucketSubscriptions {
+    std::set<std::string> bucket;
+    std::unordered_map<std::string, std::set<std::string>> objects;
+    utility::RadixTree<std::set<std::string>> prefixes;
+
+    bool empty() const { return bucket.empty() && objects.empty() && prefixes.size() == 0; }
+  };
+
+  // Type, bucket and key of a subscription.
+  using Subscription = std::tuple<geds::rpc::SubscriptionType, std::string, std::string>;
+
+  const size_t _queueCapacity;
+  const std::chrono::steady_clock::duration _expiry;
+  std::unordered_map<std::string, BucketSubscriptions> _buckets;
+  std::unordered_map<std::string, std::set<Subscription>> _subscribers;
+
+  std::mutex _streamsMutex;
+  std::unordered_map<std::string, std::shared_ptr<Subscriber>> _streams;
+  // Subscribers without a stream and the time they lost it or first subscribed.
+  std::unordered_map<std::string, std::chrono::steady_clock::time_point> _disconnected;
+  std::chrono::steady_clock::time_point _lastExpiry;
+
+  /**
+   * @brief Remove a subscription. Requires the write lock.
+   */
+  bool remove(const Subscription &subscription, const std::string &subscriberID);
+
+  /**
+   * @brief Drop the subscriptions of subscribers which have had no stream for `_expiry`. Runs at
+   * most once per `_expiry`.
+   */
+  void expire();
+
+public:
+  static constexpr size_t DefaultQueueCapacity = 10000;
+  static constexpr std::chrono::minutes DefaultExpiry{10};
+
+  SubscriptionManager(size_t queueCapacity = DefaultQueueCapacity,
+                      std::chrono::steady_clock::duration expiry = DefaultExpiry);
+
+  absl::Status subscribe(const geds::rpc::SubscriptionEvent &event);
+  absl::Status unsubscribe(const geds::rpc::SubscriptionEvent &event);
+
+  /**
+   * @brief Check whether any subscription covers objects in `bucket`.
+   */
+  bool hasSubscriptions(const std::string &bucket);
+
+  /**
+   * @brief Check whether any subscription exists.
+   */
+  bool hasSubscriptions();
+
+  /**
+   * @brief Open the stream of `subscriberID`. A previous stream of the subscriber is closed.
+   */
+  std::shared_ptr<Subscriber> connect(const std::string &subscriberID);
+
+  /**
+   * @brief Close `subscriber`. Its subscriptions are kept for the next stream until they expire.
+   */
+  void disconnect(const std::shared_ptr<Subscriber> &subscriber);
+
+  void publish(geds::rpc::PublicationType type, const geds::Object &object);
+};
+
+#endif
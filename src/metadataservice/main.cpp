@@ -3,21 +3,100 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <chrono>
 #include <iostream>
 
 #include <absl/flags/flag.h>
 #include <absl/flags/parse.h>
 
 #include "GRPCServer.h"
+#include "Logging.h"
 #include "Ports.h"
 
 ABSL_FLAG(std::string, address, "0.0.0.0", "Server interface address.");
 ABSL_FLAG(uint16_t, port, defaultMetdataServerPort, "Port.");
+ABSL_FLAG(std::string, metadata_dir, "",
+          "Directory of the metadata log and snapshots. Metadata is not persisted if empty.");
+ABSL_FLAG(int64_t, snapshot_interval, 60, "Seconds between checks whether to write a snapshot.");
+ABSL_FLAG(size_t, snapshot_min_records, 100000,
+          "Minimum number of logged mutations before writing a snapshot.");
+ABSL_FLAG(size_t, replay_threads, 0,
+          "Number of threads loading the snapshot on startup. 0 uses all cores.");
+ABSL_FLAG(size_t, polling_threads, 0,
+          "Number of threads serving unary RPCs from completion queues. 0 serves all RPCs "
+          "synchronously.");
+ABSL_FLAG(bool, pin_threads, true, "Pin the polling threads to cores.");
+ABSL_FLAG(std::string, shards, "",
+          "Comma-separated addresses of all metadata servers if the metadata is sharded.");
+ABSL_FLAG(std::string, shard, "",
+          "Address of this server in --shards. Defaults to the address and port of this server.");
+ABSL_FLAG(std::string, s3_import, "background",
+          "Import registered S3 buckets in the background (background) or a prefix when it is "
+          "first listed or looked up (on_demand). on_demand requires --polling_threads=0.");
+ABSL_FLAG(size_t, s3_import_threads, 8, "Number of threads listing a bucket imported in the "
+                                        "background.");
+ABSL_FLAG(uint32_t, access_log_sampling, 1, "Log one in N RPCs. 0 disables the access log.");
+ABSL_FLAG(std::string, log_level, "debug",
+          "Minimum level of log lines: debug, info, warning, error.");
 
 int main(int argc, char **argv) {
   absl::ParseCommandLine(argc, argv);
+  auto &logger = geds::logging::Logger::instance();
+  auto logLevel = absl::GetFlag(FLAGS_log_level);
+  if (logLevel == "debug") {
+    logger.setLevel(geds::logging::Level::Debug);
+  } else if (logLevel == "info") {
+    logger.setLevel(geds::logging::Level::Info);
+  } else if (logLevel == "warning") {
+    logger.setLevel(geds::logging::Level::Warning);
+  } else if (logLevel == "error") {
+    logger.setLevel(geds::logging::Level::Error);
+  } else {
+    std::cerr << "Invalid log level " << logLevel << std::endl;
+    exit(1);
+  }
+  logger.setAccessSampling(absl::GetFlag(FLAGS_access_log_sampling));
   auto serverAddress = FLAGS_address.CurrentValue() + ":" + FLAGS_port.CurrentValue();
-  GRPCServer service(serverAddress);
+  GRPCServer::Options serverOptions;
+  serverOptions.pollingThreads = absl::GetFlag(FLAGS_polling_threads);
+  serverOptions.pinThreads = absl::GetFlag(FLAGS_pin_threads);
+  auto s3Import = absl::GetFlag(FLAGS_s3_import);
+  if (s3Import == "background") {
+    serverOptions.s3Import.mode = S3ImportMode::Background;
+  } else if (s3Import == "on_demand") {
+    serverOptions.s3Import.mode = S3ImportMode::OnDemand;
+  } else {
+    std::cerr << "Invalid S3 import mode " << s3Import << std::endl;
+    exit(1);
+  }
+  serverOptions.s3Import.threads = absl::GetFlag(FLAGS_s3_import_threads);
+  if (serverOptions.s3Import.mode == S3ImportMode::OnDemand && serverOptions.pollingThreads > 0) {
+    std::cerr << "--s3_import=on_demand cannot be combined with --polling_threads" << std::endl;
+    exit(1);
+  }
+  GRPCServer service(serverAddress, serverOptions);
+  if (auto shards = absl::GetFlag(FLAGS_shards); !shards.empty()) {
+    auto shard = absl::GetFlag(FLAGS_shard);
+    auto status = service.setShards(shards, shard.empty() ? serverAddress : shard);
+    if (!status.ok()) {
+      std::cerr << status.message() << std::endl;
+      exit(1);
+    }
+  }
+  auto metadataDir = absl::GetFlag(FLAGS_metadata_dir);
+  if (!metadataDir.empty()) {
+    MetadataLog::Options options;
+    options.snapshotInterval = std::chrono::seconds(absl::GetFlag(FLAGS_snapshot_interval));
+    options.snapshotMinRecords = absl::GetFlag(FLAGS_snapshot_min_records);
+    if (auto threads = absl::GetFlag(FLAGS_replay_threads); threads > 0) {
+      options.replayThreads = threads;
+    }
+    auto status = service.enableLog(metadataDir, options);
+    if (!status.ok()) {
+      std::cerr << status.message() << std::endl;
+      exit(1);
+    }
+  }
   auto status = service.startAndWait();
   if (!status.ok()) {
     std::cerr << status.message() << std::endl;
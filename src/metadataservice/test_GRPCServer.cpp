@@ -0,0 +1,170 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "GRPCServer.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+#include <grpcpp/grpcpp.h>
+
+#include "Object.h"
+#include "Status.h"
+#include "geds.grpc.pb.h"
+#include "geds.pb.h"
+
+namespace {
+
+/**
+ * @brief Serves the metadata service of a `GRPCServer` in-process.
+ */
+struct InProcessServer {
+  GRPCServer metadataServer{"unused"};
+  std::unique_ptr<grpc::Server> server;
+  std::unique_ptr<geds::rpc::MetadataService::Stub> stub;
+
+  InProcessServer() {
+    grpc::ServerBuilder builder;
+    builder.RegisterService(metadataServer.service());
+    server = builder.BuildAndStart();
+    stub = geds::rpc::MetadataService::NewStub(server->InProcessChannel({}));
+  }
+
+  ~InProcessServer() { server->Shutdown(); }
+
+  void createBucket(const std::string &name) {
+    geds::rpc::Bucket bucket;
+    bucket.set_bucket(name);
+    geds::rpc::StatusResponse response;
+    grpc::ClientContext context;
+    ASSERT_TRUE(stub->CreateBucket(&context, bucket, &response).ok());
+    ASSERT_TRUE(convertStatus(response).ok());
+  }
+};
+
+void addID(geds::rpc::ObjectIDBatch &batch, const std::string &bucket, const std::string &key) {
+  auto id = batch.add_ids();
+  id->set_bucket(bucket);
+  id->set_key(key);
+}
+
+void addObject(geds::rpc::ObjectBatch &batch, const std::string &bucket, const std::string &key,
+               size_t size) {
+  auto object = batch.add_objects();
+  object->mutable_id()->set_bucket(bucket);
+  object->mutable_id()->set_key(key);
+  object->mutable_info()->set_location("geds://node");
+  object->mutable_info()->set_size(size);
+  object->mutable_info()->set_sealedoffset(size);
+}
+
+} // namespace
+
+TEST(GRPCServer, Batches) {
+  InProcessServer server;
+  server.createBucket("bucket");
+
+  {
+    geds::rpc::ObjectBatch request;
+    addObject(request, "bucket", "a", 1);
+    addObject(request, "missing", "b", 2);
+    addObject(request, "bucket", "c", 3);
+    geds::rpc::StatusResponseBatch response;
+    grpc::ClientContext context;
+    ASSERT_TRUE(server.stub->CreateBatch(&context, request, &response).ok());
+    ASSERT_EQ(response.results_size(), 3);
+    ASSERT_TRUE(convertStatus(response.results(0)).ok());
+    ASSERT_EQ(convertStatus(response.results(1)).code(), absl::StatusCode::kNotFound);
+    ASSERT_TRUE(convertStatus(response.results(2)).ok());
+  }
+  {
+    geds::rpc::ObjectIDBatch request;
+    addID(request, "bucket", "c");
+    addID(request, "bucket", "b");
+    addID(request, "bucket", "a");
+    geds::rpc::ObjectResponseBatch response;
+    grpc::ClientContext context;
+    ASSERT_TRUE(server.stub->LookupBatch(&context, request, &response).ok());
+    ASSERT_EQ(response.results_size(), 3);
+    ASSERT_FALSE(response.results(0).has_error());
+    ASSERT_EQ(response.results(0).result().id().key(), "c");
+    ASSERT_EQ(response.results(0).result().info().size(), 3);
+    ASSERT_TRUE(response.results(1).has_error());
+    ASSERT_EQ(convertStatus(response.results(1).error()).code(), absl::StatusCode::kNotFound);
+    ASSERT_FALSE(response.results(2).has_error());
+    ASSERT_EQ(response.results(2).result().info().size(), 1);
+  }
+  {
+    geds::rpc::ObjectIDBatch request;
+    addID(request, "bucket", "a");
+    addID(request, "bucket", "b");
+    geds::rpc::StatusResponseBatch response;
+    grpc::ClientContext context;
+    ASSERT_TRUE(server.stub->DeleteBatch(&context, request, &response).ok());
+    ASSERT_EQ(response.results_size(), 2);
+    ASSERT_TRUE(convertStatus(response.results(0)).ok());
+    ASSERT_EQ(convertStatus(response.results(1)).code(), absl::StatusCode::kNotFound);
+  }
+  {
+    geds::rpc::ObjectID request;
+    request.set_bucket("bucket");
+    request.set_key("a");
+    geds::rpc::ObjectResponse response;
+    grpc::ClientContext context;
+    ASSERT_TRUE(server.stub->Lookup(&context, request, &response).ok());
+    ASSERT_TRUE(response.has_error());
+  }
+}
+
+TEST(GRPCServer, BatchSize) {
+  InProcessServer server;
+  server.createBucket("bucket");
+
+  geds::rpc::ObjectBatch objects;
+  geds::rpc::ObjectIDBatch ids;
+  for (size_t i = 0; i < geds::MaxMetadataBatchSize; i++) {
+    addObject(objects, "bucket", std::to_string(i), i);
+    addID(ids, "bucket", std::to_string(i));
+  }
+  {
+    geds::rpc::StatusResponseBatch response;
+    grpc::ClientContext context;
+    ASSERT_TRUE(server.stub->CreateBatch(&context, objects, &response).ok());
+    ASSERT_EQ(response.results_size(), geds::MaxMetadataBatchSize);
+  }
+
+  addObject(objects, "bucket", "overflow", 0);
+  addID(ids, "bucket", "overflow");
+  {
+    geds::rpc::StatusResponseBatch response;
+    grpc::ClientContext context;
+    auto status = server.stub->CreateBatch(&context, objects, &response);
+    ASSERT_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
+  }
+  {
+    geds::rpc::ObjectResponseBatch response;
+    grpc::ClientContext context;
+    auto status = server.stub->LookupBatch(&context, ids, &response);
+    ASSERT_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
+  }
+  {
+    geds::rpc::StatusResponseBatch response;
+    grpc::ClientContext context;
+    auto status = server.stub->DeleteBatch(&context, ids, &response);
+    ASSERT_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
+  }
+  // Rejected batches are not applied partially.
+  {
+    geds::rpc::ObjectID request;
+    request.set_bucket("bucket");
+    request.set_key("overflow");
+    geds::rpc::ObjectResponse response;
+    grpc::ClientContext context;
+    ASSERT_TRUE(server.stub->Lookup(&context, request, &response).ok());
+    ASSERT_TRUE(response.has_error());
+  }
+}
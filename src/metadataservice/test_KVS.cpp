@@ -4,8 +4,12 @@
  */
 
 #include <absl/status/status.h>
+#include <algorithm>
 #include <cstddef>
 #include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "MDSKVS.h"
 #include "Object.h"
@@ -76,3 +80,168 @@ TEST(KVS, Delete) {
   EXPECT_EQ(kvs.deleteObjectPrefix(geds::ObjectID{bucket, "/"}).code(),
             absl::StatusCode::kNotFound);
 }
+
+TEST(KVS, ConcurrentCreate) {
+  auto kvs = MDSKVS();
+
+  auto bucket = "testConcurrentCreate";
+  EXPECT_EQ(kvs.createBucket(bucket).code(), absl::StatusCode::kOk);
+
+  constexpr size_t numThreads = 8;
+  constexpr size_t numObjects = 1000;
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < numThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < numObjects; i++) {
+        auto key = "/" + std::to_string(t) + "/" + std::to_string(i);
+        EXPECT_TRUE(kvs.createObject(geds::Object{geds::ObjectID{bucket, key},
+                                                  geds::ObjectInfo{"node", i, i, std::nullopt}})
+                        .ok());
+        // Listings observe complete keys only.
+        auto list = kvs.listObjects(geds::ObjectID(bucket, "/"), '/');
+        EXPECT_TRUE(list.ok());
+        EXPECT_LE(list->second.size(), numThreads);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  auto list = kvs.listObjects(geds::ObjectID(bucket, "/"), '/');
+  EXPECT_TRUE(list.ok());
+  EXPECT_EQ(list->second.size(), numThreads);
+  list = kvs.listObjects(geds::ObjectID(bucket, "/3/"));
+  EXPECT_TRUE(list.ok());
+  EXPECT_EQ(list->first.size(), numObjects);
+  EXPECT_TRUE(std::is_sorted(list->first.begin(), list->first.end(),
+                             [](const auto &a, const auto &b) { return a.id.key < b.id.key; }));
+}
+
+TEST(KVS, Pagination) {
+  auto kvs = MDSKVS();
+
+  auto bucket = "testPagination";
+  EXPECT_EQ(kvs.createBucket(bucket).code(), absl::StatusCode::kOk);
+  for (size_t i = 0; i < 100; i++) {
+    auto key = "/" + std::to_string(i % 10) + (i < 50 ? "/" : "_") + std::to_string(i);
+    EXPECT_TRUE(kvs.createObject(geds::Object{geds::ObjectID{bucket, key},
+                                              geds::ObjectInfo{"node", i, i, "metadata"}})
+                    .ok());
+  }
+  auto expected = kvs.listObjects(bucket, "/", '/');
+  EXPECT_TRUE(expected.ok());
+  EXPECT_EQ(expected->first.size(), 50);
+  EXPECT_EQ(expected->second.size(), 10);
+
+  std::vector<std::string> objects;
+  std::vector<std::string> commonPrefixes;
+  MDSKVSListOptions options{.startAfter = "", .maxResults = 7, .omitMetadata = true};
+  size_t pages = 0;
+  while (true) {
+    auto page = kvs.listObjects(bucket, "/", '/', options);
+    EXPECT_TRUE(page.ok());
+    EXPECT_LE(page->objects.size() + page->commonPrefixes.size(), 7);
+    for (const auto &object : page->objects) {
+      EXPECT_FALSE(object.info.metadata.has_value());
+      objects.push_back(object.id.key);
+    }
+    commonPrefixes.insert(commonPrefixes.end(), page->commonPrefixes.begin(),
+                          page->commonPrefixes.end());
+    pages++;
+    if (!page->continuationToken.has_value()) {
+      break;
+    }
+    options.startAfter = *page->continuationToken;
+  }
+  EXPECT_EQ(pages, 9);
+  EXPECT_EQ(commonPrefixes, expected->second);
+  std::vector<std::string> expectedObjects;
+  for (const auto &object : expected->first) {
+    expectedObjects.push_back(object.id.key);
+  }
+  EXPECT_EQ(objects, expectedObjects);
+}
+
+TEST(KVS, CreateObjectsIfAbsent) {
+  auto kvs = MDSKVS();
+  auto bucketName = "testCreateIfAbsent";
+  ASSERT_TRUE(kvs.createBucket(bucketName).ok());
+  ASSERT_TRUE(kvs.createObject(geds::Object{geds::ObjectID{bucketName, "key_1"},
+                                            geds::ObjectInfo{"geds://node", 1, 1, std::nullopt}})
+                  .ok());
+  auto bucket = kvs.getBucket(bucketName);
+  ASSERT_TRUE(bucket.ok());
+
+  std::vector<geds::Object> objects;
+  for (size_t i = 0; i < 100; i++) {
+    objects.push_back(geds::Object{geds::ObjectID{bucketName, "key_" + std::to_string(i)},
+                                   geds::ObjectInfo{"s3://bucket", i, i, std::nullopt}});
+  }
+  ASSERT_EQ((*bucket)->createObjectsIfAbsent(objects), 99);
+  ASSERT_EQ((*bucket)->createObjectsIfAbsent(objects), 0);
+
+  // Existing objects are not overwritten.
+  auto existing = kvs.lookup(bucketName, "key_1");
+  ASSERT_TRUE(existing.ok());
+  ASSERT_EQ(existing->info.location, "geds://node");
+  auto imported = kvs.lookup(bucketName, "key_42");
+  ASSERT_TRUE(imported.ok());
+  ASSERT_EQ(imported->info.location, "s3://bucket");
+  ASSERT_EQ(imported->info.size, 42);
+}
+
+TEST(KVS, Rename) {
+  auto kvs = MDSKVS();
+  ASSERT_TRUE(kvs.createBucket("src").ok());
+  ASSERT_TRUE(kvs.createBucket("dest").ok());
+  for (size_t i = 0; i < 100; i++) {
+    ASSERT_TRUE(kvs.createObject(geds::Object{geds::ObjectID{"src", "dir/" + std::to_string(i)},
+                                              geds::ObjectInfo{"geds://node", i, i, std::nullopt}})
+                    .ok());
+  }
+
+  auto renamed = kvs.renameObject(geds::ObjectID{"src", "dir/1"}, geds::ObjectID{"dest", "one"});
+  ASSERT_TRUE(renamed.ok());
+  ASSERT_EQ(renamed->id.key, "one");
+  ASSERT_EQ(renamed->info.size, 1);
+  ASSERT_EQ(kvs.lookup("src", "dir/1").status().code(), absl::StatusCode::kNotFound);
+  ASSERT_EQ(kvs.lookup("dest", "one")->info.size, 1);
+  renamed = kvs.renameObject(geds::ObjectID{"src", "dir/1"}, geds::ObjectID{"dest", "one"});
+  ASSERT_EQ(renamed.status().code(), absl::StatusCode::kNotFound);
+
+  // The destination prefix may start with the source prefix.
+  auto prefix =
+      kvs.renameObjectPrefix(geds::ObjectID{"src", "dir/"}, geds::ObjectID{"src", "dir/sub/"});
+  ASSERT_TRUE(prefix.ok());
+  ASSERT_EQ(prefix->size(), 99);
+  ASSERT_EQ(kvs.lookup("src", "dir/sub/42")->info.size, 42);
+  ASSERT_EQ(kvs.lookup("src", "dir/42").status().code(), absl::StatusCode::kNotFound);
+
+  prefix = kvs.renameObjectPrefix(geds::ObjectID{"src", "dir/"}, geds::ObjectID{"dest", "moved/"});
+  ASSERT_TRUE(prefix.ok());
+  ASSERT_EQ(prefix->size(), 99);
+  ASSERT_EQ(kvs.listObjects(geds::ObjectID{"src", ""})->first.size(), 0);
+  ASSERT_EQ(kvs.listObjects(geds::ObjectID{"dest", "moved/sub/"})->first.size(), 99);
+  ASSERT_EQ(kvs.renameObjectPrefix(geds::ObjectID{"src", "dir/"}, geds::ObjectID{"dest", "x/"})
+                .status()
+                .code(),
+            absl::StatusCode::kNotFound);
+  // Prefix renames with expected keys fail if another object appeared.
+  ASSERT_TRUE(kvs.createObject(geds::Object{geds::ObjectID{"dest", "moved/new"},
+                                            geds::ObjectInfo{"geds://other", 1, 1, std::nullopt}})
+                  .ok());
+  std::vector<std::string> listed;
+  for (const auto &object : kvs.listObjects(geds::ObjectID{"dest", "moved/sub/"})->first) {
+    listed.push_back(object.id.key);
+  }
+  prefix = kvs.renameObjectPrefix(geds::ObjectID{"dest", "moved/"}, geds::ObjectID{"dest", "x/"},
+                                  listed);
+  ASSERT_EQ(prefix.status().code(), absl::StatusCode::kFailedPrecondition);
+  ASSERT_EQ(kvs.lookup("dest", "moved/new")->info.location, "geds://other");
+  listed.push_back("moved/new");
+  prefix = kvs.renameObjectPrefix(geds::ObjectID{"dest", "moved/"}, geds::ObjectID{"dest", "x/"},
+                                  listed);
+  ASSERT_TRUE(prefix.ok());
+  ASSERT_EQ(prefix->size(), 100);
+}
@@ -0,0 +1,257 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <absl/status/status.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "MDSKVS.h"
+#include "MetadataLog.h"
+#include "Object.h"
+
+namespace {
+
+class MetadataLogTest : public ::testing::Test {
+protected:
+  std::string directory;
+
+  void SetUp() override {
+    directory = std::filesystem::temp_directory_path() /
+                ("geds_metadata_log_" + std::to_string(::getpid()) + "_" +
+                 ::testing::UnitTest::GetInstance()->current_test_info()->name());
+    std::filesystem::remove_all(directory);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory); }
+
+  std::pair<std::shared_ptr<MDSKVS>, std::unique_ptr<MetadataLog>> open() {
+    auto kvs = std::make_shared<MDSKVS>();
+    MetadataLog::Options options;
+    options.snapshotInterval = std::chrono::seconds(3600);
+    options.replayThreads = 4;
+    auto log = MetadataLog::open(directory, kvs, options);
+    EXPECT_TRUE(log.ok()) << log.status().message();
+    return {kvs, std::move(*log)};
+  }
+};
+
+geds::Object makeObject(const std::string &key, size_t size) {
+  return geds::Object{geds::ObjectID{"bucket", key},
+                      geds::ObjectInfo{"geds://" + key, size, size, std::nullopt}};
+}
+
+absl::Status createBucket(MDSKVS &kvs, MetadataLog &log, const std::string &bucket) {
+  return log.apply(MetadataLogRecord::forBucket(MetadataLogRecord::Type::CreateBucket, bucket),
+                   [&] { return kvs.createBucket(bucket); });
+}
+
+absl::Status createObject(MDSKVS &kvs, MetadataLog &log, const geds::Object &object) {
+  return log.apply(MetadataLogRecord::forObject(MetadataLogRecord::Type::CreateObject, object),
+                   [&] { return kvs.createObject(object); });
+}
+
+absl::Status deleteObject(MDSKVS &kvs, MetadataLog &log, const geds::ObjectID &id) {
+  return log.apply(MetadataLogRecord::forID(MetadataLogRecord::Type::DeleteObject, id),
+                   [&] { return kvs.deleteObject(id); });
+}
+
+std::vector<std::string> keys(MDSKVS &kvs) {
+  std::vector<std::string> result;
+  auto listing = kvs.listObjects("bucket", "");
+  EXPECT_TRUE(listing.ok());
+  for (const auto &object : listing->first) {
+    result.push_back(object.id.key);
+  }
+  return result;
+}
+
+} // namespace
+
+TEST_F(MetadataLogTest, Reopen) {
+  {
+    auto [kvs, log] = open();
+    ASSERT_TRUE(createBucket(*kvs, *log, "bucket").ok());
+    ASSERT_TRUE(createBucket(*kvs, *log, "other").ok());
+    ASSERT_TRUE(createObject(*kvs, *log, makeObject("a", 1)).ok());
+    ASSERT_TRUE(createObject(*kvs, *log, makeObject("dir/b", 2)).ok());
+    ASSERT_TRUE(createObject(*kvs, *log, makeObject("dir/c", 3)).ok());
+    auto updated = makeObject("a", 10);
+    updated.info.metadata = "metadata";
+    ASSERT_TRUE(log->apply(MetadataLogRecord::forObject(MetadataLogRecord::Type::UpdateObject,
+                                                        updated),
+                           [&] { return kvs->updateObject(updated); })
+                    .ok());
+    ASSERT_TRUE(deleteObject(*kvs, *log, geds::ObjectID{"bucket", "dir/b"}).ok());
+    // Failed mutations are not logged.
+    ASSERT_EQ(deleteObject(*kvs, *log, geds::ObjectID{"bucket", "missing"}).code(),
+              absl::StatusCode::kNotFound);
+    ASSERT_TRUE(log->apply(MetadataLogRecord::forBucket(MetadataLogRecord::Type::DeleteBucket,
+                                                        "other"),
+                           [&] { return kvs->deleteBucket("other"); })
+                    .ok());
+
+    std::vector<MetadataLogRecord> records;
+    for (auto key : {"e/1", "e/2", "e/3"}) {
+      records.push_back(
+          MetadataLogRecord::forObject(MetadataLogRecord::Type::CreateObject, makeObject(key, 4)));
+    }
+    auto results =
+        log->applyBatch(records, [&](size_t i) { return kvs->createObject(records[i].object); });
+    ASSERT_EQ(results.size(), 3);
+    ASSERT_TRUE(log->apply(MetadataLogRecord::forID(MetadataLogRecord::Type::DeleteObjectPrefix,
+                                                    geds::ObjectID{"bucket", "e/2"}),
+                           [&] { return kvs->deleteObjectPrefix("bucket", "e/2"); })
+                    .ok());
+  }
+  auto [kvs, log] = open();
+  ASSERT_EQ(kvs->bucketStatus(std::string{"other"}).code(), absl::StatusCode::kNotFound);
+  ASSERT_EQ(keys(*kvs), (std::vector<std::string>{"a", "dir/c", "e/1", "e/3"}));
+  auto object = kvs->lookup("bucket", "a");
+  ASSERT_TRUE(object.ok());
+  ASSERT_EQ(object->info.size, 10);
+  ASSERT_EQ(object->info.metadata, "metadata");
+}
+
+TEST_F(MetadataLogTest, Snapshot) {
+  {
+    auto [kvs, log] = open();
+    ASSERT_TRUE(createBucket(*kvs, *log, "bucket").ok());
+    for (size_t i = 0; i < 5000; i++) {
+      ASSERT_TRUE(createObject(*kvs, *log, makeObject("key" + std::to_string(i), i)).ok());
+    }
+    ASSERT_TRUE(log->snapshot().ok());
+    for (size_t i = 0; i < 5000; i += 2) {
+      auto id = geds::ObjectID{"bucket", "key" + std::to_string(i)};
+      ASSERT_TRUE(deleteObject(*kvs, *log, id).ok());
+    }
+    ASSERT_TRUE(createObject(*kvs, *log, makeObject("after", 1)).ok());
+  }
+  size_t segments = 0;
+  for (const auto &entry : std::filesystem::directory_iterator{directory}) {
+    segments += entry.path().filename().string().starts_with("wal.");
+  }
+  ASSERT_EQ(segments, 1);
+
+  auto [kvs, log] = open();
+  ASSERT_EQ(keys(*kvs).size(), 2501);
+  ASSERT_TRUE(kvs->lookup("bucket", "key1").ok());
+  ASSERT_FALSE(kvs->lookup("bucket", "key2").ok());
+  ASSERT_TRUE(kvs->lookup("bucket", "after").ok());
+}
+
+TEST_F(MetadataLogTest, Versions) {
+  uint64_t snapshotted;
+  uint64_t logged;
+  {
+    auto [kvs, log] = open();
+    ASSERT_TRUE(createBucket(*kvs, *log, "bucket").ok());
+    auto object = makeObject("snapshotted", 1);
+    object.info.version = kvs->nextVersion();
+    snapshotted = object.info.version;
+    ASSERT_TRUE(createObject(*kvs, *log, object).ok());
+    ASSERT_TRUE(log->snapshot().ok());
+    object = makeObject("logged", 2);
+    object.info.version = kvs->nextVersion();
+    logged = object.info.version;
+    ASSERT_TRUE(createObject(*kvs, *log, object).ok());
+    ASSERT_GT(logged, snapshotted);
+  }
+  auto [kvs, log] = open();
+  ASSERT_EQ(kvs->lookup("bucket", "snapshotted")->info.version, snapshotted);
+  ASSERT_EQ(kvs->lookup("bucket", "logged")->info.version, logged);
+  ASSERT_GT(kvs->nextVersion(), logged);
+}
+
+TEST_F(MetadataLogTest, Rename) {
+  auto rename = [](MDSKVS &kvs, MetadataLog &log, MetadataLogRecord::Type type,
+                   const std::string &src, const std::string &dest) {
+    auto record = MetadataLogRecord::forID(type, geds::ObjectID{"bucket", src});
+    return log.apply(record, [&]() -> absl::Status {
+      if (type == MetadataLogRecord::Type::RenameObject) {
+        auto renamed = kvs.renameObject(record.object.id, geds::ObjectID{"bucket", dest});
+        if (!renamed.ok()) {
+          return renamed.status();
+        }
+        record.objects = {*renamed};
+        return absl::OkStatus();
+      }
+      auto renamed = kvs.renameObjectPrefix(record.object.id, geds::ObjectID{"bucket", dest});
+      if (!renamed.ok()) {
+        return renamed.status();
+      }
+      record.objects = *renamed;
+      return absl::OkStatus();
+    });
+  };
+  {
+    auto [kvs, log] = open();
+    ASSERT_TRUE(createBucket(*kvs, *log, "bucket").ok());
+    ASSERT_TRUE(createObject(*kvs, *log, makeObject("a", 1)).ok());
+    ASSERT_TRUE(createObject(*kvs, *log, makeObject("dir/b", 2)).ok());
+    ASSERT_TRUE(createObject(*kvs, *log, makeObject("dir/c", 3)).ok());
+    ASSERT_TRUE(log->snapshot().ok());
+    ASSERT_TRUE(rename(*kvs, *log, MetadataLogRecord::Type::RenameObject, "a", "z").ok());
+    ASSERT_TRUE(
+        rename(*kvs, *log, MetadataLogRecord::Type::RenameObjectPrefix, "dir/", "out/").ok());
+    // The source is recreated after the rename.
+    ASSERT_TRUE(createObject(*kvs, *log, makeObject("a", 4)).ok());
+  }
+  auto [kvs, log] = open();
+  ASSERT_EQ(keys(*kvs), (std::vector<std::string>{"a", "out/b", "out/c", "z"}));
+  ASSERT_EQ(kvs->lookup("bucket", "a")->info.size, 4);
+  ASSERT_EQ(kvs->lookup("bucket", "z")->info.size, 1);
+  ASSERT_EQ(kvs->lookup("bucket", "out/c")->info.size, 3);
+}
+
+TEST_F(MetadataLogTest, TornTail) {
+  {
+    auto [kvs, log] = open();
+    ASSERT_TRUE(createBucket(*kvs, *log, "bucket").ok());
+    ASSERT_TRUE(createObject(*kvs, *log, makeObject("a", 1)).ok());
+  }
+  {
+    // Simulate a crash in the middle of appending a record.
+    std::ofstream segment{directory + "/wal.0", std::ios::binary | std::ios::app};
+    segment << std::string("\x20\x00\x00\x00\x01\x02", 6);
+  }
+  {
+    auto [kvs, log] = open();
+    ASSERT_EQ(keys(*kvs), (std::vector<std::string>{"a"}));
+    ASSERT_TRUE(createObject(*kvs, *log, makeObject("b", 2)).ok());
+  }
+  auto [kvs, log] = open();
+  ASSERT_EQ(keys(*kvs), (std::vector<std::string>{"a", "b"}));
+}
+
+TEST_F(MetadataLogTest, ConcurrentApply) {
+  constexpr size_t numThreads = 8;
+  constexpr size_t perThread = 200;
+  {
+    auto [kvs, log] = open();
+    ASSERT_TRUE(createBucket(*kvs, *log, "bucket").ok());
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++) {
+      threads.emplace_back([&, t] {
+        for (size_t i = 0; i < perThread; i++) {
+          auto key = std::to_string(t) + "/" + std::to_string(i);
+          EXPECT_TRUE(createObject(*kvs, *log, makeObject(key, i)).ok());
+        }
+      });
+    }
+    threads.emplace_back([&] { EXPECT_TRUE(log->snapshot().ok()); });
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+  auto [kvs, log] = open();
+  ASSERT_EQ(keys(*kvs).size(), numThreads * perThread);
+}
@@ -0,0 +1,131 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <absl/status/status.h>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Object.h"
+#include "SubscriptionManager.h"
+
+namespace {
+
+geds::rpc::SubscriptionEvent subscription(const std::string &subscriber,
+                                          geds::rpc::SubscriptionType type,
+                                          const std::string &key) {
+  geds::rpc::SubscriptionEvent event;
+  event.set_subscriberid(subscriber);
+  event.set_bucketid("bucket");
+  event.set_key(key);
+  event.set_subscriptiontype(type);
+  return event;
+}
+
+geds::Object makeObject(const std::string &key) {
+  return geds::Object{geds::ObjectID{"bucket", key}, geds::ObjectInfo{"geds://", 1, 1, {}}};
+}
+
+std::vector<std::string> received(Subscriber &subscriber) {
+  std::vector<Subscriber::Event> events;
+  std::vector<std::string> keys;
+  if (subscriber.pop(events, std::chrono::milliseconds(0))) {
+    for (const auto &event : events) {
+      keys.push_back(event->object().id().key());
+    }
+  }
+  return keys;
+}
+
+} // namespace
+
+TEST(SubscriptionManager, Matching) {
+  SubscriptionManager manager;
+  ASSERT_TRUE(manager.subscribe(subscription("object", geds::rpc::OBJECT, "dir/a")).ok());
+  ASSERT_TRUE(manager.subscribe(subscription("prefix", geds::rpc::PREFIX, "dir/")).ok());
+  ASSERT_TRUE(manager.subscribe(subscription("prefix", geds::rpc::PREFIX, "dir/a")).ok());
+  ASSERT_TRUE(manager.subscribe(subscription("bucket", geds::rpc::BUCKET, "")).ok());
+  ASSERT_EQ(manager.subscribe(subscription("", geds::rpc::BUCKET, "")).code(),
+            absl::StatusCode::kInvalidArgument);
+  ASSERT_TRUE(manager.hasSubscriptions("bucket"));
+  ASSERT_FALSE(manager.hasSubscriptions("other"));
+
+  auto object = manager.connect("object");
+  auto prefix = manager.connect("prefix");
+  auto bucket = manager.connect("bucket");
+  for (const auto &key : {"dir/a", "dir/b", "other"}) {
+    manager.publish(geds::rpc::CREATE_OBJECT, makeObject(key));
+  }
+  manager.publish(geds::rpc::CREATE_OBJECT,
+                  geds::Object{geds::ObjectID{"other", "dir/a"}, geds::ObjectInfo{"", 0, 0, {}}});
+  ASSERT_EQ(received(*object), (std::vector<std::string>{"dir/a"}));
+  // Overlapping subscriptions deliver a publication once.
+  ASSERT_EQ(received(*prefix), (std::vector<std::string>{"dir/a", "dir/b"}));
+  ASSERT_EQ(received(*bucket), (std::vector<std::string>{"dir/a", "dir/b", "other"}));
+
+  ASSERT_TRUE(manager.unsubscribe(subscription("prefix", geds::rpc::PREFIX, "dir/")).ok());
+  ASSERT_EQ(manager.unsubscribe(subscription("prefix", geds::rpc::PREFIX, "dir/")).code(),
+            absl::StatusCode::kNotFound);
+  manager.publish(geds::rpc::DELETE_OBJECT, makeObject("dir/b"));
+  manager.publish(geds::rpc::DELETE_OBJECT, makeObject("dir/a"));
+  ASSERT_EQ(received(*prefix), (std::vector<std::string>{"dir/a"}));
+}
+
+TEST(SubscriptionManager, Reconnect) {
+  SubscriptionManager manager;
+  ASSERT_TRUE(manager.subscribe(subscription("s", geds::rpc::BUCKET, "")).ok());
+  auto first = manager.connect("s");
+  auto second = manager.connect("s");
+  std::vector<Subscriber::Event> events;
+  ASSERT_FALSE(first->pop(events, std::chrono::milliseconds(0)));
+  ASSERT_FALSE(first->overflowed());
+
+  // Subscriptions survive the stream.
+  manager.disconnect(second);
+  auto third = manager.connect("s");
+  manager.publish(geds::rpc::CREATE_OBJECT, makeObject("a"));
+  ASSERT_EQ(received(*third), (std::vector<std::string>{"a"}));
+}
+
+TEST(SubscriptionManager, SlowSubscriber) {
+  SubscriptionManager manager(4);
+  ASSERT_TRUE(manager.subscribe(subscription("slow", geds::rpc::BUCKET, "")).ok());
+  ASSERT_TRUE(manager.subscribe(subscription("fast", geds::rpc::BUCKET, "")).ok());
+  auto slow = manager.connect("slow");
+  auto fast = manager.connect("fast");
+  for (int i = 0; i < 8; i++) {
+    manager.publish(geds::rpc::CREATE_OBJECT, makeObject(std::to_string(i)));
+    if (i % 2 == 1) {
+      ASSERT_EQ(received(*fast).size(), 2);
+    }
+  }
+  std::vector<Subscriber::Event> events;
+  ASSERT_FALSE(slow->pop(events, std::chrono::milliseconds(0)));
+  ASSERT_TRUE(slow->overflowed());
+  ASSERT_FALSE(fast->overflowed());
+}
+
+TEST(SubscriptionManager, Expiry) {
+  SubscriptionManager manager(SubscriptionManager::DefaultQueueCapacity,
+                              std::chrono::milliseconds(50));
+  ASSERT_TRUE(manager.subscribe(subscription("gone", geds::rpc::OBJECT, "a")).ok());
+  ASSERT_TRUE(manager.subscribe(subscription("gone", geds::rpc::PREFIX, "dir/")).ok());
+  ASSERT_TRUE(manager.subscribe(subscription("active", geds::rpc::OBJECT, "b")).ok());
+  auto gone = manager.connect("gone");
+  auto active = manager.connect("active");
+  manager.disconnect(gone);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // Subscriptions of subscribers without a stream are dropped by the next subscription.
+  ASSERT_TRUE(manager.subscribe(subscription("active", geds::rpc::OBJECT, "c")).ok());
+  ASSERT_EQ(manager.unsubscribe(subscription("gone", geds::rpc::OBJECT, "a")).code(),
+            absl::StatusCode::kNotFound);
+  ASSERT_EQ(manager.unsubscribe(subscription("gone", geds::rpc::PREFIX, "dir/")).code(),
+            absl::StatusCode::kNotFound);
+  manager.publish(geds::rpc::CREATE_OBJECT, makeObject("b"));
+  ASSERT_EQ(received(*active), (std::vector<std::string>{"b"}));
+}
@@ -5,16 +5,28 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <string>
 
 namespace geds {
+/**
+ * @brief Maximum number of items per batch request of the metadata service. Bounds the message
+ * size.
+ */
+inline constexpr size_t MaxMetadataBatchSize = 1024;
+
 struct ObjectInfo {
   std::string location;
   uint64_t size;
   uint64_t sealedOffset;
   std::optional<std::string> metadata;
+  /**
+   * @brief Assigned by the metadata server on every create and update, 0 if unknown. Not part of
+   * the comparison: It names a state of the object rather than describing it.
+   */
+  uint64_t version = 0;
   bool operator==(const ObjectInfo &other) const {
     return location == other.location && size == other.size && sealedOffset == other.sealedOffset &&
            metadata == other.metadata;
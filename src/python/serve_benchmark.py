@@ -14,9 +14,11 @@ GEDS_TMP = os.environ.get("GEDS_TMP")
 BUCKET_NAME = os.environ.get("BUCKET_NAME", "benchmark")
 MAX_THREADS = int(os.environ.get("MAX_THREADS", "16"))
 MAX_SIZE = int(os.environ.get("MAX_SIZE", "18"))
+TRANSPORT = os.environ.get("GEDS_TRANSPORT", "asio")
 
 config = GEDSConfig(METADATA_SERVER)
 config.available_local_storage = 1000 * 1024 * 1024 * 1024
+config.transport = TRANSPORT
 TMP_FOLDER = os.environ.get("GEDS_TMP")
 if TMP_FOLDER is not None:
     config.local_storage_path = TMP_FOLDER
@@ -44,8 +44,25 @@ PYBIND11_MODULE(pygeds, m) {
       .def_readwrite("port", &GEDSConfig::port)
       .def_readwrite("port_http_server", &GEDSConfig::portHttpServer)
       .def_readwrite("local_storage_path", &GEDSConfig::localStoragePath)
+      .def_readwrite("transport", &GEDSConfig::transport)
+      .def_readwrite("local_transport", &GEDSConfig::localTransport)
       .def_readwrite("cache_block_size", &GEDSConfig::cacheBlockSize)
+      .def_readwrite("copy_buffer_memory", &GEDSConfig::copyBufferMemory)
+      .def_readwrite("open_file_cache_size", &GEDSConfig::openFileCacheSize)
+      .def_readwrite("read_stripe_size", &GEDSConfig::readStripeSize)
+      .def_readwrite("read_stripe_threshold", &GEDSConfig::readStripeThreshold)
+      .def_readwrite("read_ahead", &GEDSConfig::readAhead)
+      .def_readwrite("read_ahead_min_window", &GEDSConfig::readAheadMinWindow)
+      .def_readwrite("read_ahead_max_window", &GEDSConfig::readAheadMaxWindow)
+      .def_readwrite("read_ahead_memory", &GEDSConfig::readAheadMemory)
+      .def_readwrite("async_seal", &GEDSConfig::asyncSeal)
+      .def_readwrite("lookup_cache", &GEDSConfig::lookupCache)
+      .def_readwrite("lookup_cache_size", &GEDSConfig::lookupCacheSize)
+      .def_readwrite("lookup_cache_ttl", &GEDSConfig::lookupCacheTtl)
+      .def_readwrite("lookup_cache_negative_ttl", &GEDSConfig::lookupCacheNegativeTtl)
       .def_readwrite("cache_objects_from_s3", &GEDSConfig::cache_objects_from_s3)
+      .def_readwrite("cache_objects_from_geds", &GEDSConfig::cache_objects_from_geds)
+      .def_readwrite("geds_object_cache_size", &GEDSConfig::geds_object_cache_size)
       .def_readwrite("available_local_storage", &GEDSConfig::available_local_storage)
       .def_readwrite("available_local_memory", &GEDSConfig::available_local_memory)
       .def_readwrite("force_relocation_when_stopping", &GEDSConfig::force_relocation_when_stopping);
@@ -59,6 +76,7 @@ PYBIND11_MODULE(pygeds, m) {
       .def(py::init<GEDSConfig>())
       .def("start", &GEDS::start)
       .def("stop", &GEDS::stop)
+      .def("flush", &GEDS::flush, py::call_guard<py::gil_scoped_release>())
       .def(
           "create",
           [](GEDS &self, const std::string &bucket, const std::string &key, bool overwrite)
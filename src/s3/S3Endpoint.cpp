@@ -10,6 +10,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <exception>
+#include <functional>
 #include <istream>
 #include <iterator>
 #include <memory>
@@ -157,6 +158,45 @@ absl::Status Endpoint::list(const std::string &bucket, const std::string &prefix
   return absl::OkStatus();
 }
 
+absl::Status Endpoint::listPages(
+    const std::string &bucket, const std::string &prefix, char delimiter,
+    const std::function<absl::Status(std::vector<GEDSFileStatus> &&)> &onPage) const {
+  Aws::S3::Model::ListObjectsV2Request request;
+  request.WithBucket(bucket);
+  request.WithPrefix(prefix);
+  if (delimiter != 0) {
+    request.WithDelimiter(std::string{delimiter});
+  }
+  while (true) {
+    *totalRequestsSent += 1;
+    auto outcome = _s3Client->ListObjectsV2(request);
+    if (!outcome.IsSuccess()) {
+      auto &error = outcome.GetError();
+      return convertS3Error(error, "list", prefix);
+    }
+    const auto &s3result = outcome.GetResult();
+    std::vector<GEDSFileStatus> page;
+    page.reserve(s3result.GetContents().size() + s3result.GetCommonPrefixes().size());
+    for (const auto &obj : s3result.GetContents()) {
+      page.emplace_back(
+          GEDSFileStatus{.key = obj.GetKey(), .size = (size_t)obj.GetSize(), .isDirectory = false});
+    }
+    for (const auto &commonPrefix : s3result.GetCommonPrefixes()) {
+      page.emplace_back(
+          GEDSFileStatus{.key = commonPrefix.GetPrefix(), .size = 0, .isDirectory = true});
+    }
+    auto status = onPage(std::move(page));
+    if (!status.ok()) {
+      return status;
+    }
+    const auto &token = s3result.GetNextContinuationToken();
+    if (token.empty()) {
+      return absl::OkStatus();
+    }
+    request.WithContinuationToken(token);
+  }
+}
+
 absl::StatusOr<std::vector<GEDSFileStatus>>
 Endpoint::listAsFolder(const std::string &bucket, const std::string &prefix) const {
   return list(bucket, prefix, '/');
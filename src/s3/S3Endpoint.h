@@ -7,6 +7,7 @@
 #define GEDS_S3_ENDPOINT_H
 
 #include <aws/s3/S3Errors.h>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <optional>
@@ -62,6 +63,15 @@ public:
   absl::Status list(const std::string &bucket, const std::string &prefix, char delimiter,
                     std::set<GEDSFileStatus> &result,
                     std::optional<std::string> continuationToken = std::nullopt) const;
+  /**
+   * @brief List keys starting with prefix page by page. Every page is passed to `onPage` as soon
+   * as it arrives; common prefixes are passed as directories. Directory markers are not filtered.
+   * Listing stops with the status of `onPage` if it fails.
+   */
+  absl::Status
+  listPages(const std::string &bucket, const std::string &prefix, char delimiter,
+            const std::function<absl::Status(std::vector<GEDSFileStatus> &&)> &onPage) const;
+
   /**
    * @brief List keys starting with prefix. `/` will be used as delmiter and acts as folder
    * emulation. Keys ending with `/_$folder$` will be used as directory markers.
@@ -0,0 +1,130 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "Logging.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <pthread.h>
+#include <sstream>
+#include <vector>
+
+#include "FormatISO8601.h"
+
+namespace geds::logging {
+
+void LogRecord::format(std::ostream &out) const {
+  if (_timestamp) {
+    out << _time << " - ";
+  }
+  if (_format != nullptr) {
+    _format(_storage.data(), out);
+  }
+  out << '\n';
+}
+
+Logger::Logger(size_t capacity) : _buffer(capacity) {
+  _writer = std::thread([this] { run(); });
+  _writer.detach();
+  pthread_atfork(nullptr, nullptr, [] { Logger::instance().afterFork(); });
+}
+
+void Logger::afterFork() {
+  // Only the forking thread exists in the child: Nobody drains the ring buffer, and another thread
+  // may have held the mutex of synchronous lines. Queued lines belong to the parent's writer.
+  new (&_syncMutex) std::mutex;
+  _forked.store(true, std::memory_order_relaxed);
+}
+
+void Logger::write(std::ostream &dest, bool timestamp, std::string_view line) {
+  auto lock = std::lock_guard(_syncMutex);
+  if (timestamp) {
+    dest << std::chrono::system_clock::now() << " - ";
+  }
+  dest.write(line.data(), static_cast<std::streamsize>(line.size()));
+  dest.flush();
+}
+
+Logger &Logger::instance() {
+  // Never destroyed: Static destructors of other objects may still log while the process exits.
+  static Logger *logger = [] {
+    auto *result = new Logger(DefaultCapacity);
+    std::atexit([] { Logger::instance().flush(); });
+    return result;
+  }();
+  return *logger;
+}
+
+void Logger::run() {
+  static constexpr size_t BatchSize = 1024;
+  std::ostringstream line;
+  std::vector<std::ostream *> written;
+  uint64_t reportedDrops = 0;
+  while (true) {
+    size_t count = 0;
+    while (count < BatchSize && _buffer.tryPop([&](LogRecord &record) {
+      if (record.empty()) {
+        return;
+      }
+      line.str("");
+      record.format(line);
+      auto view = line.view();
+      {
+        // Synchronous lines are written to the same streams.
+        auto lock = std::lock_guard(_syncMutex);
+        record.dest().write(view.data(), static_cast<std::streamsize>(view.size()));
+      }
+      if (std::find(written.begin(), written.end(), &record.dest()) == written.end()) {
+        written.push_back(&record.dest());
+      }
+      record.clear();
+    })) {
+      count++;
+    }
+
+    {
+      auto lock = std::lock_guard(_syncMutex);
+      if (auto drops = dropped(); drops != reportedDrops) {
+        std::clog << std::chrono::system_clock::now() << " - WARN  Dropped "
+                  << drops - reportedDrops << " log lines.\n";
+        reportedDrops = drops;
+        written.push_back(&std::clog);
+      }
+      for (auto *stream : written) {
+        stream->flush();
+      }
+    }
+    written.clear();
+    _written.store(_buffer.popped(), std::memory_order_release);
+    _flushed.notify_all();
+    if (count == BatchSize) {
+      continue;
+    }
+
+    auto lock = std::unique_lock(_mutex);
+    _writerSleeping.store(true, std::memory_order_relaxed);
+    // Pairs with the fence in `notifyWriter`: Producers which missed the flag notify under
+    // `_mutex`, so their lines are seen by the predicate.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    _wakeup.wait(lock, [&]() { return _buffer.readable() || dropped() != reportedDrops; });
+    _writerSleeping.store(false, std::memory_order_relaxed);
+  }
+}
+
+void Logger::flush() {
+  if (_forked.load(std::memory_order_relaxed)) {
+    // Lines of a forked child are written synchronously.
+    return;
+  }
+  auto target = _buffer.pushed();
+  auto lock = std::unique_lock(_mutex);
+  while (_written.load(std::memory_order_acquire) < target) {
+    _wakeup.notify_one();
+    _flushed.wait_for(lock, std::chrono::milliseconds(1));
+  }
+}
+
+} // namespace geds::logging
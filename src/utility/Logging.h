@@ -4,17 +4,259 @@
  */
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <mutex>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "RingBuffer.h"
 
 namespace geds::logging {
 
-static std::mutex __mutex;
+enum class Level : int { Debug = 0, Info = 1, Warning = 2, Error = 3, Off = 4 };
+
+namespace detail {
+
+/**
+ * @brief Copy of a log argument that stays valid until the writer formats it. Character arrays
+ * of const chars are string literals (including `__func__`) and are kept as pointers; other
+ * strings are copied.
+ */
+template <typename T> auto capture(T &&value) {
+  using Value = std::remove_cvref_t<T>;
+  using Decayed = std::decay_t<T>;
+  if constexpr (std::is_array_v<Value>) {
+    using Element = std::remove_extent_t<std::remove_reference_t<T>>;
+    if constexpr (std::is_same_v<Element, const char>) {
+      return static_cast<const char *>(value);
+    } else {
+      return std::string(value);
+    }
+  } else if constexpr (std::is_same_v<Decayed, char *> || std::is_same_v<Decayed, const char *>) {
+    return value == nullptr ? std::string("(null)") : std::string(value);
+  } else if constexpr (std::is_constructible_v<std::string, const Value &>) {
+    // Copies string views of any flavour, e.g. absl::string_view returned by Status::message().
+    return std::string(value);
+  } else {
+    return Value(std::forward<T>(value));
+  }
+}
+
+} // namespace detail
+
+/**
+ * @brief A log line whose arguments are formatted by the writer thread.
+ *
+ * The captured arguments are stored inline if they fit, so logging does not allocate unless it
+ * copies long strings.
+ */
+class LogRecord {
+  static constexpr size_t InlineSize = 256;
+
+  std::ostream *_dest = nullptr;
+  bool _timestamp = false;
+  std::chrono::system_clock::time_point _time;
+  void (*_format)(const void *, std::ostream &) = nullptr;
+  void (*_destroy)(void *) = nullptr;
+  alignas(std::max_align_t) std::array<std::byte, InlineSize> _storage;
+
+  template <typename Tuple> static void formatTuple(const Tuple &args, std::ostream &out) {
+    std::apply([&](const auto &...arg) { (out << ... << arg); }, args);
+  }
+
+public:
+  LogRecord() = default;
+  LogRecord(const LogRecord &) = delete;
+  LogRecord &operator=(const LogRecord &) = delete;
+  ~LogRecord() { clear(); }
+
+  template <typename... Msg> void emplace(std::ostream &dest, bool timestamp, Msg &&...msg) {
+    using Tuple = std::tuple<decltype(detail::capture(std::forward<Msg>(msg)))...>;
+    _dest = &dest;
+    _timestamp = timestamp;
+    if (timestamp) {
+      _time = std::chrono::system_clock::now();
+    }
+    if constexpr (sizeof(Tuple) <= InlineSize && alignof(Tuple) <= alignof(std::max_align_t)) {
+      new (_storage.data()) Tuple(detail::capture(std::forward<Msg>(msg))...);
+      _format = [](const void *storage, std::ostream &out) {
+        formatTuple(*static_cast<const Tuple *>(storage), out);
+      };
+      _destroy = [](void *storage) { static_cast<Tuple *>(storage)->~Tuple(); };
+    } else {
+      new (_storage.data()) Tuple *(new Tuple(detail::capture(std::forward<Msg>(msg))...));
+      _format = [](const void *storage, std::ostream &out) {
+        formatTuple(**static_cast<Tuple *const *>(storage), out);
+      };
+      _destroy = [](void *storage) { delete *static_cast<Tuple **>(storage); };
+    }
+  }
+
+  std::ostream &dest() const { return *_dest; }
+
+  /**
+   * @brief Whether the record holds no line, e.g. because capturing the arguments threw.
+   */
+  bool empty() const { return _format == nullptr; }
+
+  /**
+   * @brief Format the line including its line break to `out`.
+   */
+  void format(std::ostream &out) const;
+
+  void clear() {
+    if (_destroy != nullptr) {
+      _destroy(_storage.data());
+    }
+    _format = nullptr;
+    _destroy = nullptr;
+  }
+};
+
+/**
+ * @brief Process-wide logger: Threads append log lines to a lock-free ring buffer and a background
+ * thread formats and writes them.
+ *
+ * When the ring buffer is full, lines are dropped and counted instead of blocking the caller. The
+ * writer reports the number of dropped lines. Warnings and errors are written synchronously by
+ * `logSync`, so they are neither dropped nor lost when the process aborts. The writer thread does
+ * not survive `fork`: A forked child writes all lines synchronously. Level and access-log sampling
+ * can be changed at any time.
+ */
+class Logger {
+  static constexpr size_t DefaultCapacity = 1 << 16;
+
+  std::atomic<int> _level{static_cast<int>(Level::Debug)};
+  std::atomic<uint32_t> _accessSampling{1};
+  std::atomic<uint64_t> _dropped{0};
+
+  utility::MPSCRingBuffer<LogRecord> _buffer;
+  std::atomic<size_t> _written{0};
+
+  std::mutex _mutex;
+  std::condition_variable _wakeup;
+  std::condition_variable _flushed;
+  std::atomic<bool> _writerSleeping{false};
+  std::thread _writer;
+
+  std::mutex _syncMutex;
+  std::atomic<bool> _forked{false};
+
+  Logger(size_t capacity);
+
+  void run();
+
+  /**
+   * @brief Called in the child after `fork`.
+   */
+  void afterFork();
+
+  void write(std::ostream &dest, bool timestamp, std::string_view line);
+
+  /**
+   * @brief Wake the writer if it waits for lines.
+   */
+  void notifyWriter() {
+    // Pairs with the fence in `run`: Either the writer sees the new line or we see it sleeping.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_writerSleeping.load(std::memory_order_relaxed)) {
+      auto lock = std::lock_guard(_mutex);
+      _wakeup.notify_one();
+    }
+  }
+
+public:
+  /**
+   * @brief The logger of the process. It lives until the process exits and is flushed on `exit`.
+   */
+  static Logger &instance();
+
+  Logger(const Logger &) = delete;
+  Logger &operator=(const Logger &) = delete;
+
+  void setLevel(Level level) { _level.store(static_cast<int>(level), std::memory_order_relaxed); }
+  Level level() const { return static_cast<Level>(_level.load(std::memory_order_relaxed)); }
+  bool enabled(Level level) const {
+    return static_cast<int>(level) >= _level.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Log one in `every` access-log lines. 0 disables the access log.
+   */
+  void setAccessSampling(uint32_t every) {
+    _accessSampling.store(every, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Decide whether the calling thread logs its next access.
+   */
+  bool sampleAccess() {
+    auto every = _accessSampling.load(std::memory_order_relaxed);
+    if (every <= 1) {
+      return every == 1;
+    }
+    thread_local uint32_t counter = 0;
+    return ++counter % every == 0;
+  }
+
+  /**
+   * @brief Number of lines dropped because the ring buffer was full.
+   */
+  uint64_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Wait until all lines logged before the call are written.
+   */
+  void flush();
+
+  /**
+   * @brief Format and write a line on the calling thread.
+   */
+  template <typename... Msg> void logSync(std::ostream &dest, bool timestamp, Msg &&...msg) {
+    std::ostringstream line;
+    (line << ... << msg);
+    line << '\n';
+    write(dest, timestamp, line.view());
+  }
+
+  template <typename... Msg> void log(std::ostream &dest, bool timestamp, Msg &&...msg) {
+    if (_forked.load(std::memory_order_relaxed)) {
+      logSync(dest, timestamp, std::forward<Msg>(msg)...);
+      return;
+    }
+    bool pushed = false;
+    try {
+      pushed = _buffer.tryPush(
+          [&](LogRecord &record) { record.emplace(dest, timestamp, std::forward<Msg>(msg)...); });
+    } catch (...) {
+      // The slot is published empty and skipped by the writer.
+    }
+    if (!pushed) {
+      _dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    notifyWriter();
+  }
+};
+
+template <typename T, typename... Msg> inline void LogLine(T &dest, Msg &&...msg) {
+  Logger::instance().log(dest, false, std::forward<Msg>(msg)...);
+}
 
-template <typename T, typename... Msg> inline void LogLine(T &dest, const Msg &...msg) {
-  auto lock = std::unique_lock<std::mutex>(__mutex);
-  (dest << ... << msg) << std::endl;
+template <typename T, typename... Msg> inline void LogLineSync(T &dest, Msg &&...msg) {
+  Logger::instance().logSync(dest, false, std::forward<Msg>(msg)...);
 }
 
 template <typename T, typename... Msg>
@@ -22,21 +264,31 @@ inline void NoLog(__attribute__((unused)) T &dest, __attribute__((unused)) const
   // Nolog.
 }
 
-template <typename T, typename... Msg> inline void LogTimestamp(T &dest, const Msg &...msg) {
-  auto lock = std::unique_lock<std::mutex>(__mutex);
-  dest << std::chrono::system_clock::now() << " - ";
-  (dest << ... << msg) << std::endl;
+template <typename T, typename... Msg> inline void LogTimestamp(T &dest, Msg &&...msg) {
+  Logger::instance().log(dest, true, std::forward<Msg>(msg)...);
 }
 } // namespace geds::logging
 
-#define LOG_LINE __func__, " (", __FILE__, ": ", __LINE__, "): "                          // NOLINT
-#define LOG_ERROR(...) geds::logging::LogLine(std::cerr, "ERROR ", LOG_LINE, __VA_ARGS__) // NOLINT
-#define LOG_INFO(...) geds::logging::LogLine(std::clog, "INFO ", LOG_LINE, __VA_ARGS__)   // NOLINT
+#define LOG_LINE __func__, " (", __FILE__, ": ", __LINE__, "): " // NOLINT
+#define LOG_LEVEL(level, dest, ...)                                                                \
+  do {                                                                                             \
+    if (geds::logging::Logger::instance().enabled(geds::logging::Level::level)) {                  \
+      geds::logging::LogLine(dest, __VA_ARGS__);                                                   \
+    }                                                                                              \
+  } while (0) // NOLINT
+#define LOG_LEVEL_SYNC(level, dest, ...)                                                           \
+  do {                                                                                             \
+    if (geds::logging::Logger::instance().enabled(geds::logging::Level::level)) {                  \
+      geds::logging::LogLineSync(dest, __VA_ARGS__);                                               \
+    }                                                                                              \
+  } while (0) // NOLINT
+#define LOG_ERROR(...) LOG_LEVEL_SYNC(Error, std::cerr, "ERROR ", LOG_LINE, __VA_ARGS__) // NOLINT
+#define LOG_INFO(...) LOG_LEVEL(Info, std::clog, "INFO ", LOG_LINE, __VA_ARGS__)        // NOLINT
 #define LOG_WARNING(...)                                                                           \
-  geds::logging::LogLine(std::clog, "WARN  ", LOG_LINE, __VA_ARGS__) // NOLINT
+  LOG_LEVEL_SYNC(Warning, std::clog, "WARN  ", LOG_LINE, __VA_ARGS__) // NOLINT
 
 #if defined(NDEBUG)
 #define LOG_DEBUG(...) geds::logging::NoLog(std::clog, "DEBUG ", LOG_LINE, __VA_ARGS__) // NOLINT
 #else
-#define LOG_DEBUG(...) geds::logging::LogLine(std::clog, "DEBUG ", LOG_LINE, __VA_ARGS__) // NOLINT
+#define LOG_DEBUG(...) LOG_LEVEL(Debug, std::clog, "DEBUG ", LOG_LINE, __VA_ARGS__) // NOLINT
 #endif
@@ -5,15 +5,29 @@
 
 #include "MDSKVS.h"
 
+#include <chrono>
+
 #define QUOTE(str) #str
 #define STRINGIFY(str) QUOTE(str)
 
-MDSKVS::MDSKVS() {
+MDSKVS::MDSKVS()
+    : _version(std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+                   .count()) {
 #if defined(HAVE_DEFAULT_BUCKET) && HAVE_DEFAULT_BUCKET
   (void)createBucket(STRINGIFY(DEFAULT_BUCKET_NAME));
 #endif
 }
 
+uint64_t MDSKVS::nextVersion() { return _version.fetch_add(1, std::memory_order_relaxed) + 1; }
+
+void MDSKVS::observeVersion(uint64_t version) {
+  auto current = _version.load(std::memory_order_relaxed);
+  while (version > current &&
+         !_version.compare_exchange_weak(current, version, std::memory_order_relaxed)) {
+  }
+}
+
 absl::StatusOr<std::shared_ptr<MDSKVSBucket>> MDSKVS::getBucket(const std::string &bucket) {
   auto lock = getReadLock();
   auto it = _map.find(bucket);
@@ -79,6 +93,7 @@ absl::Status MDSKVS::createObject(const geds::Object &obj, bool forceCreateBucke
       return bucket.status();
     }
   }
+  observeVersion(obj.info.version);
   return (*bucket)->createObject(obj);
 }
 
@@ -87,6 +102,7 @@ absl::Status MDSKVS::updateObject(const geds::Object &obj) {
   if (!bucket.ok()) {
     return bucket.status();
   }
+  observeVersion(obj.info.version);
   return bucket.value()->updateObject(obj);
 }
 
@@ -122,6 +138,34 @@ absl::Status MDSKVS::deleteObjectPrefix(const std::string &bucket, const std::st
   return (*b)->deleteObjectPrefix(prefix);
 }
 
+absl::StatusOr<geds::Object> MDSKVS::renameObject(const geds::ObjectID &src,
+                                                 const geds::ObjectID &dest) {
+  auto srcBucket = getBucket(src);
+  if (!srcBucket.ok()) {
+    return srcBucket.status();
+  }
+  auto destBucket = getBucket(dest);
+  if (!destBucket.ok()) {
+    return destBucket.status();
+  }
+  return MDSKVSBucket::renameObject(**srcBucket, src.key, **destBucket, dest.key);
+}
+
+absl::StatusOr<std::vector<geds::Object>>
+MDSKVS::renameObjectPrefix(const geds::ObjectID &src, const geds::ObjectID &dest,
+                           const std::vector<std::string> &expectedKeys) {
+  auto srcBucket = getBucket(src);
+  if (!srcBucket.ok()) {
+    return srcBucket.status();
+  }
+  auto destBucket = getBucket(dest);
+  if (!destBucket.ok()) {
+    return destBucket.status();
+  }
+  return MDSKVSBucket::renameObjectPrefix(**srcBucket, src.key, **destBucket, dest.key,
+                                          expectedKeys);
+}
+
 absl::StatusOr<geds::Object> MDSKVS::lookup(const geds::ObjectID &id) {
   auto bucket = getBucket(id);
   if (!bucket.ok()) {
@@ -155,3 +199,13 @@ MDSKVS::listObjects(const std::string &bucket, const std::string &prefix, char d
   }
   return (*b)->listObjects(prefix, delimiter);
 }
+
+absl::StatusOr<MDSKVSListPage> MDSKVS::listObjects(const std::string &bucket,
+                                                   const std::string &prefix, char delimiter,
+                                                   const MDSKVSListOptions &options) {
+  auto b = getBucket(bucket);
+  if (!b.ok()) {
+    return b.status();
+  }
+  return (*b)->listObjects(prefix, delimiter, options);
+}
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -21,10 +23,20 @@
 class MDSKVS : public utility::RWConcurrentObjectAdaptor {
 private:
   std::map<std::string, std::shared_ptr<MDSKVSBucket>> _map;
+  std::atomic<uint64_t> _version;
+
+  void observeVersion(uint64_t version);
 
 public:
   MDSKVS();
 
+  /**
+   * @brief Return a new object version, greater than the version of every object created or
+   * updated so far. Versions start at the current time in microseconds, so they keep increasing
+   * across restarts of servers that do not persist the metadata.
+   */
+  uint64_t nextVersion();
+
   ~MDSKVS() = default;
 
   /**
@@ -72,6 +84,22 @@ public:
   absl::Status deleteObjectPrefix(const geds::ObjectID &id);
   absl::Status deleteObjectPrefix(const std::string &bucket, const std::string &prefix);
 
+  /**
+   * @brief Atomically move object `src` to `dest`, replacing an existing object. The object keeps
+   * its version. Returns the object under its new ID.
+   */
+  absl::StatusOr<geds::Object> renameObject(const geds::ObjectID &src, const geds::ObjectID &dest);
+
+  /**
+   * @brief Atomically move all objects in `src.bucket` starting with `src.key` to `dest.bucket`,
+   * replacing the prefix `src.key` with `dest.key`. Returns the moved objects under their new IDs.
+   * Fails without moving anything if `expectedKeys` is not empty and differs from the keys of the
+   * objects starting with `src.key`.
+   */
+  absl::StatusOr<std::vector<geds::Object>>
+  renameObjectPrefix(const geds::ObjectID &src, const geds::ObjectID &dest,
+                     const std::vector<std::string> &expectedKeys = {});
+
   /**
    * @brief Lookup exact object.
    */
@@ -91,4 +119,10 @@ public:
 
   absl::StatusOr<std::pair<std::vector<geds::Object>, std::vector<std::string>>>
   listObjects(const std::string &bucket, const std::string &prefix, char delimiter = 0);
+
+  /**
+   * @brief List a page of objects and common prefixes, see `MDSKVSListOptions`.
+   */
+  absl::StatusOr<MDSKVSListPage> listObjects(const std::string &bucket, const std::string &prefix,
+                                             char delimiter, const MDSKVSListOptions &options);
 };
@@ -7,8 +7,13 @@
 
 #include <absl/status/status.h>
 #include <absl/status/statusor.h>
+#include <algorithm>
+#include <functional>
+#include <limits>
 #include <memory>
-#include <set>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <utility>
 #include <vector>
 
@@ -18,25 +23,67 @@
 
 MDSKVSBucket::MDSKVSBucket(const std::string &name) : _name(name) {}
 
+MDSKVSBucket::Shard &MDSKVSBucket::shard(const std::string &key) {
+  return _shards[std::hash<std::string>{}(key) % _shards.size()];
+}
+
+std::vector<std::unique_lock<std::shared_mutex>>
+MDSKVSBucket::lockShards(std::vector<Shard *> shards) {
+  std::sort(shards.begin(), shards.end(), std::less<>{});
+  shards.erase(std::unique(shards.begin(), shards.end()), shards.end());
+  std::vector<std::unique_lock<std::shared_mutex>> locks;
+  locks.reserve(shards.size());
+  for (auto *s : shards) {
+    locks.push_back(s->getWriteLock());
+  }
+  return locks;
+}
+
 absl::StatusOr<std::shared_ptr<MDSKVSBucket::Container>>
 MDSKVSBucket::getObject(const std::string &key) {
-  auto lock = getReadLock();
-  auto it = _map.find(utility::Path{key});
-  if (it == _map.end()) {
+  auto &s = shard(key);
+  auto lock = s.getReadLock();
+  auto container = s.tree.find(key);
+  if (container == nullptr) {
     return absl::NotFoundError("Key " + key + " does not exist.");
   }
-  return it->second;
+  return *container;
 }
 
 absl::Status MDSKVSBucket::createObject(const geds::Object &obj) {
-  auto lock = getWriteLock();
-  if (_map.find(utility::Path{obj.id.key}) != _map.end()) {
+  auto container = std::make_shared<MDSKVSBucket::Container>(obj.info);
+  auto &s = shard(obj.id.key);
+  auto lock = s.getWriteLock();
+  auto inserted = s.tree.insertOrAssign(obj.id.key, std::move(container));
+  if (!inserted) {
     LOG_DEBUG("Overwriting ", obj.id.key, " since it already exists!");
   }
-  _map[utility::Path{obj.id.key}] = std::make_shared<MDSKVSBucket::Container>(obj.info);
   return absl::OkStatus();
 }
 
+size_t MDSKVSBucket::createObjectsIfAbsent(const std::vector<geds::Object> &objects) {
+  std::array<std::vector<const geds::Object *>, std::tuple_size_v<decltype(_shards)>> perShard;
+  for (const auto &obj : objects) {
+    perShard[&shard(obj.id.key) - _shards.data()].push_back(&obj);
+  }
+  size_t count = 0;
+  for (size_t i = 0; i < _shards.size(); i++) {
+    if (perShard[i].empty()) {
+      continue;
+    }
+    auto &s = _shards[i];
+    auto lock = s.getWriteLock();
+    for (const auto *obj : perShard[i]) {
+      if (s.tree.find(obj->id.key) != nullptr) {
+        continue;
+      }
+      s.tree.insertOrAssign(obj->id.key, std::make_shared<MDSKVSBucket::Container>(obj->info));
+      count++;
+    }
+  }
+  return count;
+}
+
 absl::Status MDSKVSBucket::updateObject(const geds::Object &obj) {
   auto data = getObject(obj.id.key);
   if (!data.ok()) {
@@ -49,26 +96,98 @@ absl::Status MDSKVSBucket::updateObject(const geds::Object &obj) {
 }
 
 absl::Status MDSKVSBucket::deleteObject(const std::string &key) {
-  auto lock = getWriteLock();
-  auto it = _map.find(utility::Path{key});
-  if (it == _map.end()) {
+  auto &s = shard(key);
+  auto lock = s.getWriteLock();
+  if (!s.tree.erase(key)) {
     return absl::NotFoundError("Key " + key + " does not exist.");
   }
-  _map.erase(it);
   return absl::OkStatus();
 }
 
 absl::Status MDSKVSBucket::deleteObjectPrefix(const std::string &prefix) {
-  auto lock = getWriteLock();
-  auto [prefixStart, prefixEnd] = utility::prefixSearch(_map, prefix);
-  if (prefixStart == _map.end()) {
+  std::vector<std::unique_lock<std::shared_mutex>> locks;
+  locks.reserve(_shards.size());
+  for (auto &s : _shards) {
+    locks.push_back(s.getWriteLock());
+  }
+  size_t count = 0;
+  for (auto &s : _shards) {
+    count += s.tree.erasePrefix(prefix);
+  }
+  if (count == 0) {
     return absl::NotFoundError("No objects starting with " + prefix + " found.");
   }
-  _map.erase(prefixStart, prefixEnd);
-
   return absl::OkStatus();
 }
 
+absl::StatusOr<geds::Object> MDSKVSBucket::renameObject(MDSKVSBucket &src,
+                                                       const std::string &srcKey,
+                                                       MDSKVSBucket &dest,
+                                                       const std::string &destKey) {
+  auto &srcShard = src.shard(srcKey);
+  auto &destShard = dest.shard(destKey);
+  auto locks = lockShards({&srcShard, &destShard});
+  auto found = srcShard.tree.find(srcKey);
+  if (found == nullptr) {
+    return absl::NotFoundError("Key " + srcKey + " does not exist.");
+  }
+  auto container = *found;
+  if (&src != &dest || srcKey != destKey) {
+    srcShard.tree.erase(srcKey);
+    destShard.tree.insertOrAssign(destKey, container);
+  }
+  auto lock = container->getReadLock();
+  return geds::Object{geds::ObjectID{dest._name, destKey}, container->obj};
+}
+
+absl::StatusOr<std::vector<geds::Object>>
+MDSKVSBucket::renameObjectPrefix(MDSKVSBucket &src, const std::string &srcPrefix,
+                                 MDSKVSBucket &dest, const std::string &destPrefix,
+                                 const std::vector<std::string> &expectedKeys) {
+  std::vector<Shard *> shards;
+  shards.reserve(src._shards.size() + dest._shards.size());
+  for (auto *bucket : {&src, &dest}) {
+    for (auto &s : bucket->_shards) {
+      shards.push_back(&s);
+    }
+  }
+  auto locks = lockShards(std::move(shards));
+
+  // Collect first: The destination prefix may start with the source prefix.
+  std::vector<std::pair<std::string, std::shared_ptr<Container>>> moved;
+  std::vector<std::string> srcKeys;
+  for (auto &s : src._shards) {
+    s.tree.forEach(srcPrefix,
+                   [&](const std::string &key, const std::shared_ptr<Container> &container) {
+                     moved.emplace_back(destPrefix + key.substr(srcPrefix.size()), container);
+                     srcKeys.push_back(key);
+                   });
+  }
+  if (moved.empty()) {
+    return absl::NotFoundError("No objects starting with " + srcPrefix + " found.");
+  }
+  if (!expectedKeys.empty()) {
+    auto expected = expectedKeys;
+    std::sort(expected.begin(), expected.end());
+    std::sort(srcKeys.begin(), srcKeys.end());
+    if (expected != srcKeys) {
+      return absl::FailedPreconditionError("The objects starting with " + srcPrefix +
+                                           " do not match the expected keys.");
+    }
+  }
+  for (auto &s : src._shards) {
+    s.tree.erasePrefix(srcPrefix);
+  }
+  std::vector<geds::Object> result;
+  result.reserve(moved.size());
+  for (auto &[key, container] : moved) {
+    dest.shard(key).tree.insertOrAssign(key, container);
+    auto lock = container->getReadLock();
+    result.push_back(geds::Object{geds::ObjectID{dest._name, key}, container->obj});
+  }
+  return result;
+}
+
 absl::StatusOr<geds::Object> MDSKVSBucket::lookup(const std::string &key) {
   auto data = getObject(key);
   if (!data.ok()) {
@@ -81,36 +200,92 @@ absl::StatusOr<geds::Object> MDSKVSBucket::lookup(const std::string &key) {
 
 absl::StatusOr<std::pair<std::vector<geds::Object>, std::vector<std::string>>>
 MDSKVSBucket::listObjects(const std::string &keyPrefix, char delimiter) {
-  auto lock = getReadLock();
   auto result = std::vector<geds::Object>();
-  const auto prefixLength = keyPrefix.length();
-
-  std::set<std::string> commonPrefixes;
-  auto [prefixStart, prefixEnd] = utility::prefixSearch(_map, keyPrefix);
-  for (auto it = prefixStart; it != prefixEnd; it++) {
-    if (delimiter != 0) {
-      const auto &path = it->first.name;
-      auto loc = path.find(delimiter, prefixLength);
-      if (loc != std::string::npos) {
-        // Also include delimitor in string. This makes it compatible with AWS:
-        // https://docs.aws.amazon.com/AmazonS3/latest/API/API_CommonPrefix.html
-        commonPrefixes.insert(path.substr(0, loc + 1));
-        continue;
-      }
+  // Common prefixes include the delimiter. This makes it compatible with AWS:
+  // https://docs.aws.amazon.com/AmazonS3/latest/API/API_CommonPrefix.html
+  std::vector<std::string> commonPrefixes;
+  {
+    // Hold all shards to list a consistent state.
+    std::vector<std::shared_lock<std::shared_mutex>> locks;
+    locks.reserve(_shards.size());
+    for (const auto &s : _shards) {
+      locks.push_back(s.getReadLock());
+    }
+    for (const auto &s : _shards) {
+      s.tree.forEachDelimited(
+          keyPrefix, delimiter,
+          [&](const std::string &key, const std::shared_ptr<Container> &container) {
+            result.push_back(geds::Object{geds::ObjectID{_name, key}, container->obj});
+          },
+          [&](const std::string &commonPrefix) { commonPrefixes.push_back(commonPrefix); });
+    }
+  }
+  std::sort(result.begin(), result.end(),
+            [](const geds::Object &a, const geds::Object &b) { return a.id.key < b.id.key; });
+  // A common prefix may span multiple shards.
+  std::sort(commonPrefixes.begin(), commonPrefixes.end());
+  commonPrefixes.erase(std::unique(commonPrefixes.begin(), commonPrefixes.end()),
+                       commonPrefixes.end());
+  return std::make_pair(std::move(result), std::move(commonPrefixes));
+}
+
+absl::StatusOr<MDSKVSListPage> MDSKVSBucket::listObjects(const std::string &keyPrefix,
+                                                         char delimiter,
+                                                         const MDSKVSListOptions &options) {
+  // Common prefixes are merged with the objects without value.
+  std::vector<std::pair<std::string, std::optional<geds::ObjectInfo>>> entries;
+  // One entry more than requested tells whether the listing continues.
+  auto limit = options.maxResults == 0 ? std::numeric_limits<size_t>::max()
+                                       : options.maxResults + 1;
+  for (const auto &s : _shards) {
+    auto lock = s.getReadLock();
+    size_t count = 0;
+    s.tree.forEachDelimitedAfter(
+        keyPrefix, delimiter, options.startAfter,
+        [&](const std::string &key, const std::shared_ptr<Container> *container) {
+          if (container == nullptr) {
+            entries.emplace_back(key, std::nullopt);
+          } else {
+            auto objectLock = (*container)->getReadLock();
+            const auto &obj = (*container)->obj;
+            if (options.omitMetadata) {
+              entries.emplace_back(
+                  key, geds::ObjectInfo{obj.location, obj.size, obj.sealedOffset, std::nullopt});
+            } else {
+              entries.emplace_back(key, obj);
+            }
+          }
+          return ++count < limit;
+        });
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const auto &a, const auto &b) { return a.first < b.first; });
+  // A common prefix may span multiple shards.
+  entries.erase(std::unique(entries.begin(), entries.end(),
+                            [](const auto &a, const auto &b) { return a.first == b.first; }),
+                entries.end());
+
+  MDSKVSListPage page;
+  if (entries.size() >= limit) {
+    entries.resize(options.maxResults);
+    page.continuationToken = entries.back().first;
+  }
+  for (auto &[key, info] : entries) {
+    if (info.has_value()) {
+      page.objects.push_back(geds::Object{geds::ObjectID{_name, std::move(key)}, std::move(*info)});
+    } else {
+      page.commonPrefixes.push_back(std::move(key));
     }
-    auto container = it->second;
-    result.push_back(geds::Object{geds::ObjectID{_name, it->first.name}, container->obj});
   }
-  return std::make_pair(std::move(result),
-                        std::vector<std::string>{commonPrefixes.begin(), commonPrefixes.end()});
+  return page;
 }
 
 void MDSKVSBucket::forall(
     std::function<void(const utility::Path &, const geds::ObjectInfo &)> action) const {
-  auto lock = getReadLock();
-  for (const auto &v : _map) {
-    const auto &key = v.first;
-    const auto &value = v.second;
-    action(key, value->obj);
+  for (const auto &s : _shards) {
+    auto lock = s.getReadLock();
+    s.tree.forEach("", [&](const std::string &key, const std::shared_ptr<Container> &value) {
+      action(utility::Path{key}, value->obj);
+    });
   }
 }
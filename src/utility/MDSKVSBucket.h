@@ -5,8 +5,9 @@
 
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <functional>
-#include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -21,8 +22,36 @@
 #include "Object.h"
 #include "Path.h"
 #include "RWConcurrentObjectAdaptor.h"
+#include "RadixTree.h"
 
-class MDSKVSBucket : public utility::RWConcurrentObjectAdaptor {
+/**
+ * @brief Options of a paginated listing.
+ */
+struct MDSKVSListOptions {
+  /**
+   * @brief Only list objects and common prefixes greater than `startAfter`.
+   */
+  std::string startAfter;
+  /**
+   * @brief Maximum number of objects and common prefixes. `0` lists all.
+   */
+  size_t maxResults = 0;
+  /**
+   * @brief Omit `ObjectInfo::metadata` from the results.
+   */
+  bool omitMetadata = false;
+};
+
+struct MDSKVSListPage {
+  std::vector<geds::Object> objects;
+  std::vector<std::string> commonPrefixes;
+  /**
+   * @brief Set to the last listed entry if more entries follow.
+   */
+  std::optional<std::string> continuationToken;
+};
+
+class MDSKVSBucket {
   class Container : public utility::RWConcurrentObjectAdaptor {
   public:
     geds::ObjectInfo obj;
@@ -32,7 +61,28 @@ class MDSKVSBucket : public utility::RWConcurrentObjectAdaptor {
     Container(const MDSKVSBucket &) = delete;
   };
 
-  std::map<utility::Path, std::shared_ptr<Container>, std::less<>> _map;
+  /**
+   * @brief Objects indexed by key. Delimited listings only visit the direct children of the
+   * prefix.
+   */
+  struct Shard : public utility::RWConcurrentObjectAdaptor {
+    utility::RadixTree<std::shared_ptr<Container>> tree;
+  };
+
+  /**
+   * @brief Keys are distributed over the shards by hash: Point operations on different shards do
+   * not contend. Prefix operations lock all shards in order.
+   */
+  std::array<Shard, 64> _shards;
+
+  Shard &shard(const std::string &key);
+
+  /**
+   * @brief Lock `shards` for writing in address order, so concurrent renames between the same
+   * buckets do not deadlock.
+   */
+  static std::vector<std::unique_lock<std::shared_mutex>> lockShards(std::vector<Shard *> shards);
+
   absl::StatusOr<std::shared_ptr<Container>> getObject(const std::string &key);
 
   std::string _name;
@@ -44,14 +94,53 @@ public:
 
   absl::Status createObject(const geds::Object &obj);
 
+  /**
+   * @brief Insert the objects whose keys do not exist yet. The lock of each shard is taken once
+   * for all of its objects. Returns the number of inserted objects.
+   */
+  size_t createObjectsIfAbsent(const std::vector<geds::Object> &objects);
+
   absl::Status updateObject(const geds::Object &obj);
 
   absl::Status deleteObject(const std::string &key);
   absl::Status deleteObjectPrefix(const std::string &prefix);
 
+  /**
+   * @brief Move object `srcKey` of `src` to `destKey` of `dest` and replace an existing object
+   * there. The shards of both keys are locked together, so readers never observe the object under
+   * both keys or under neither. Returns the object under its new ID.
+   */
+  static absl::StatusOr<geds::Object> renameObject(MDSKVSBucket &src, const std::string &srcKey,
+                                                   MDSKVSBucket &dest,
+                                                   const std::string &destKey);
+
+  /**
+   * @brief Move all objects of `src` starting with `srcPrefix` to `dest`, replacing `srcPrefix`
+   * with `destPrefix`. Locks all shards of both buckets. Returns the moved objects under their new
+   * IDs.
+   *
+   * If `expectedKeys` is not empty, nothing is moved and FAILED_PRECONDITION is returned unless the
+   * keys starting with `srcPrefix` are exactly `expectedKeys`.
+   */
+  static absl::StatusOr<std::vector<geds::Object>>
+  renameObjectPrefix(MDSKVSBucket &src, const std::string &srcPrefix, MDSKVSBucket &dest,
+                     const std::string &destPrefix,
+                     const std::vector<std::string> &expectedKeys = {});
+
   absl::StatusOr<geds::Object> lookup(const std::string &key);
   absl::StatusOr<std::pair<std::vector<geds::Object>, std::vector<std::string>>>
   listObjects(const std::string &keyPrefix, char delimiter = 0);
 
+  /**
+   * @brief List a page of objects and common prefixes in key order. Shards are locked one at a
+   * time, so a page does not block writers for the whole listing.
+   */
+  absl::StatusOr<MDSKVSListPage> listObjects(const std::string &keyPrefix, char delimiter,
+                                             const MDSKVSListOptions &options);
+
+  /**
+   * @brief Visit all objects. Keys are ordered within each shard only. Only the visited shard is
+   * locked, so concurrent mutations of other shards may or may not be observed.
+   */
   void forall(std::function<void(const utility::Path &, const geds::ObjectInfo &)> action) const;
 };
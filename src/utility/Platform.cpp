@@ -9,6 +9,11 @@
 #include <stdexcept>
 #include <unistd.h>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #ifndef HOST_NAME_MAX
 #define HOST_NAME_MAX 64
 #endif
@@ -25,5 +30,18 @@ std::string getHostName() {
   return std::string(hostname);
 }
 
+bool pinThread(std::thread &thread, size_t core) {
+#ifdef __linux__
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(core, &cpuset);
+  return pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuset) == 0;
+#else
+  (void)thread;
+  (void)core;
+  return false;
+#endif
+}
+
 } // namespace platform
 } // namespace utility
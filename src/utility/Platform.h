@@ -11,7 +11,9 @@
 #include <utility>
 #endif
 
+#include <cstddef>
 #include <string>
+#include <thread>
 
 namespace utility::platform {
 
@@ -33,5 +35,10 @@ namespace utility::platform {
 
 std::string getHostName();
 
+/**
+ * @brief Restrict `thread` to run on `core`. Returns false if the platform does not support it.
+ */
+bool pinThread(std::thread &thread, size_t core);
+
 } // namespace utility::platform
 #endif // GEDS_GEDSPLATFORM_H
@@ -0,0 +1,382 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace utility {
+
+/**
+ * @brief Compressed radix tree mapping string keys to values.
+ *
+ * Every node stores the edge label leading to it and its children sorted by the first byte of
+ * their label, so keys are visited in the order of `std::string::compare`. Listings with a
+ * delimiter stop at the first delimiter below the prefix and only touch the nodes leading to the
+ * direct children of the prefix.
+ *
+ * The tree is not synchronized.
+ */
+template <typename V> class RadixTree {
+  struct Node {
+    std::string label;
+    std::optional<V> value;
+    std::vector<std::unique_ptr<Node>> children;
+  };
+  using Children = std::vector<std::unique_ptr<Node>>;
+
+  Node _root;
+  size_t _size = 0;
+
+  static unsigned char firstByte(const Node &node) {
+    return static_cast<unsigned char>(node.label.front());
+  }
+
+  static typename Children::iterator findChild(Children &children, char c) {
+    auto byte = static_cast<unsigned char>(c);
+    return std::lower_bound(
+        children.begin(), children.end(), byte,
+        [](const auto &child, unsigned char b) { return firstByte(*child) < b; });
+  }
+
+  static typename Children::const_iterator findChild(const Children &children, char c) {
+    auto byte = static_cast<unsigned char>(c);
+    return std::lower_bound(
+        children.begin(), children.end(), byte,
+        [](const auto &child, unsigned char b) { return firstByte(*child) < b; });
+  }
+
+  static bool matchesChild(const Children &children, typename Children::const_iterator it,
+                           char c) {
+    return it != children.end() && firstByte(**it) == static_cast<unsigned char>(c);
+  }
+
+  static size_t countValues(const Node &node) {
+    size_t count = node.value.has_value() ? 1 : 0;
+    for (const auto &child : node.children) {
+      count += countValues(*child);
+    }
+    return count;
+  }
+
+  /**
+   * @brief Remove a child without value with at most one child by merging it into its parent.
+   */
+  static void compact(Children &children, typename Children::iterator it) {
+    auto &child = **it;
+    if (child.value.has_value()) {
+      return;
+    }
+    if (child.children.empty()) {
+      children.erase(it);
+    } else if (child.children.size() == 1) {
+      auto grandChild = std::move(child.children.front());
+      grandChild->label.insert(0, child.label);
+      *it = std::move(grandChild);
+    }
+  }
+
+  bool erase(Node &node, std::string_view key) {
+    if (key.empty()) {
+      if (!node.value.has_value()) {
+        return false;
+      }
+      node.value.reset();
+      _size--;
+      return true;
+    }
+    auto it = findChild(node.children, key.front());
+    if (!matchesChild(node.children, it, key.front()) || !key.starts_with((*it)->label)) {
+      return false;
+    }
+    if (!erase(**it, key.substr((*it)->label.size()))) {
+      return false;
+    }
+    compact(node.children, it);
+    return true;
+  }
+
+  size_t erasePrefix(Node &node, std::string_view prefix) {
+    auto it = findChild(node.children, prefix.front());
+    if (!matchesChild(node.children, it, prefix.front())) {
+      return 0;
+    }
+    const auto &label = (*it)->label;
+    if (label.size() >= prefix.size()) {
+      if (!std::string_view{label}.starts_with(prefix)) {
+        return 0;
+      }
+      auto count = countValues(**it);
+      node.children.erase(it);
+      _size -= count;
+      return count;
+    }
+    if (!prefix.starts_with(label)) {
+      return 0;
+    }
+    auto count = erasePrefix(**it, prefix.substr(label.size()));
+    if (count > 0) {
+      compact(node.children, it);
+    }
+    return count;
+  }
+
+  /**
+   * @brief Find the node covering `prefix`. `path` is set to the key of the returned node, which
+   * starts with `prefix`.
+   */
+  const Node *findPrefix(const std::string &prefix, std::string &path) const {
+    const Node *node = &_root;
+    path.clear();
+    while (path.size() < prefix.size()) {
+      auto c = prefix[path.size()];
+      auto it = findChild(node->children, c);
+      if (!matchesChild(node->children, it, c)) {
+        return nullptr;
+      }
+      const auto &label = (*it)->label;
+      auto length = std::min(label.size(), prefix.size() - path.size());
+      if (prefix.compare(path.size(), length, label, 0, length) != 0) {
+        return nullptr;
+      }
+      path += label;
+      node = it->get();
+    }
+    return node;
+  }
+
+  static void visit(const Node &node, std::string &path,
+                    const std::function<void(const std::string &, const V &)> &action) {
+    if (node.value.has_value()) {
+      action(path, *node.value);
+    }
+    for (const auto &child : node.children) {
+      path += child->label;
+      visit(*child, path, action);
+      path.resize(path.size() - child->label.size());
+    }
+  }
+
+  static void visitDelimited(const Node &node, std::string &path, size_t from, char delimiter,
+                             const std::function<void(const std::string &, const V &)> &onValue,
+                             const std::function<void(const std::string &)> &onCommonPrefix) {
+    auto loc = path.find(delimiter, from);
+    if (loc != std::string::npos) {
+      // All keys below share the prefix up to and including the delimiter.
+      onCommonPrefix(path.substr(0, loc + 1));
+      return;
+    }
+    if (node.value.has_value()) {
+      onValue(path, *node.value);
+    }
+    for (const auto &child : node.children) {
+      auto size = path.size();
+      path += child->label;
+      visitDelimited(*child, path, size, delimiter, onValue, onCommonPrefix);
+      path.resize(size);
+    }
+  }
+
+  static bool visitAfter(const Node &node, std::string &path, size_t from, char delimiter,
+                         const std::string &startAfter,
+                         const std::function<bool(const std::string &, const V *)> &onEntry) {
+    if (path < startAfter && !startAfter.starts_with(path)) {
+      // All keys below sort before `startAfter`.
+      return true;
+    }
+    if (delimiter != 0) {
+      auto loc = path.find(delimiter, from);
+      if (loc != std::string::npos) {
+        auto commonPrefix = path.substr(0, loc + 1);
+        return commonPrefix <= startAfter || onEntry(commonPrefix, nullptr);
+      }
+    }
+    if (node.value.has_value() && path > startAfter && !onEntry(path, &*node.value)) {
+      return false;
+    }
+    for (const auto &child : node.children) {
+      auto size = path.size();
+      path += child->label;
+      if (!visitAfter(*child, path, size, delimiter, startAfter, onEntry)) {
+        return false;
+      }
+      path.resize(size);
+    }
+    return true;
+  }
+
+public:
+  size_t size() const { return _size; }
+
+  /**
+   * @brief Insert or replace the value of `key`. Returns true if the key was inserted.
+   */
+  bool insertOrAssign(const std::string &key, V value) {
+    Node *node = &_root;
+    size_t pos = 0;
+    while (true) {
+      if (pos == key.size()) {
+        auto inserted = !node->value.has_value();
+        node->value = std::move(value);
+        if (inserted) {
+          _size++;
+        }
+        return inserted;
+      }
+      auto it = findChild(node->children, key[pos]);
+      if (!matchesChild(node->children, it, key[pos])) {
+        auto leaf = std::make_unique<Node>();
+        leaf->label = key.substr(pos);
+        leaf->value = std::move(value);
+        node->children.insert(it, std::move(leaf));
+        _size++;
+        return true;
+      }
+      auto &label = (*it)->label;
+      auto [labelEnd, keyEnd] = std::mismatch(label.begin(), label.end(), key.begin() + pos,
+                                              key.end());
+      auto common = static_cast<size_t>(labelEnd - label.begin());
+      if (common < label.size()) {
+        // Split the edge at the first differing byte.
+        auto split = std::make_unique<Node>();
+        split->label = label.substr(0, common);
+        auto child = std::move(*it);
+        child->label.erase(0, common);
+        split->children.push_back(std::move(child));
+        *it = std::move(split);
+      }
+      node = it->get();
+      pos += common;
+    }
+  }
+
+  V *find(const std::string &key) {
+    return const_cast<V *>(static_cast<const RadixTree *>(this)->find(key));
+  }
+
+  const V *find(const std::string &key) const {
+    const Node *node = &_root;
+    size_t pos = 0;
+    while (pos < key.size()) {
+      auto it = findChild(node->children, key[pos]);
+      if (!matchesChild(node->children, it, key[pos])) {
+        return nullptr;
+      }
+      const auto &label = (*it)->label;
+      if (key.compare(pos, label.size(), label) != 0) {
+        return nullptr;
+      }
+      pos += label.size();
+      node = it->get();
+    }
+    return node->value.has_value() ? &*node->value : nullptr;
+  }
+
+  /**
+   * @brief Remove `key`. Returns false if the key does not exist.
+   */
+  bool erase(const std::string &key) { return erase(_root, key); }
+
+  /**
+   * @brief Remove all keys starting with `prefix`. Returns the number of removed keys.
+   */
+  size_t erasePrefix(const std::string &prefix) {
+    if (prefix.empty()) {
+      auto count = _size;
+      clear();
+      return count;
+    }
+    return erasePrefix(_root, prefix);
+  }
+
+  void clear() {
+    _root.value.reset();
+    _root.children.clear();
+    _size = 0;
+  }
+
+  /**
+   * @brief Visit all keys which are a prefix of `key`, shortest first.
+   */
+  void forEachPrefixOf(const std::string &key,
+                       const std::function<void(const std::string &, const V &)> &action) const {
+    const Node *node = &_root;
+    size_t pos = 0;
+    while (true) {
+      if (node->value.has_value()) {
+        action(key.substr(0, pos), *node->value);
+      }
+      if (pos == key.size()) {
+        return;
+      }
+      auto it = findChild(node->children, key[pos]);
+      if (!matchesChild(node->children, it, key[pos])) {
+        return;
+      }
+      const auto &label = (*it)->label;
+      if (key.compare(pos, label.size(), label) != 0) {
+        return;
+      }
+      pos += label.size();
+      node = it->get();
+    }
+  }
+
+  /**
+   * @brief Visit all keys starting with `prefix` in order.
+   */
+  void forEach(const std::string &prefix,
+               const std::function<void(const std::string &, const V &)> &action) const {
+    std::string path;
+    const Node *node = findPrefix(prefix, path);
+    if (node != nullptr) {
+      visit(*node, path, action);
+    }
+  }
+
+  /**
+   * @brief Visit all keys starting with `prefix` in order. Keys containing `delimiter` after the
+   * prefix are reported once per common prefix, which includes the delimiter. Delimiter `\0` is
+   * treated as no delimiter.
+   */
+  void forEachDelimited(const std::string &prefix, char delimiter,
+                        const std::function<void(const std::string &, const V &)> &onValue,
+                        const std::function<void(const std::string &)> &onCommonPrefix) const {
+    if (delimiter == 0) {
+      forEach(prefix, onValue);
+      return;
+    }
+    std::string path;
+    const Node *node = findPrefix(prefix, path);
+    if (node != nullptr) {
+      visitDelimited(*node, path, prefix.size(), delimiter, onValue, onCommonPrefix);
+    }
+  }
+
+  /**
+   * @brief Visit the keys and common prefixes of `forEachDelimited` which are greater than
+   * `startAfter` in order, so an empty `startAfter` only skips the empty key. Common prefixes are
+   * reported without value. Stops once `onEntry` returns false.
+   */
+  void
+  forEachDelimitedAfter(const std::string &prefix, char delimiter, const std::string &startAfter,
+                        const std::function<bool(const std::string &, const V *)> &onEntry) const {
+    std::string path;
+    const Node *node = findPrefix(prefix, path);
+    if (node != nullptr) {
+      visitAfter(*node, path, prefix.size(), delimiter, startAfter, onEntry);
+    }
+  }
+};
+
+} // namespace utility
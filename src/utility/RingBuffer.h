@@ -0,0 +1,121 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GEDS_RING_BUFFER_H
+#define GEDS_RING_BUFFER_H
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+
+namespace utility {
+
+/**
+ * @brief Bounded lock-free queue for many producers and a single consumer.
+ *
+ * Every slot carries a sequence number that tells producers and the consumer whose turn it is, so
+ * neither side takes a lock (D. Vyukov's bounded queue). Entries are written and read in place:
+ * `T` is never moved, which allows it to hold type-erased inline storage.
+ */
+template <typename T> class MPSCRingBuffer {
+  struct alignas(64) Slot {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  const size_t _mask;
+  std::unique_ptr<Slot[]> _slots;
+  alignas(64) std::atomic<size_t> _tail{0};
+  alignas(64) std::atomic<size_t> _head{0};
+
+public:
+  /**
+   * @brief Create a ring buffer with `capacity` rounded up to a power of two.
+   */
+  explicit MPSCRingBuffer(size_t capacity)
+      : _mask(std::bit_ceil(capacity < 2 ? 2 : capacity) - 1),
+        _slots(std::make_unique<Slot[]>(_mask + 1)) {
+    for (size_t i = 0; i <= _mask; i++) {
+      _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MPSCRingBuffer(const MPSCRingBuffer &) = delete;
+  MPSCRingBuffer &operator=(const MPSCRingBuffer &) = delete;
+
+  size_t capacity() const { return _mask + 1; }
+
+  /**
+   * @brief Number of entries claimed by producers so far.
+   */
+  size_t pushed() const { return _tail.load(std::memory_order_acquire); }
+
+  /**
+   * @brief Number of entries consumed so far.
+   */
+  size_t popped() const { return _head.load(std::memory_order_acquire); }
+
+  /**
+   * @brief Claim a slot and fill it with `fill(T &)`. Returns false without calling `fill` if the
+   * buffer is full. Safe to call from any thread.
+   *
+   * If `fill` throws, the slot is published as `fill` left it and the exception propagates: An
+   * unpublished slot would stall the consumer forever.
+   */
+  template <typename F> bool tryPush(F &&fill) {
+    auto position = _tail.load(std::memory_order_relaxed);
+    Slot *slot;
+    while (true) {
+      slot = &_slots[position & _mask];
+      auto sequence = slot->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+      if (diff == 0) {
+        if (_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        position = _tail.load(std::memory_order_relaxed);
+      }
+    }
+    struct Publish {
+      Slot *slot;
+      size_t sequence;
+      ~Publish() { slot->sequence.store(sequence, std::memory_order_release); }
+    } publish{slot, position + 1};
+    fill(slot->value);
+    return true;
+  }
+
+  /**
+   * @brief Whether `tryPop` finds a published entry. Must only be called by the consumer thread.
+   */
+  bool readable() const {
+    auto head = _head.load(std::memory_order_relaxed);
+    return _slots[head & _mask].sequence.load(std::memory_order_acquire) == head + 1;
+  }
+
+  /**
+   * @brief Pass the oldest entry to `consume(T &)` and release its slot. Returns false if the
+   * buffer is empty. Must only be called by the consumer thread.
+   */
+  template <typename F> bool tryPop(F &&consume) {
+    auto head = _head.load(std::memory_order_relaxed);
+    auto &slot = _slots[head & _mask];
+    if (slot.sequence.load(std::memory_order_acquire) != head + 1) {
+      return false;
+    }
+    consume(slot.value);
+    slot.sequence.store(head + _mask + 1, std::memory_order_release);
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+};
+
+} // namespace utility
+
+#endif // GEDS_RING_BUFFER_H
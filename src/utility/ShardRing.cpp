@@ -0,0 +1,75 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ShardRing.h"
+
+#include <algorithm>
+
+namespace utility {
+
+ShardRing::ShardRing(std::vector<std::string> shards, size_t virtualNodes)
+    : _shards(std::move(shards)) {
+  _points.reserve(_shards.size() * virtualNodes);
+  for (size_t i = 0; i < _shards.size(); i++) {
+    for (size_t v = 0; v < virtualNodes; v++) {
+      _points.emplace_back(hash(_shards[i] + "#" + std::to_string(v)), i);
+    }
+  }
+  // Ties are broken by name, not by position in the list.
+  std::sort(_points.begin(), _points.end(), [&](const auto &a, const auto &b) {
+    return a.first < b.first || (a.first == b.first && _shards[a.second] < _shards[b.second]);
+  });
+}
+
+ShardRing ShardRing::parse(std::string_view list) {
+  std::vector<std::string> shards;
+  while (!list.empty()) {
+    auto end = list.find(',');
+    auto shard = list.substr(0, end);
+    while (!shard.empty() && shard.front() == ' ') {
+      shard.remove_prefix(1);
+    }
+    while (!shard.empty() && shard.back() == ' ') {
+      shard.remove_suffix(1);
+    }
+    if (!shard.empty()) {
+      shards.emplace_back(shard);
+    }
+    if (end == std::string_view::npos) {
+      break;
+    }
+    list.remove_prefix(end + 1);
+  }
+  return ShardRing(std::move(shards));
+}
+
+uint64_t ShardRing::hash(std::string_view key) {
+  // FNV-1a followed by the SplitMix64 finalizer to spread similar names over the ring.
+  uint64_t h = 14695981039346656037ULL;
+  for (auto c : key) {
+    h ^= static_cast<uint8_t>(c);
+    h *= 1099511628211ULL;
+  }
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+  return h;
+}
+
+size_t ShardRing::shardOf(std::string_view key) const {
+  if (_shards.size() == 1) {
+    return 0;
+  }
+  auto it = std::lower_bound(_points.begin(), _points.end(), hash(key),
+                             [](const auto &point, uint64_t h) { return point.first < h; });
+  if (it == _points.end()) {
+    it = _points.begin();
+  }
+  return it->second;
+}
+
+} // namespace utility
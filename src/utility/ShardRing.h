@@ -0,0 +1,56 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef UTILITY_SHARD_RING_H
+#define UTILITY_SHARD_RING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace utility {
+
+/**
+ * @brief Consistent-hash ring assigning keys to shards.
+ *
+ * Every shard is placed on the ring at `virtualNodes` points derived from its name, and a key
+ * belongs to the first point at or after its hash. The assignment only depends on the set of
+ * shard names, so clients and servers configured with the same names in any order agree on it,
+ * and adding a shard only moves the keys it takes over. The hash is stable across processes and
+ * platforms.
+ */
+class ShardRing {
+  std::vector<std::string> _shards;
+  std::vector<std::pair<uint64_t, size_t>> _points;
+
+public:
+  static constexpr size_t DefaultVirtualNodes = 128;
+
+  explicit ShardRing(std::vector<std::string> shards, size_t virtualNodes = DefaultVirtualNodes);
+
+  /**
+   * @brief Ring of the comma-separated shard names in `list`. Surrounding spaces are ignored.
+   */
+  static ShardRing parse(std::string_view list);
+
+  static uint64_t hash(std::string_view key);
+
+  size_t size() const { return _shards.size(); }
+
+  const std::string &shard(size_t index) const { return _shards[index]; }
+  const std::vector<std::string> &shards() const { return _shards; }
+
+  /**
+   * @brief Index of the shard owning `key`. The ring must not be empty.
+   */
+  size_t shardOf(std::string_view key) const;
+};
+
+} // namespace utility
+
+#endif // UTILITY_SHARD_RING_H
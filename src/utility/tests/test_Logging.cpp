@@ -0,0 +1,159 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "Logging.h"
+
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(Logging, DeferredFormatting) {
+  auto &logger = geds::logging::Logger::instance();
+  std::stringstream out;
+  {
+    std::string temporary = "temporary string that does not fit into the small string buffer";
+    std::string_view view = temporary;
+    char buffer[] = "buffer";
+    logger.log(out, false, "literal ", temporary.c_str(), " ", view, " ", buffer, " ", 42);
+    temporary.assign(temporary.size(), 'x');
+    buffer[0] = 'X';
+  }
+  logger.flush();
+  ASSERT_EQ(out.str(), "literal temporary string that does not fit into the small string buffer "
+                       "temporary string that does not fit into the small string buffer buffer "
+                       "42\n");
+}
+
+namespace {
+/**
+ * A non-owning view that is not a std::string_view, like absl::string_view.
+ */
+struct ForeignView {
+  const char *data;
+  size_t size;
+  explicit operator std::string() const { return std::string(data, size); }
+};
+std::ostream &operator<<(std::ostream &out, const ForeignView &view) {
+  return out.write(view.data, view.size);
+}
+} // namespace
+
+TEST(Logging, ForeignStringViews) {
+  auto &logger = geds::logging::Logger::instance();
+  std::stringstream out;
+  {
+    std::string temporary = "message owned by a temporary status";
+    logger.log(out, false, "view: ", ForeignView{temporary.data(), temporary.size()});
+    temporary.assign(temporary.size(), 'x');
+  }
+  logger.flush();
+  ASSERT_EQ(out.str(), "view: message owned by a temporary status\n");
+}
+
+TEST(Logging, ConcurrentLines) {
+  constexpr size_t numThreads = 8;
+  constexpr size_t perThread = 1000;
+  auto &logger = geds::logging::Logger::instance();
+  std::stringstream out;
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < numThreads; t++) {
+    threads.emplace_back([&, t] {
+      for (size_t i = 0; i < perThread; i++) {
+        geds::logging::LogLine(out, "thread ", t, " line ", i);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  logger.flush();
+  size_t lines = 0;
+  for (std::string line; std::getline(out, line);) {
+    ASSERT_TRUE(line.starts_with("thread ")) << line;
+    lines++;
+  }
+  ASSERT_EQ(lines + logger.dropped(), numThreads * perThread);
+}
+
+TEST(Logging, Controls) {
+  auto &logger = geds::logging::Logger::instance();
+  logger.setLevel(geds::logging::Level::Warning);
+  ASSERT_FALSE(logger.enabled(geds::logging::Level::Info));
+  ASSERT_TRUE(logger.enabled(geds::logging::Level::Error));
+  logger.setLevel(geds::logging::Level::Debug);
+  ASSERT_TRUE(logger.enabled(geds::logging::Level::Info));
+
+  logger.setAccessSampling(4);
+  size_t sampled = 0;
+  for (size_t i = 0; i < 100; i++) {
+    sampled += logger.sampleAccess();
+  }
+  ASSERT_EQ(sampled, 25);
+  logger.setAccessSampling(0);
+  ASSERT_FALSE(logger.sampleAccess());
+  logger.setAccessSampling(1);
+  ASSERT_TRUE(logger.sampleAccess());
+}
+
+TEST(Logging, SynchronousLines) {
+  std::stringstream out;
+  geds::logging::LogLineSync(out, "error ", 42);
+  ASSERT_EQ(out.str(), "error 42\n");
+}
+
+TEST(Logging, MixedLines) {
+  auto &logger = geds::logging::Logger::instance();
+  std::stringstream out;
+  constexpr int Lines = 200;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < Lines; i++) {
+        logger.log(out, false, "async line ", t, " ", i);
+        logger.logSync(out, false, "sync line ", t, " ", i);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  logger.flush();
+  // Asynchronous and synchronous lines do not interleave.
+  std::string line;
+  size_t count = 0;
+  while (std::getline(out, line)) {
+    ASSERT_TRUE(line.starts_with("async line ") || line.starts_with("sync line ")) << line;
+    ASSERT_EQ(line.find("line", line.find("line") + 1), std::string::npos) << line;
+    count++;
+  }
+  ASSERT_EQ(count + logger.dropped(), 2 * 4 * Lines);
+}
+
+TEST(Logging, Fork) {
+  auto &logger = geds::logging::Logger::instance();
+  std::stringstream parent;
+  logger.log(parent, false, "before fork");
+  auto pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    // The writer thread does not exist in the child: Lines are written synchronously and the
+    // flush at exit does not wait for it.
+    std::stringstream child;
+    logger.log(child, false, "child");
+    std::exit(child.str() == "child\n" ? 0 : 1);
+  }
+  int status = 0;
+  ASSERT_EQ(waitpid(pid, &status, 0), pid);
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), 0);
+  logger.flush();
+  ASSERT_EQ(parent.str(), "before fork\n");
+}
@@ -0,0 +1,156 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "RadixTree.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+using Listing = std::pair<std::vector<std::string>, std::vector<std::string>>;
+
+Listing listTree(const utility::RadixTree<int> &tree, const std::string &prefix, char delimiter) {
+  Listing result;
+  tree.forEachDelimited(
+      prefix, delimiter, [&](const std::string &key, const int &) { result.first.push_back(key); },
+      [&](const std::string &commonPrefix) { result.second.push_back(commonPrefix); });
+  return result;
+}
+
+Listing listMap(const std::map<std::string, int> &map, const std::string &prefix, char delimiter) {
+  Listing result;
+  std::set<std::string> commonPrefixes;
+  for (auto it = map.lower_bound(prefix); it != map.end() && it->first.starts_with(prefix); it++) {
+    auto loc = delimiter == 0 ? std::string::npos : it->first.find(delimiter, prefix.size());
+    if (loc != std::string::npos) {
+      commonPrefixes.insert(it->first.substr(0, loc + 1));
+    } else {
+      result.first.push_back(it->first);
+    }
+  }
+  result.second = {commonPrefixes.begin(), commonPrefixes.end()};
+  return result;
+}
+
+std::string randomKey(std::mt19937 &rng) {
+  static const std::string alphabet = "ab/\xc3";
+  std::uniform_int_distribution<size_t> length(0, 8);
+  std::uniform_int_distribution<size_t> letter(0, alphabet.size() - 1);
+  std::string key;
+  for (size_t i = length(rng); i > 0; i--) {
+    key.push_back(alphabet[letter(rng)]);
+  }
+  return key;
+}
+
+} // namespace
+
+TEST(RadixTree, Basic) {
+  utility::RadixTree<int> tree;
+  ASSERT_TRUE(tree.insertOrAssign("dir/a", 1));
+  ASSERT_TRUE(tree.insertOrAssign("dir/ab", 2));
+  ASSERT_TRUE(tree.insertOrAssign("dir/sub/c", 3));
+  ASSERT_TRUE(tree.insertOrAssign("dir", 4));
+  ASSERT_FALSE(tree.insertOrAssign("dir/a", 5));
+  ASSERT_EQ(tree.size(), 4);
+  ASSERT_EQ(*tree.find("dir/a"), 5);
+  ASSERT_EQ(tree.find("dir/"), nullptr);
+  ASSERT_EQ(tree.find("dir/abc"), nullptr);
+
+  auto listing = listTree(tree, "dir/", '/');
+  ASSERT_EQ(listing.first, (std::vector<std::string>{"dir/a", "dir/ab"}));
+  ASSERT_EQ(listing.second, (std::vector<std::string>{"dir/sub/"}));
+
+  ASSERT_TRUE(tree.erase("dir/a"));
+  ASSERT_FALSE(tree.erase("dir/a"));
+  ASSERT_EQ(*tree.find("dir/ab"), 2);
+  ASSERT_EQ(tree.erasePrefix("dir/"), 2);
+  ASSERT_EQ(tree.size(), 1);
+  ASSERT_EQ(*tree.find("dir"), 4);
+}
+
+TEST(RadixTree, MatchesOrderedMap) {
+  std::mt19937 rng(42);
+  utility::RadixTree<int> tree;
+  std::map<std::string, int> reference;
+  for (int i = 0; i < 20000; i++) {
+    auto key = randomKey(rng);
+    switch (rng() % 4) {
+    case 0:
+      ASSERT_EQ(tree.erase(key), reference.erase(key) == 1) << key;
+      break;
+    case 1: {
+      auto prefix = key.substr(0, key.size() / 2);
+      size_t erased = 0;
+      for (auto it = reference.lower_bound(prefix);
+           it != reference.end() && it->first.starts_with(prefix);) {
+        it = reference.erase(it);
+        erased++;
+      }
+      ASSERT_EQ(tree.erasePrefix(prefix), erased) << prefix;
+      break;
+    }
+    default:
+      ASSERT_EQ(tree.insertOrAssign(key, i), reference.insert_or_assign(key, i).second) << key;
+    }
+    ASSERT_EQ(tree.size(), reference.size());
+  }
+  tree.insertOrAssign("", -1);
+  reference.insert_or_assign("", -1);
+  for (const auto &[key, value] : reference) {
+    ASSERT_NE(tree.find(key), nullptr) << key;
+    ASSERT_EQ(*tree.find(key), value);
+  }
+  for (int i = 0; i < 1000; i++) {
+    auto key = randomKey(rng);
+    std::vector<std::string> expected;
+    for (size_t length = 0; length <= key.size(); length++) {
+      if (reference.contains(key.substr(0, length))) {
+        expected.push_back(key.substr(0, length));
+      }
+    }
+    std::vector<std::string> prefixes;
+    tree.forEachPrefixOf(key, [&](const std::string &prefix, const int &) {
+      prefixes.push_back(prefix);
+    });
+    ASSERT_EQ(prefixes, expected) << key;
+  }
+  for (const std::string prefix : {"", "a", "ab", "a/", "b/a", "\xc3", "zz"}) {
+    for (char delimiter : {'\0', '/', 'b'}) {
+      ASSERT_EQ(listTree(tree, prefix, delimiter), listMap(reference, prefix, delimiter))
+          << prefix << " " << delimiter;
+
+      // Page through the merged listing three entries at a time.
+      auto expected = listMap(reference, prefix, delimiter);
+      std::vector<std::string> entries = expected.first;
+      entries.insert(entries.end(), expected.second.begin(), expected.second.end());
+      std::sort(entries.begin(), entries.end());
+      // The empty key is not greater than the empty `startAfter`.
+      std::erase(entries, "");
+      std::vector<std::string> paged;
+      std::string startAfter;
+      while (true) {
+        size_t count = 0;
+        tree.forEachDelimitedAfter(prefix, delimiter, startAfter,
+                                   [&](const std::string &entry, const int *) {
+                                     paged.push_back(entry);
+                                     return ++count < 3;
+                                   });
+        if (count < 3) {
+          break;
+        }
+        startAfter = paged.back();
+      }
+      ASSERT_EQ(paged, entries) << prefix << " " << delimiter;
+    }
+  }
+}
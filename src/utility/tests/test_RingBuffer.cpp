@@ -0,0 +1,87 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "RingBuffer.h"
+
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(RingBuffer, Capacity) {
+  utility::MPSCRingBuffer<int> buffer(5);
+  ASSERT_EQ(buffer.capacity(), 8);
+  ASSERT_FALSE(buffer.readable());
+  for (int i = 0; i < 8; i++) {
+    ASSERT_TRUE(buffer.tryPush([&](int &value) { value = i; }));
+  }
+  ASSERT_TRUE(buffer.readable());
+  ASSERT_FALSE(buffer.tryPush([](int &) { FAIL(); }));
+  int value = -1;
+  ASSERT_TRUE(buffer.tryPop([&](int &v) { value = v; }));
+  ASSERT_EQ(value, 0);
+  ASSERT_TRUE(buffer.tryPush([](int &v) { v = 8; }));
+  for (int i = 1; i <= 8; i++) {
+    ASSERT_TRUE(buffer.tryPop([&](int &v) { value = v; }));
+    ASSERT_EQ(value, i);
+  }
+  ASSERT_FALSE(buffer.tryPop([](int &) { FAIL(); }));
+  ASSERT_FALSE(buffer.readable());
+  ASSERT_EQ(buffer.pushed(), 9);
+  ASSERT_EQ(buffer.popped(), 9);
+}
+
+TEST(RingBuffer, ThrowingFill) {
+  utility::MPSCRingBuffer<int> buffer(4);
+  auto throwing = [](int &value) {
+    value = -1;
+    throw std::runtime_error("fill failed");
+  };
+  ASSERT_THROW(buffer.tryPush(throwing), std::runtime_error);
+  ASSERT_TRUE(buffer.tryPush([](int &value) { value = 1; }));
+  // The slot of the failed push does not block the consumer.
+  int value = 0;
+  ASSERT_TRUE(buffer.tryPop([&](int &v) { value = v; }));
+  ASSERT_EQ(value, -1);
+  ASSERT_TRUE(buffer.tryPop([&](int &v) { value = v; }));
+  ASSERT_EQ(value, 1);
+}
+
+TEST(RingBuffer, ConcurrentProducers) {
+  constexpr size_t numThreads = 8;
+  constexpr size_t perThread = 100000;
+  utility::MPSCRingBuffer<std::pair<size_t, size_t>> buffer(64);
+  std::vector<std::thread> producers;
+  for (size_t t = 0; t < numThreads; t++) {
+    producers.emplace_back([&, t] {
+      for (size_t i = 0; i < perThread; i++) {
+        while (!buffer.tryPush([&](auto &entry) { entry = {t, i}; })) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  // Entries of each producer arrive in order.
+  std::vector<size_t> next(numThreads, 0);
+  size_t received = 0;
+  while (received < numThreads * perThread) {
+    if (!buffer.tryPop([&](auto &entry) {
+          ASSERT_EQ(entry.second, next[entry.first]);
+          next[entry.first]++;
+        })) {
+      std::this_thread::yield();
+      continue;
+    }
+    received++;
+  }
+  for (auto &producer : producers) {
+    producer.join();
+  }
+  for (auto n : next) {
+    ASSERT_EQ(n, perThread);
+  }
+}
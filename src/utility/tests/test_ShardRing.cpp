@@ -0,0 +1,65 @@
+/**
+ * Copyright 2023- IBM Inc. All rights reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ShardRing.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(ShardRing, Parse) {
+  auto ring = utility::ShardRing::parse("a:4381, b:4381,,c:4381");
+  ASSERT_EQ(ring.size(), 3);
+  ASSERT_EQ(ring.shard(0), "a:4381");
+  ASSERT_EQ(ring.shard(1), "b:4381");
+  ASSERT_EQ(ring.shard(2), "c:4381");
+
+  auto single = utility::ShardRing::parse("localhost:4381");
+  ASSERT_EQ(single.size(), 1);
+  ASSERT_EQ(single.shardOf("bucket"), 0);
+}
+
+TEST(ShardRing, IndependentOfOrder) {
+  auto ring = utility::ShardRing::parse("a,b,c");
+  auto reversed = utility::ShardRing::parse("c,b,a");
+  for (size_t i = 0; i < 1000; i++) {
+    auto key = "bucket-" + std::to_string(i);
+    ASSERT_EQ(ring.shard(ring.shardOf(key)), reversed.shard(reversed.shardOf(key)));
+  }
+}
+
+TEST(ShardRing, Distribution) {
+  auto ring = utility::ShardRing::parse("a,b,c,d");
+  std::vector<size_t> counts(ring.size());
+  constexpr size_t Keys = 40000;
+  for (size_t i = 0; i < Keys; i++) {
+    counts[ring.shardOf("bucket-" + std::to_string(i))]++;
+  }
+  for (auto count : counts) {
+    ASSERT_GT(count, Keys / ring.size() / 2);
+    ASSERT_LT(count, Keys / ring.size() * 2);
+  }
+}
+
+TEST(ShardRing, AddShard) {
+  auto ring = utility::ShardRing::parse("a,b,c");
+  auto grown = utility::ShardRing::parse("a,b,c,d");
+  constexpr size_t Keys = 10000;
+  size_t moved = 0;
+  for (size_t i = 0; i < Keys; i++) {
+    auto key = "bucket-" + std::to_string(i);
+    const auto &before = ring.shard(ring.shardOf(key));
+    const auto &after = grown.shard(grown.shardOf(key));
+    if (before != after) {
+      // Keys only move to the new shard.
+      ASSERT_EQ(after, "d");
+      moved++;
+    }
+  }
+  ASSERT_GT(moved, 0);
+  ASSERT_LT(moved, Keys / 2);
+}